@@ -602,41 +602,52 @@ void MHABackwardProxyBase::exec_internal(MHA_PROXY_BACKWARD_EXEC_PARAM) {
         grad_nz = grad_z;
     }
 
-    // nz = ny @ nv
-    TensorND grad_ny{wksp_bundle.get_workspace(11).raw_ptr, m_grad_ny_layout};
-    TensorND grad_nv{wksp_bundle.get_workspace(12).raw_ptr, m_grad_nv_layout};
-    m_bmatmul_opr->param().transposeA = false;
-    m_bmatmul_opr->param().transposeB = true;
-    m_bmatmul_opr->exec(grad_nz, nv, grad_ny, wksp_bundle.get_workspace(13));
-    m_bmatmul_opr->param().transposeA = true;
-    m_bmatmul_opr->param().transposeB = false;
-    m_bmatmul_opr->exec(attn_weight, grad_nz, grad_nv, wksp_bundle.get_workspace(14));
-
-    // ny = dropout(ny)
-    TensorND grad_drop1{wksp_bundle.get_workspace(15).raw_ptr, m_grad_drop1_layout};
-    m_dropoutbw_opr->param().drop_prob = param.attn_prob;
-    m_dropoutbw_opr->exec(grad_ny, mask1, grad_drop1, wksp_bundle.get_workspace(16));
-    // ny = softmax(nx)
-    TensorND grad_nx{wksp_bundle.get_workspace(17).raw_ptr, m_grad_nx_layout};
-    m_softmaxbw_opr->param().axis = -1;
-    m_softmaxbw_opr->exec(nx, grad_drop1, grad_nx, wksp_bundle.get_workspace(18));
-    // nx = nx * scaler
-    T* d_scaler = wksp_bundle.get_workspace(19).ptr<T>();
-    T param_scaler = static_cast<T>(param.sm_scaler);
-    move_scaler_to_device(handle, d_scaler, &param_scaler);
-    m_elem_opr->param().mode = Elemwise::Mode::MUL;
-    m_elem_opr->exec(
-            {grad_nx, TensorND{d_scaler, {{1}, queries.layout.dtype}}}, grad_nx);
-
-    // nx = nq @ nk
     TensorND grad_nq{wksp_bundle.get_workspace(20).raw_ptr, m_grad_nq_layout};
     TensorND grad_nk{wksp_bundle.get_workspace(21).raw_ptr, m_grad_nk_layout};
-    m_bmatmul_opr->param().transposeA = false;
-    m_bmatmul_opr->param().transposeB = false;
-    m_bmatmul_opr->exec(grad_nx, nk, grad_nq, wksp_bundle.get_workspace(22));
-    m_bmatmul_opr->param().transposeA = true;
-    m_bmatmul_opr->param().transposeB = false;
-    m_bmatmul_opr->exec(grad_nx, nq, grad_nk, wksp_bundle.get_workspace(23));
+    TensorND grad_nv{wksp_bundle.get_workspace(12).raw_ptr, m_grad_nv_layout};
+    bool fused = false;
+    if (param.attn_prob == 0.f) {
+        // the extra workspace of the fused path follows the proxy bundle
+        fused = fused_attn_backward_exec(
+                handle, param, grad_nz, nq, nk, nv, nx, grad_nq, grad_nk, grad_nv,
+                workspace.raw_ptr + wksp_bundle.total_size_in_bytes());
+    }
+    if (!fused) {
+        // nz = ny @ nv
+        TensorND grad_ny{wksp_bundle.get_workspace(11).raw_ptr, m_grad_ny_layout};
+        m_bmatmul_opr->param().transposeA = false;
+        m_bmatmul_opr->param().transposeB = true;
+        m_bmatmul_opr->exec(grad_nz, nv, grad_ny, wksp_bundle.get_workspace(13));
+        m_bmatmul_opr->param().transposeA = true;
+        m_bmatmul_opr->param().transposeB = false;
+        m_bmatmul_opr->exec(
+                attn_weight, grad_nz, grad_nv, wksp_bundle.get_workspace(14));
+
+        // ny = dropout(ny)
+        TensorND grad_drop1{wksp_bundle.get_workspace(15).raw_ptr, m_grad_drop1_layout};
+        m_dropoutbw_opr->param().drop_prob = param.attn_prob;
+        m_dropoutbw_opr->exec(
+                grad_ny, mask1, grad_drop1, wksp_bundle.get_workspace(16));
+        // ny = softmax(nx)
+        TensorND grad_nx{wksp_bundle.get_workspace(17).raw_ptr, m_grad_nx_layout};
+        m_softmaxbw_opr->param().axis = -1;
+        m_softmaxbw_opr->exec(nx, grad_drop1, grad_nx, wksp_bundle.get_workspace(18));
+        // nx = nx * scaler
+        T* d_scaler = wksp_bundle.get_workspace(19).ptr<T>();
+        T param_scaler = static_cast<T>(param.sm_scaler);
+        move_scaler_to_device(handle, d_scaler, &param_scaler);
+        m_elem_opr->param().mode = Elemwise::Mode::MUL;
+        m_elem_opr->exec(
+                {grad_nx, TensorND{d_scaler, {{1}, queries.layout.dtype}}}, grad_nx);
+
+        // nx = nq @ nk
+        m_bmatmul_opr->param().transposeA = false;
+        m_bmatmul_opr->param().transposeB = false;
+        m_bmatmul_opr->exec(grad_nx, nk, grad_nq, wksp_bundle.get_workspace(22));
+        m_bmatmul_opr->param().transposeA = true;
+        m_bmatmul_opr->param().transposeB = false;
+        m_bmatmul_opr->exec(grad_nx, nq, grad_nk, wksp_bundle.get_workspace(23));
+    }
 
     // nq, nk, nv = q, k, v
     auto from_multihead_layout = [&](size_t head,
@@ -29,6 +29,35 @@ struct MHABackwardProxyBase {
     MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
 #undef cb
 
+    /*!
+     * \brief fused path from grad_nz to grad_nq/grad_nk/grad_nv
+     *
+     * Backends may override this to fuse the two batched matmuls around the
+     * softmax backward of every (batch, head) pair. \p ny is the saved softmax
+     * output. It is only called when attention dropout is disabled.
+     *
+     * \param workspace extra workspace following the proxy workspace bundle
+     * \return false if the fused path is not applicable
+     */
+    virtual bool fused_attn_backward_exec(
+            Handle* handle, const Param& param, const TensorND& grad_nz,
+            const TensorND& nq, const TensorND& nk, const TensorND& nv,
+            const TensorND& ny, const TensorND& grad_nq, const TensorND& grad_nk,
+            const TensorND& grad_nv, void* workspace) {
+        MEGDNN_MARK_USED_VAR(handle);
+        MEGDNN_MARK_USED_VAR(param);
+        MEGDNN_MARK_USED_VAR(grad_nz);
+        MEGDNN_MARK_USED_VAR(nq);
+        MEGDNN_MARK_USED_VAR(nk);
+        MEGDNN_MARK_USED_VAR(nv);
+        MEGDNN_MARK_USED_VAR(ny);
+        MEGDNN_MARK_USED_VAR(grad_nq);
+        MEGDNN_MARK_USED_VAR(grad_nk);
+        MEGDNN_MARK_USED_VAR(grad_nv);
+        MEGDNN_MARK_USED_VAR(workspace);
+        return false;
+    }
+
     size_t get_workspace_in_bytes(MHA_PROXY_BACKWARD_LAYOUT_CONST_PARAM);
     size_t get_mask_reservespace_in_bytes(MHA_PROXY_BACKWARD_LAYOUT_CONST_PARAM);
     size_t get_othr_reservespace_in_bytes(MHA_PROXY_BACKWARD_LAYOUT_CONST_PARAM);
@@ -501,60 +501,71 @@ void MHAForwardProxyBase::exec_internal(MHA_PROXY_FORWARD_EXEC_PARAM) {
         }
     }
 
-    // nx
-    TensorND nx{wksp_bundle.get_workspace(9).raw_ptr, m_nx_layout};
-    TensorND ny{othr_bundle.get_workspace(3).raw_ptr, m_nx_layout};
-    TensorND mask1{mask_bundle.get_workspace(0).raw_ptr, m_mask1_layout};
-    m_bmatmul_opr->param().transposeA = false;
-    m_bmatmul_opr->param().transposeB = true;
-    m_bmatmul_opr->exec(nq, nk, nx, wksp_bundle.get_workspace(10));
-    // scale
-    auto d_scaler = wksp_bundle.get_workspace(11).ptr<T>();
-    T param_scaler = static_cast<T>(param.sm_scaler);
-    move_scaler_to_device(handle, d_scaler, &param_scaler);
-    m_elem_opr->param().mode = Elemwise::Mode::MUL;
-    m_elem_opr->exec({nx, TensorND{d_scaler, {{1}, queries.layout.dtype}}}, nx);
-    // mask
-    if (param.attn_mask_type == MaskType::DEFAULT_MASK or
-        param.attn_mask_type == MaskType::USER_DEFINED_MASK) {
-        m_elem_opr->param().mode = Elemwise::Mode::ADD;
-        m_elem_opr->exec({nx, attn_mask}, nx);
-    }
-    if (param.training) {
-        // softmax
-        m_softmax_opr->exec(nx, ny, wksp_bundle.get_workspace(12));
-        // dropout
-        m_dropout_opr->param().drop_prob = param.attn_prob;
-        m_dropout_opr->exec(ny, attn_weight, mask1, wksp_bundle.get_workspace(13));
-    } else {
-        m_softmax_opr->exec(nx, attn_weight, wksp_bundle.get_workspace(12));
-    }
-    // nz
-    TensorND nz{wksp_bundle.get_workspace(14).raw_ptr, m_nz_layout};
     TensorND z{othr_bundle.get_workspace(4).raw_ptr, m_z_layout};
-    m_bmatmul_opr->param().transposeA = false;
-    m_bmatmul_opr->param().transposeB = false;
-    if (param.num_heads > 1) {
-        m_bmatmul_opr->exec(attn_weight, nv, nz, wksp_bundle.get_workspace(15));
-        // z: multihead to norm
-        auto relayout_from_multihead = [&](const TensorND& nq, const TensorND& q) {
-            size_t batch = nq.layout[0];
-            size_t seq = nq.layout[1];
-            size_t embeding_size = nq.layout[2];
-            TensorLayout layout{
-                    {batch / m_heads, m_heads, seq, embeding_size}, nq.layout.dtype};
-            layout = layout.dimshuffle({0, 2, 1, 3});
-            m_relayout_opr->exec({nq.raw_ptr(), layout}, q);
-        };
-        if ((param.training == false) and (param.oproj_size == 0)) {
-            relayout_from_multihead(nz, out);
+    bool fused = false;
+    if (!param.training) {
+        // the extra workspace of the fused path follows the proxy bundle
+        fused = fused_attn_exec(
+                handle, param, nq, nk, nv, attn_mask, attn_weight,
+                param.oproj_size ? z : out,
+                workspace.raw_ptr + wksp_bundle.total_size_in_bytes());
+    }
+    if (!fused) {
+        // nx
+        TensorND nx{wksp_bundle.get_workspace(9).raw_ptr, m_nx_layout};
+        TensorND ny{othr_bundle.get_workspace(3).raw_ptr, m_nx_layout};
+        TensorND mask1{mask_bundle.get_workspace(0).raw_ptr, m_mask1_layout};
+        m_bmatmul_opr->param().transposeA = false;
+        m_bmatmul_opr->param().transposeB = true;
+        m_bmatmul_opr->exec(nq, nk, nx, wksp_bundle.get_workspace(10));
+        // scale
+        auto d_scaler = wksp_bundle.get_workspace(11).ptr<T>();
+        T param_scaler = static_cast<T>(param.sm_scaler);
+        move_scaler_to_device(handle, d_scaler, &param_scaler);
+        m_elem_opr->param().mode = Elemwise::Mode::MUL;
+        m_elem_opr->exec({nx, TensorND{d_scaler, {{1}, queries.layout.dtype}}}, nx);
+        // mask
+        if (param.attn_mask_type == MaskType::DEFAULT_MASK or
+            param.attn_mask_type == MaskType::USER_DEFINED_MASK) {
+            m_elem_opr->param().mode = Elemwise::Mode::ADD;
+            m_elem_opr->exec({nx, attn_mask}, nx);
+        }
+        if (param.training) {
+            // softmax
+            m_softmax_opr->exec(nx, ny, wksp_bundle.get_workspace(12));
+            // dropout
+            m_dropout_opr->param().drop_prob = param.attn_prob;
+            m_dropout_opr->exec(ny, attn_weight, mask1, wksp_bundle.get_workspace(13));
         } else {
-            relayout_from_multihead(nz, z);
+            m_softmax_opr->exec(nx, attn_weight, wksp_bundle.get_workspace(12));
+        }
+        // nz
+        TensorND nz{wksp_bundle.get_workspace(14).raw_ptr, m_nz_layout};
+        m_bmatmul_opr->param().transposeA = false;
+        m_bmatmul_opr->param().transposeB = false;
+        if (param.num_heads > 1) {
+            m_bmatmul_opr->exec(attn_weight, nv, nz, wksp_bundle.get_workspace(15));
+            // z: multihead to norm
+            auto relayout_from_multihead = [&](const TensorND& nq, const TensorND& q) {
+                size_t batch = nq.layout[0];
+                size_t seq = nq.layout[1];
+                size_t embeding_size = nq.layout[2];
+                TensorLayout layout{
+                        {batch / m_heads, m_heads, seq, embeding_size},
+                        nq.layout.dtype};
+                layout = layout.dimshuffle({0, 2, 1, 3});
+                m_relayout_opr->exec({nq.raw_ptr(), layout}, q);
+            };
+            if ((param.training == false) and (param.oproj_size == 0)) {
+                relayout_from_multihead(nz, out);
+            } else {
+                relayout_from_multihead(nz, z);
+            }
+        } else if ((param.training == false) and (param.oproj_size == 0)) {
+            m_bmatmul_opr->exec(attn_weight, nv, out, wksp_bundle.get_workspace(15));
+        } else {
+            m_bmatmul_opr->exec(attn_weight, nv, z, wksp_bundle.get_workspace(15));
         }
-    } else if ((param.training == false) and (param.oproj_size == 0)) {
-        m_bmatmul_opr->exec(attn_weight, nv, out, wksp_bundle.get_workspace(15));
-    } else {
-        m_bmatmul_opr->exec(attn_weight, nv, z, wksp_bundle.get_workspace(15));
     }
 
     // o
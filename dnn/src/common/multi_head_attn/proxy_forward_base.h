@@ -29,6 +29,33 @@ struct MHAForwardProxyBase {
     MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
 #undef cb
 
+    /*!
+     * \brief fused path for z = softmax(nq @ nk^T * scaler + mask) @ nv
+     *
+     * Backends may override this to compute the attention of every (batch, head)
+     * pair in one pass without materializing nx. The result is written into \p z,
+     * whose layout is (batch, seq, heads * vsize), and the softmax result into
+     * \p attn_weight. It is only called in inference mode.
+     *
+     * \param workspace extra workspace following the proxy workspace bundle
+     * \return false if the fused path is not applicable
+     */
+    virtual bool fused_attn_exec(
+            Handle* handle, const Param& param, const TensorND& nq, const TensorND& nk,
+            const TensorND& nv, const TensorND& attn_mask, const TensorND& attn_weight,
+            const TensorND& z, void* workspace) {
+        MEGDNN_MARK_USED_VAR(handle);
+        MEGDNN_MARK_USED_VAR(param);
+        MEGDNN_MARK_USED_VAR(nq);
+        MEGDNN_MARK_USED_VAR(nk);
+        MEGDNN_MARK_USED_VAR(nv);
+        MEGDNN_MARK_USED_VAR(attn_mask);
+        MEGDNN_MARK_USED_VAR(attn_weight);
+        MEGDNN_MARK_USED_VAR(z);
+        MEGDNN_MARK_USED_VAR(workspace);
+        return false;
+    }
+
     void deduce_layout(MHA_PROXY_FORWARD_LAYOUT_PARAM);
     size_t get_workspace_in_bytes(MHA_PROXY_FORWARD_LAYOUT_CONST_PARAM);
     size_t get_mask_reservespace_in_bytes(MHA_PROXY_FORWARD_LAYOUT_CONST_PARAM);
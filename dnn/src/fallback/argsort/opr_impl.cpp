@@ -0,0 +1,179 @@
+#include "src/fallback/argsort/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/naive/handle.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+//! rows shorter than this are sorted by std::sort
+constexpr size_t RADIX_MIN_LEN = 64;
+constexpr size_t RADIX_BITS = 8;
+constexpr size_t RADIX_SIZE = 1 << RADIX_BITS;
+constexpr size_t RADIX_PASSES = 32 / RADIX_BITS;
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+bool is_radix_usable(DType dtype) {
+    return dtype == dtype::Float32() || dtype == dtype::Int32();
+}
+
+//! per-task uint32 buffers: keys and indices, each double buffered
+size_t buf_size(size_t N) {
+    return 4 * N;
+}
+
+//! map the value to an unsigned key of the same order; -0 and +0 compare equal
+uint32_t radix_key(dt_float32 x) {
+    uint32_t u;
+    memcpy(&u, &x, sizeof(u));
+    if (u == 0x80000000u) {
+        u = 0;
+    }
+    return (u >> 31) ? ~u : u | 0x80000000u;
+}
+
+uint32_t radix_key(dt_int32 x) {
+    return static_cast<uint32_t>(x) ^ 0x80000000u;
+}
+
+/*!
+ * \brief sort a row by its (key, index) pairs like naive::ArgsortForwardImpl
+ *
+ * LSD radix sort is stable, so equal keys keep the initial order; descending
+ * rows are fed in reverse with inverted keys to break ties by larger index
+ * first as std::greater on the pairs does
+ */
+template <typename ctype>
+void radix_argsort(
+        const ctype* src, ctype* dst, dt_int32* indices, size_t N, bool ascending,
+        uint32_t* buf) {
+    uint32_t *key = buf, *key_tmp = buf + N;
+    uint32_t *idx = buf + 2 * N, *idx_tmp = buf + 3 * N;
+    uint32_t hist[RADIX_PASSES][RADIX_SIZE];
+    memset(hist, 0, sizeof(hist));
+    uint32_t flip = ascending ? 0 : ~0u;
+    for (size_t i = 0; i < N; ++i) {
+        size_t j = ascending ? i : N - 1 - i;
+        uint32_t k = radix_key(src[j]) ^ flip;
+        key[i] = k;
+        idx[i] = j;
+        for (size_t d = 0; d < RADIX_PASSES; ++d) {
+            ++hist[d][(k >> (d * RADIX_BITS)) & (RADIX_SIZE - 1)];
+        }
+    }
+    for (size_t d = 0; d < RADIX_PASSES; ++d) {
+        size_t shift = d * RADIX_BITS;
+        uint32_t* cnt = hist[d];
+        // all the keys share this digit
+        if (cnt[(key[0] >> shift) & (RADIX_SIZE - 1)] == N) {
+            continue;
+        }
+        uint32_t sum = 0;
+        for (size_t b = 0; b < RADIX_SIZE; ++b) {
+            uint32_t c = cnt[b];
+            cnt[b] = sum;
+            sum += c;
+        }
+        for (size_t i = 0; i < N; ++i) {
+            uint32_t pos = cnt[(key[i] >> shift) & (RADIX_SIZE - 1)]++;
+            key_tmp[pos] = key[i];
+            idx_tmp[pos] = idx[i];
+        }
+        std::swap(key, key_tmp);
+        std::swap(idx, idx_tmp);
+    }
+    for (size_t i = 0; i < N; ++i) {
+        indices[i] = idx[i];
+        dst[i] = src[idx[i]];
+    }
+}
+
+template <typename ctype>
+void comparison_argsort(
+        const ctype* src, ctype* dst, dt_int32* indices, size_t N, bool ascending,
+        void* buf) {
+    using KV = std::pair<ctype, int>;
+    KV* row = static_cast<KV*>(buf);
+    for (size_t i = 0; i < N; ++i) {
+        row[i] = {src[i], static_cast<int>(i)};
+    }
+    if (ascending) {
+        std::sort(row, row + N);
+    } else {
+        std::sort(row, row + N, std::greater<KV>{});
+    }
+    for (size_t i = 0; i < N; ++i) {
+        dst[i] = row[i].first;
+        indices[i] = row[i].second;
+    }
+}
+
+template <typename ctype>
+void forward(
+        naive::HandleImpl* handle, size_t M, size_t N, const ctype* src, ctype* dst,
+        dt_int32* indices, bool ascending, uint32_t* workspace) {
+    size_t nr_parts = std::min(M, get_nr_threads(handle));
+    size_t size = buf_size(N);
+    auto run = [=](size_t part, size_t) {
+        size_t q = M / nr_parts, r = M % nr_parts;
+        size_t begin = part * q + std::min(part, r), end = begin + q + (part < r);
+        uint32_t* buf = workspace + part * size;
+        for (size_t i = begin; i < end; ++i) {
+            if (N < RADIX_MIN_LEN) {
+                comparison_argsort(
+                        src + i * N, dst + i * N, indices + i * N, N, ascending, buf);
+            } else {
+                radix_argsort(
+                        src + i * N, dst + i * N, indices + i * N, N, ascending, buf);
+            }
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+}
+
+}  // namespace
+
+size_t ArgsortForwardImpl::get_workspace_in_bytes(
+        const TensorLayout& src, const TensorLayout& dst,
+        const TensorLayout& indices) {
+    if (!is_radix_usable(src.dtype)) {
+        return naive::ArgsortForwardImpl::get_workspace_in_bytes(src, dst, indices);
+    }
+    size_t nr_parts = std::min(src[0], get_nr_threads(handle()));
+    return nr_parts * buf_size(src[1]) * sizeof(uint32_t);
+}
+
+void ArgsortForwardImpl::exec(
+        _megdnn_tensor_in src, _megdnn_tensor_out dst, _megdnn_tensor_out indices,
+        _megdnn_workspace workspace) {
+    if (!is_radix_usable(src.layout.dtype)) {
+        naive::ArgsortForwardImpl::exec(src, dst, indices, workspace);
+        return;
+    }
+    check_exec(src.layout, dst.layout, indices.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    size_t M = src.layout[0], N = src.layout[1];
+    bool ascending = param().order == Order::ASCENDING;
+    auto wptr = reinterpret_cast<uint32_t*>(workspace.raw_ptr);
+#define cb(DType)                                                 \
+    if (src.layout.dtype == DType()) {                            \
+        using ctype = DTypeTrait<DType>::ctype;                   \
+        forward<ctype>(                                           \
+                handle, M, N, src.ptr<ctype>(), dst.ptr<ctype>(), \
+                indices.ptr<dt_int32>(), ascending, wptr);        \
+        return;                                                   \
+    }
+    cb(dtype::Float32);
+    cb(dtype::Int32);
+#undef cb
+    megdnn_throw("bad dtype");
+}
+
+// vim: syntax=cpp.doxygen
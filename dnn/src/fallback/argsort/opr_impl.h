@@ -0,0 +1,28 @@
+#pragma once
+
+#include "src/naive/argsort/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief argsort of fp32 and int32 rows by LSD radix sort on the key bits
+ *
+ * rows are distributed over the cpu dispatcher and short rows are sorted by
+ * comparison; the other dtypes use the naive implementation.
+ */
+class ArgsortForwardImpl : public naive::ArgsortForwardImpl {
+public:
+    using naive::ArgsortForwardImpl::ArgsortForwardImpl;
+    void exec(
+            _megdnn_tensor_in src, _megdnn_tensor_out dst, _megdnn_tensor_out indices,
+            _megdnn_workspace workspace) override;
+    size_t get_workspace_in_bytes(
+            const TensorLayout& src, const TensorLayout& dst,
+            const TensorLayout& indices) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
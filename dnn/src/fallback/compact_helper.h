@@ -0,0 +1,150 @@
+#pragma once
+#include <algorithm>
+#include "megdnn/arch.h"
+#include "megdnn/basic_types.h"
+#include "src/fallback/general_intrinsic/gi_int.h"
+#include "src/naive/handle.h"
+
+namespace megdnn {
+namespace fallback {
+namespace compact {
+
+//! number of elements whose predicate results are packed into a mask byte
+constexpr size_t GROUP = 8;
+//! minimal number of elements handled by one task
+constexpr size_t MIN_PART_LEN = 64 * 1024;
+
+/*!
+ * \brief table from the predicate mask of a group to the offsets of its
+ *      selected elements, so that a group is compacted without branches
+ */
+struct MaskTable {
+    int32_t offset[256][GROUP];
+    size_t count[256];
+
+    MaskTable() {
+        for (size_t mask = 0; mask < 256; ++mask) {
+            size_t nr = 0;
+            for (size_t i = 0; i < GROUP; ++i) {
+                if (mask >> i & 1) {
+                    offset[mask][nr++] = i;
+                }
+            }
+            count[mask] = nr;
+            std::fill(offset[mask] + nr, offset[mask] + GROUP, 0);
+        }
+    }
+
+    static const MaskTable& inst() {
+        static MaskTable table;
+        return table;
+    }
+};
+
+//! number of tasks to compact n elements with given number of threads
+inline size_t nr_parts(size_t n, size_t nr_threads) {
+    return std::max<size_t>(1, std::min(nr_threads, n / MIN_PART_LEN));
+}
+
+//! elements [begin, end) of part \p part when n elements are split into
+//! \p nr_parts parts
+inline void split(
+        size_t n, size_t nr_parts, size_t part, size_t& begin, size_t& end) {
+    size_t q = n / nr_parts, r = n % nr_parts;
+    begin = part * q + std::min(part, r);
+    end = begin + q + (part < r);
+}
+
+//! number of elements in src[begin:end] satisfying pred
+template <typename ctype, class Pred>
+size_t count(const ctype* src, size_t begin, size_t end, const Pred& pred) {
+    size_t ret = 0;
+    for (size_t i = begin; i < end; ++i) {
+        ret += pred(src[i]);
+    }
+    return ret;
+}
+
+/*!
+ * \brief write the indices of the elements in src[begin:end] satisfying pred to
+ *      dst, which should hold exactly \p nr_selected elements
+ *
+ * The offsets of a group are added to the group start in vector registers and
+ * stored as a whole, then the output pointer is advanced by the number of
+ * selected elements. Whole stores stop before the end of dst, so the parts
+ * of dst can be written by different threads.
+ */
+template <typename ctype, class Pred>
+void compact(
+        const ctype* src, size_t begin, size_t end, size_t nr_selected,
+        const Pred& pred, dt_int32* dst) {
+    constexpr size_t width = GI_SIMD_LEN_BYTE / sizeof(int32_t);
+    static_assert(GROUP % width == 0, "bad group size");
+    auto&& table = MaskTable::inst();
+    size_t i = begin, nr = 0;
+    for (; i + GROUP <= end && nr + GROUP <= nr_selected; i += GROUP) {
+        uint32_t mask = 0;
+        for (size_t j = 0; j < GROUP; ++j) {
+            mask |= static_cast<uint32_t>(pred(src[i + j])) << j;
+        }
+        GI_INT32_t base = GiBroadcastInt32(i);
+        for (size_t j = 0; j < GROUP; j += width) {
+            GiStoreInt32(
+                    dst + nr + j,
+                    GiAddInt32(base, GiLoadInt32(table.offset[mask] + j)));
+        }
+        nr += table.count[mask];
+    }
+    for (; i < end; ++i) {
+        if (pred(src[i])) {
+            dst[nr++] = i;
+        }
+    }
+}
+
+/*!
+ * \brief first pass of the parallel compaction: count the selected elements of
+ *      each part of src into offsets[1:nr_parts+1]
+ */
+template <typename ctype, class Pred>
+void dispatch_count(
+        naive::HandleImpl* handle, const ctype* src, size_t n, size_t nr_parts,
+        const Pred& pred, size_t* offsets) {
+    auto kern = [=](size_t part, size_t) {
+        size_t begin, end;
+        split(n, nr_parts, part, begin, end);
+        offsets[part + 1] = count(src, begin, end, pred);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);
+}
+
+//! turn the counts of the first pass into the output offsets of the parts and
+//! return the total number of selected elements; must be called after sync
+inline size_t counts_to_offsets(size_t* offsets, size_t nr_parts) {
+    offsets[0] = 0;
+    for (size_t i = 0; i < nr_parts; ++i) {
+        offsets[i + 1] += offsets[i];
+    }
+    return offsets[nr_parts];
+}
+
+//! second pass of the parallel compaction: write the indices of the selected
+//! elements of each part to dst at the offset of the part
+template <typename ctype, class Pred>
+void dispatch_compact(
+        naive::HandleImpl* handle, const ctype* src, size_t n, size_t nr_parts,
+        const Pred& pred, const size_t* offsets, dt_int32* dst) {
+    auto kern = [=](size_t part, size_t) {
+        size_t begin, end;
+        split(n, nr_parts, part, begin, end);
+        compact(src, begin, end, offsets[part + 1] - offsets[part], pred,
+                dst + offsets[part]);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);
+}
+
+}  // namespace compact
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,132 @@
+#include "src/fallback/cond_take/opr_impl.h"
+#include "src/common/cond_take/predicate.cuh"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+using namespace cond_take;
+
+using Param = CondTake::Param;
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+struct CountKern {
+    template <typename ctype, class Pred>
+    static void run(
+            const ctype* mask, const Pred& pred, naive::HandleImpl* handle,
+            size_t size, size_t nr_parts, size_t* offsets, dt_int32*) {
+        compact::dispatch_count(handle, mask, size, nr_parts, pred, offsets);
+    }
+};
+
+struct CompactKern {
+    template <typename ctype, class Pred>
+    static void run(
+            const ctype* mask, const Pred& pred, naive::HandleImpl* handle,
+            size_t size, size_t nr_parts, size_t* offsets, dt_int32* idx) {
+        compact::dispatch_compact(handle, mask, size, nr_parts, pred, offsets, idx);
+    }
+};
+
+template <class Kern, typename ctype>
+void dispatch_mode(
+        const Param& param, const ctype* mask, naive::HandleImpl* handle, size_t size,
+        size_t nr_parts, size_t* offsets, dt_int32* idx) {
+    KParam kparam(param);
+    switch (param.mode) {
+#define cb(_m)                                                                \
+    case Param::Mode::_m:                                                     \
+        Kern::run(                                                            \
+                mask, Pred<PEnum::_m, ctype>(kparam), handle, size, nr_parts, \
+                offsets, idx);                                                \
+        return;
+        MEGDNN_FOREACH_COND_TAKE_MODE(cb)
+#undef cb
+    }
+    megdnn_assert_internal(0);
+}
+
+template <class Kern>
+void dispatch_mask(
+        const Param& param, const TensorND& mask, naive::HandleImpl* handle,
+        size_t size, size_t nr_parts, size_t* offsets, dt_int32* idx = nullptr) {
+    switch (mask.layout.dtype.enumv()) {
+#define cb(_dt)                                                                   \
+    case DTypeTrait<_dt>::enumv: {                                                \
+        using ctype = DTypeTrait<_dt>::ctype;                                     \
+        dispatch_mode<Kern>(                                                      \
+                param, mask.ptr<ctype>(), handle, size, nr_parts, offsets, idx); \
+        return;                                                                   \
+    }
+        MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+        cb(::megdnn::dtype::Bool)
+#undef cb
+        default:
+            megdnn_throw("bad mask dtype");
+    }
+}
+
+//! dst[i] = src[idx[i]], the values are moved as unsigned integers of the same
+//! size
+template <typename ctype>
+void dispatch_gather(
+        naive::HandleImpl* handle, size_t size, const dt_int32* idx,
+        const ctype* src, ctype* dst) {
+    size_t nr_parts = compact::nr_parts(size, get_nr_threads(handle));
+    auto kern = [=](size_t part, size_t) {
+        size_t begin, end;
+        compact::split(size, nr_parts, part, begin, end);
+        for (size_t i = begin; i < end; ++i) {
+            dst[i] = src[idx[i]];
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);
+}
+
+}  // anonymous namespace
+
+size_t CondTakeImpl::get_workspace_in_bytes(
+        const TensorLayout& data, const TensorLayout&) {
+    auto nr_parts = compact::nr_parts(data.total_nr_elems(), get_nr_threads(handle()));
+    return (nr_parts + 1) * sizeof(size_t);
+}
+
+CondTakeImpl::Output CondTakeImpl::exec(
+        _megdnn_tensor_in data, _megdnn_tensor_in mask, _megdnn_workspace workspace,
+        DynOutMallocPolicyCall malloc_policy) {
+    auto size = check_exec_get_size(data.layout, mask.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    auto nr_parts = compact::nr_parts(size, get_nr_threads(handle));
+    auto offsets = workspace.ptr<size_t>();
+
+    dispatch_mask<CountKern>(param(), mask, handle, size, nr_parts, offsets);
+    handle->megcore_dispatcher()->sync();
+    size_t out_size = compact::counts_to_offsets(offsets, nr_parts);
+    auto out_data = malloc_policy.alloc_output(0, data.layout.dtype, {out_size});
+    auto out_idx = malloc_policy.alloc_output(1, dtype::Int32(), {out_size});
+    auto idx = out_idx.ptr<dt_int32>();
+    dispatch_mask<CompactKern>(param(), mask, handle, size, nr_parts, offsets, idx);
+
+    switch (data.layout.dtype.size()) {
+#define cb(_bytes, _ctype)                                                       \
+    case _bytes:                                                                 \
+        dispatch_gather(                                                         \
+                handle, out_size, idx, static_cast<const _ctype*>(data.raw_ptr()), \
+                static_cast<_ctype*>(out_data.raw_ptr()));                       \
+        break;
+        cb(1, uint8_t) cb(2, uint16_t) cb(4, uint32_t)
+#undef cb
+        default:
+            megdnn_throw("bad data dtype");
+    }
+
+    return {{out_data, out_idx}};
+}
+
+// vim: syntax=cpp.doxygen
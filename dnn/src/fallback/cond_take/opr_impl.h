@@ -0,0 +1,30 @@
+#pragma once
+
+#include "src/naive/cond_take/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief CondTake by parallel two-pass compaction
+ *
+ * the first pass counts the selected elements of each part of the mask, then
+ * the second one writes their indices at the offsets of the parts by the mask
+ * table compaction shared with NonZero, and gathers the data.
+ */
+class CondTakeImpl : public naive::CondTakeImpl {
+public:
+    using naive::CondTakeImpl::CondTakeImpl;
+
+    size_t get_workspace_in_bytes(
+            const TensorLayout& data, const TensorLayout& mask) override;
+
+    Output exec(
+            _megdnn_tensor_in data, _megdnn_tensor_in mask, _megdnn_workspace workspace,
+            DynOutMallocPolicyCall malloc_policy) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
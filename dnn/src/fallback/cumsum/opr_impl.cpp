@@ -0,0 +1,321 @@
+#include "src/fallback/cumsum/opr_impl.h"
+#include "src/common/reduce_helper.h"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/fallback/general_intrinsic/gi_float.h"
+#include "src/fallback/general_intrinsic/gi_int.h"
+#include "src/naive/handle.h"
+
+#include <algorithm>
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+//! minimal number of elements of a row chunk handled by one task
+constexpr size_t MIN_CHUNK_LEN = 16 * 1024;
+//! number of columns handled by one task when the axis is not the innermost
+constexpr size_t COL_BLOCK = 256;
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+template <typename ctype>
+struct Simd;
+
+template <>
+struct Simd<dt_float32> {
+    using vec = GI_FLOAT32_t;
+    static vec load(const dt_float32* ptr) { return GiLoadFloat32(ptr); }
+    static void store(dt_float32* ptr, vec v) { GiStoreFloat32(ptr, v); }
+    static vec add(vec a, vec b) { return GiAddFloat32(a, b); }
+    static vec broadcast(dt_float32 x) { return GiBroadcastFloat32(x); }
+    //! lanes [n, n + 4) of the concatenation of a and b
+    template <int n>
+    static vec ext(vec a, vec b) {
+        vec ret = GiExtqFloat32(a, b, n);
+        return ret;
+    }
+};
+
+template <>
+struct Simd<dt_int32> {
+    using vec = GI_INT32_t;
+    static vec load(const dt_int32* ptr) { return GiLoadInt32(ptr); }
+    static void store(dt_int32* ptr, vec v) { GiStoreInt32(ptr, v); }
+    static vec add(vec a, vec b) { return GiAddInt32(a, b); }
+    static vec broadcast(dt_int32 x) { return GiBroadcastInt32(x); }
+    template <int n>
+    static vec ext(vec a, vec b) {
+        GI_FLOAT32_t ret =
+                GiExtqFloat32(GiReintInt32ToFloat32(a), GiReintInt32ToFloat32(b), n);
+        return GiReinterpretAsInt32(ret);
+    }
+};
+
+#if GI_SIMD_LEN_BYTE == 16
+//! inclusive prefix sums of the lanes
+template <class S>
+typename S::vec lane_prefix(typename S::vec v) {
+    auto zero = S::broadcast(0);
+    v = S::add(v, S::template ext<3>(zero, v));
+    return S::add(v, S::template ext<2>(zero, v));
+}
+
+//! inclusive suffix sums of the lanes
+template <class S>
+typename S::vec lane_suffix(typename S::vec v) {
+    auto zero = S::broadcast(0);
+    v = S::add(v, S::template ext<1>(v, zero));
+    return S::add(v, S::template ext<2>(v, zero));
+}
+#endif
+
+/*!
+ * \brief scan a contiguous segment of a row from the given carry, and return the
+ *      carry of the segment following it in scan order
+ */
+template <typename ctype, bool exclusive, bool reverse>
+ctype scan_row(const ctype* src, ctype* dst, size_t len, ctype carry) {
+    using S = Simd<ctype>;
+    if (!reverse) {
+        size_t i = 0;
+#if GI_SIMD_LEN_BYTE == 16
+        auto zero = S::broadcast(0);
+        for (; i + 4 <= len; i += 4) {
+            auto v = lane_prefix<S>(S::load(src + i));
+            if (exclusive) {
+                v = S::template ext<3>(zero, v);
+            }
+            S::store(dst + i, S::add(S::broadcast(carry), v));
+            carry = exclusive ? dst[i + 3] + src[i + 3] : dst[i + 3];
+        }
+#endif
+        for (; i < len; ++i) {
+            if (exclusive) {
+                dst[i] = carry;
+                carry += src[i];
+            } else {
+                carry += src[i];
+                dst[i] = carry;
+            }
+        }
+    } else {
+        size_t i = len;
+#if GI_SIMD_LEN_BYTE == 16
+        auto zero = S::broadcast(0);
+        for (; i >= 4; i -= 4) {
+            auto v = lane_suffix<S>(S::load(src + i - 4));
+            if (exclusive) {
+                v = S::template ext<1>(v, zero);
+            }
+            S::store(dst + i - 4, S::add(S::broadcast(carry), v));
+            carry = exclusive ? dst[i - 4] + src[i - 4] : dst[i - 4];
+        }
+#endif
+        for (; i > 0; --i) {
+            if (exclusive) {
+                dst[i - 1] = carry;
+                carry += src[i - 1];
+            } else {
+                carry += src[i - 1];
+                dst[i - 1] = carry;
+            }
+        }
+    }
+    return carry;
+}
+
+//! sum of src[0:len]
+template <typename ctype>
+ctype segment_sum(const ctype* src, size_t len) {
+    using S = Simd<ctype>;
+    constexpr size_t width = GI_SIMD_LEN_BYTE / sizeof(ctype);
+    auto acc = S::broadcast(0);
+    size_t i = 0;
+    for (; i + width <= len; i += width) {
+        acc = S::add(acc, S::load(src + i));
+    }
+    ctype lanes[width], ret = 0;
+    S::store(lanes, acc);
+    for (size_t j = 0; j < width; ++j) {
+        ret += lanes[j];
+    }
+    for (; i < len; ++i) {
+        ret += src[i];
+    }
+    return ret;
+}
+
+//! z[0:n] = x[0:n] + y[0:n]
+template <typename ctype>
+void add_rows(const ctype* x, const ctype* y, ctype* z, size_t n) {
+    using S = Simd<ctype>;
+    constexpr size_t width = GI_SIMD_LEN_BYTE / sizeof(ctype);
+    size_t i = 0;
+    for (; i + width <= n; i += width) {
+        S::store(z + i, S::add(S::load(x + i), S::load(y + i)));
+    }
+    for (; i < n; ++i) {
+        z[i] = x[i] + y[i];
+    }
+}
+
+//! scan n adjacent columns of B rows with a stride of C elements
+template <typename ctype, bool exclusive, bool reverse>
+void scan_cols(const ctype* src, ctype* dst, size_t B, size_t C, size_t n) {
+    //! offset from a row to the previous one in scan order
+    ptrdiff_t prev = reverse ? static_cast<ptrdiff_t>(C) : -static_cast<ptrdiff_t>(C);
+    for (size_t k = 0; k < B; ++k) {
+        size_t b = reverse ? B - 1 - k : k;
+        const ctype* s = src + b * C;
+        ctype* d = dst + b * C;
+        if (!k) {
+            if (exclusive) {
+                std::fill(d, d + n, ctype(0));
+            } else {
+                std::copy(s, s + n, d);
+            }
+        } else {
+            add_rows(d + prev, exclusive ? s + prev : s, d, n);
+        }
+    }
+}
+
+struct CumsumPlan {
+    size_t A, B, C;
+    //! number of chunks of each row scanned by the two-pass algorithm; 1 if
+    //! rows are not split
+    size_t nr_chunks;
+    //! number of tasks
+    size_t nr_parts;
+};
+
+bool make_plan(Handle* handle, const TensorLayout& src, size_t axis, CumsumPlan& plan) {
+    if ((src.dtype != dtype::Float32() && src.dtype != dtype::Int32()) ||
+        src.is_empty()) {
+        return false;
+    }
+    size_t A, B, C;
+    reduce::get_ABC(src, A, B, C, axis);
+    size_t nr_threads = get_nr_threads(handle);
+    plan.A = A;
+    plan.B = B;
+    plan.C = C;
+    plan.nr_chunks = 1;
+    if (C == 1) {
+        if (A < nr_threads) {
+            plan.nr_chunks = std::max<size_t>(
+                    1, std::min(div_ceil(nr_threads, A), B / MIN_CHUNK_LEN));
+        }
+        plan.nr_parts =
+                plan.nr_chunks > 1 ? A * plan.nr_chunks : std::min(A, nr_threads);
+    } else {
+        plan.nr_parts = std::min(A * div_ceil(C, COL_BLOCK), nr_threads);
+    }
+    return true;
+}
+
+template <typename ctype, bool exclusive, bool reverse>
+void exec_scan(
+        naive::HandleImpl* handle, const CumsumPlan& plan, const ctype* src,
+        ctype* dst, ctype* workspace) {
+    size_t A = plan.A, B = plan.B, C = plan.C, nr_parts = plan.nr_parts;
+    if (C > 1) {
+        size_t nr_blocks = div_ceil(C, COL_BLOCK);
+        auto kern = [=](size_t part, size_t) {
+            size_t begin, end;
+            compact::split(A * nr_blocks, nr_parts, part, begin, end);
+            for (size_t t = begin; t < end; ++t) {
+                size_t a = t / nr_blocks, c = t % nr_blocks * COL_BLOCK,
+                       offset = a * B * C + c;
+                scan_cols<ctype, exclusive, reverse>(
+                        src + offset, dst + offset, B, C, std::min(COL_BLOCK, C - c));
+            }
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);
+        return;
+    }
+    if (plan.nr_chunks == 1) {
+        auto kern = [=](size_t part, size_t) {
+            size_t begin, end;
+            compact::split(A, nr_parts, part, begin, end);
+            for (size_t a = begin; a < end; ++a) {
+                scan_row<ctype, exclusive, reverse>(
+                        src + a * B, dst + a * B, B, ctype(0));
+            }
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);
+        return;
+    }
+
+    size_t nr_chunks = plan.nr_chunks;
+    auto sum_kern = [=](size_t task, size_t) {
+        size_t a = task / nr_chunks, begin, end;
+        compact::split(B, nr_chunks, task % nr_chunks, begin, end);
+        workspace[task] = segment_sum(src + a * B + begin, end - begin);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, sum_kern);
+    auto scan_kern = [=](size_t task, size_t) {
+        size_t a = task / nr_chunks, chunk = task % nr_chunks, begin, end;
+        compact::split(B, nr_chunks, chunk, begin, end);
+        const ctype* sums = workspace + a * nr_chunks;
+        ctype carry = 0;
+        if (reverse) {
+            for (size_t i = chunk + 1; i < nr_chunks; ++i) {
+                carry += sums[i];
+            }
+        } else {
+            for (size_t i = 0; i < chunk; ++i) {
+                carry += sums[i];
+            }
+        }
+        scan_row<ctype, exclusive, reverse>(
+                src + a * B + begin, dst + a * B + begin, end - begin, carry);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, scan_kern);
+}
+
+}  // anonymous namespace
+
+size_t CumsumForwardImpl::get_workspace_in_bytes(
+        const TensorLayout& src, const TensorLayout& dst) {
+    CumsumPlan plan;
+    if (!make_plan(handle(), src, param().axis, plan)) {
+        return naive::CumsumForwardImpl::get_workspace_in_bytes(src, dst);
+    }
+    return plan.nr_chunks > 1 ? plan.A * plan.nr_chunks * src.dtype.size() : 0;
+}
+
+void CumsumForwardImpl::exec(
+        _megdnn_tensor_in src, _megdnn_tensor_out dst, _megdnn_workspace workspace) {
+    CumsumPlan plan;
+    if (!make_plan(handle(), src.layout, param().axis, plan)) {
+        naive::CumsumForwardImpl::exec(src, dst, workspace);
+        return;
+    }
+    check_exec(src.layout, dst.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    bool exclusive = param().exclusive, reverse = param().reverse;
+#define cb_mode(_excl, _rev)                                      \
+    if (exclusive == _excl && reverse == _rev) {                  \
+        exec_scan<ctype, _excl, _rev>(                            \
+                handle, plan, src.ptr<ctype>(), dst.ptr<ctype>(), \
+                workspace.ptr<ctype>());                          \
+        return;                                                   \
+    }
+#define cb(DType)                                                       \
+    if (src.layout.dtype == DType()) {                                  \
+        using ctype = DTypeTrait<DType>::ctype;                         \
+        cb_mode(false, false) cb_mode(false, true) cb_mode(true, false) \
+                cb_mode(true, true)                                     \
+    }
+    cb(dtype::Float32) cb(dtype::Int32)
+#undef cb
+#undef cb_mode
+    megdnn_assert_internal(0);
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "src/naive/cumsum/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief Cumsum of fp32 and int32 by SIMD scans
+ *
+ * when the scanned axis is the innermost one, each row is scanned blockwise in
+ * vector registers, and rows that are too few for the threads are split into
+ * chunks by a two-pass scan: the sums of the chunks are computed in parallel,
+ * then each chunk is scanned from the total of the chunks before it. Otherwise
+ * the rows of the axis are added up as vectors, in parallel over the columns.
+ * The other dtypes use the naive implementation.
+ */
+class CumsumForwardImpl : public naive::CumsumForwardImpl {
+public:
+    using naive::CumsumForwardImpl::CumsumForwardImpl;
+    void exec(
+            _megdnn_tensor_in src, _megdnn_tensor_out dst,
+            _megdnn_workspace workspace) override;
+    size_t get_workspace_in_bytes(
+            const TensorLayout& src, const TensorLayout& dst) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
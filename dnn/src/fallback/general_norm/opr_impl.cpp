@@ -0,0 +1,282 @@
+#include "src/fallback/general_norm/opr_impl.h"
+#include "src/common/reduce_helper.h"
+#include "src/common/utils.h"
+#include "src/fallback/gi_simd_traits.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+using Param = megdnn::GeneralNorm::Param;
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+/*!
+ * per-task floats: weight and bias, then data and dst of a slice (C == 1) or
+ * of a block of NORM_COL_BLOCK columns converted to fp32
+ */
+size_t fwd_buf_size(size_t B, size_t C, bool inplace) {
+    if (inplace) {
+        return 0;
+    }
+    return C == 1 ? 4 * B : 2 * B + 2 * B * NORM_COL_BLOCK;
+}
+
+/*!
+ * per-task floats: the partial dweight and dbias, the column coefficients of
+ * norm_bwd_cols, then weight, diff, data and ddata converted to fp32
+ */
+size_t bwd_buf_size(size_t B, size_t C, bool inplace) {
+    if (C == 1) {
+        return 2 * B + (inplace ? 0 : 4 * B);
+    }
+    return 2 * B + 2 * NORM_COL_BLOCK + (inplace ? 0 : B + 3 * B * NORM_COL_BLOCK);
+}
+
+template <typename T>
+void forward(
+        naive::HandleImpl* handle, const NormKern& kern, const TensorND& data,
+        const TensorND& weight, const TensorND& bias, const TensorND& dst,
+        const TensorND& mean, const TensorND& rstd, const Param& param,
+        float* workspace) {
+    using Storage = NormStorage<T>;
+    size_t A, B, C;
+    reduce::get_ABC(data.layout, A, B, C, param.axis_start, param.axis_end);
+    // with C == 1 every slice is contiguous, otherwise a task normalizes a
+    // block of columns of the (B, C) matrix of one a
+    size_t nr_blocks = C == 1 ? 1 : div_ceil(C, NORM_COL_BLOCK);
+    size_t nr_items = A * nr_blocks;
+    size_t nr_parts = std::min(nr_items, get_nr_threads(handle));
+    size_t buf_size = fwd_buf_size(B, C, Storage::inplace);
+    bool affine = param.affine;
+    float eps = param.eps;
+    auto fwd = C == 1 ? kern.fwd_rows : kern.fwd_cols;
+    auto run = [=](size_t part, size_t) {
+        size_t begin, end;
+        norm_partition(nr_items, nr_parts, part, begin, end);
+        float* buf = workspace + part * buf_size;
+        float* cvt = buf + 2 * B;
+        NormParam p{};
+        if (affine) {
+            p.weight = Storage::load(weight.ptr<T>(), 1, B, B, buf);
+            p.bias = Storage::load(bias.ptr<T>(), 1, B, B, buf + B);
+        }
+        p.eps = eps;
+        if (C == 1) {
+            p.cols = p.stride = B;
+            size_t step = Storage::inplace ? end - begin : 1;
+            for (size_t i = begin; i < end; i += step) {
+                T* dst_ptr = dst.ptr<T>() + i * B;
+                p.rows = step;
+                p.x = Storage::load(data.ptr<T>() + i * B, 1, B, B, cvt);
+                p.y = Storage::dst(dst_ptr, cvt + B);
+                p.mean = mean.ptr<dt_float32>() + i;
+                p.rstd = rstd.ptr<dt_float32>() + i;
+                fwd(p);
+                Storage::store(dst_ptr, p.y, 1, B, B);
+            }
+            return;
+        }
+        p.rows = B;
+        for (size_t i = begin; i < end; ++i) {
+            size_t a = i / nr_blocks, c0 = i % nr_blocks * NORM_COL_BLOCK;
+            size_t nc = std::min(NORM_COL_BLOCK, C - c0);
+            size_t offset = a * B * C + c0;
+            T* dst_ptr = dst.ptr<T>() + offset;
+            p.cols = nc;
+            p.stride = Storage::inplace ? C : nc;
+            p.x = Storage::load(data.ptr<T>() + offset, B, nc, C, cvt);
+            p.y = Storage::dst(dst_ptr, cvt + B * NORM_COL_BLOCK);
+            p.mean = mean.ptr<dt_float32>() + a * C + c0;
+            p.rstd = rstd.ptr<dt_float32>() + a * C + c0;
+            fwd(p);
+            Storage::store(dst_ptr, p.y, B, nc, C);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+}
+
+template <typename T>
+void backward(
+        naive::HandleImpl* handle, const NormKern& kern, const TensorND& diff,
+        const TensorND& data, const TensorND& weight, const TensorND& mean,
+        const TensorND& rstd, const TensorND& ddata, const TensorND& dweight,
+        const TensorND& dbias, const Param& param, float* workspace) {
+    using Storage = NormStorage<T>;
+    size_t A, B, C;
+    reduce::get_ABC(data.layout, A, B, C, param.axis_start, param.axis_end);
+    size_t nr_blocks = C == 1 ? 1 : div_ceil(C, NORM_COL_BLOCK);
+    size_t nr_items = A * nr_blocks;
+    size_t nr_parts = std::min(nr_items, get_nr_threads(handle));
+    size_t buf_size = bwd_buf_size(B, C, Storage::inplace);
+    bool affine = param.affine;
+    auto bwd = C == 1 ? kern.bwd_rows : kern.bwd_cols;
+    auto run = [=](size_t part, size_t) {
+        size_t begin, end;
+        norm_partition(nr_items, nr_parts, part, begin, end);
+        float* buf = workspace + part * buf_size;
+        float* coef = buf + 2 * B;
+        float* cvt = C == 1 ? coef : coef + 2 * NORM_COL_BLOCK;
+        NormParam p{};
+        if (affine) {
+            p.weight = Storage::load(weight.ptr<T>(), 1, B, B, cvt);
+            p.dweight = buf;
+            p.dbias = buf + B;
+            std::fill(buf, buf + 2 * B, 0.f);
+        }
+        cvt += B;
+        if (C == 1) {
+            p.cols = p.stride = B;
+            size_t step = Storage::inplace ? end - begin : 1;
+            for (size_t i = begin; i < end; i += step) {
+                T* ddata_ptr = ddata.ptr<T>() + i * B;
+                p.rows = step;
+                p.dy = Storage::load(diff.ptr<T>() + i * B, 1, B, B, cvt);
+                p.x = Storage::load(data.ptr<T>() + i * B, 1, B, B, cvt + B);
+                p.y = Storage::dst(ddata_ptr, cvt + 2 * B);
+                p.mean = mean.ptr<dt_float32>() + i;
+                p.rstd = rstd.ptr<dt_float32>() + i;
+                bwd(p);
+                Storage::store(ddata_ptr, p.y, 1, B, B);
+            }
+            return;
+        }
+        size_t block = B * NORM_COL_BLOCK;
+        p.rows = B;
+        p.workspace = coef;
+        for (size_t i = begin; i < end; ++i) {
+            size_t a = i / nr_blocks, c0 = i % nr_blocks * NORM_COL_BLOCK;
+            size_t nc = std::min(NORM_COL_BLOCK, C - c0);
+            size_t offset = a * B * C + c0;
+            T* ddata_ptr = ddata.ptr<T>() + offset;
+            p.cols = nc;
+            p.stride = Storage::inplace ? C : nc;
+            p.dy = Storage::load(diff.ptr<T>() + offset, B, nc, C, cvt);
+            p.x = Storage::load(data.ptr<T>() + offset, B, nc, C, cvt + block);
+            p.y = Storage::dst(ddata_ptr, cvt + 2 * block);
+            p.mean = mean.ptr<dt_float32>() + a * C + c0;
+            p.rstd = rstd.ptr<dt_float32>() + a * C + c0;
+            bwd(p);
+            Storage::store(ddata_ptr, p.y, B, nc, C);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+
+    if (affine) {
+        auto reduce = [=]() {
+            T* dw = dweight.ptr<T>();
+            T* db = dbias.ptr<T>();
+            for (size_t b = 0; b < B; ++b) {
+                float sum_w = 0.f, sum_b = 0.f;
+                for (size_t part = 0; part < nr_parts; ++part) {
+                    sum_w += workspace[part * buf_size + b];
+                    sum_b += workspace[part * buf_size + B + b];
+                }
+                dw[b] = static_cast<T>(sum_w);
+                db[b] = static_cast<T>(sum_b);
+            }
+        };
+        MEGDNN_DISPATCH_CPU_KERN(handle, reduce());
+    }
+}
+
+}  // namespace
+
+/* ===================== GeneralNormForwardImpl ===================== */
+
+GeneralNormForwardImpl::GeneralNormForwardImpl(Handle* handle)
+        : naive::GeneralNormForwardImpl(handle),
+          m_kern(get_norm_kern<GiSimdTraits>()) {}
+
+size_t GeneralNormForwardImpl::get_workspace_in_bytes(
+        const TensorLayout& data, const TensorLayout& weight, const TensorLayout& bias,
+        const TensorLayout& dst, const TensorLayout& mean, const TensorLayout& rstd) {
+    if (!is_norm_usable({data, weight, bias, dst})) {
+        return naive::GeneralNormForwardImpl::get_workspace_in_bytes(
+                data, weight, bias, dst, mean, rstd);
+    }
+    size_t A, B, C;
+    reduce::get_ABC(data, A, B, C, param().axis_start, param().axis_end);
+    bool inplace = data.dtype == dtype::Float32();
+    return get_nr_threads(handle()) * fwd_buf_size(B, C, inplace) * sizeof(float);
+}
+
+void GeneralNormForwardImpl::exec(
+        _megdnn_tensor_in data, _megdnn_tensor_in weight, _megdnn_tensor_in bias,
+        _megdnn_tensor_out dst, _megdnn_tensor_out mean, _megdnn_tensor_out rstd,
+        _megdnn_workspace workspace) {
+    if (!is_norm_usable({data.layout, weight.layout, bias.layout, dst.layout})) {
+        naive::GeneralNormForwardImpl::exec(
+                data, weight, bias, dst, mean, rstd, workspace);
+        return;
+    }
+    check_exec(
+            data.layout, weight.layout, bias.layout, dst.layout, mean.layout,
+            rstd.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    auto wptr = workspace.ptr<dt_float32>();
+#define cb(DType)                                                                    \
+    if (data.layout.dtype == DType()) {                                              \
+        forward<DTypeTrait<DType>::ctype>(                                           \
+                handle, m_kern, data, weight, bias, dst, mean, rstd, param(), wptr); \
+        return;                                                                      \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE_FLOAT(cb)
+#undef cb
+    megdnn_throw("bad dtype");
+}
+
+/* ===================== GeneralNormBackwardImpl ===================== */
+
+GeneralNormBackwardImpl::GeneralNormBackwardImpl(Handle* handle)
+        : naive::GeneralNormBackwardImpl(handle),
+          m_kern(get_norm_kern<GiSimdTraits>()) {}
+
+size_t GeneralNormBackwardImpl::get_workspace_in_bytes(
+        const TensorLayout& diff, const TensorLayout& data, const TensorLayout& weight,
+        const TensorLayout& mean, const TensorLayout& rstd, const TensorLayout& ddata,
+        const TensorLayout& dweight, const TensorLayout& dbias) {
+    if (!is_norm_usable({data, diff, weight, ddata, dweight, dbias})) {
+        return naive::GeneralNormBackwardImpl::get_workspace_in_bytes(
+                diff, data, weight, mean, rstd, ddata, dweight, dbias);
+    }
+    size_t A, B, C;
+    reduce::get_ABC(data, A, B, C, param().axis_start, param().axis_end);
+    bool inplace = data.dtype == dtype::Float32();
+    return get_nr_threads(handle()) * bwd_buf_size(B, C, inplace) * sizeof(float);
+}
+
+void GeneralNormBackwardImpl::exec(
+        _megdnn_tensor_in diff, _megdnn_tensor_in data, _megdnn_tensor_in weight,
+        _megdnn_tensor_in mean, _megdnn_tensor_in rstd, _megdnn_tensor_out ddata,
+        _megdnn_tensor_out dweight, _megdnn_tensor_out dbias,
+        _megdnn_workspace workspace) {
+    if (!is_norm_usable(
+                {data.layout, diff.layout, weight.layout, ddata.layout, dweight.layout,
+                 dbias.layout})) {
+        naive::GeneralNormBackwardImpl::exec(
+                diff, data, weight, mean, rstd, ddata, dweight, dbias, workspace);
+        return;
+    }
+    check_exec(
+            diff.layout, data.layout, weight.layout, mean.layout, rstd.layout,
+            ddata.layout, dweight.layout, dbias.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    auto wptr = workspace.ptr<dt_float32>();
+#define cb(DType)                                                                  \
+    if (data.layout.dtype == DType()) {                                            \
+        backward<DTypeTrait<DType>::ctype>(                                        \
+                handle, m_kern, diff, data, weight, mean, rstd, ddata, dweight,    \
+                dbias, param(), wptr);                                             \
+        return;                                                                    \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE_FLOAT(cb)
+#undef cb
+    megdnn_throw("bad dtype");
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,31 @@
+#pragma once
+#include "src/fallback/elemwise/gi_impl/gi_mathfun.h"
+#include "src/fallback/general_intrinsic/gi_float.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief general intrinsic version of the x86::simd_traits interface
+ *
+ * kernels templated on the simd traits are instantiated with this one by the
+ * fallback oprs and with x86::simd_traits by the x86 oprs
+ */
+struct GiSimdTraits {
+    using type = GI_FLOAT32_t;
+    static MEGDNN_CONSTEXPR size_t width = GI_SIMD_LEN_BYTE / sizeof(float);
+    static type setzero() { return GiZeroFloat32(); }
+    static type set1(float a) { return GiBroadcastFloat32(a); }
+    static type loadu(const float* ptr) { return GiLoadFloat32(ptr); }
+    static void storeu(float* ptr, type a) { GiStoreFloat32(ptr, a); }
+    static type add(type a, type b) { return GiAddFloat32(a, b); }
+    static type sub(type a, type b) { return GiSubtractFloat32(a, b); }
+    static type mul(type a, type b) { return GiMultiplyFloat32(a, b); }
+    static type fmadd(type a, type b, type c) { return GiMultiplyAddFloat32(c, a, b); }
+    static type exp(type a) { return GiExpPsFloat32(a); }
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,248 @@
+#include "src/fallback/group_norm/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/gi_simd_traits.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+using Param = megdnn::GroupNorm::Param;
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+//! per-task floats: weight and bias of all the channels, data and dst of a
+//! group converted to fp32
+size_t fwd_buf_size(size_t C, size_t inner_size, bool inplace) {
+    return inplace ? 0 : 2 * C + 2 * inner_size;
+}
+
+//! per-task floats: weight of all the channels, diff, data and ddata of a
+//! group converted to fp32
+size_t bwd_buf_size(size_t C, size_t inner_size, bool inplace) {
+    return inplace ? 0 : C + 3 * inner_size;
+}
+
+template <typename T>
+void forward(
+        naive::HandleImpl* handle, NormKernFunc kern, const TensorND& data,
+        const TensorND& weight, const TensorND& bias, const TensorND& dst,
+        const TensorND& mean, const TensorND& rstd, const Param& param,
+        float* workspace) {
+    using Storage = NormStorage<T>;
+    size_t N = data.layout[0], C = data.layout[1];
+    size_t HxW = data.layout[2] * data.layout[3];
+    size_t G = param.group, D = C / G, inner_size = D * HxW;
+    size_t nr_parts = std::min(N * G, get_nr_threads(handle));
+    size_t buf_size = fwd_buf_size(C, inner_size, Storage::inplace);
+    bool affine = param.affine;
+    float eps = param.eps;
+    auto run = [=](size_t part, size_t) {
+        size_t begin, end;
+        norm_partition(N * G, nr_parts, part, begin, end);
+        float* buf = workspace + part * buf_size;
+        float* cvt = buf + 2 * C;
+        const float* w = nullptr;
+        const float* b = nullptr;
+        if (affine) {
+            w = Storage::load(weight.ptr<T>(), 1, C, C, buf);
+            b = Storage::load(bias.ptr<T>(), 1, C, C, buf + C);
+        }
+        NormParam p{};
+        p.rows = D;
+        p.cols = p.stride = HxW;
+        p.eps = eps;
+        for (size_t i = begin; i < end; ++i) {
+            size_t g = i % G;
+            T* dst_ptr = dst.ptr<T>() + i * inner_size;
+            if (affine) {
+                p.weight = w + g * D;
+                p.bias = b + g * D;
+            }
+            p.x = Storage::load(
+                    data.ptr<T>() + i * inner_size, 1, inner_size, inner_size, cvt);
+            p.y = Storage::dst(dst_ptr, cvt + inner_size);
+            p.mean = mean.ptr<dt_float32>() + i;
+            p.rstd = rstd.ptr<dt_float32>() + i;
+            kern(p);
+            Storage::store(dst_ptr, p.y, 1, inner_size, inner_size);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+}
+
+/*!
+ * the per-channel sums of diff * data and diff are kept in the first 2 * N * C
+ * floats of workspace for the weight gradient
+ */
+template <typename T>
+void backward(
+        naive::HandleImpl* handle, NormKernFunc kern, const TensorND& diff,
+        const TensorND& data, const TensorND& weight, const TensorND& mean,
+        const TensorND& rstd, const TensorND& ddata, const TensorND& dweight,
+        const TensorND& dbias, const Param& param, float* workspace) {
+    using Storage = NormStorage<T>;
+    size_t N = data.layout[0], C = data.layout[1];
+    size_t HxW = data.layout[2] * data.layout[3];
+    size_t G = param.group, D = C / G, inner_size = D * HxW;
+    size_t nr_parts = std::min(N * G, get_nr_threads(handle));
+    size_t buf_size = bwd_buf_size(C, inner_size, Storage::inplace);
+    bool affine = param.affine;
+    float eps = param.eps;
+    float* ds = workspace;
+    float* db = ds + N * C;
+    float* bufs = db + N * C;
+    auto run = [=](size_t part, size_t) {
+        size_t begin, end;
+        norm_partition(N * G, nr_parts, part, begin, end);
+        float* buf = bufs + part * buf_size;
+        float* cvt = buf + C;
+        const float* w = nullptr;
+        if (affine) {
+            w = Storage::load(weight.ptr<T>(), 1, C, C, buf);
+        }
+        NormParam p{};
+        p.rows = D;
+        p.cols = p.stride = HxW;
+        p.eps = eps;
+        for (size_t i = begin; i < end; ++i) {
+            size_t g = i % G;
+            T* ddata_ptr = ddata.ptr<T>() + i * inner_size;
+            p.weight = affine ? w + g * D : nullptr;
+            p.dy = Storage::load(
+                    diff.ptr<T>() + i * inner_size, 1, inner_size, inner_size, cvt);
+            p.x = Storage::load(
+                    data.ptr<T>() + i * inner_size, 1, inner_size, inner_size,
+                    cvt + inner_size);
+            p.y = Storage::dst(ddata_ptr, cvt + 2 * inner_size);
+            p.mean = mean.ptr<dt_float32>() + i;
+            p.rstd = rstd.ptr<dt_float32>() + i;
+            p.dweight = ds + i * D;
+            p.dbias = db + i * D;
+            kern(p);
+            Storage::store(ddata_ptr, p.y, 1, inner_size, inner_size);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+
+    if (affine) {
+        auto reduce = [=]() {
+            const float* mean_ptr = mean.ptr<dt_float32>();
+            const float* var_ptr = rstd.ptr<dt_float32>();
+            for (size_t c = 0; c < C; ++c) {
+                size_t g = c / D;
+                float sum_w = 0.f, sum_b = 0.f;
+                for (size_t n = 0; n < N; ++n) {
+                    float slice_rstd = 1.f / std::sqrt(var_ptr[n * G + g] + eps);
+                    sum_w += (ds[n * C + c] - db[n * C + c] * mean_ptr[n * G + g]) *
+                             slice_rstd;
+                    sum_b += db[n * C + c];
+                }
+                dweight.ptr<T>()[c] = static_cast<T>(sum_w);
+                dbias.ptr<T>()[c] = static_cast<T>(sum_b);
+            }
+        };
+        MEGDNN_DISPATCH_CPU_KERN(handle, reduce());
+    }
+}
+
+}  // namespace
+
+/* ===================== GroupNormForwardImpl ===================== */
+
+GroupNormForwardImpl::GroupNormForwardImpl(Handle* handle)
+        : naive::GroupNormForwardImpl(handle), m_kern(get_norm_kern<GiSimdTraits>()) {}
+
+size_t GroupNormForwardImpl::get_workspace_in_bytes(
+        const TensorLayout& data, const TensorLayout& weight, const TensorLayout& bias,
+        const TensorLayout& dst, const TensorLayout& mean, const TensorLayout& rstd) {
+    if (!is_norm_usable({data, weight, bias, dst})) {
+        return naive::GroupNormForwardImpl::get_workspace_in_bytes(
+                data, weight, bias, dst, mean, rstd);
+    }
+    size_t C = data[1], inner_size = data.total_nr_elems() / data[0] / param().group;
+    bool inplace = data.dtype == dtype::Float32();
+    return get_nr_threads(handle()) * fwd_buf_size(C, inner_size, inplace) *
+           sizeof(float);
+}
+
+void GroupNormForwardImpl::exec(
+        _megdnn_tensor_in data, _megdnn_tensor_in weight, _megdnn_tensor_in bias,
+        _megdnn_tensor_out dst, _megdnn_tensor_out mean, _megdnn_tensor_out rstd,
+        _megdnn_workspace workspace) {
+    if (!is_norm_usable({data.layout, weight.layout, bias.layout, dst.layout})) {
+        naive::GroupNormForwardImpl::exec(
+                data, weight, bias, dst, mean, rstd, workspace);
+        return;
+    }
+    check_exec(
+            data.layout, weight.layout, bias.layout, dst.layout, mean.layout,
+            rstd.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    auto wptr = workspace.ptr<dt_float32>();
+#define cb(DType)                                                               \
+    if (data.layout.dtype == DType()) {                                         \
+        forward<DTypeTrait<DType>::ctype>(                                      \
+                handle, m_kern.fwd_group, data, weight, bias, dst, mean, rstd, \
+                param(), wptr);                                                 \
+        return;                                                                 \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE_FLOAT(cb)
+#undef cb
+    megdnn_throw("bad dtype");
+}
+
+/* ===================== GroupNormBackwardImpl ===================== */
+
+GroupNormBackwardImpl::GroupNormBackwardImpl(Handle* handle)
+        : naive::GroupNormBackwardImpl(handle), m_kern(get_norm_kern<GiSimdTraits>()) {}
+
+size_t GroupNormBackwardImpl::get_workspace_in_bytes(
+        const TensorLayout& diff, const TensorLayout& data, const TensorLayout& weight,
+        const TensorLayout& mean, const TensorLayout& rstd, const TensorLayout& ddata,
+        const TensorLayout& dweight, const TensorLayout& dbias) {
+    if (!is_norm_usable({data, diff, weight, ddata, dweight, dbias})) {
+        return naive::GroupNormBackwardImpl::get_workspace_in_bytes(
+                diff, data, weight, mean, rstd, ddata, dweight, dbias);
+    }
+    size_t N = data[0], C = data[1];
+    size_t inner_size = data.total_nr_elems() / N / param().group;
+    bool inplace = data.dtype == dtype::Float32();
+    size_t nr_floats = 2 * N * C +
+                       get_nr_threads(handle()) * bwd_buf_size(C, inner_size, inplace);
+    return nr_floats * sizeof(float);
+}
+
+void GroupNormBackwardImpl::exec(
+        _megdnn_tensor_in diff, _megdnn_tensor_in data, _megdnn_tensor_in weight,
+        _megdnn_tensor_in mean, _megdnn_tensor_in rstd, _megdnn_tensor_out ddata,
+        _megdnn_tensor_out dweight, _megdnn_tensor_out dbias,
+        _megdnn_workspace workspace) {
+    if (!is_norm_usable(
+                {data.layout, diff.layout, weight.layout, ddata.layout, dweight.layout,
+                 dbias.layout})) {
+        naive::GroupNormBackwardImpl::exec(
+                diff, data, weight, mean, rstd, ddata, dweight, dbias, workspace);
+        return;
+    }
+    check_exec(
+            diff.layout, data.layout, weight.layout, mean.layout, rstd.layout,
+            ddata.layout, dweight.layout, dbias.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    auto wptr = workspace.ptr<dt_float32>();
+#define cb(DType)                                                                  \
+    if (data.layout.dtype == DType()) {                                            \
+        backward<DTypeTrait<DType>::ctype>(                                        \
+                handle, m_kern.bwd_group, diff, data, weight, mean, rstd, ddata,   \
+                dweight, dbias, param(), wptr);                                    \
+        return;                                                                    \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE_FLOAT(cb)
+#undef cb
+    megdnn_throw("bad dtype");
+}
+
+// vim: syntax=cpp.doxygen
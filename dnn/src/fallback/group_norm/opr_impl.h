@@ -0,0 +1,46 @@
+#pragma once
+#include "src/fallback/norm_helper.h"
+#include "src/naive/group_norm/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+class GroupNormForwardImpl : public naive::GroupNormForwardImpl {
+public:
+    GroupNormForwardImpl(Handle* handle);
+    void exec(
+            _megdnn_tensor_in data, _megdnn_tensor_in weight, _megdnn_tensor_in bias,
+            _megdnn_tensor_out dst, _megdnn_tensor_out mean, _megdnn_tensor_out rstd,
+            _megdnn_workspace workspace) override;
+    size_t get_workspace_in_bytes(
+            const TensorLayout& data, const TensorLayout& weight,
+            const TensorLayout& bias, const TensorLayout& dst, const TensorLayout& mean,
+            const TensorLayout& rstd) override;
+
+protected:
+    //! fp32 kernels, replaced by the x86 oprs when avx is available
+    NormKern m_kern;
+};
+
+class GroupNormBackwardImpl : public naive::GroupNormBackwardImpl {
+public:
+    GroupNormBackwardImpl(Handle* handle);
+    void exec(
+            _megdnn_tensor_in diff, _megdnn_tensor_in data, _megdnn_tensor_in weight,
+            _megdnn_tensor_in mean, _megdnn_tensor_in rstd, _megdnn_tensor_out ddata,
+            _megdnn_tensor_out dweight, _megdnn_tensor_out dbias,
+            _megdnn_workspace workspace) override;
+    size_t get_workspace_in_bytes(
+            const TensorLayout& diff, const TensorLayout& data,
+            const TensorLayout& weight, const TensorLayout& mean,
+            const TensorLayout& rstd, const TensorLayout& ddata,
+            const TensorLayout& dweight, const TensorLayout& dbias) override;
+
+protected:
+    NormKern m_kern;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
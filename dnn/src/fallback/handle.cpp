@@ -2,30 +2,47 @@
 #include "src/common/handle_impl.h"
 
 #include "src/fallback/add_update/opr_impl.h"
+#include "src/fallback/argsort/opr_impl.h"
 #include "src/fallback/batched_matrix_mul/opr_impl.h"
 #include "src/fallback/concat/opr_impl.h"
+#include "src/fallback/cond_take/opr_impl.h"
 #include "src/fallback/conv_bias/opr_impl.h"
 #include "src/fallback/convolution/opr_impl.h"
+#include "src/fallback/cumsum/opr_impl.h"
 #include "src/fallback/elemwise/opr_impl.h"
 #include "src/fallback/elemwise_multi_type/opr_impl.h"
 #include "src/fallback/flip/opr_impl.h"
 #include "src/fallback/gaussian_blur/opr_impl.h"
+#include "src/fallback/general_norm/opr_impl.h"
 #include "src/fallback/group_local/opr_impl.h"
+#include "src/fallback/group_norm/opr_impl.h"
+#include "src/fallback/indexing_multi_axis_vec/opr_impl.h"
+#include "src/fallback/indexing_one_hot/opr_impl.h"
+#include "src/fallback/layer_norm/opr_impl.h"
+#include "src/fallback/lstm/opr_impl.h"
+#include "src/fallback/lstm_cell/opr_impl.h"
 #include "src/fallback/mask_conv/opr_impl.h"
+#include "src/fallback/masked_fill/opr_impl.h"
 #include "src/fallback/matrix_mul/opr_impl.h"
+#include "src/fallback/mesh_indexing/opr_impl.h"
+#include "src/fallback/multi_head_attn/opr_impl.h"
+#include "src/fallback/non_zero/opr_impl.h"
 #include "src/fallback/pooling/opr_impl.h"
 #include "src/fallback/powc/opr_impl.h"
 #include "src/fallback/reduce/opr_impl.h"
 #include "src/fallback/relayout/opr_impl.h"
 #include "src/fallback/repeat/opr_impl.h"
 #include "src/fallback/resize/opr_impl.h"
+#include "src/fallback/rnn/opr_impl.h"
 #include "src/fallback/roi_copy/opr_impl.h"
 #include "src/fallback/rotate/opr_impl.h"
 #include "src/fallback/softmax/opr_impl.h"
 #include "src/fallback/split/opr_impl.h"
 #include "src/fallback/tile/opr_impl.h"
+#include "src/fallback/topk/opr_impl.h"
 #include "src/fallback/type_cvt/opr_impl.h"
 #include "src/fallback/warp_perspective/opr_impl.h"
+#include "src/fallback/where/opr_impl.h"
 
 namespace megdnn {
 namespace fallback {
@@ -61,6 +78,35 @@ MEGDNN_SPECIALIZE_CREATE_OPERATOR(Resize)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(BatchedMatrixMulForward)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(ConvBias)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(PowC)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(MultiHeadAttnForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(MultiHeadAttnBackward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(LayerNormForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(LayerNormBackward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GroupNormForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GroupNormBackward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GeneralNormForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GeneralNormBackward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(ArgsortForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(TopK)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(RNN)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(LSTM)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(LSTMCell)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(CumsumForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(CondTake)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(NonZero)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(WhereForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(MaskedFill)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(IndexingOneHotForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(IndexingSetOneHotForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(IndexingMultiAxisVec)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(IndexingSetMultiAxisVec)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(IndexingIncrMultiAxisVec)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(MeshIndexing)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(IncrMeshIndexing)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(SetMeshIndexing)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(BatchedMeshIndexing)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(BatchedIncrMeshIndexing)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(BatchedSetMeshIndexing)
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"
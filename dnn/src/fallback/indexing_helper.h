@@ -0,0 +1,94 @@
+#pragma once
+#include <cstring>
+#include "megdnn/basic_types.h"
+#include "src/common/indexing_multi_axis_vec_kdef.h"
+
+namespace megdnn {
+namespace fallback {
+namespace indexing {
+
+using OprFwd = indexing_multi_axis_vec_kdef::OprFwd;
+using OprSet = indexing_multi_axis_vec_kdef::OprSet;
+using OprIncr = indexing_multi_axis_vec_kdef::OprIncr;
+
+//! minimal number of elements handled by one task
+constexpr size_t MIN_PART_LEN = 16 * 1024;
+
+//! whether rows of different tasks must not reach the same data element, which
+//! is needed by accumulation with possibly duplicated indices
+template <class Opr>
+struct NeedOwner {
+    static constexpr bool value = false;
+};
+template <>
+struct NeedOwner<OprIncr> {
+    static constexpr bool value = true;
+};
+
+/*!
+ * \brief the task owning the data row at given offset
+ *
+ * Rows are assigned to tasks by the hash of their offset, so that rows reaching
+ * the same data are accumulated by the same task in the original order, which
+ * is conflict-free and gives the same result as a sequential scatter.
+ */
+inline size_t owner_of(ptrdiff_t offset, size_t nr_parts) {
+    uint64_t hash = static_cast<uint64_t>(offset) * 0x9E3779B97F4A7C15ull;
+    return (hash >> 32) % nr_parts;
+}
+
+//! apply Opr on contiguous rows of data and value with n elements
+template <typename ctype>
+void apply_row(OprFwd, ctype* data, ctype* value, size_t n) {
+    memcpy(value, data, n * sizeof(ctype));
+}
+
+template <typename ctype>
+void apply_row(OprSet, ctype* data, ctype* value, size_t n) {
+    memcpy(data, value, n * sizeof(ctype));
+}
+
+template <typename ctype>
+void apply_row(OprIncr, ctype* __restrict data, ctype* __restrict value, size_t n) {
+    for (size_t i = 0; i < n; ++i) {
+        data[i] += value[i];
+    }
+}
+
+/*!
+ * \brief apply Opr on a row of data with arbitrary layout and a row of value
+ *      with given stride
+ */
+template <class Opr, typename ctype>
+void apply_strided_row(
+        ctype* data, const TensorLayout& layout, ctype* value, ptrdiff_t value_stride) {
+    size_t idx[TensorLayout::MAX_NDIM] = {0}, ndim = layout.ndim;
+    ptrdiff_t offset = 0;
+    for (size_t i = 0, it = layout.total_nr_elems(); i < it; ++i) {
+        Opr::apply(data[offset], value[i * value_stride]);
+        for (size_t j = ndim; j--;) {
+            offset += layout.stride[j];
+            if (++idx[j] < layout.shape[j]) {
+                break;
+            }
+            offset -= layout.stride[j] * static_cast<ptrdiff_t>(layout.shape[j]);
+            idx[j] = 0;
+        }
+    }
+}
+
+//! offset of the \p i-th element in a layout
+inline ptrdiff_t offset_of(const TensorLayout& layout, size_t i) {
+    ptrdiff_t ret = 0;
+    for (size_t j = layout.ndim; j--;) {
+        ret += static_cast<ptrdiff_t>(i % layout.shape[j]) * layout.stride[j];
+        i /= layout.shape[j];
+    }
+    return ret;
+}
+
+}  // namespace indexing
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
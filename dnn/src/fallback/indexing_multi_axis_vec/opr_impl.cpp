@@ -0,0 +1,259 @@
+#include "src/fallback/indexing_multi_axis_vec/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/fallback/indexing_helper.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+using namespace indexing;
+
+namespace {
+
+using IndexDesc = IndexingMultiAxisVec::IndexDesc;
+using ExecInfo = IndexingMultiAxisVec::ExecInfo;
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+size_t nr_parts_of(size_t size, size_t nr_threads) {
+    return std::max<size_t>(1, std::min(nr_threads, size / MIN_PART_LEN));
+}
+
+/*!
+ * \brief value viewed as rows of (outer, idx) over data, where outer and tail
+ *      are the non-indexed axes before and after the indexed ones
+ */
+struct ExecPlan {
+    //! shape and data strides of the outer and tail axes
+    TensorLayout outer, tail;
+    size_t nr_outer = 1, nr_idx, nr_tail = 1;
+    ptrdiff_t value_stride;
+    //! whether the rows are contiguous in both data and value
+    bool contig_row;
+};
+
+//! indexers broadcast to the index shape
+struct OffsetBaseParam {
+    struct Item {
+        size_t axis;
+        const dt_int32* ptr;
+        TensorLayout layout;
+    };
+    size_t nr_index;
+    Item items[TensorLayout::MAX_NDIM];
+    TensorShape idx_shape;
+};
+
+ExecPlan make_plan(
+        const TensorLayout& data, const TensorLayout& value, const IndexDesc& index,
+        const ExecInfo& info, TensorShape& idx_shape) {
+    ExecPlan ret;
+    TensorLayout layout;
+    size_t idx_axis;
+    std::tie(layout, idx_axis, idx_shape) =
+            IndexingMultiAxisVec::get_value_iter_optimized_layout(
+                    data, value, index, info.idx_axis);
+    ret.outer.ndim = idx_axis;
+    for (size_t i = 0; i < idx_axis; ++i) {
+        ret.outer.shape[i] = layout.shape[i];
+        ret.outer.stride[i] = layout.stride[i];
+        ret.nr_outer *= layout.shape[i];
+    }
+    size_t tail_axis = idx_axis + idx_shape.ndim;
+    ret.tail.ndim = layout.ndim - tail_axis;
+    for (size_t i = tail_axis; i < layout.ndim; ++i) {
+        ret.tail.shape[i - tail_axis] = layout.shape[i];
+        ret.tail.stride[i - tail_axis] = layout.stride[i];
+        ret.nr_tail *= layout.shape[i];
+    }
+    ret.nr_idx = idx_shape.total_nr_elems();
+    ret.value_stride = info.value_stride;
+    ret.contig_row =
+            ret.value_stride == 1 &&
+            (!ret.tail.ndim || (ret.tail.ndim == 1 && ret.tail.stride[0] == 1));
+    return ret;
+}
+
+//! offset_base[begin:end] = data offsets of the index positions
+void gen_offset_base(
+        const TensorLayout& data, const OffsetBaseParam& param, ptrdiff_t* offset_base,
+        size_t begin, size_t end) {
+    auto&& idx_shape = param.idx_shape;
+    for (size_t pos = begin; pos < end; ++pos) {
+        size_t coord[TensorLayout::MAX_NDIM];
+        for (size_t i = idx_shape.ndim, p = pos; i--;) {
+            coord[i] = p % idx_shape.shape[i];
+            p /= idx_shape.shape[i];
+        }
+        ptrdiff_t offset = 0;
+        for (size_t i = 0; i < param.nr_index; ++i) {
+            auto&& item = param.items[i];
+            ptrdiff_t index_offset = 0;
+            for (size_t j = 0; j < idx_shape.ndim; ++j) {
+                index_offset +=
+                        static_cast<ptrdiff_t>(coord[j]) * item.layout.stride[j];
+            }
+            int data_idx = item.ptr[index_offset];
+            size_t data_shape = data.shape[item.axis];
+            if (data_idx < 0) {
+                data_idx += data_shape;
+            }
+            megdnn_assert(
+                    data_idx >= 0 && static_cast<size_t>(data_idx) < data_shape,
+                    "invalid advanced indexing: "
+                    "input index %d is out of bounds for axis %zu with size %zu",
+                    data_idx, i, data_shape);
+            offset += data.stride[item.axis] * data_idx;
+        }
+        offset_base[pos] = offset;
+    }
+}
+
+template <typename ctype, class Opr>
+void exec_rows(
+        const ExecPlan& plan, ctype* data, ctype* value, const ptrdiff_t* offset_base,
+        size_t part, size_t nr_parts) {
+    size_t nr_idx = plan.nr_idx, nr_tail = plan.nr_tail;
+    auto run_row = [&](size_t row, ptrdiff_t offset) {
+        ctype* row_value = value + row * nr_tail * plan.value_stride;
+        if (nr_tail == 1) {
+            Opr::apply(data[offset], *row_value);
+        } else if (plan.contig_row) {
+            apply_row(Opr{}, data + offset, row_value, nr_tail);
+        } else {
+            apply_strided_row<Opr>(
+                    data + offset, plan.tail, row_value, plan.value_stride);
+        }
+    };
+    if (NeedOwner<Opr>::value && nr_parts > 1) {
+        for (size_t o = 0; o < plan.nr_outer; ++o) {
+            ptrdiff_t outer_offset = offset_of(plan.outer, o);
+            for (size_t i = 0; i < nr_idx; ++i) {
+                ptrdiff_t offset = outer_offset + offset_base[i];
+                if (owner_of(offset, nr_parts) == part) {
+                    run_row(o * nr_idx + i, offset);
+                }
+            }
+        }
+        return;
+    }
+    size_t begin, end;
+    compact::split(plan.nr_outer * nr_idx, nr_parts, part, begin, end);
+    ptrdiff_t outer_offset = 0;
+    for (size_t row = begin, o = -1; row < end; ++row) {
+        if (row / nr_idx != o) {
+            o = row / nr_idx;
+            outer_offset = offset_of(plan.outer, o);
+        }
+        run_row(row, outer_offset + offset_base[row % nr_idx]);
+    }
+}
+
+/*!
+ * \brief run Opr between data and value; return false if the workspace is too
+ *      small for the offset table
+ */
+template <class Opr>
+bool dispatch_exec(
+        naive::HandleImpl* handle, const TensorND& data, const TensorND& value,
+        const IndexDesc& index, const ExecInfo& info, const Workspace& workspace) {
+    OffsetBaseParam param;
+    auto plan = make_plan(data.layout, value.layout, index, info, param.idx_shape);
+    size_t nr_idx = plan.nr_idx;
+    if (workspace.size < nr_idx * sizeof(ptrdiff_t)) {
+        return false;
+    }
+    if (!value.layout.total_nr_elems()) {
+        return true;
+    }
+    param.nr_index = index.size();
+    for (size_t i = 0; i < index.size(); ++i) {
+        param.items[i] = {
+                index[i].axis, index[i].vec.ptr<dt_int32>(),
+                index[i].vec.layout.broadcast(param.idx_shape)};
+    }
+    auto offset_base = workspace.ptr<ptrdiff_t>();
+    auto data_layout = data.layout;
+    size_t nr_threads = get_nr_threads(handle),
+           nr_gen_parts = nr_parts_of(nr_idx, nr_threads);
+    auto gen = [=](size_t part, size_t) {
+        size_t begin, end;
+        compact::split(nr_idx, nr_gen_parts, part, begin, end);
+        gen_offset_base(data_layout, param, offset_base, begin, end);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_gen_parts, gen);
+
+    size_t nr_parts = nr_parts_of(value.layout.total_nr_elems(), nr_threads);
+    if (!NeedOwner<Opr>::value) {
+        nr_parts = std::min(nr_parts, plan.nr_outer * nr_idx);
+    }
+#define cb(_dt)                                                              \
+    case DTypeTrait<_dt>::enumv: {                                           \
+        using ctype = DTypeTrait<_dt>::ctype;                                \
+        auto data_ptr = data.ptr<ctype>(), value_ptr = value.ptr<ctype>();   \
+        auto kern = [=](size_t part, size_t) {                               \
+            exec_rows<ctype, Opr>(                                           \
+                    plan, data_ptr, value_ptr, offset_base, part, nr_parts); \
+        };                                                                   \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);       \
+        return true;                                                         \
+    }
+    switch (data.layout.dtype.enumv()) {
+        MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+        cb(::megdnn::dtype::Bool)
+        default:
+            megdnn_throw("bad dtype");
+    }
+#undef cb
+}
+
+}  // anonymous namespace
+
+size_t IndexingMultiAxisVecImpl::get_workspace_in_bytes(size_t dst_idx_size) {
+    return dst_idx_size * sizeof(ptrdiff_t);
+}
+
+void IndexingMultiAxisVecImpl::exec(
+        _megdnn_tensor_in src, const IndexDesc& index, _megdnn_tensor_out dst,
+        _megdnn_workspace workspace) {
+    auto info = check_exec(src.layout, index, dst.layout, workspace.size);
+    if (!dispatch_exec<OprFwd>(
+                static_cast<naive::HandleImpl*>(handle()), src, dst, index, info,
+                workspace)) {
+        naive::IndexingMultiAxisVecImpl::exec(src, index, dst, workspace);
+    }
+}
+
+size_t IndexingSetMultiAxisVecImpl::get_workspace_in_bytes(size_t value_idx_size) {
+    return value_idx_size * sizeof(ptrdiff_t);
+}
+
+void IndexingSetMultiAxisVecImpl::exec(
+        _megdnn_tensor_in data, _megdnn_tensor_out value, const IndexDesc& index,
+        _megdnn_workspace workspace) {
+    auto info = check_exec(data.layout, value.layout, index, workspace.size);
+    if (!dispatch_exec<OprSet>(
+                static_cast<naive::HandleImpl*>(handle()), data, value, index, info,
+                workspace)) {
+        naive::IndexingSetMultiAxisVecImpl::exec(data, value, index, workspace);
+    }
+}
+
+size_t IndexingIncrMultiAxisVecImpl::get_workspace_in_bytes(size_t value_idx_size) {
+    return value_idx_size * sizeof(ptrdiff_t);
+}
+
+void IndexingIncrMultiAxisVecImpl::exec(
+        _megdnn_tensor_in data, _megdnn_tensor_out value, const IndexDesc& index,
+        _megdnn_workspace workspace) {
+    auto info = check_exec(data.layout, value.layout, index, workspace.size);
+    if (!dispatch_exec<OprIncr>(
+                static_cast<naive::HandleImpl*>(handle()), data, value, index, info,
+                workspace)) {
+        naive::IndexingIncrMultiAxisVecImpl::exec(data, value, index, workspace);
+    }
+}
+
+// vim: syntax=cpp.doxygen
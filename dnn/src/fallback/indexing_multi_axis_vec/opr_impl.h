@@ -0,0 +1,53 @@
+#pragma once
+
+#include "src/naive/indexing_multi_axis_vec/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief advanced indexing by a precomputed table of data offsets
+ *
+ * The data offsets of the index positions are precomputed into a table in the
+ * workspace, then value is processed as rows of the non-indexed trailing axes:
+ * contiguous rows are copied or added as a whole, and the rows are split among
+ * threads. Rows of IndexingIncrMultiAxisVec are assigned to threads by their
+ * data offsets, so duplicated indices are accumulated without conflicts.
+ */
+class IndexingMultiAxisVecImpl final : public naive::IndexingMultiAxisVecImpl {
+public:
+    using naive::IndexingMultiAxisVecImpl::IndexingMultiAxisVecImpl;
+
+    size_t get_workspace_in_bytes(size_t dst_idx_size) override;
+
+    void exec(
+            _megdnn_tensor_in src, const IndexDesc& index, _megdnn_tensor_out dst,
+            _megdnn_workspace workspace) override;
+};
+
+class IndexingSetMultiAxisVecImpl final : public naive::IndexingSetMultiAxisVecImpl {
+public:
+    using naive::IndexingSetMultiAxisVecImpl::IndexingSetMultiAxisVecImpl;
+
+    size_t get_workspace_in_bytes(size_t value_idx_size) override;
+
+    void exec(
+            _megdnn_tensor_in data, _megdnn_tensor_out value, const IndexDesc& index,
+            _megdnn_workspace workspace) override;
+};
+
+class IndexingIncrMultiAxisVecImpl final : public naive::IndexingIncrMultiAxisVecImpl {
+public:
+    using naive::IndexingIncrMultiAxisVecImpl::IndexingIncrMultiAxisVecImpl;
+
+    size_t get_workspace_in_bytes(size_t value_idx_size) override;
+
+    void exec(
+            _megdnn_tensor_in data, _megdnn_tensor_out value, const IndexDesc& index,
+            _megdnn_workspace workspace) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,144 @@
+#include "src/fallback/indexing_one_hot/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+//! contiguous tensor viewed as (A, M, C) around the indexed axis
+struct OneHotShape {
+    size_t A = 1, M, C = 1;
+
+    OneHotShape(const TensorLayout& layout, size_t axis) : M{layout.shape[axis]} {
+        for (size_t i = 0; i < axis; ++i) {
+            A *= layout.shape[i];
+        }
+        for (size_t i = axis + 1; i < layout.ndim; ++i) {
+            C *= layout.shape[i];
+        }
+    }
+};
+
+inline size_t check_idx(int idx, size_t M) {
+    megdnn_assert(
+            idx >= 0 && static_cast<size_t>(idx) < M,
+            "bad value in IndexingOneHot index: input shape is %zu, "
+            "index value is %d",
+            M, idx);
+    return idx;
+}
+
+//! dst[a, c] = src[a, index[a, c], c] for a in [begin, end)
+template <typename ctype>
+void exec_get(
+        const OneHotShape& s, const ctype* src, const dt_int32* index, ctype* dst,
+        size_t begin, size_t end) {
+    for (size_t a = begin; a < end; ++a) {
+        const ctype* block = src + a * s.M * s.C;
+        const dt_int32* idx = index + a * s.C;
+        ctype* out = dst + a * s.C;
+        for (size_t c = 0; c < s.C; ++c) {
+            out[c] = block[check_idx(idx[c], s.M) * s.C + c];
+        }
+    }
+}
+
+//! data[a, index[a, c], c] = sub[a, c] for a in [begin, end)
+template <typename ctype>
+void exec_set(
+        const OneHotShape& s, ctype* data, const dt_int32* index, const ctype* sub,
+        size_t begin, size_t end) {
+    for (size_t a = begin; a < end; ++a) {
+        ctype* block = data + a * s.M * s.C;
+        const dt_int32* idx = index + a * s.C;
+        const ctype* in = sub + a * s.C;
+        for (size_t c = 0; c < s.C; ++c) {
+            block[check_idx(idx[c], s.M) * s.C + c] = in[c];
+        }
+    }
+}
+
+bool is_contiguous(
+        const TensorLayout& data, const TensorLayout& index, const TensorLayout& sub) {
+    return data.is_contiguous() && index.is_contiguous() && sub.is_contiguous() &&
+           !data.is_empty() && index.dtype == dtype::Int32();
+}
+
+}  // anonymous namespace
+
+void IndexingOneHotForwardImpl::exec(
+        _megdnn_tensor_in src, _megdnn_tensor_in index, _megdnn_tensor_out dst,
+        _megdnn_workspace workspace) {
+    if (!is_contiguous(src.layout, index.layout, dst.layout)) {
+        naive::IndexingOneHotForwardImpl::exec(src, index, dst, workspace);
+        return;
+    }
+    check_exec(src.layout, index.layout, dst.layout, workspace.size);
+    OneHotShape shape{src.layout, param().axis};
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    size_t nr_parts = std::min(
+            shape.A, compact::nr_parts(shape.A * shape.C, get_nr_threads(handle)));
+#define cb(_dt)                                                            \
+    case DTypeTrait<_dt>::enumv: {                                         \
+        using ctype = DTypeTrait<_dt>::ctype;                              \
+        auto src_ptr = src.ptr<ctype>(), dst_ptr = dst.ptr<ctype>();       \
+        auto idx_ptr = index.ptr<dt_int32>();                              \
+        auto kern = [=](size_t part, size_t) {                             \
+            size_t begin, end;                                             \
+            compact::split(shape.A, nr_parts, part, begin, end);           \
+            exec_get<ctype>(shape, src_ptr, idx_ptr, dst_ptr, begin, end); \
+        };                                                                 \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);     \
+        return;                                                            \
+    }
+    switch (src.layout.dtype.enumv()) {
+        MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+        cb(megdnn::dtype::Quantized8Asymm)
+        default:
+            megdnn_throw("bad dtype");
+    }
+#undef cb
+}
+
+void IndexingSetOneHotForwardImpl::exec(
+        _megdnn_tensor_inout data, _megdnn_tensor_in index, _megdnn_tensor_in sub,
+        _megdnn_workspace workspace) {
+    if (!is_contiguous(data.layout, index.layout, sub.layout)) {
+        naive::IndexingSetOneHotForwardImpl::exec(data, index, sub, workspace);
+        return;
+    }
+    check_exec(data.layout, index.layout, sub.layout, workspace.size);
+    OneHotShape shape{data.layout, param().axis};
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    size_t nr_parts = std::min(
+            shape.A, compact::nr_parts(shape.A * shape.C, get_nr_threads(handle)));
+#define cb(_dt)                                                             \
+    case DTypeTrait<_dt>::enumv: {                                          \
+        using ctype = DTypeTrait<_dt>::ctype;                               \
+        auto data_ptr = data.ptr<ctype>(), sub_ptr = sub.ptr<ctype>();      \
+        auto idx_ptr = index.ptr<dt_int32>();                               \
+        auto kern = [=](size_t part, size_t) {                              \
+            size_t begin, end;                                              \
+            compact::split(shape.A, nr_parts, part, begin, end);            \
+            exec_set<ctype>(shape, data_ptr, idx_ptr, sub_ptr, begin, end); \
+        };                                                                  \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);      \
+        return;                                                             \
+    }
+    switch (data.layout.dtype.enumv()) {
+        MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+        cb(megdnn::dtype::Quantized8Asymm)
+        default:
+            megdnn_throw("bad dtype");
+    }
+#undef cb
+}
+
+// vim: syntax=cpp.doxygen
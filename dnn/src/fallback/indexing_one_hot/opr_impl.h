@@ -0,0 +1,36 @@
+#pragma once
+
+#include "src/naive/indexing_one_hot/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief IndexingOneHot of contiguous tensors in parallel
+ *
+ * src is viewed as (A, M, C) around the indexed axis; each of the A outer
+ * blocks gathers C elements from the row selected by the index. Other layouts
+ * use the naive implementation.
+ */
+class IndexingOneHotForwardImpl final : public naive::IndexingOneHotForwardImpl {
+public:
+    using naive::IndexingOneHotForwardImpl::IndexingOneHotForwardImpl;
+    void exec(
+            _megdnn_tensor_in src, _megdnn_tensor_in index, _megdnn_tensor_out dst,
+            _megdnn_workspace workspace) override;
+};
+
+//! IndexingSetOneHot of contiguous tensors in parallel over the outer blocks
+class IndexingSetOneHotForwardImpl final
+        : public naive::IndexingSetOneHotForwardImpl {
+public:
+    using naive::IndexingSetOneHotForwardImpl::IndexingSetOneHotForwardImpl;
+    void exec(
+            _megdnn_tensor_inout data, _megdnn_tensor_in index, _megdnn_tensor_in sub,
+            _megdnn_workspace workspace) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
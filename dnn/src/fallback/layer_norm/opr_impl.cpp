@@ -0,0 +1,230 @@
+#include "src/fallback/layer_norm/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/gi_simd_traits.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+using Param = megdnn::LayerNorm::Param;
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+void get_slices(
+        const TensorLayout& data, const Param& param, size_t& n_slices,
+        size_t& slice_len) {
+    n_slices = 1;
+    for (size_t i = 0; i < data.ndim - param.normalized_dim; ++i) {
+        n_slices *= data.shape[i];
+    }
+    slice_len = param.normalized_size;
+}
+
+//! per-task floats: weight, bias, data and dst converted to fp32
+size_t fwd_buf_size(size_t slice_len, bool inplace) {
+    return inplace ? 0 : 4 * slice_len;
+}
+
+//! per-task floats: the partial dweight and dbias, then weight, diff, data and
+//! ddata converted to fp32
+size_t bwd_buf_size(size_t slice_len, bool inplace) {
+    return 2 * slice_len + (inplace ? 0 : 4 * slice_len);
+}
+
+template <typename T>
+void forward(
+        naive::HandleImpl* handle, NormKernFunc kern, const TensorND& data,
+        const TensorND& weight, const TensorND& bias, const TensorND& dst,
+        const TensorND& mean, const TensorND& rstd, const Param& param,
+        float* workspace) {
+    using Storage = NormStorage<T>;
+    size_t n_slices, len;
+    get_slices(data.layout, param, n_slices, len);
+    size_t nr_parts = std::min(n_slices, get_nr_threads(handle));
+    size_t buf_size = fwd_buf_size(len, Storage::inplace);
+    bool affine = param.affine;
+    float eps = param.eps;
+    auto run = [=](size_t part, size_t) {
+        size_t begin, end;
+        norm_partition(n_slices, nr_parts, part, begin, end);
+        float* buf = workspace + part * buf_size;
+        NormParam p{};
+        if (affine) {
+            p.weight = Storage::load(weight.ptr<T>(), 1, len, len, buf);
+            p.bias = Storage::load(bias.ptr<T>(), 1, len, len, buf + len);
+        }
+        p.cols = p.stride = len;
+        p.eps = eps;
+        // fp32 slices are processed at once, the others one by one via buf
+        size_t step = Storage::inplace ? end - begin : 1;
+        for (size_t i = begin; i < end; i += step) {
+            T* dst_ptr = dst.ptr<T>() + i * len;
+            p.rows = step;
+            p.x = Storage::load(data.ptr<T>() + i * len, 1, len, len, buf + 2 * len);
+            p.y = Storage::dst(dst_ptr, buf + 3 * len);
+            p.mean = mean.ptr<dt_float32>() + i;
+            p.rstd = rstd.ptr<dt_float32>() + i;
+            kern(p);
+            Storage::store(dst_ptr, p.y, 1, len, len);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+}
+
+template <typename T>
+void backward(
+        naive::HandleImpl* handle, NormKernFunc kern, const TensorND& diff,
+        const TensorND& data, const TensorND& weight, const TensorND& mean,
+        const TensorND& rstd, const TensorND& ddata, const TensorND& dweight,
+        const TensorND& dbias, const Param& param, float* workspace) {
+    using Storage = NormStorage<T>;
+    size_t n_slices, len;
+    get_slices(data.layout, param, n_slices, len);
+    size_t nr_parts = std::min(n_slices, get_nr_threads(handle));
+    size_t buf_size = bwd_buf_size(len, Storage::inplace);
+    bool affine = param.affine;
+    auto run = [=](size_t part, size_t) {
+        size_t begin, end;
+        norm_partition(n_slices, nr_parts, part, begin, end);
+        float* buf = workspace + part * buf_size;
+        float* cvt = buf + 2 * len;
+        NormParam p{};
+        if (affine) {
+            p.weight = Storage::load(weight.ptr<T>(), 1, len, len, cvt);
+            p.dweight = buf;
+            p.dbias = buf + len;
+            std::fill(buf, buf + 2 * len, 0.f);
+        }
+        p.cols = p.stride = len;
+        size_t step = Storage::inplace ? end - begin : 1;
+        for (size_t i = begin; i < end; i += step) {
+            T* ddata_ptr = ddata.ptr<T>() + i * len;
+            p.rows = step;
+            p.dy = Storage::load(diff.ptr<T>() + i * len, 1, len, len, cvt + len);
+            p.x = Storage::load(data.ptr<T>() + i * len, 1, len, len, cvt + 2 * len);
+            p.y = Storage::dst(ddata_ptr, cvt + 3 * len);
+            p.mean = mean.ptr<dt_float32>() + i;
+            p.rstd = rstd.ptr<dt_float32>() + i;
+            kern(p);
+            Storage::store(ddata_ptr, p.y, 1, len, len);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+
+    if (affine) {
+        auto reduce = [=]() {
+            T* dw = dweight.ptr<T>();
+            T* db = dbias.ptr<T>();
+            for (size_t j = 0; j < len; ++j) {
+                float sum_w = 0.f, sum_b = 0.f;
+                for (size_t part = 0; part < nr_parts; ++part) {
+                    sum_w += workspace[part * buf_size + j];
+                    sum_b += workspace[part * buf_size + len + j];
+                }
+                dw[j] = static_cast<T>(sum_w);
+                db[j] = static_cast<T>(sum_b);
+            }
+        };
+        MEGDNN_DISPATCH_CPU_KERN(handle, reduce());
+    }
+}
+
+}  // namespace
+
+/* ===================== LayerNormForwardImpl ===================== */
+
+LayerNormForwardImpl::LayerNormForwardImpl(Handle* handle)
+        : naive::LayerNormForwardImpl(handle), m_kern(get_norm_kern<GiSimdTraits>()) {}
+
+size_t LayerNormForwardImpl::get_workspace_in_bytes(
+        const TensorLayout& data, const TensorLayout& weight, const TensorLayout& bias,
+        const TensorLayout& dst, const TensorLayout& mean, const TensorLayout& rstd) {
+    if (!is_norm_usable({data, weight, bias, dst})) {
+        return naive::LayerNormForwardImpl::get_workspace_in_bytes(
+                data, weight, bias, dst, mean, rstd);
+    }
+    size_t n_slices, len;
+    get_slices(data, param(), n_slices, len);
+    bool inplace = data.dtype == dtype::Float32();
+    return get_nr_threads(handle()) * fwd_buf_size(len, inplace) * sizeof(float);
+}
+
+void LayerNormForwardImpl::exec(
+        _megdnn_tensor_in data, _megdnn_tensor_in weight, _megdnn_tensor_in bias,
+        _megdnn_tensor_out dst, _megdnn_tensor_out mean, _megdnn_tensor_out rstd,
+        _megdnn_workspace workspace) {
+    if (!is_norm_usable({data.layout, weight.layout, bias.layout, dst.layout})) {
+        naive::LayerNormForwardImpl::exec(
+                data, weight, bias, dst, mean, rstd, workspace);
+        return;
+    }
+    check_exec(
+            data.layout, weight.layout, bias.layout, dst.layout, mean.layout,
+            rstd.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    auto wptr = workspace.ptr<dt_float32>();
+#define cb(DType)                                                                     \
+    if (data.layout.dtype == DType()) {                                               \
+        forward<DTypeTrait<DType>::ctype>(                                            \
+                handle, m_kern.fwd_rows, data, weight, bias, dst, mean, rstd, param(), \
+                wptr);                                                                \
+        return;                                                                       \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE_FLOAT(cb)
+#undef cb
+    megdnn_throw("bad dtype");
+}
+
+/* ===================== LayerNormBackwardImpl ===================== */
+
+LayerNormBackwardImpl::LayerNormBackwardImpl(Handle* handle)
+        : naive::LayerNormBackwardImpl(handle), m_kern(get_norm_kern<GiSimdTraits>()) {}
+
+size_t LayerNormBackwardImpl::get_workspace_in_bytes(
+        const TensorLayout& diff, const TensorLayout& data, const TensorLayout& weight,
+        const TensorLayout& mean, const TensorLayout& rstd, const TensorLayout& ddata,
+        const TensorLayout& dweight, const TensorLayout& dbias) {
+    if (!is_norm_usable({data, diff, weight, ddata, dweight, dbias})) {
+        return naive::LayerNormBackwardImpl::get_workspace_in_bytes(
+                diff, data, weight, mean, rstd, ddata, dweight, dbias);
+    }
+    size_t n_slices, len;
+    get_slices(data, param(), n_slices, len);
+    bool inplace = data.dtype == dtype::Float32();
+    return get_nr_threads(handle()) * bwd_buf_size(len, inplace) * sizeof(float);
+}
+
+void LayerNormBackwardImpl::exec(
+        _megdnn_tensor_in diff, _megdnn_tensor_in data, _megdnn_tensor_in weight,
+        _megdnn_tensor_in mean, _megdnn_tensor_in rstd, _megdnn_tensor_out ddata,
+        _megdnn_tensor_out dweight, _megdnn_tensor_out dbias,
+        _megdnn_workspace workspace) {
+    if (!is_norm_usable(
+                {data.layout, diff.layout, weight.layout, ddata.layout, dweight.layout,
+                 dbias.layout})) {
+        naive::LayerNormBackwardImpl::exec(
+                diff, data, weight, mean, rstd, ddata, dweight, dbias, workspace);
+        return;
+    }
+    check_exec(
+            diff.layout, data.layout, weight.layout, mean.layout, rstd.layout,
+            ddata.layout, dweight.layout, dbias.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    auto wptr = workspace.ptr<dt_float32>();
+#define cb(DType)                                                                 \
+    if (data.layout.dtype == DType()) {                                           \
+        backward<DTypeTrait<DType>::ctype>(                                       \
+                handle, m_kern.bwd_rows, diff, data, weight, mean, rstd, ddata,   \
+                dweight, dbias, param(), wptr);                                   \
+        return;                                                                   \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE_FLOAT(cb)
+#undef cb
+    megdnn_throw("bad dtype");
+}
+
+// vim: syntax=cpp.doxygen
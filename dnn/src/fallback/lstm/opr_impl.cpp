@@ -0,0 +1,55 @@
+#include "src/fallback/lstm/opr_impl.h"
+#include "src/fallback/rnn/funcs.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+}  // namespace
+
+size_t LSTMImpl::get_workspace_in_bytes(
+        const TensorLayout& input, const TensorLayout& hx, const TensorLayout& cx,
+        const TensorLayout& flatten_weights, const TensorLayout& output,
+        const TensorLayout& hy, const TensorLayout& cy,
+        const TensorLayout& reserve_space) {
+    if (!rnn::is_usable({input, hx, cx, flatten_weights, output, hy, cy})) {
+        return naive::LSTMImpl::get_workspace_in_bytes(
+                input, hx, cx, flatten_weights, output, hy, cy, reserve_space);
+    }
+    rnn::SeqPlan plan(
+            input, param().hidden_size, 4, param().bidirectional ? 2 : 1,
+            param().num_layers, param().bias, get_nr_threads(handle()));
+    return plan.bundle.total_size_in_bytes();
+}
+
+void LSTMImpl::exec(
+        _megdnn_tensor_in input, _megdnn_tensor_in hx, _megdnn_tensor_in cx,
+        _megdnn_tensor_in flatten_weights, _megdnn_tensor_out output,
+        _megdnn_tensor_out hy, _megdnn_tensor_out cy, _megdnn_tensor_out reserve_space,
+        _megdnn_workspace workspace) {
+    if (!rnn::is_usable(
+                {input.layout, hx.layout, cx.layout, flatten_weights.layout,
+                 output.layout, hy.layout, cy.layout})) {
+        naive::LSTMImpl::exec(
+                input, hx, cx, flatten_weights, output, hy, cy, reserve_space,
+                workspace);
+        return;
+    }
+    check_exec(
+            input.layout, hx.layout, cx.layout, flatten_weights.layout, output.layout,
+            hy.layout, cy.layout, reserve_space.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    rnn::SeqPlan plan(
+            input.layout, param().hidden_size, 4, param().bidirectional ? 2 : 1,
+            param().num_layers, param().bias, get_nr_threads(handle));
+    rnn::exec_seq(
+            handle, plan, input, flatten_weights, hx, cx, output, hy, cy,
+            reserve_space, workspace.raw_ptr, rnn::NonlineMode::IDENTITY);
+}
+
+// vim: syntax=cpp.doxygen
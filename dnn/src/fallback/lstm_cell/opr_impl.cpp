@@ -0,0 +1,107 @@
+#include "src/fallback/lstm_cell/opr_impl.h"
+#include "src/fallback/rnn/funcs.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+bool is_bias_usable(const TensorLayout& bias, size_t batch, size_t gate_hidden) {
+    size_t nr_elems = bias.total_nr_elems();
+    return bias.shape[bias.ndim - 1] == gate_hidden &&
+           (nr_elems == gate_hidden || nr_elems == batch * gate_hidden);
+}
+
+//! the two projections of the cell and the workspace of the matmul
+WorkspaceBundle get_bundle(
+        MatrixMul* matmul, const TensorLayout& input, const TensorLayout& weight_ih,
+        const TensorLayout& hx, const TensorLayout& weight_hh) {
+    TensorLayout proj{{input[0], weight_ih[0]}, input.dtype};
+    size_t matmul_ws = std::max(
+            matmul->get_workspace_in_bytes(input, weight_ih, proj),
+            matmul->get_workspace_in_bytes(hx, weight_hh, proj));
+    return {nullptr, {proj.span().dist_byte(), proj.span().dist_byte(), matmul_ws}};
+}
+
+}  // namespace
+
+size_t LSTMCellImpl::get_workspace_in_bytes(
+        const TensorLayout& input, const TensorLayout& weight_ih,
+        const TensorLayout& bias_ih, const TensorLayout& hx,
+        const TensorLayout& weight_hh, const TensorLayout& bias_hh,
+        const TensorLayout& cx, const TensorLayout& h_new, const TensorLayout& c_new,
+        const TensorLayout& gates) {
+    if (!rnn::is_usable(
+                {input, weight_ih, bias_ih, hx, weight_hh, bias_hh, cx, h_new, c_new,
+                 gates}) ||
+        !is_bias_usable(bias_ih, input[0], weight_ih[0]) ||
+        !is_bias_usable(bias_hh, input[0], weight_ih[0])) {
+        return naive::LSTMCellImpl::get_workspace_in_bytes(
+                input, weight_ih, bias_ih, hx, weight_hh, bias_hh, cx, h_new, c_new,
+                gates);
+    }
+    auto matmul = handle()->create_operator<MatrixMul>();
+    matmul->param().transposeB = true;
+    return get_bundle(matmul.get(), input, weight_ih, hx, weight_hh)
+            .total_size_in_bytes();
+}
+
+void LSTMCellImpl::exec(
+        _megdnn_tensor_in input, _megdnn_tensor_in weight_ih, _megdnn_tensor_in bias_ih,
+        _megdnn_tensor_in hx, _megdnn_tensor_in weight_hh, _megdnn_tensor_in bias_hh,
+        _megdnn_tensor_in cx, _megdnn_tensor_out h_new, _megdnn_tensor_out c_new,
+        _megdnn_tensor_out gates, _megdnn_workspace workspace) {
+    size_t batch = input.layout[0], GH = weight_ih.layout[0], H = GH / 4;
+    if (!rnn::is_usable(
+                {input.layout, weight_ih.layout, bias_ih.layout, hx.layout,
+                 weight_hh.layout, bias_hh.layout, cx.layout, h_new.layout,
+                 c_new.layout, gates.layout}) ||
+        !is_bias_usable(bias_ih.layout, batch, GH) ||
+        !is_bias_usable(bias_hh.layout, batch, GH)) {
+        naive::LSTMCellImpl::exec(
+                input, weight_ih, bias_ih, hx, weight_hh, bias_hh, cx, h_new, c_new,
+                gates, workspace);
+        return;
+    }
+    check_exec(
+            input.layout, weight_ih.layout, bias_ih.layout, hx.layout,
+            weight_hh.layout, bias_hh.layout, cx.layout, h_new.layout, c_new.layout,
+            gates.layout, workspace.size);
+    auto matmul = handle()->create_operator<MatrixMul>();
+    matmul->param().transposeB = true;
+    auto bundle = get_bundle(
+            matmul.get(), input.layout, weight_ih.layout, hx.layout, weight_hh.layout);
+    bundle.set(workspace.raw_ptr);
+    TensorLayout proj_layout{{batch, GH}, input.layout.dtype};
+    TensorND proj_ih{bundle.get(0), proj_layout}, proj_hh{bundle.get(1), proj_layout};
+    matmul->exec(input, weight_ih, proj_ih, bundle.get_workspace(2));
+    matmul->exec(hx, weight_hh, proj_hh, bundle.get_workspace(2));
+
+    size_t ih_stride = bias_ih.layout.total_nr_elems() == GH ? 0 : GH;
+    size_t hh_stride = bias_hh.layout.total_nr_elems() == GH ? 0 : GH;
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    size_t nr_parts = std::min(
+            batch, static_cast<size_t>(handle->megcore_dispatcher()->nr_threads()));
+    auto run = [=](size_t part, size_t) {
+        size_t chunk = div_ceil(batch, nr_parts);
+        size_t end = std::min(batch, (part + 1) * chunk);
+        for (size_t b = part * chunk; b < end; ++b) {
+            //! gates are stored gate by gate, each of shape (batch, hidden)
+            rnn::LstmRowParam p{
+                    proj_ih.ptr<dt_float32>() + b * GH,
+                    proj_hh.ptr<dt_float32>() + b * GH,
+                    bias_ih.ptr<dt_float32>() + b * ih_stride,
+                    bias_hh.ptr<dt_float32>() + b * hh_stride,
+                    gates.ptr<dt_float32>() + b * H,
+                    batch * H,
+                    cx.ptr<dt_float32>() + b * H,
+                    c_new.ptr<dt_float32>() + b * H,
+                    h_new.ptr<dt_float32>() + b * H,
+                    H};
+            rnn::lstm_row(p);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+}
+
+// vim: syntax=cpp.doxygen
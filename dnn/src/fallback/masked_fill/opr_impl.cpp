@@ -0,0 +1,94 @@
+#include "src/fallback/masked_fill/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/fallback/select_helper.h"
+#include "src/naive/handle.h"
+
+#include <cstring>
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+//! fill the elements of origin[begin:end] whose mask is set
+template <typename ctype>
+void fill_elems(
+        const ctype* origin, const dt_bool* mask, ctype* dst, ctype value,
+        size_t begin, size_t end) {
+    size_t i = begin;
+    if (sizeof(ctype) == sizeof(int32_t)) {
+        int32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        auto x = reinterpret_cast<const int32_t*>(origin);
+        auto z = reinterpret_cast<int32_t*>(dst);
+        for (; i + select::STEP <= end; i += select::STEP) {
+            select::select_step(
+                    mask + i, select::ScalarSrc{bits}, select::VecSrc{x + i}, z + i);
+        }
+    }
+    for (; i < end; ++i) {
+        dst[i] = mask[i] ? value : origin[i];
+    }
+}
+
+//! fill or copy the blocks [begin, end) of \p inner elements by their masks
+template <typename ctype>
+void fill_blocks(
+        const ctype* origin, const dt_bool* mask, ctype* dst, ctype value,
+        size_t inner, size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+        ctype* block = dst + i * inner;
+        if (mask[i]) {
+            std::fill(block, block + inner, value);
+        } else if (origin != dst) {
+            memcpy(block, origin + i * inner, inner * sizeof(ctype));
+        }
+    }
+}
+
+}  // anonymous namespace
+
+void MaskedFillImpl::exec(
+        _megdnn_tensor_in origin, _megdnn_tensor_in index, _megdnn_tensor_out dst) {
+    if (!origin.layout.is_contiguous() || origin.layout.is_empty()) {
+        naive::MaskedFillImpl::exec(origin, index, dst);
+        return;
+    }
+    check_exec(origin.layout, index.layout, dst.layout);
+    size_t outer = index.layout.total_nr_elems(),
+           inner = origin.layout.total_nr_elems() / outer;
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    size_t nr_parts = std::min(
+            outer, compact::nr_parts(outer * inner, get_nr_threads(handle)));
+#define cb(DType)                                                             \
+    if (origin.layout.dtype == DType()) {                                     \
+        using ctype = typename DTypeTrait<DType>::ctype;                      \
+        auto value = static_cast<ctype>(param().value);                       \
+        auto origin_ptr = origin.ptr<ctype>(), dst_ptr = dst.ptr<ctype>();    \
+        auto mask_ptr = index.ptr<dt_bool>();                                 \
+        auto kern = [=](size_t part, size_t) {                                \
+            size_t begin, end;                                                \
+            compact::split(outer, nr_parts, part, begin, end);                \
+            if (inner == 1) {                                                 \
+                fill_elems(origin_ptr, mask_ptr, dst_ptr, value, begin, end); \
+            } else {                                                          \
+                fill_blocks(                                                  \
+                        origin_ptr, mask_ptr, dst_ptr, value, inner, begin,   \
+                        end);                                                 \
+            }                                                                 \
+        };                                                                    \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);        \
+        return;                                                               \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+    cb(::megdnn::dtype::Bool)
+#undef cb
+    megdnn_assert_internal(0);
+}
+
+// vim: syntax=cpp.doxygen
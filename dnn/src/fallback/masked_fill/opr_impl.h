@@ -0,0 +1,26 @@
+#pragma once
+
+#include "src/naive/masked_fill/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief MaskedFill of contiguous tensors in parallel
+ *
+ * A mask element covering a block of trailing elements fills or copies the
+ * whole block; a mask of the same shape as origin is applied by branchless
+ * selection, in vector registers for 4-byte dtypes. Other layouts use the naive
+ * implementation.
+ */
+class MaskedFillImpl : public naive::MaskedFillImpl {
+public:
+    using naive::MaskedFillImpl::MaskedFillImpl;
+    void exec(_megdnn_tensor_in origin, _megdnn_tensor_in index, _megdnn_tensor_out dst)
+            override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
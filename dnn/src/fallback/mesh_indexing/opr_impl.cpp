@@ -0,0 +1,278 @@
+#include "src/fallback/mesh_indexing/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/fallback/indexing_helper.h"
+#include "src/naive/handle.h"
+
+#include <memory>
+#include <vector>
+
+using namespace megdnn;
+using namespace fallback;
+using namespace indexing;
+
+namespace {
+
+using IndexDesc = MeshIndexing::IndexDesc;
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+//! layout of the indexed tensor and the indexers on its axes
+struct MeshPlan {
+    static constexpr size_t MAX_NDIM = TensorLayout::MAX_NDIM;
+    bool batched;
+    size_t ndim, nr_rows;
+    size_t shape[MAX_NDIM], data_shape[MAX_NDIM];
+    ptrdiff_t data_stride[MAX_NDIM];
+    //! indexer of each axis, or nullptr if the axis is not indexed
+    const dt_int32* index[MAX_NDIM];
+    ptrdiff_t index_batch_stride[MAX_NDIM], index_stride[MAX_NDIM];
+    //! begin of the offset table of each axis, whose entries are the data
+    //! offsets of the positions (of each batch if batched) on the axis
+    size_t table_begin[MAX_NDIM];
+    size_t table_size;
+
+    MeshPlan(
+            const TensorLayout& data, const TensorLayout& value, const IndexDesc& desc,
+            bool batched_)
+            : batched{batched_}, ndim{value.ndim}, table_size{0} {
+        for (size_t i = 0; i < ndim; ++i) {
+            shape[i] = value.shape[i];
+            data_shape[i] = data.shape[i];
+            data_stride[i] = data.stride[i];
+            index[i] = nullptr;
+        }
+        for (auto&& i : desc) {
+            auto&& layout = i.vec.layout;
+            index[i.axis] = i.vec.ptr<dt_int32>();
+            index_batch_stride[i.axis] = batched ? layout.stride[0] : 0;
+            index_stride[i.axis] = layout.stride[layout.ndim - 1];
+        }
+        for (size_t i = 0; i < ndim; ++i) {
+            table_begin[i] = table_size;
+            table_size += (batched && index[i] ? shape[0] : 1) * shape[i];
+        }
+        nr_rows = value.total_nr_elems() / shape[ndim - 1];
+    }
+
+    void gen_table(ptrdiff_t* table) const {
+        for (size_t i = 0; i < ndim; ++i) {
+            ptrdiff_t* ptr = table + table_begin[i];
+            if (!index[i]) {
+                for (size_t k = 0; k < shape[i]; ++k) {
+                    ptr[k] = k * data_stride[i];
+                }
+                continue;
+            }
+            for (size_t b = 0, nr_batch = batched ? shape[0] : 1; b < nr_batch; ++b) {
+                for (size_t k = 0; k < shape[i]; ++k) {
+                    int idx = index[i][b * index_batch_stride[i] + k * index_stride[i]];
+                    if (idx < 0) {
+                        idx += data_shape[i];
+                    }
+                    megdnn_assert(
+                            idx >= 0 && static_cast<size_t>(idx) < data_shape[i],
+                            "invalid mesh indexing: index %d is out of bounds for "
+                            "axis %zu with size %zu",
+                            idx, i, data_shape[i]);
+                    ptr[b * shape[i] + k] = idx * data_stride[i];
+                }
+            }
+        }
+    }
+
+    //! offset table of an axis for given batch
+    const ptrdiff_t* table_of(const ptrdiff_t* table, size_t axis, size_t batch) const {
+        return table + table_begin[axis] +
+               (batched && index[axis] ? batch * shape[axis] : 0);
+    }
+};
+
+/*!
+ * \brief apply Opr on the rows [begin, end) of value, or on the rows owned by
+ *      \p part if \p nr_parts is not zero
+ */
+template <typename ctype, class Opr>
+void exec_rows(
+        const MeshPlan& plan, const ptrdiff_t* table, ctype* data, ctype* value,
+        size_t begin, size_t end, size_t part, size_t nr_parts) {
+    size_t last = plan.ndim - 1, n = plan.shape[last];
+    bool contig_row = !plan.index[last] && plan.data_stride[last] == 1;
+    size_t coord[MeshPlan::MAX_NDIM];
+    for (size_t i = last, r = begin; i--;) {
+        coord[i] = r % plan.shape[i];
+        r /= plan.shape[i];
+    }
+    for (size_t row = begin; row < end; ++row) {
+        size_t batch = last ? coord[0] : 0;
+        ptrdiff_t offset = 0;
+        for (size_t i = 0; i < last; ++i) {
+            offset += plan.table_of(table, i, batch)[coord[i]];
+        }
+        for (size_t i = last; i--;) {
+            if (++coord[i] < plan.shape[i]) {
+                break;
+            }
+            coord[i] = 0;
+        }
+        if (nr_parts && owner_of(offset, nr_parts) != part) {
+            continue;
+        }
+        ctype* row_value = value + row * n;
+        if (contig_row) {
+            apply_row(Opr{}, data + offset, row_value, n);
+        } else {
+            auto row_table = plan.table_of(table, last, batch);
+            for (size_t k = 0; k < n; ++k) {
+                Opr::apply(data[offset + row_table[k]], row_value[k]);
+            }
+        }
+    }
+}
+
+template <class Opr>
+struct ExecMesh {
+    template <typename ctype>
+    static void run(
+            naive::HandleImpl* handle, const TensorND& data, const TensorND& value,
+            const MeshPlan& plan) {
+        auto table = std::make_shared<std::vector<ptrdiff_t>>(plan.table_size);
+        auto gen = [plan, table]() { plan.gen_table(table->data()); };
+        MEGDNN_DISPATCH_CPU_KERN(handle, gen());
+
+        size_t nr_rows = plan.nr_rows,
+               nr_parts = std::min(
+                       nr_rows, std::max<size_t>(
+                                        1, std::min(
+                                                   get_nr_threads(handle),
+                                                   value.layout.total_nr_elems() /
+                                                           MIN_PART_LEN)));
+        auto data_ptr = data.ptr<ctype>(), value_ptr = value.ptr<ctype>();
+        auto kern = [plan, table, data_ptr, value_ptr, nr_rows, nr_parts](
+                            size_t part, size_t) {
+            if (NeedOwner<Opr>::value && nr_parts > 1) {
+                exec_rows<ctype, Opr>(
+                        plan, table->data(), data_ptr, value_ptr, 0, nr_rows, part,
+                        nr_parts);
+            } else {
+                size_t begin, end;
+                compact::split(nr_rows, nr_parts, part, begin, end);
+                exec_rows<ctype, Opr>(
+                        plan, table->data(), data_ptr, value_ptr, begin, end, 0, 0);
+            }
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);
+    }
+};
+
+//! quantized dtypes are not accumulated, as in the naive implementation
+template <class Opr>
+bool dispatch_quantized(
+        naive::HandleImpl* handle, const TensorND& data, const TensorND& value,
+        const MeshPlan& plan) {
+#define cb(DType)                                                       \
+    if (data.layout.dtype.enumv() == DTypeTrait<DType>::enumv) {        \
+        ExecMesh<Opr>::template run<typename DTypeTrait<DType>::ctype>( \
+                handle, data, value, plan);                             \
+        return true;                                                    \
+    }
+    MEGDNN_FOREACH_QUANTIZED_DTYPE(cb)
+#undef cb
+    return false;
+}
+
+template <>
+bool dispatch_quantized<OprIncr>(
+        naive::HandleImpl*, const TensorND&, const TensorND&, const MeshPlan&) {
+    return false;
+}
+
+/*!
+ * \brief run Opr between data and value; return false if value is not
+ *      contiguous
+ */
+template <class Opr>
+bool dispatch_exec(
+        Handle* handle, const TensorND& data, const TensorND& value,
+        const IndexDesc& desc, bool batched) {
+    if (!value.layout.is_contiguous()) {
+        return false;
+    }
+    if (value.layout.is_empty()) {
+        return true;
+    }
+    MeshPlan plan{data.layout, value.layout, desc, batched};
+    auto handle_ptr = static_cast<naive::HandleImpl*>(handle);
+#define cb(DType)                                                       \
+    if (data.layout.dtype.enumv() == DTypeTrait<DType>::enumv) {        \
+        ExecMesh<Opr>::template run<typename DTypeTrait<DType>::ctype>( \
+                handle_ptr, data, value, plan);                         \
+        return true;                                                    \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+#undef cb
+    megdnn_assert(
+            dispatch_quantized<Opr>(handle_ptr, data, value, plan),
+            "bad dtype for mesh indexing: %s", data.layout.dtype.name());
+    return true;
+}
+
+}  // anonymous namespace
+
+void MeshIndexingImpl::exec(
+        _megdnn_tensor_in src, const IndexDesc& desc, _megdnn_tensor_out dst,
+        _megdnn_workspace workspace) {
+    check_exec(src.layout, dst.layout, desc);
+    if (!dispatch_exec<OprFwd>(handle(), src, dst, desc, false)) {
+        naive::MeshIndexingImpl::exec(src, desc, dst, workspace);
+    }
+}
+
+void IncrMeshIndexingImpl::exec(
+        _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+        _megdnn_workspace workspace) {
+    check_exec(data.layout, value.layout, desc);
+    if (!dispatch_exec<OprIncr>(handle(), data, value, desc, false)) {
+        naive::IncrMeshIndexingImpl::exec(data, value, desc, workspace);
+    }
+}
+
+void SetMeshIndexingImpl::exec(
+        _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+        _megdnn_workspace workspace) {
+    check_exec(data.layout, value.layout, desc);
+    if (!dispatch_exec<OprSet>(handle(), data, value, desc, false)) {
+        naive::SetMeshIndexingImpl::exec(data, value, desc, workspace);
+    }
+}
+
+void BatchedMeshIndexingImpl::exec(
+        _megdnn_tensor_in src, const IndexDesc& desc, _megdnn_tensor_out dst,
+        _megdnn_workspace workspace) {
+    check_exec(src.layout, dst.layout, desc);
+    if (!dispatch_exec<OprFwd>(handle(), src, dst, desc, true)) {
+        naive::BatchedMeshIndexingImpl::exec(src, desc, dst, workspace);
+    }
+}
+
+void BatchedIncrMeshIndexingImpl::exec(
+        _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+        _megdnn_workspace workspace) {
+    check_exec(data.layout, value.layout, desc);
+    if (!dispatch_exec<OprIncr>(handle(), data, value, desc, true)) {
+        naive::BatchedIncrMeshIndexingImpl::exec(data, value, desc, workspace);
+    }
+}
+
+void BatchedSetMeshIndexingImpl::exec(
+        _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+        _megdnn_workspace workspace) {
+    check_exec(data.layout, value.layout, desc);
+    if (!dispatch_exec<OprSet>(handle(), data, value, desc, true)) {
+        naive::BatchedSetMeshIndexingImpl::exec(data, value, desc, workspace);
+    }
+}
+
+// vim: syntax=cpp.doxygen
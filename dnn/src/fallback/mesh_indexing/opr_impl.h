@@ -0,0 +1,70 @@
+#pragma once
+
+#include "src/naive/mesh_indexing/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief mesh indexing by precomputed per-axis offset tables
+ *
+ * The data offset of each position on each axis of the indexed tensor is put
+ * into a table, so an element is located by adding up the table entries of its
+ * coordinates; the innermost rows are copied or added as a whole when they are
+ * contiguous on both sides. Rows are split among threads, and rows of the incr
+ * variants are assigned to threads by their data offsets to accumulate
+ * duplicated indices without conflicts. Non-contiguous indexed tensors use the
+ * naive implementation.
+ */
+class MeshIndexingImpl : public naive::MeshIndexingImpl {
+public:
+    using naive::MeshIndexingImpl::MeshIndexingImpl;
+    void exec(
+            _megdnn_tensor_in src, const IndexDesc& desc, _megdnn_tensor_out dst,
+            _megdnn_workspace workspace) override;
+};
+
+class IncrMeshIndexingImpl : public naive::IncrMeshIndexingImpl {
+public:
+    using naive::IncrMeshIndexingImpl::IncrMeshIndexingImpl;
+    void exec(
+            _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+            _megdnn_workspace workspace) override;
+};
+
+class SetMeshIndexingImpl : public naive::SetMeshIndexingImpl {
+public:
+    using naive::SetMeshIndexingImpl::SetMeshIndexingImpl;
+    void exec(
+            _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+            _megdnn_workspace workspace) override;
+};
+
+class BatchedMeshIndexingImpl : public naive::BatchedMeshIndexingImpl {
+public:
+    using naive::BatchedMeshIndexingImpl::BatchedMeshIndexingImpl;
+    void exec(
+            _megdnn_tensor_in src, const IndexDesc& desc, _megdnn_tensor_out dst,
+            _megdnn_workspace workspace) override;
+};
+
+class BatchedIncrMeshIndexingImpl : public naive::BatchedIncrMeshIndexingImpl {
+public:
+    using naive::BatchedIncrMeshIndexingImpl::BatchedIncrMeshIndexingImpl;
+    void exec(
+            _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+            _megdnn_workspace workspace) override;
+};
+
+class BatchedSetMeshIndexingImpl : public naive::BatchedSetMeshIndexingImpl {
+public:
+    using naive::BatchedSetMeshIndexingImpl::BatchedSetMeshIndexingImpl;
+    void exec(
+            _megdnn_tensor_inout data, _megdnn_tensor_in value, const IndexDesc& desc,
+            _megdnn_workspace workspace) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,295 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include "megdnn/arch.h"
+
+namespace megdnn {
+namespace fallback {
+
+//! rows of queries processed together, sharing one transposed key tile
+constexpr size_t ATTN_BLOCK_L = 16;
+//! columns of keys in one tile of the online softmax
+constexpr size_t ATTN_BLOCK_S = 64;
+
+/*!
+ * \brief attention of a single (batch, head) pair
+ *
+ * q, k and v are dense (L, D), (S, D) and (S, Dv) matrices; out rows are
+ * out_stride apart so the result can be written into the (batch, seq,
+ * heads * vsize) tensor directly. mask is a dense (L, S) matrix or nullptr.
+ */
+struct AttnFwdParam {
+    const float* q;
+    const float* k;
+    const float* v;
+    const float* mask;
+    float* attn_weight;
+    float* out;
+    size_t L, S, D, Dv, out_stride;
+    float scaler;
+    float* workspace;
+};
+
+/*!
+ * \brief gradient of a single (batch, head) pair
+ *
+ * y is the dense (L, S) softmax output saved by forward; all the tensors are
+ * dense and grad_k/grad_v are overwritten.
+ */
+struct AttnBwdParam {
+    const float* grad_z;
+    const float* q;
+    const float* k;
+    const float* v;
+    const float* y;
+    float* grad_q;
+    float* grad_k;
+    float* grad_v;
+    size_t L, S, D, Dv;
+    float scaler;
+    float* workspace;
+};
+
+using AttnFwdKern = void (*)(const AttnFwdParam&);
+using AttnBwdKern = void (*)(const AttnBwdParam&);
+
+//! per-thread workspace of attn_fwd in floats
+inline size_t attn_fwd_workspace(size_t D, size_t Dv) {
+    return D * ATTN_BLOCK_S + ATTN_BLOCK_L * ATTN_BLOCK_S + ATTN_BLOCK_L * Dv +
+           2 * ATTN_BLOCK_L;
+}
+
+//! per-thread workspace of attn_bwd in floats
+inline size_t attn_bwd_workspace(size_t S, size_t Dv) {
+    return Dv * S + S;
+}
+
+/*!
+ * \brief FlashAttention-style forward: tiled QK^T, online softmax and tiled AV
+ *
+ * Simd provides the interface of x86::simd_traits (setzero, set1, loadu,
+ * storeu, add, sub, mul, fmadd and exp).
+ */
+template <class Simd>
+void attn_fwd(const AttnFwdParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t L = p.L, S = p.S, D = p.D, Dv = p.Dv;
+    const float neg_inf = -std::numeric_limits<float>::infinity();
+    float* kt = p.workspace;
+    float* score = kt + D * ATTN_BLOCK_S;
+    float* acc = score + ATTN_BLOCK_L * ATTN_BLOCK_S;
+    float* row_max = acc + ATTN_BLOCK_L * Dv;
+    float* row_sum = row_max + ATTN_BLOCK_L;
+    type vscaler = Simd::set1(p.scaler);
+
+    for (size_t l0 = 0; l0 < L; l0 += ATTN_BLOCK_L) {
+        size_t nl = std::min(ATTN_BLOCK_L, L - l0);
+        std::fill(row_max, row_max + nl, neg_inf);
+        std::fill(row_sum, row_sum + nl, 0.f);
+        std::fill(acc, acc + nl * Dv, 0.f);
+        for (size_t s0 = 0; s0 < S; s0 += ATTN_BLOCK_S) {
+            size_t ns = std::min(ATTN_BLOCK_S, S - s0);
+            // transpose the key tile so that QK^T is vectorized along S
+            for (size_t j = 0; j < ns; ++j) {
+                const float* krow = p.k + (s0 + j) * D;
+                for (size_t d = 0; d < D; ++d) {
+                    kt[d * ns + j] = krow[d];
+                }
+            }
+            for (size_t i = 0; i < nl; ++i) {
+                const float* qrow = p.q + (l0 + i) * D;
+                float* srow = score + i * ATTN_BLOCK_S;
+                size_t j = 0;
+                for (; j + width <= ns; j += width) {
+                    type sum = Simd::setzero();
+                    for (size_t d = 0; d < D; ++d) {
+                        sum = Simd::fmadd(
+                                Simd::set1(qrow[d]), Simd::loadu(kt + d * ns + j), sum);
+                    }
+                    sum = Simd::mul(sum, vscaler);
+                    if (p.mask) {
+                        sum = Simd::add(
+                                sum, Simd::loadu(p.mask + (l0 + i) * S + s0 + j));
+                    }
+                    Simd::storeu(srow + j, sum);
+                }
+                for (; j < ns; ++j) {
+                    float sum = 0.f;
+                    for (size_t d = 0; d < D; ++d) {
+                        sum += qrow[d] * kt[d * ns + j];
+                    }
+                    sum *= p.scaler;
+                    if (p.mask) {
+                        sum += p.mask[(l0 + i) * S + s0 + j];
+                    }
+                    srow[j] = sum;
+                }
+                // raw scores are normalized once the row max is final
+                memcpy(p.attn_weight + (l0 + i) * S + s0, srow, ns * sizeof(float));
+
+                float m_new = row_max[i];
+                for (j = 0; j < ns; ++j) {
+                    m_new = std::max(m_new, srow[j]);
+                }
+                if (m_new == neg_inf) {
+                    // the whole tile is masked out so far
+                    continue;
+                }
+                float correction = std::exp(row_max[i] - m_new);
+                row_max[i] = m_new;
+
+                type vmax = Simd::set1(m_new);
+                for (j = 0; j + width <= ns; j += width) {
+                    Simd::storeu(
+                            srow + j,
+                            Simd::exp(Simd::sub(Simd::loadu(srow + j), vmax)));
+                }
+                for (; j < ns; ++j) {
+                    srow[j] = std::exp(srow[j] - m_new);
+                }
+
+                float* arow = acc + i * Dv;
+                float psum = 0.f;
+                type vcorr = Simd::set1(correction);
+                size_t e = 0;
+                for (; e + width <= Dv; e += width) {
+                    Simd::storeu(arow + e, Simd::mul(Simd::loadu(arow + e), vcorr));
+                }
+                for (; e < Dv; ++e) {
+                    arow[e] *= correction;
+                }
+                for (j = 0; j < ns; ++j) {
+                    float pj = srow[j];
+                    psum += pj;
+                    const float* vrow = p.v + (s0 + j) * Dv;
+                    type vp = Simd::set1(pj);
+                    for (e = 0; e + width <= Dv; e += width) {
+                        type va = Simd::loadu(arow + e);
+                        va = Simd::fmadd(vp, Simd::loadu(vrow + e), va);
+                        Simd::storeu(arow + e, va);
+                    }
+                    for (; e < Dv; ++e) {
+                        arow[e] += pj * vrow[e];
+                    }
+                }
+                row_sum[i] = row_sum[i] * correction + psum;
+            }
+        }
+        for (size_t i = 0; i < nl; ++i) {
+            float inv = 1.f / row_sum[i];
+            type vinv = Simd::set1(inv);
+            const float* arow = acc + i * Dv;
+            float* orow = p.out + (l0 + i) * p.out_stride;
+            size_t e = 0;
+            for (; e + width <= Dv; e += width) {
+                Simd::storeu(orow + e, Simd::mul(Simd::loadu(arow + e), vinv));
+            }
+            for (; e < Dv; ++e) {
+                orow[e] = arow[e] * inv;
+            }
+
+            float* wrow = p.attn_weight + (l0 + i) * S;
+            type vmax = Simd::set1(row_max[i]);
+            size_t j = 0;
+            for (; j + width <= S; j += width) {
+                type w = Simd::exp(Simd::sub(Simd::loadu(wrow + j), vmax));
+                Simd::storeu(wrow + j, Simd::mul(w, vinv));
+            }
+            for (; j < S; ++j) {
+                wrow[j] = std::exp(wrow[j] - row_max[i]) * inv;
+            }
+        }
+    }
+}
+
+/*!
+ * \brief backward of attn_fwd without dropout, one query row at a time
+ *
+ * dY = dZ V^T and dX = Y * (dY - rowsum(dY * Y)) * scaler are kept in a single
+ * row buffer, then accumulated into dQ = dX K, dK += dX^T Q and dV += Y^T dZ.
+ */
+template <class Simd>
+void attn_bwd(const AttnBwdParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t L = p.L, S = p.S, D = p.D, Dv = p.Dv;
+    float* vt = p.workspace;
+    float* dx = vt + Dv * S;
+    for (size_t j = 0; j < S; ++j) {
+        for (size_t e = 0; e < Dv; ++e) {
+            vt[e * S + j] = p.v[j * Dv + e];
+        }
+    }
+    std::fill(p.grad_k, p.grad_k + S * D, 0.f);
+    std::fill(p.grad_v, p.grad_v + S * Dv, 0.f);
+
+    for (size_t i = 0; i < L; ++i) {
+        const float* gz = p.grad_z + i * Dv;
+        const float* y = p.y + i * S;
+        const float* q = p.q + i * D;
+        float* gq = p.grad_q + i * D;
+
+        size_t j = 0;
+        float dot = 0.f;
+        for (; j + width <= S; j += width) {
+            type sum = Simd::setzero();
+            for (size_t e = 0; e < Dv; ++e) {
+                sum = Simd::fmadd(Simd::set1(gz[e]), Simd::loadu(vt + e * S + j), sum);
+            }
+            Simd::storeu(dx + j, sum);
+        }
+        for (; j < S; ++j) {
+            float sum = 0.f;
+            for (size_t e = 0; e < Dv; ++e) {
+                sum += gz[e] * vt[e * S + j];
+            }
+            dx[j] = sum;
+        }
+        for (j = 0; j < S; ++j) {
+            dot += dx[j] * y[j];
+        }
+        type vdot = Simd::set1(dot), vscaler = Simd::set1(p.scaler);
+        for (j = 0; j + width <= S; j += width) {
+            type g = Simd::sub(Simd::loadu(dx + j), vdot);
+            g = Simd::mul(Simd::mul(g, Simd::loadu(y + j)), vscaler);
+            Simd::storeu(dx + j, g);
+        }
+        for (; j < S; ++j) {
+            dx[j] = (dx[j] - dot) * y[j] * p.scaler;
+        }
+
+        std::fill(gq, gq + D, 0.f);
+        for (j = 0; j < S; ++j) {
+            type vdx = Simd::set1(dx[j]), vy = Simd::set1(y[j]);
+            const float* krow = p.k + j * D;
+            float* gkrow = p.grad_k + j * D;
+            float* gvrow = p.grad_v + j * Dv;
+            size_t d = 0;
+            for (; d + width <= D; d += width) {
+                type vk = Simd::loadu(krow + d), vq = Simd::loadu(q + d);
+                Simd::storeu(gq + d, Simd::fmadd(vdx, vk, Simd::loadu(gq + d)));
+                Simd::storeu(gkrow + d, Simd::fmadd(vdx, vq, Simd::loadu(gkrow + d)));
+            }
+            for (; d < D; ++d) {
+                gq[d] += dx[j] * krow[d];
+                gkrow[d] += dx[j] * q[d];
+            }
+            size_t e = 0;
+            for (; e + width <= Dv; e += width) {
+                type vgz = Simd::loadu(gz + e);
+                Simd::storeu(gvrow + e, Simd::fmadd(vy, vgz, Simd::loadu(gvrow + e)));
+            }
+            for (; e < Dv; ++e) {
+                gvrow[e] += y[j] * gz[e];
+            }
+        }
+    }
+}
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,227 @@
+#include "src/fallback/multi_head_attn/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/gi_simd_traits.h"
+#include "src/naive/handle.h"
+
+namespace megdnn {
+namespace fallback {
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+bool is_dense_f32(const TensorLayout& layout) {
+    return layout.dtype == dtype::Float32() && layout.is_contiguous();
+}
+
+}  // anonymous namespace
+
+/* ===================== MHAForwardProxyOpr ===================== */
+
+#define cb(DType)                                          \
+    void MHAForwardProxyOpr::move_scaler_to_device(        \
+            Handle* handle, DTypeTrait<DType>::ctype* dst, \
+            DTypeTrait<DType>::ctype* src) {               \
+        MEGDNN_MARK_USED_VAR(handle);                      \
+        *dst = *src;                                       \
+    };
+MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+#undef cb
+
+size_t MHAForwardProxyOpr::get_fused_workspace_in_bytes(
+        Handle* handle, const Param& param) {
+    if (!kern || param.training || m_datatype != DTypeEnum::Float32) {
+        return 0;
+    }
+    return get_nr_threads(handle) * attn_fwd_workspace(m_nq_layout[2], m_nv_layout[2]) *
+           sizeof(float);
+}
+
+bool MHAForwardProxyOpr::fused_attn_exec(
+        Handle* handle, const Param& param, const TensorND& nq, const TensorND& nk,
+        const TensorND& nv, const TensorND& attn_mask, const TensorND& attn_weight,
+        const TensorND& z, void* workspace) {
+    if (!kern || !is_dense_f32(nq.layout) || !is_dense_f32(nk.layout) ||
+        !is_dense_f32(nv.layout) || !is_dense_f32(attn_weight.layout) ||
+        !is_dense_f32(z.layout)) {
+        return false;
+    }
+    size_t BH = nq.layout[0], L = nq.layout[1], D = nq.layout[2];
+    size_t S = nk.layout[1], Dv = nv.layout[2], heads = param.num_heads;
+    megdnn_assert(
+            nk.layout[0] == BH && nk.layout[2] == D && nv.layout[0] == BH &&
+            nv.layout[1] == S && z.layout.total_nr_elems() == BH * L * Dv);
+
+    // the mask is added to the (batch * heads, L, S) scores with broadcast
+    size_t mask_stride = 0;
+    using MaskType = multi_head_attn::MaskType;
+    bool has_mask = param.attn_mask_type == MaskType::DEFAULT_MASK or
+                    param.attn_mask_type == MaskType::USER_DEFINED_MASK;
+    if (has_mask) {
+        auto&& ml = attn_mask.layout;
+        if (!is_dense_f32(ml) || ml.ndim < 2 || ml.ndim > 3 ||
+            ml[ml.ndim - 2] != L || ml[ml.ndim - 1] != S) {
+            return false;
+        }
+        if (ml.ndim == 3 && ml[0] != 1) {
+            if (ml[0] != BH) {
+                return false;
+            }
+            mask_stride = L * S;
+        }
+    }
+
+    size_t wsize = attn_fwd_workspace(D, Dv);
+    float scaler = param.sm_scaler;
+    auto attn_kern = kern;
+    float* wptr = static_cast<float*>(workspace);
+    auto run = [=](size_t index, size_t thread_id) {
+        size_t b = index / heads, h = index % heads;
+        AttnFwdParam p;
+        p.q = nq.ptr<dt_float32>() + index * L * D;
+        p.k = nk.ptr<dt_float32>() + index * S * D;
+        p.v = nv.ptr<dt_float32>() + index * S * Dv;
+        p.mask = has_mask ? attn_mask.ptr<dt_float32>() + index * mask_stride
+                          : nullptr;
+        p.attn_weight = attn_weight.ptr<dt_float32>() + index * L * S;
+        p.out = z.ptr<dt_float32>() + b * L * heads * Dv + h * Dv;
+        p.L = L;
+        p.S = S;
+        p.D = D;
+        p.Dv = Dv;
+        p.out_stride = heads * Dv;
+        p.scaler = scaler;
+        p.workspace = wptr + thread_id * wsize;
+        attn_kern(p);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(
+            static_cast<naive::HandleImpl*>(handle), BH, run);
+    return true;
+}
+
+/* ===================== MHABackwardProxyOpr ===================== */
+
+#define cb(DType)                                          \
+    void MHABackwardProxyOpr::move_scaler_to_device(       \
+            Handle* handle, DTypeTrait<DType>::ctype* dst, \
+            DTypeTrait<DType>::ctype* src) {               \
+        MEGDNN_MARK_USED_VAR(handle);                      \
+        *dst = *src;                                       \
+    };
+MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+#undef cb
+
+size_t MHABackwardProxyOpr::get_fused_workspace_in_bytes(
+        Handle* handle, const Param& param) {
+    if (!kern || param.attn_prob != 0.f || m_datatype != DTypeEnum::Float32) {
+        return 0;
+    }
+    return get_nr_threads(handle) *
+           attn_bwd_workspace(m_grad_nk_layout[1], m_grad_nv_layout[2]) *
+           sizeof(float);
+}
+
+bool MHABackwardProxyOpr::fused_attn_backward_exec(
+        Handle* handle, const Param& param, const TensorND& grad_nz,
+        const TensorND& nq, const TensorND& nk, const TensorND& nv, const TensorND& ny,
+        const TensorND& grad_nq, const TensorND& grad_nk, const TensorND& grad_nv,
+        void* workspace) {
+    if (!kern || !is_dense_f32(grad_nz.layout) || !is_dense_f32(nq.layout) ||
+        !is_dense_f32(nk.layout) || !is_dense_f32(nv.layout) ||
+        !is_dense_f32(ny.layout) || !is_dense_f32(grad_nq.layout) ||
+        !is_dense_f32(grad_nk.layout) || !is_dense_f32(grad_nv.layout)) {
+        return false;
+    }
+    size_t BH = nq.layout[0], L = nq.layout[1], D = nq.layout[2];
+    size_t S = nk.layout[1], Dv = nv.layout[2];
+    megdnn_assert(
+            grad_nz.layout.total_nr_elems() == BH * L * Dv &&
+            ny.layout.total_nr_elems() == BH * L * S);
+
+    size_t wsize = attn_bwd_workspace(S, Dv);
+    float scaler = param.sm_scaler;
+    auto attn_kern = kern;
+    float* wptr = static_cast<float*>(workspace);
+    auto run = [=](size_t index, size_t thread_id) {
+        AttnBwdParam p;
+        p.grad_z = grad_nz.ptr<dt_float32>() + index * L * Dv;
+        p.q = nq.ptr<dt_float32>() + index * L * D;
+        p.k = nk.ptr<dt_float32>() + index * S * D;
+        p.v = nv.ptr<dt_float32>() + index * S * Dv;
+        p.y = ny.ptr<dt_float32>() + index * L * S;
+        p.grad_q = grad_nq.ptr<dt_float32>() + index * L * D;
+        p.grad_k = grad_nk.ptr<dt_float32>() + index * S * D;
+        p.grad_v = grad_nv.ptr<dt_float32>() + index * S * Dv;
+        p.L = L;
+        p.S = S;
+        p.D = D;
+        p.Dv = Dv;
+        p.scaler = scaler;
+        p.workspace = wptr + thread_id * wsize;
+        attn_kern(p);
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(
+            static_cast<naive::HandleImpl*>(handle), BH, run);
+    return true;
+}
+
+/* ===================== MultiHeadAttnForwardImpl ===================== */
+
+MultiHeadAttnForwardImpl::MultiHeadAttnForwardImpl(Handle* handle)
+        : MultiHeadAttnForward(handle) {
+    proxy_opr.kern = attn_fwd<GiSimdTraits>;
+}
+
+void MultiHeadAttnForwardImpl::deduce_layout(MHA_FORWARD_LAYOUT_PARAM) {
+    proxy_opr.deduce_layout(this->handle(), param(), MHA_FORWARD_CALL);
+}
+
+size_t MultiHeadAttnForwardImpl::get_workspace_in_bytes(
+        MHA_FORWARD_LAYOUT_CONST_PARAM) {
+    size_t size =
+            proxy_opr.get_workspace_in_bytes(this->handle(), param(), MHA_FORWARD_CALL);
+    return size + proxy_opr.get_fused_workspace_in_bytes(this->handle(), param());
+}
+
+size_t MultiHeadAttnForwardImpl::get_mask_reservespace_in_bytes(
+        MHA_FORWARD_LAYOUT_CONST_PARAM) {
+    return proxy_opr.get_mask_reservespace_in_bytes(
+            this->handle(), param(), MHA_FORWARD_CALL);
+}
+
+size_t MultiHeadAttnForwardImpl::get_othr_reservespace_in_bytes(
+        MHA_FORWARD_LAYOUT_CONST_PARAM) {
+    return proxy_opr.get_othr_reservespace_in_bytes(
+            this->handle(), param(), MHA_FORWARD_CALL);
+}
+
+void MultiHeadAttnForwardImpl::exec(MHA_FORWARD_EXEC_PARAM) {
+    check_exec(MHA_FORWARD_TENSOR_TO_LAYOUT_CALL, workspace.size);
+    proxy_opr.exec(this->handle(), param(), MHA_FORWARD_CALL, workspace);
+}
+
+/* ===================== MultiHeadAttnBackwardImpl ===================== */
+
+MultiHeadAttnBackwardImpl::MultiHeadAttnBackwardImpl(Handle* handle)
+        : MultiHeadAttnBackward(handle) {
+    proxy_opr.kern = attn_bwd<GiSimdTraits>;
+}
+
+void MultiHeadAttnBackwardImpl::exec(MHA_BACKWARD_EXEC_PARAM) {
+    check_exec(MHA_BACKWARD_TENSOR_TO_LAYOUT_CALL, workspace.size);
+    proxy_opr.exec(this->handle(), param(), MHA_BACKWARD_CALL, workspace);
+}
+
+size_t MultiHeadAttnBackwardImpl::get_workspace_in_bytes(
+        MHA_BACKWARD_LAYOUT_CONST_PARAM) {
+    size_t size = proxy_opr.get_workspace_in_bytes(
+            this->handle(), param(), MHA_BACKWARD_CALL);
+    return size + proxy_opr.get_fused_workspace_in_bytes(this->handle(), param());
+}
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,79 @@
+#pragma once
+#include "megdnn/oprs/nn.h"
+#include "src/common/multi_head_attn/proxy_backward_base.h"
+#include "src/common/multi_head_attn/proxy_forward_base.h"
+#include "src/fallback/multi_head_attn/attn_kern.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief proxy that replaces the attention core of the naive pipeline by a
+ *      fused kernel, multithreaded over batch x head
+ */
+class MHAForwardProxyOpr final : public multi_head_attn::MHAForwardProxyBase {
+public:
+    using Param = multi_head_attn::Param;
+    //! kernel for a single (batch, head) pair, chosen by the opr impl
+    AttnFwdKern kern = nullptr;
+
+#define cb(DType)               \
+    void move_scaler_to_device( \
+            Handle*, DTypeTrait<DType>::ctype*, DTypeTrait<DType>::ctype*) override;
+    MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+#undef cb
+
+    bool fused_attn_exec(
+            Handle* handle, const Param& param, const TensorND& nq, const TensorND& nk,
+            const TensorND& nv, const TensorND& attn_mask, const TensorND& attn_weight,
+            const TensorND& z, void* workspace) override;
+
+    //! workspace of the fused path, valid after the proxy layouts are refilled
+    size_t get_fused_workspace_in_bytes(Handle* handle, const Param& param);
+};
+
+class MHABackwardProxyOpr final : public multi_head_attn::MHABackwardProxyBase {
+public:
+    using Param = multi_head_attn::Param;
+    AttnBwdKern kern = nullptr;
+
+#define cb(DType)               \
+    void move_scaler_to_device( \
+            Handle*, DTypeTrait<DType>::ctype*, DTypeTrait<DType>::ctype*) override;
+    MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+#undef cb
+
+    bool fused_attn_backward_exec(
+            Handle* handle, const Param& param, const TensorND& grad_nz,
+            const TensorND& nq, const TensorND& nk, const TensorND& nv,
+            const TensorND& ny, const TensorND& grad_nq, const TensorND& grad_nk,
+            const TensorND& grad_nv, void* workspace) override;
+
+    size_t get_fused_workspace_in_bytes(Handle* handle, const Param& param);
+};
+
+class MultiHeadAttnForwardImpl : public MultiHeadAttnForward {
+public:
+    MultiHeadAttnForwardImpl(Handle* handle);
+    MHAForwardProxyOpr proxy_opr;
+
+    void exec(MHA_FORWARD_EXEC_PARAM) override;
+    void deduce_layout(MHA_FORWARD_LAYOUT_PARAM) override;
+    size_t get_workspace_in_bytes(MHA_FORWARD_LAYOUT_CONST_PARAM) override;
+    size_t get_mask_reservespace_in_bytes(MHA_FORWARD_LAYOUT_CONST_PARAM) override;
+    size_t get_othr_reservespace_in_bytes(MHA_FORWARD_LAYOUT_CONST_PARAM) override;
+};
+
+class MultiHeadAttnBackwardImpl : public MultiHeadAttnBackward {
+public:
+    MultiHeadAttnBackwardImpl(Handle* handle);
+    MHABackwardProxyOpr proxy_opr;
+
+    void exec(MHA_BACKWARD_EXEC_PARAM) override;
+    size_t get_workspace_in_bytes(MHA_BACKWARD_LAYOUT_CONST_PARAM) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,90 @@
+#include "src/fallback/non_zero/opr_impl.h"
+#include "src/common/cond_take/predicate.cuh"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+//! bytes of the part offsets at the beginning of the workspace
+size_t offsets_size(size_t nr_parts) {
+    return (nr_parts + 1) * sizeof(size_t);
+}
+
+//! write the coordinates of the flat indices idx[0:size] to dst, whose row d
+//! holds the coordinates of axis d
+void dispatch_expand(
+        naive::HandleImpl* handle, const dt_int32* idx, size_t size,
+        const TensorShape& shape, dt_int32* dst) {
+    size_t nr_parts = compact::nr_parts(size, get_nr_threads(handle));
+    auto kern = [=](size_t part, size_t) {
+        size_t begin, end;
+        compact::split(size, nr_parts, part, begin, end);
+        for (size_t i = begin; i < end; ++i) {
+            size_t rem = idx[i];
+            for (size_t d = shape.ndim; d > 0; --d) {
+                dst[(d - 1) * size + i] = rem % shape[d - 1];
+                rem /= shape[d - 1];
+            }
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);
+}
+
+}  // anonymous namespace
+
+size_t NonZeroImpl::get_workspace_in_bytes(const TensorLayout& src) {
+    size_t n = src.total_nr_elems();
+    auto nr_parts = compact::nr_parts(n, get_nr_threads(handle()));
+    return offsets_size(nr_parts) + n * sizeof(dt_int32);
+}
+
+TensorND NonZeroImpl::exec(
+        _megdnn_tensor_in src, _megdnn_workspace workspace,
+        DynOutMallocPolicyCall malloc_policy) {
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    size_t n = src.layout.total_nr_elems();
+    auto nr_parts = compact::nr_parts(n, get_nr_threads(handle));
+    megdnn_assert(workspace.size >= get_workspace_in_bytes(src.layout));
+    auto offsets = workspace.ptr<size_t>();
+    auto idx = workspace.ptr<dt_int32>(offsets_size(nr_parts));
+
+    cond_take::KParam kparam({});
+    kparam.val = 0.0;
+    kparam.eps = 1e-6;
+    switch (src.layout.dtype.enumv()) {
+#define cb(_dt)                                                                  \
+    case DTypeTrait<_dt>::enumv: {                                               \
+        using ctype = DTypeTrait<_dt>::ctype;                                    \
+        cond_take::Pred<cond_take::PEnum::NEQ, ctype> pred(kparam);              \
+        compact::dispatch_count(                                                 \
+                handle, src.ptr<ctype>(), n, nr_parts, pred, offsets);          \
+        handle->megcore_dispatcher()->sync();                                    \
+        compact::counts_to_offsets(offsets, nr_parts);                           \
+        compact::dispatch_compact(                                               \
+                handle, src.ptr<ctype>(), n, nr_parts, pred, offsets, idx);     \
+        break;                                                                   \
+    }
+        MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+        cb(::megdnn::dtype::Bool)
+#undef cb
+                default : megdnn_throw(ssprintf(
+                                  "bad mask dtype %s of NonZero",
+                                  src.layout.dtype.name()));
+    }
+
+    size_t ndim = src.layout.ndim;
+    size_t size = offsets[nr_parts];
+    auto ret = malloc_policy.alloc_output(0, dtype::Int32(), {ndim, size});
+    dispatch_expand(handle, idx, size, src.layout, ret.ptr<dt_int32>());
+    return ret;
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "src/naive/non_zero/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief NonZero by the parallel two-pass compaction shared with CondTake
+ *
+ * the flat indices of the nonzero elements are compacted into the workspace,
+ * then they are expanded into the coordinates of each axis in parallel.
+ */
+class NonZeroImpl : public naive::NonZeroImpl {
+public:
+    using naive::NonZeroImpl::NonZeroImpl;
+    TensorND exec(
+            _megdnn_tensor_in src, _megdnn_workspace workspace,
+            DynOutMallocPolicyCall malloc_policy) override;
+    size_t get_workspace_in_bytes(const TensorLayout& src) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,516 @@
+#pragma once
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <initializer_list>
+#include "megdnn/arch.h"
+#include "megdnn/basic_types.h"
+
+namespace megdnn {
+namespace fallback {
+
+//! columns of a GeneralNorm slice handled by one task when the slices are strided
+constexpr size_t NORM_COL_BLOCK = 64;
+
+/*!
+ * \brief arguments of the normalization kernels
+ *
+ * x, dy and y are fp32 (rows, cols) matrices whose rows are stride apart.
+ * weight and bias are nullptr without affine, dweight and dbias are nullptr
+ * when the weight gradient is not wanted.
+ */
+struct NormParam {
+    const float* x;
+    const float* dy;
+    const float* weight;
+    const float* bias;
+    //! dst in forward and ddata in backward
+    float* y;
+    float* mean;
+    float* rstd;
+    float* dweight;
+    float* dbias;
+    size_t rows, cols, stride;
+    float eps;
+    float* workspace;
+};
+
+using NormKernFunc = void (*)(const NormParam&);
+
+/*!
+ * \brief the kernels of the three slice shapes
+ *
+ * rows: every row is a slice, the affine params follow the columns (LayerNorm)
+ * group: the whole matrix is one slice, the affine params follow the rows and
+ *      rstd holds the variance (GroupNorm)
+ * cols: every column is a slice, the affine params follow the rows
+ *      (GeneralNorm with trailing axes)
+ */
+struct NormKern {
+    NormKernFunc fwd_rows, fwd_group, fwd_cols;
+    NormKernFunc bwd_rows, bwd_group, bwd_cols;
+};
+
+/*!
+ * \brief single-pass Welford statistics and the fused affine of each row
+ *
+ * every lane keeps its own running mean and M2, the lanes and the scalar tail
+ * are merged by the parallel variance formula at the end. mean and rstd of
+ * row r are written to mean[r] and rstd[r].
+ */
+template <class Simd>
+void norm_fwd_rows(const NormParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t n = p.cols;
+    float lane_mean[width], lane_m2[width];
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * p.stride;
+        float* y = p.y + r * p.stride;
+        type vmean = Simd::setzero(), vm2 = Simd::setzero();
+        size_t i = 0, k = 0;
+        for (; i + width <= n; i += width) {
+            ++k;
+            type vx = Simd::loadu(x + i);
+            type delta = Simd::sub(vx, vmean);
+            vmean = Simd::fmadd(delta, Simd::set1(1.f / k), vmean);
+            vm2 = Simd::fmadd(delta, Simd::sub(vx, vmean), vm2);
+        }
+        float mean = 0.f, m2 = 0.f;
+        size_t count = k * width;
+        if (k) {
+            Simd::storeu(lane_mean, vmean);
+            Simd::storeu(lane_m2, vm2);
+            for (size_t l = 0; l < width; ++l) {
+                mean += lane_mean[l];
+            }
+            mean /= width;
+            for (size_t l = 0; l < width; ++l) {
+                float d = lane_mean[l] - mean;
+                m2 += lane_m2[l] + k * d * d;
+            }
+        }
+        for (; i < n; ++i) {
+            float d = x[i] - mean;
+            mean += d / ++count;
+            m2 += d * (x[i] - mean);
+        }
+        float rstd = 1.f / std::sqrt(m2 / n + p.eps);
+        p.mean[r] = mean;
+        p.rstd[r] = rstd;
+
+        type vscale = Simd::set1(rstd), vshift = Simd::set1(-mean * rstd);
+        for (i = 0; i + width <= n; i += width) {
+            type v = Simd::fmadd(Simd::loadu(x + i), vscale, vshift);
+            if (p.weight) {
+                v = Simd::fmadd(
+                        v, Simd::loadu(p.weight + i), Simd::loadu(p.bias + i));
+            }
+            Simd::storeu(y + i, v);
+        }
+        for (; i < n; ++i) {
+            float v = x[i] * rstd - mean * rstd;
+            y[i] = p.weight ? v * p.weight[i] + p.bias[i] : v;
+        }
+    }
+}
+
+//! statistics of the dense (rows, cols) slice, per-row affine; writes the
+//! variance rather than rstd, as GroupNorm saves it
+template <class Simd>
+void norm_fwd_group(const NormParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t n = p.rows * p.cols;
+    const float* x = p.x;
+    float lane_mean[width], lane_m2[width];
+    type vmean = Simd::setzero(), vm2 = Simd::setzero();
+    size_t i = 0, k = 0;
+    for (; i + width <= n; i += width) {
+        ++k;
+        type vx = Simd::loadu(x + i);
+        type delta = Simd::sub(vx, vmean);
+        vmean = Simd::fmadd(delta, Simd::set1(1.f / k), vmean);
+        vm2 = Simd::fmadd(delta, Simd::sub(vx, vmean), vm2);
+    }
+    float mean = 0.f, m2 = 0.f;
+    size_t count = k * width;
+    if (k) {
+        Simd::storeu(lane_mean, vmean);
+        Simd::storeu(lane_m2, vm2);
+        for (size_t l = 0; l < width; ++l) {
+            mean += lane_mean[l];
+        }
+        mean /= width;
+        for (size_t l = 0; l < width; ++l) {
+            float d = lane_mean[l] - mean;
+            m2 += lane_m2[l] + k * d * d;
+        }
+    }
+    for (; i < n; ++i) {
+        float d = x[i] - mean;
+        mean += d / ++count;
+        m2 += d * (x[i] - mean);
+    }
+    float var = m2 / n;
+    float rstd = 1.f / std::sqrt(var + p.eps);
+    p.mean[0] = mean;
+    p.rstd[0] = var;
+
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* xr = x + r * p.cols;
+        float* y = p.y + r * p.cols;
+        float scale = p.weight ? rstd * p.weight[r] : rstd;
+        float shift = (p.bias ? p.bias[r] : 0.f) - scale * mean;
+        type vscale = Simd::set1(scale), vshift = Simd::set1(shift);
+        size_t j = 0;
+        for (; j + width <= p.cols; j += width) {
+            Simd::storeu(y + j, Simd::fmadd(Simd::loadu(xr + j), vscale, vshift));
+        }
+        for (; j < p.cols; ++j) {
+            y[j] = xr[j] * scale + shift;
+        }
+    }
+}
+
+//! Welford statistics of every column, updated row by row across the lanes;
+//! rstd holds M2 until all the rows are seen
+template <class Simd>
+void norm_fwd_cols(const NormParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t n = p.cols;
+    float* mean = p.mean;
+    float* m2 = p.rstd;
+    std::fill(mean, mean + n, 0.f);
+    std::fill(m2, m2 + n, 0.f);
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * p.stride;
+        float inv = 1.f / (r + 1);
+        type vinv = Simd::set1(inv);
+        size_t c = 0;
+        for (; c + width <= n; c += width) {
+            type vx = Simd::loadu(x + c), vmean = Simd::loadu(mean + c);
+            type delta = Simd::sub(vx, vmean);
+            vmean = Simd::fmadd(delta, vinv, vmean);
+            type vm2 = Simd::fmadd(delta, Simd::sub(vx, vmean), Simd::loadu(m2 + c));
+            Simd::storeu(mean + c, vmean);
+            Simd::storeu(m2 + c, vm2);
+        }
+        for (; c < n; ++c) {
+            float delta = x[c] - mean[c];
+            mean[c] += delta * inv;
+            m2[c] += delta * (x[c] - mean[c]);
+        }
+    }
+    for (size_t c = 0; c < n; ++c) {
+        p.rstd[c] = 1.f / std::sqrt(m2[c] / p.rows + p.eps);
+    }
+
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * p.stride;
+        float* y = p.y + r * p.stride;
+        float w = p.weight ? p.weight[r] : 1.f, b = p.bias ? p.bias[r] : 0.f;
+        type vw = Simd::set1(w), vb = Simd::set1(b);
+        size_t c = 0;
+        for (; c + width <= n; c += width) {
+            type v = Simd::sub(Simd::loadu(x + c), Simd::loadu(mean + c));
+            v = Simd::mul(v, Simd::loadu(p.rstd + c));
+            Simd::storeu(y + c, Simd::fmadd(v, vw, vb));
+        }
+        for (; c < n; ++c) {
+            y[c] = (x[c] - mean[c]) * p.rstd[c] * w + b;
+        }
+    }
+}
+
+/*!
+ * \brief gradient of norm_fwd_rows
+ *
+ * the sums of dy * w and dy * x * w give ddata = dy * a * w + x * b + c, and
+ * (x - mean) * rstd * dy and dy of every row are accumulated into dweight and
+ * dbias when they are given.
+ */
+template <class Simd>
+void norm_bwd_rows(const NormParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t n = p.cols;
+    float lane_db[width], lane_ds[width];
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * p.stride;
+        const float* dy = p.dy + r * p.stride;
+        float* dx = p.y + r * p.stride;
+        type vdb = Simd::setzero(), vds = Simd::setzero();
+        size_t i = 0;
+        for (; i + width <= n; i += width) {
+            type vdyw = Simd::loadu(dy + i);
+            if (p.weight) {
+                vdyw = Simd::mul(vdyw, Simd::loadu(p.weight + i));
+            }
+            vdb = Simd::add(vdb, vdyw);
+            vds = Simd::fmadd(vdyw, Simd::loadu(x + i), vds);
+        }
+        Simd::storeu(lane_db, vdb);
+        Simd::storeu(lane_ds, vds);
+        float db = 0.f, ds = 0.f;
+        for (size_t l = 0; l < width; ++l) {
+            db += lane_db[l];
+            ds += lane_ds[l];
+        }
+        for (; i < n; ++i) {
+            float dyw = p.weight ? dy[i] * p.weight[i] : dy[i];
+            db += dyw;
+            ds += dyw * x[i];
+        }
+
+        float mean = p.mean[r], a = p.rstd[r];
+        float b = (db * mean - ds) * a * a * a / n;
+        float c = -b * mean - db * a / n;
+        type va = Simd::set1(a), vb = Simd::set1(b), vc = Simd::set1(c);
+        for (i = 0; i + width <= n; i += width) {
+            type vaw = p.weight ? Simd::mul(va, Simd::loadu(p.weight + i)) : va;
+            type v = Simd::fmadd(Simd::loadu(dy + i), vaw, vc);
+            Simd::storeu(dx + i, Simd::fmadd(Simd::loadu(x + i), vb, v));
+        }
+        for (; i < n; ++i) {
+            float aw = p.weight ? a * p.weight[i] : a;
+            dx[i] = dy[i] * aw + x[i] * b + c;
+        }
+
+        if (!p.dweight) {
+            continue;
+        }
+        type vmean = Simd::set1(mean);
+        for (i = 0; i + width <= n; i += width) {
+            type vdy = Simd::loadu(dy + i);
+            type xhat = Simd::mul(Simd::sub(Simd::loadu(x + i), vmean), va);
+            Simd::storeu(
+                    p.dweight + i, Simd::fmadd(xhat, vdy, Simd::loadu(p.dweight + i)));
+            Simd::storeu(p.dbias + i, Simd::add(vdy, Simd::loadu(p.dbias + i)));
+        }
+        for (; i < n; ++i) {
+            p.dweight[i] += (x[i] - mean) * a * dy[i];
+            p.dbias[i] += dy[i];
+        }
+    }
+}
+
+/*!
+ * \brief gradient of norm_fwd_group
+ *
+ * the per-row sums of dy * x and dy are written to dweight[r] and dbias[r],
+ * from which the caller reduces the weight gradient over the batch.
+ */
+template <class Simd>
+void norm_bwd_group(const NormParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t n = p.cols;
+    float lane_db[width], lane_ds[width];
+    float ds_w = 0.f, db_w = 0.f;
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * n;
+        const float* dy = p.dy + r * n;
+        type vdb = Simd::setzero(), vds = Simd::setzero();
+        size_t j = 0;
+        for (; j + width <= n; j += width) {
+            type vdy = Simd::loadu(dy + j);
+            vdb = Simd::add(vdb, vdy);
+            vds = Simd::fmadd(vdy, Simd::loadu(x + j), vds);
+        }
+        Simd::storeu(lane_db, vdb);
+        Simd::storeu(lane_ds, vds);
+        float db = 0.f, ds = 0.f;
+        for (size_t l = 0; l < width; ++l) {
+            db += lane_db[l];
+            ds += lane_ds[l];
+        }
+        for (; j < n; ++j) {
+            db += dy[j];
+            ds += dy[j] * x[j];
+        }
+        p.dweight[r] = ds;
+        p.dbias[r] = db;
+        float w = p.weight ? p.weight[r] : 1.f;
+        ds_w += ds * w;
+        db_w += db * w;
+    }
+
+    float mean = p.mean[0];
+    float rstd = 1.f / std::sqrt(p.rstd[0] + p.eps);
+    float s = 1.f / (p.rows * n);
+    float c2 = (db_w * mean - ds_w) * rstd * rstd * rstd * s;
+    float c3 = -c2 * mean - db_w * rstd * s;
+    type vc2 = Simd::set1(c2), vc3 = Simd::set1(c3);
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * n;
+        const float* dy = p.dy + r * n;
+        float* dx = p.y + r * n;
+        float c1 = p.weight ? rstd * p.weight[r] : rstd;
+        type vc1 = Simd::set1(c1);
+        size_t j = 0;
+        for (; j + width <= n; j += width) {
+            type v = Simd::fmadd(Simd::loadu(dy + j), vc1, vc3);
+            Simd::storeu(dx + j, Simd::fmadd(Simd::loadu(x + j), vc2, v));
+        }
+        for (; j < n; ++j) {
+            dx[j] = c1 * dy[j] + c2 * x[j] + c3;
+        }
+    }
+}
+
+/*!
+ * \brief gradient of norm_fwd_cols
+ *
+ * needs 2 * cols floats of workspace for the per-column coefficients; the
+ * weight gradient of every row is accumulated into dweight and dbias when
+ * they are given.
+ */
+template <class Simd>
+void norm_bwd_cols(const NormParam& p) {
+    using type = typename Simd::type;
+    static MEGDNN_CONSTEXPR size_t width = Simd::width;
+    const size_t n = p.cols;
+    float* coef_b = p.workspace;
+    float* coef_c = coef_b + n;
+    std::fill(coef_b, coef_b + 2 * n, 0.f);
+    // the sums of dy * w and dy * x * w are kept in coef_c and coef_b first
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * p.stride;
+        const float* dy = p.dy + r * p.stride;
+        float w = p.weight ? p.weight[r] : 1.f;
+        type vw = Simd::set1(w);
+        size_t c = 0;
+        for (; c + width <= n; c += width) {
+            type vdyw = Simd::mul(Simd::loadu(dy + c), vw);
+            Simd::storeu(coef_c + c, Simd::add(Simd::loadu(coef_c + c), vdyw));
+            Simd::storeu(
+                    coef_b + c,
+                    Simd::fmadd(vdyw, Simd::loadu(x + c), Simd::loadu(coef_b + c)));
+        }
+        for (; c < n; ++c) {
+            coef_c[c] += dy[c] * w;
+            coef_b[c] += dy[c] * w * x[c];
+        }
+    }
+    for (size_t c = 0; c < n; ++c) {
+        float a = p.rstd[c], mean = p.mean[c], db = coef_c[c], ds = coef_b[c];
+        coef_b[c] = (db * mean - ds) * a * a * a / p.rows;
+        coef_c[c] = -coef_b[c] * mean - db * a / p.rows;
+    }
+
+    float lane_dw[width], lane_db[width];
+    for (size_t r = 0; r < p.rows; ++r) {
+        const float* x = p.x + r * p.stride;
+        const float* dy = p.dy + r * p.stride;
+        float* dx = p.y + r * p.stride;
+        float w = p.weight ? p.weight[r] : 1.f;
+        type vw = Simd::set1(w);
+        type vdw = Simd::setzero(), vdb = Simd::setzero();
+        size_t c = 0;
+        for (; c + width <= n; c += width) {
+            type vx = Simd::loadu(x + c), vdy = Simd::loadu(dy + c);
+            type va = Simd::loadu(p.rstd + c);
+            type v = Simd::fmadd(vdy, Simd::mul(va, vw), Simd::loadu(coef_c + c));
+            Simd::storeu(dx + c, Simd::fmadd(vx, Simd::loadu(coef_b + c), v));
+            type xhat = Simd::mul(Simd::sub(vx, Simd::loadu(p.mean + c)), va);
+            vdw = Simd::fmadd(xhat, vdy, vdw);
+            vdb = Simd::add(vdb, vdy);
+        }
+        float dw = 0.f, db = 0.f;
+        for (; c < n; ++c) {
+            float a = p.rstd[c];
+            dx[c] = dy[c] * a * w + x[c] * coef_b[c] + coef_c[c];
+            dw += (x[c] - p.mean[c]) * a * dy[c];
+            db += dy[c];
+        }
+        if (p.dweight) {
+            Simd::storeu(lane_dw, vdw);
+            Simd::storeu(lane_db, vdb);
+            for (size_t l = 0; l < width; ++l) {
+                dw += lane_dw[l];
+                db += lane_db[l];
+            }
+            p.dweight[r] += dw;
+            p.dbias[r] += db;
+        }
+    }
+}
+
+template <class Simd>
+NormKern get_norm_kern() {
+    return {norm_fwd_rows<Simd>, norm_fwd_group<Simd>, norm_fwd_cols<Simd>,
+            norm_bwd_rows<Simd>, norm_bwd_group<Simd>, norm_bwd_cols<Simd>};
+}
+
+/*!
+ * \brief access to the storage of a norm opr as fp32
+ *
+ * fp32 tensors are used in place, the others are converted through a dense
+ * buffer of rows * cols floats.
+ */
+template <typename T>
+struct NormStorage {
+    static constexpr bool inplace = false;
+    static const float* load(
+            const T* src, size_t rows, size_t cols, size_t stride, float* buf) {
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < cols; ++c) {
+                buf[r * cols + c] = static_cast<float>(src[r * stride + c]);
+            }
+        }
+        return buf;
+    }
+    static float* dst(T*, float* buf) { return buf; }
+    static void store(
+            T* dst, const float* buf, size_t rows, size_t cols, size_t stride) {
+        for (size_t r = 0; r < rows; ++r) {
+            for (size_t c = 0; c < cols; ++c) {
+                dst[r * stride + c] = static_cast<T>(buf[r * cols + c]);
+            }
+        }
+    }
+};
+
+template <>
+struct NormStorage<dt_float32> {
+    static constexpr bool inplace = true;
+    static const float* load(const float* src, size_t, size_t, size_t, float*) {
+        return src;
+    }
+    static float* dst(float* dst, float*) { return dst; }
+    static void store(float*, const float*, size_t, size_t, size_t) {}
+};
+
+/*!
+ * \brief whether the norm kernels can work on the tensors
+ *
+ * all the layouts must be contiguous, or empty for the unused affine params,
+ * and the first one decides the storage dtype
+ */
+inline bool is_norm_usable(std::initializer_list<TensorLayout> layouts) {
+    auto dtype = layouts.begin()->dtype;
+    if (dtype != dtype::Float32() DNN_INC_FLOAT16(
+                         &&dtype != dtype::Float16() && dtype != dtype::BFloat16())) {
+        return false;
+    }
+    for (auto&& layout : layouts) {
+        if (layout.ndim && !layout.is_contiguous()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+//! the range of [0, n) handled by the part-th of nr_parts tasks
+inline void norm_partition(
+        size_t n, size_t nr_parts, size_t part, size_t& begin, size_t& end) {
+    begin = n * part / nr_parts;
+    end = n * (part + 1) / nr_parts;
+}
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,368 @@
+#include "src/fallback/rnn/funcs.h"
+#include "src/common/opr_delegate.h"
+#include "src/fallback/elemwise_helper/kimpl/relu.h"
+#include "src/fallback/elemwise_helper/kimpl/sigmoid.h"
+#include "src/fallback/elemwise_helper/kimpl/tanh.h"
+
+#include <cstring>
+
+using namespace megdnn;
+using namespace fallback;
+using namespace rnn;
+
+namespace {
+
+constexpr size_t SIMD_WIDTH = GI_SIMD_LEN_BYTE / sizeof(float);
+constexpr size_t ALIGN = 64;
+
+//! the first matmul algo packing both A and B of a plain fp32 GEMM
+MatrixMulImpl::AlgoBase* get_packed_algo(const MatrixMulImpl::KernSizeParam& param) {
+    static CpuOprDelegationStorage<1> storage;
+    auto matmul_opr = static_cast<MatrixMulImpl*>(storage.get<MatrixMul>());
+    using AlgoBase = MatrixMulImpl::AlgoBase;
+    auto&& algos = matmul_opr->select_algo_type(
+            {MatrixMulImpl::AlgoDataType::FLOAT32, param::MatrixMul::Format::DEFAULT});
+    for (auto&& algo : algos) {
+        if (algo->packmode() == AlgoBase::PackMode::DEFAULT &&
+            algo->algoset() == AlgoBase::AlgoSet::ALGO_TYPE_GEMM &&
+            algo->usable(param)) {
+            return algo;
+        }
+    }
+    megdnn_throw("no packed fp32 matmul algo");
+}
+
+inline const float* offset(const float* ptr, size_t n) {
+    return ptr ? ptr + n : nullptr;
+}
+
+inline GI_FLOAT32_t load_sum(
+        const float* x, const float* y, const float* b0, const float* b1, size_t i) {
+    GI_FLOAT32_t ret = GiLoadFloat32(x + i);
+    if (y)
+        ret = GiAddFloat32(ret, GiLoadFloat32(y + i));
+    if (b0)
+        ret = GiAddFloat32(ret, GiLoadFloat32(b0 + i));
+    if (b1)
+        ret = GiAddFloat32(ret, GiLoadFloat32(b1 + i));
+    return ret;
+}
+
+inline float sum(
+        const float* x, const float* y, const float* b0, const float* b1, size_t i) {
+    float ret = x[i];
+    if (y)
+        ret += y[i];
+    if (b0)
+        ret += b0[i];
+    if (b1)
+        ret += b1[i];
+    return ret;
+}
+
+struct IdentityOp {
+    GI_FLOAT32_t operator()(const GI_FLOAT32_t& src) const { return src; }
+    float operator()(const float& src) const { return src; }
+};
+
+template <class Op>
+void rnn_row_impl(
+        const float* x, const float* y, const float* b0, const float* b1, float* h,
+        size_t len) {
+    Op op;
+    size_t i = 0;
+    for (; i + SIMD_WIDTH <= len; i += SIMD_WIDTH) {
+        GiStoreFloat32(h + i, op(load_sum(x, y, b0, b1, i)));
+    }
+    for (; i < len; ++i) {
+        h[i] = op(sum(x, y, b0, b1, i));
+    }
+}
+
+}  // namespace
+
+bool rnn::is_usable(const TensorLayoutArray& layouts) {
+    for (auto&& layout : layouts) {
+        if (layout.dtype != dtype::Float32() || !layout.is_contiguous()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* ===================== PackedGemm ===================== */
+
+PackedGemm::PackedGemm(size_t N, size_t K) {
+    m_param.A_type = m_param.B_type = m_param.C_type = dtype::Float32();
+    m_param.M = ROW_BLOCK;
+    m_param.N = N;
+    m_param.K = K;
+    m_param.LDA = m_param.LDB = K;
+    m_param.LDC = N;
+    m_param.trA = false;
+    m_param.trB = true;
+    m_param.compute_mode = param::MatrixMul::ComputeMode::DEFAULT;
+    m_param.format = param::MatrixMul::Format::DEFAULT;
+    m_algo = get_packed_algo(m_param);
+}
+
+size_t PackedGemm::weight_size() const {
+    return m_algo->get_bundle(m_param).get_size(1);
+}
+
+size_t PackedGemm::panel_size() const {
+    return m_algo->get_bundle(m_param).get_size(0);
+}
+
+void PackedGemm::pack_weight(const float* weight, void* packed_weight) const {
+    MatrixMulImpl::KernParam kern_param;
+    static_cast<MatrixMulImpl::KernSizeParam&>(kern_param) = m_param;
+    kern_param.B_ptr = const_cast<float*>(weight);
+    m_algo->pack_B(kern_param, packed_weight, 0, m_param.N);
+}
+
+void PackedGemm::exec(
+        const float* A, size_t lda, size_t nr_rows, const void* packed_weight,
+        void* a_panel, float* C, size_t ldc) const {
+    megdnn_assert(nr_rows <= ROW_BLOCK);
+    MatrixMulImpl::KernParam kern_param;
+    static_cast<MatrixMulImpl::KernSizeParam&>(kern_param) = m_param;
+    kern_param.M = nr_rows;
+    kern_param.LDA = lda;
+    kern_param.LDC = ldc;
+    kern_param.A_ptr = const_cast<float*>(A);
+    kern_param.C_ptr = C;
+    m_algo->pack_A(kern_param, a_panel, 0, nr_rows);
+    m_algo->get_kern_naked(kern_param)(kern_param, a_panel, packed_weight);
+}
+
+/* ===================== gate kernels ===================== */
+
+void rnn::lstm_row(const LstmRowParam& p) {
+    const size_t H = p.hidden_size;
+    const float *x[4], *y[4], *b0[4], *b1[4];
+    float* gates[4];
+    for (size_t g = 0; g < 4; ++g) {
+        x[g] = p.x + g * H;
+        y[g] = offset(p.y, g * H);
+        b0[g] = offset(p.bias_ih, g * H);
+        b1[g] = offset(p.bias_hh, g * H);
+        gates[g] = p.gates ? p.gates + g * p.gates_stride : nullptr;
+    }
+    SigmoidOp<dt_float32> sigmoid;
+    TanhOp<dt_float32> tanh;
+    size_t i = 0;
+    for (; i + SIMD_WIDTH <= H; i += SIMD_WIDTH) {
+        GI_FLOAT32_t pre[4];
+        for (size_t g = 0; g < 4; ++g) {
+            pre[g] = load_sum(x[g], y[g], b0[g], b1[g], i);
+            if (gates[g])
+                GiStoreFloat32(gates[g] + i, pre[g]);
+        }
+        //! c_new = f * c_prev + i * g, h_new = o * tanh(c_new)
+        GI_FLOAT32_t ig = GiMultiplyFloat32(sigmoid(pre[0]), tanh(pre[2]));
+        GI_FLOAT32_t c = GiMultiplyAddFloat32(
+                ig, sigmoid(pre[1]), GiLoadFloat32(p.c_prev + i));
+        GiStoreFloat32(p.c_new + i, c);
+        GiStoreFloat32(p.h_new + i, GiMultiplyFloat32(sigmoid(pre[3]), tanh(c)));
+    }
+    for (; i < H; ++i) {
+        float pre[4];
+        for (size_t g = 0; g < 4; ++g) {
+            pre[g] = sum(x[g], y[g], b0[g], b1[g], i);
+            if (gates[g])
+                gates[g][i] = pre[g];
+        }
+        float c = sigmoid(pre[1]) * p.c_prev[i] + sigmoid(pre[0]) * tanh(pre[2]);
+        p.c_new[i] = c;
+        p.h_new[i] = sigmoid(pre[3]) * tanh(c);
+    }
+}
+
+void rnn::rnn_row(
+        const float* x, const float* y, const float* bias_ih, const float* bias_hh,
+        float* h_new, size_t hidden_size, NonlineMode mode) {
+    switch (mode) {
+        case NonlineMode::IDENTITY:
+            rnn_row_impl<IdentityOp>(x, y, bias_ih, bias_hh, h_new, hidden_size);
+            break;
+        case NonlineMode::RELU:
+            rnn_row_impl<ReluOp<dt_float32>>(
+                    x, y, bias_ih, bias_hh, h_new, hidden_size);
+            break;
+        case NonlineMode::TANH:
+            rnn_row_impl<TanhOp<dt_float32>>(
+                    x, y, bias_ih, bias_hh, h_new, hidden_size);
+            break;
+        default:
+            megdnn_throw("unsupported nonline mode");
+    }
+}
+
+/* ===================== SeqPlan ===================== */
+
+SeqPlan::SeqPlan(
+        const TensorLayout& input, size_t hidden_size, size_t nr_gates, size_t D,
+        size_t num_layers, bool bias, size_t nr_threads)
+        : seq_len(input[0]),
+          batch(input[1]),
+          input_size(input[2]),
+          hidden_size(hidden_size),
+          nr_gates(nr_gates),
+          D(D),
+          num_layers(num_layers),
+          bias(bias) {
+    size_t GH = nr_gates * hidden_size;
+    // every direction runs its chunks on at least one thread
+    nr_chunks = std::min(batch, std::max<size_t>(div_ceil(nr_threads, D), 1));
+    gemm_ih0 = PackedGemm(GH, input_size);
+    gemm_hh = PackedGemm(GH, hidden_size);
+    packed_ih_size = round_up(gemm_ih0.weight_size(), ALIGN);
+    size_t panel = std::max(gemm_ih0.panel_size(), gemm_hh.panel_size());
+    if (num_layers > 1) {
+        gemm_ih = PackedGemm(GH, D * hidden_size);
+        packed_ih_size =
+                std::max(packed_ih_size, round_up(gemm_ih.weight_size(), ALIGN));
+        panel = std::max(panel, gemm_ih.panel_size());
+    }
+    packed_size = packed_ih_size + round_up(gemm_hh.weight_size(), ALIGN);
+    // per thread: the A panel and the output of the recurrent GEMM
+    thread_size = round_up(panel, ALIGN) + ROW_BLOCK * GH * sizeof(float);
+
+    size_t rows = seq_len * batch;
+    size_t layer_output = rows * D * hidden_size * sizeof(float);
+    bundle = {nullptr,
+              {D * packed_size, bias ? D * GH * sizeof(float) : 0,
+               D * rows * GH * sizeof(float),
+               std::min<size_t>(num_layers - 1, 2) * layer_output,
+               nr_threads * thread_size}};
+}
+
+/* ===================== exec_seq ===================== */
+
+void rnn::exec_seq(
+        naive::HandleImpl* handle, SeqPlan plan, const TensorND& input,
+        const TensorND& flatten_weights, const TensorND& hx, const TensorND& cx,
+        const TensorND& output, const TensorND& hy, const TensorND& cy,
+        const TensorND& reserve_space, void* workspace, NonlineMode mode) {
+    plan.bundle.set(workspace);
+    const size_t T = plan.seq_len, B = plan.batch, H = plan.hidden_size,
+                 D = plan.D, L = plan.num_layers, GH = plan.nr_gates * H;
+    const size_t rows = T * B, nr_chunks = plan.nr_chunks;
+    const size_t chunk = div_ceil(B, nr_chunks);
+    const bool lstm = plan.nr_gates == 4, bias = plan.bias;
+    //! number of states kept in reserve_space per step
+    const size_t S = lstm ? 2 : 1;
+    auto packed = static_cast<dt_byte*>(plan.bundle.get(0));
+    auto bias_sum = static_cast<float*>(plan.bundle.get(1));
+    auto gin = static_cast<float*>(plan.bundle.get(2));
+    auto buf0 = static_cast<float*>(plan.bundle.get(3));
+    auto buf1 = buf0 + rows * D * H;
+    auto thread_ws = static_cast<dt_byte*>(plan.bundle.get(4));
+    const size_t packed_size = plan.packed_size, packed_ih_size = plan.packed_ih_size,
+                 thread_size = plan.thread_size;
+    const size_t panel_size = thread_size - ROW_BLOCK * GH * sizeof(float);
+
+    size_t weight_offset = 0;
+    for (size_t layer = 0; layer < L; ++layer) {
+        size_t in_size = layer ? D * H : plan.input_size;
+        size_t cell_size = GH * (in_size + H) + (bias ? 2 * GH : 0);
+        PackedGemm gemm_ih = layer ? plan.gemm_ih : plan.gemm_ih0;
+        PackedGemm gemm_hh = plan.gemm_hh;
+        const float* layer_src = layer % 2 ? buf0 : buf1;
+        float* layer_dst = layer % 2 ? buf1 : buf0;
+
+        auto pack = [=](size_t d, size_t) {
+            const float* w =
+                    flatten_weights.ptr<dt_float32>() + weight_offset + d * cell_size;
+            dt_byte* packed_d = packed + d * packed_size;
+            gemm_ih.pack_weight(w, packed_d);
+            gemm_hh.pack_weight(w + GH * in_size, packed_d + packed_ih_size);
+            if (bias) {
+                const float* bias_ih = w + GH * (in_size + H);
+                const float* bias_hh = bias_ih + GH;
+                float* dst = bias_sum + d * GH;
+                for (size_t i = 0; i < GH; ++i) {
+                    dst[i] = bias_ih[i] + bias_hh[i];
+                }
+            }
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, D, pack);
+
+        //! input projection of all the timesteps at once
+        size_t nr_blocks = div_ceil(rows, ROW_BLOCK);
+        auto project = [=](size_t index, size_t thread_id) {
+            size_t d = index / nr_blocks, row = index % nr_blocks * ROW_BLOCK;
+            const float* src = layer ? layer_src : input.ptr<dt_float32>();
+            gemm_ih.exec(
+                    src + row * in_size, in_size, std::min(ROW_BLOCK, rows - row),
+                    packed + d * packed_size, thread_ws + thread_id * thread_size,
+                    gin + (d * rows + row) * GH, GH);
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, D * nr_blocks, project);
+
+        auto recurrence = [=](size_t index, size_t thread_id) {
+            size_t d = index / nr_chunks;
+            size_t begin = index % nr_chunks * chunk, end = std::min(begin + chunk, B);
+            if (begin >= end)
+                return;
+            size_t cell = layer * D + d;
+            const void* packed_hh = packed + d * packed_size + packed_ih_size;
+            const float* bias_d = bias ? bias_sum + d * GH : nullptr;
+            const float* gin_d = gin + d * rows * GH;
+            dt_byte* a_panel = thread_ws + thread_id * thread_size;
+            float* gh = reinterpret_cast<float*>(a_panel + panel_size);
+            float* states = reserve_space.ptr<dt_float32>() + cell * T * S * B * H;
+            float* dst = layer + 1 == L ? output.ptr<dt_float32>() : layer_dst;
+            const float* h0 = hx.ptr<dt_float32>() + cell * B * H;
+            const float* c0 = lstm ? cx.ptr<dt_float32>() + cell * B * H : nullptr;
+            for (size_t i = 0; i < T; ++i) {
+                size_t step = d ? T - 1 - i : i;
+                //! the states of step i are stored in reserve_space as h, c
+                float* h_new = states + i * S * B * H;
+                float* c_new = h_new + B * H;
+                const float* h_prev = i ? h_new - S * B * H : h0;
+                const float* c_prev = i ? c_new - S * B * H : c0;
+                for (size_t row = begin; row < end; row += ROW_BLOCK) {
+                    size_t nr_rows = std::min(ROW_BLOCK, end - row);
+                    gemm_hh.exec(
+                            h_prev + row * H, H, nr_rows, packed_hh, a_panel, gh, GH);
+                    for (size_t b = row; b < row + nr_rows; ++b) {
+                        const float* x = gin_d + (step * B + b) * GH;
+                        const float* y = gh + (b - row) * GH;
+                        if (lstm) {
+                            LstmRowParam p{x,
+                                           y,
+                                           bias_d,
+                                           nullptr,
+                                           nullptr,
+                                           0,
+                                           c_prev + b * H,
+                                           c_new + b * H,
+                                           h_new + b * H,
+                                           H};
+                            lstm_row(p);
+                        } else {
+                            rnn_row(x, y, bias_d, nullptr, h_new + b * H, H, mode);
+                        }
+                        memcpy(dst + (step * B + b) * D * H + d * H,
+                               h_new + b * H, H * sizeof(float));
+                    }
+                }
+            }
+            size_t len = (end - begin) * H;
+            const float* h_last = T ? states + (T - 1) * S * B * H : h0;
+            memcpy(hy.ptr<dt_float32>() + cell * B * H + begin * H,
+                   h_last + begin * H, len * sizeof(float));
+            if (lstm) {
+                const float* c_last = T ? h_last + B * H : c0;
+                memcpy(cy.ptr<dt_float32>() + cell * B * H + begin * H,
+                       c_last + begin * H, len * sizeof(float));
+            }
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, D * nr_chunks, recurrence);
+        weight_offset += D * cell_size;
+    }
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,107 @@
+#pragma once
+#include "megdnn/oprs.h"
+#include "src/common/utils.h"
+#include "src/fallback/matrix_mul/opr_impl.h"
+#include "src/naive/handle.h"
+
+namespace megdnn {
+namespace fallback {
+namespace rnn {
+
+using NonlineMode = param::RNNCell::NonlineMode;
+
+//! max rows of the A matrix packed at once by PackedGemm
+constexpr size_t ROW_BLOCK = 48;
+
+//! whether all the layouts are contiguous fp32 ones
+bool is_usable(const TensorLayoutArray& layouts);
+
+/*!
+ * \brief C = A * W^T of row-major fp32 matrices, where the (N, K) weight W is
+ * packed once by the matmul algo and reused by every exec
+ *
+ * A has at most ROW_BLOCK rows per exec and is packed into a_panel, which must
+ * hold panel_size() bytes and be private to the calling thread
+ */
+class PackedGemm {
+public:
+    PackedGemm() = default;
+    PackedGemm(size_t N, size_t K);
+
+    size_t weight_size() const;
+    size_t panel_size() const;
+    void pack_weight(const float* weight, void* packed_weight) const;
+    void exec(
+            const float* A, size_t lda, size_t nr_rows, const void* packed_weight,
+            void* a_panel, float* C, size_t ldc) const;
+
+private:
+    MatrixMulImpl::AlgoBase* m_algo = nullptr;
+    MatrixMulImpl::KernSizeParam m_param;
+};
+
+/*!
+ * \brief fused LSTM gates of a single batch row
+ *
+ * x and y hold the preactivations of the gates i, f, g and o, each of
+ * hidden_size elements; y, bias_ih and bias_hh are laid out the same way and
+ * may be nullptr. The sum of them is stored to gates[g * gates_stride] if
+ * gates is not nullptr.
+ */
+struct LstmRowParam {
+    const float* x;
+    const float* y;
+    const float* bias_ih;
+    const float* bias_hh;
+    float* gates;
+    size_t gates_stride;
+    const float* c_prev;
+    float* c_new;
+    float* h_new;
+    size_t hidden_size;
+};
+
+void lstm_row(const LstmRowParam& p);
+
+//! h_new = nonline(x + y + bias_ih + bias_hh), all but x may be nullptr
+void rnn_row(
+        const float* x, const float* y, const float* bias_ih, const float* bias_hh,
+        float* h_new, size_t hidden_size, NonlineMode mode);
+
+/*!
+ * \brief shapes and workspace of a multi-layer RNN / LSTM forward
+ *
+ * For each layer the input projection of all the timesteps is computed by one
+ * GEMM into the workspace, then the batch of every direction is split into
+ * chunks running the whole recurrence independently. Weights of the layer are
+ * packed only once and shared by all the timesteps and chunks.
+ */
+struct SeqPlan {
+    size_t seq_len, batch, input_size, hidden_size, nr_gates, D, num_layers;
+    bool bias;
+    size_t nr_chunks;
+    PackedGemm gemm_ih0, gemm_ih, gemm_hh;
+    size_t packed_ih_size, packed_size, thread_size;
+    WorkspaceBundle bundle{nullptr, {}};
+
+    SeqPlan(const TensorLayout& input, size_t hidden_size, size_t nr_gates, size_t D,
+            size_t num_layers, bool bias, size_t nr_threads);
+};
+
+/*!
+ * \brief run the forward described by plan
+ *
+ * cx and cy are only used by LSTM, i.e. when nr_gates is 4; the states of
+ * every step are written to reserve_space in the layout of the naive impl
+ */
+void exec_seq(
+        naive::HandleImpl* handle, SeqPlan plan, const TensorND& input,
+        const TensorND& flatten_weights, const TensorND& hx, const TensorND& cx,
+        const TensorND& output, const TensorND& hy, const TensorND& cy,
+        const TensorND& reserve_space, void* workspace, NonlineMode mode);
+
+}  // namespace rnn
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,53 @@
+#include "src/fallback/rnn/opr_impl.h"
+#include "src/fallback/rnn/funcs.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+}  // namespace
+
+size_t RNNImpl::get_workspace_in_bytes(
+        const TensorLayout& input, const TensorLayout& hx,
+        const TensorLayout& flatten_weights, const TensorLayout& output,
+        const TensorLayout& hy, const TensorLayout& reserve_space) {
+    if (!rnn::is_usable({input, hx, flatten_weights, output, hy})) {
+        return naive::RNNImpl::get_workspace_in_bytes(
+                input, hx, flatten_weights, output, hy, reserve_space);
+    }
+    rnn::SeqPlan plan(
+            input, param().hidden_size, 1, param().bidirectional ? 2 : 1,
+            param().num_layers, param().bias, get_nr_threads(handle()));
+    return plan.bundle.total_size_in_bytes();
+}
+
+void RNNImpl::exec(
+        _megdnn_tensor_in input, _megdnn_tensor_in hx,
+        _megdnn_tensor_in flatten_weights, _megdnn_tensor_out output,
+        _megdnn_tensor_out hy, _megdnn_tensor_out reserve_space,
+        _megdnn_workspace workspace) {
+    if (!rnn::is_usable(
+                {input.layout, hx.layout, flatten_weights.layout, output.layout,
+                 hy.layout})) {
+        naive::RNNImpl::exec(
+                input, hx, flatten_weights, output, hy, reserve_space, workspace);
+        return;
+    }
+    check_exec(
+            input.layout, hx.layout, flatten_weights.layout, output.layout,
+            hy.layout, reserve_space.layout, workspace.size);
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    rnn::SeqPlan plan(
+            input.layout, param().hidden_size, 1, param().bidirectional ? 2 : 1,
+            param().num_layers, param().bias, get_nr_threads(handle));
+    rnn::exec_seq(
+            handle, plan, input, flatten_weights, hx, {}, output, hy, {},
+            reserve_space, workspace.raw_ptr, param().nonlineMode);
+}
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,50 @@
+#pragma once
+#include "megdnn/basic_types.h"
+#include "megdnn/dtype.h"
+#include "src/fallback/general_intrinsic/gi_int.h"
+
+namespace megdnn {
+namespace fallback {
+namespace select {
+
+//! number of elements selected by one select_step()
+constexpr size_t STEP = GI_SIMD_LEN_BYTE;
+
+//! operand of select_step() read from memory
+struct VecSrc {
+    const int32_t* ptr;
+    GI_INT32_t load(size_t offset) const { return GiLoadInt32(ptr + offset); }
+};
+
+//! operand of select_step() broadcast from a scalar
+struct ScalarSrc {
+    int32_t val;
+    GI_INT32_t load(size_t) const { return GiBroadcastInt32(val); }
+};
+
+/*!
+ * \brief dst[0:STEP] = mask[0:STEP] ? x : y for 4-byte elements
+ *
+ * The mask bytes, which are 0 or 1, are widened to int32 and negated into lane
+ * masks to blend the operands without branches.
+ */
+template <class X, class Y>
+inline void select_step(const dt_bool* mask, const X& x, const Y& y, int32_t* dst) {
+    constexpr size_t width = GI_SIMD_LEN_BYTE / sizeof(int32_t);
+    GI_INT8_t m = GiLoadInt8(mask);
+    GI_INT16_t lo = GiMoveLowLongInt8(m), hi = GiMoveHighLongInt8(m);
+#define cb(_i, _half, _part)                                \
+    GiStoreInt32(                                           \
+            dst + _i * width,                               \
+            GiBlendInt32(                                   \
+                    y.load(_i * width), x.load(_i * width), \
+                    GiNegInt32(GiMove##_part##LongInt16(_half))));
+    cb(0, lo, Low) cb(1, lo, High) cb(2, hi, Low) cb(3, hi, High)
+#undef cb
+}
+
+}  // namespace select
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
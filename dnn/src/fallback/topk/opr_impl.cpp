@@ -0,0 +1,277 @@
+#include "src/fallback/topk/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/general_intrinsic/gi_float.h"
+#include "src/naive/handle.h"
+
+#include <algorithm>
+#include <limits>
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+using Mode = TopK::Param::Mode;
+
+//! heap selection is used when the row is at least this many times longer than k
+constexpr size_t HEAP_RATIO = 8;
+//! minimal number of elements of a row chunk handled by one task
+constexpr size_t MIN_CHUNK_LEN = 4096;
+
+template <typename ctype>
+using Item = std::pair<ctype, uint32_t>;
+
+//! the selection items of the supported dtypes share the same size
+constexpr size_t ITEM_SIZE = sizeof(Item<dt_float32>);
+static_assert(ITEM_SIZE == sizeof(Item<dt_int32>), "bad item size");
+
+/*!
+ * \brief comparators ordering the kept items before the dropped ones
+ *
+ * ties are broken by index in the same way as naive::TopKImpl, so the heap top
+ * can be compared against a later element by value only
+ */
+template <typename ctype>
+struct Smallest {
+    bool operator()(const Item<ctype>& a, const Item<ctype>& b) const { return a < b; }
+    static bool beats(ctype x, ctype top) { return x < top; }
+};
+
+template <typename ctype>
+struct Largest {
+    bool operator()(const Item<ctype>& a, const Item<ctype>& b) const { return a > b; }
+    static bool beats(ctype x, ctype top) { return x >= top; }
+};
+
+/*!
+ * \brief skip the leading blocks of a row that can not enter the heap
+ *
+ * the generic version does not skip; the fp32 one checks the extreme value of
+ * two vectors at a time
+ */
+template <typename ctype, class Cmp>
+struct BlockFilter {
+    static constexpr size_t block = 64;
+    static size_t skip(const ctype*, size_t, ctype) { return 0; }
+};
+
+template <class Cmp>
+struct BlockFilter<dt_float32, Cmp> {
+    static constexpr size_t width = GI_SIMD_LEN_BYTE / sizeof(float);
+    static constexpr size_t block = width * 2;
+    static float extreme(const float* ptr, Smallest<dt_float32>*) {
+        return GiReduceMinNanFloat32(GiMinimumFloat32(
+                GiLoadFloat32(ptr), GiLoadFloat32(ptr + width)));
+    }
+    static float extreme(const float* ptr, Largest<dt_float32>*) {
+        return GiReduceMaxNanFloat32(GiMaximumFloat32(
+                GiLoadFloat32(ptr), GiLoadFloat32(ptr + width)));
+    }
+    static size_t skip(const float* ptr, size_t len, float top) {
+        size_t i = 0;
+        for (; i + block <= len; i += block) {
+            if (Cmp::beats(extreme(ptr + i, static_cast<Cmp*>(nullptr)), top)) {
+                break;
+            }
+        }
+        return i;
+    }
+};
+
+template <typename ctype, class Cmp>
+void replace_top(Item<ctype>* heap, size_t K, const Item<ctype>& item) {
+    Cmp cmp;
+    size_t i = 0;
+    for (;;) {
+        size_t c = i * 2 + 1;
+        if (c >= K) {
+            break;
+        }
+        if (c + 1 < K && cmp(heap[c], heap[c + 1])) {
+            ++c;
+        }
+        if (!cmp(item, heap[c])) {
+            break;
+        }
+        heap[i] = heap[c];
+        i = c;
+    }
+    heap[i] = item;
+}
+
+//! select the best K elements of row[begin:end] into heap, whose top is the worst
+template <typename ctype, class Cmp>
+void heap_select(
+        const ctype* row, size_t begin, size_t end, size_t K, Item<ctype>* heap) {
+    using Filter = BlockFilter<ctype, Cmp>;
+    for (size_t j = 0; j < K; ++j) {
+        heap[j] = {row[begin + j], static_cast<uint32_t>(begin + j)};
+    }
+    std::make_heap(heap, heap + K, Cmp{});
+    ctype top = heap[0].first;
+    for (size_t j = begin + K; j < end;) {
+        j += Filter::skip(row + j, end - j, top);
+        for (size_t stop = std::min(j + Filter::block, end); j < stop; ++j) {
+            if (Cmp::beats(row[j], top)) {
+                replace_top<ctype, Cmp>(heap, K, {row[j], static_cast<uint32_t>(j)});
+                top = heap[0].first;
+            }
+        }
+    }
+}
+
+//! merge heaps of the following chunks into the first one
+template <typename ctype, class Cmp>
+void heap_merge(Item<ctype>* heap, size_t K, size_t nr_chunks) {
+    Cmp cmp;
+    for (size_t i = K; i < K * nr_chunks; ++i) {
+        if (cmp(heap[i], heap[0])) {
+            replace_top<ctype, Cmp>(heap, K, heap[i]);
+        }
+    }
+}
+
+template <typename ctype, class Cmp>
+void heap_emit(
+        Mode mode, Item<ctype>* heap, size_t K, size_t row, ctype* values,
+        int* indices) {
+    if (mode == Mode::KTH_ONLY) {
+        values[row] = heap[0].first;
+        return;
+    }
+    if (mode == Mode::VALUE_IDX_SORTED) {
+        std::sort_heap(heap, heap + K, Cmp{});
+    }
+    for (size_t j = 0; j < K; ++j) {
+        values[row * K + j] = heap[j].first;
+        indices[row * K + j] = heap[j].second;
+    }
+}
+
+void split(size_t n, size_t nr_parts, size_t part, size_t& begin, size_t& end) {
+    size_t q = n / nr_parts, r = n % nr_parts;
+    begin = part * q + std::min(part, r);
+    end = begin + q + (part < r);
+}
+
+struct TopKPlan {
+    size_t K;          //!< number of selected elements per row
+    size_t nr_chunks;  //!< number of chunks each row is split into
+    size_t nr_parts;   //!< number of tasks of the selection pass
+    size_t workspace;  //!< number of heap items in workspace
+};
+
+bool make_plan(
+        Handle* handle, DType dtype, int k, size_t m, size_t n, TopKPlan& plan) {
+    if (dtype != dtype::Float32() && dtype != dtype::Int32()) {
+        return false;
+    }
+    size_t K = std::min<size_t>(std::abs(k), n);
+    if (K * HEAP_RATIO > n || n > std::numeric_limits<uint32_t>::max()) {
+        return false;
+    }
+    size_t nr_threads =
+            static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+    plan.K = K;
+    plan.nr_chunks = 1;
+    if (m < nr_threads) {
+        plan.nr_chunks = std::max<size_t>(
+                1, std::min({(nr_threads + m - 1) / m, n / (K * HEAP_RATIO),
+                             n / MIN_CHUNK_LEN}));
+    }
+    plan.nr_parts = std::min(m * plan.nr_chunks, nr_threads);
+    // chunk heaps are kept for the merge pass, otherwise each task reuses its own
+    plan.workspace = K * (plan.nr_chunks > 1 ? m * plan.nr_chunks : plan.nr_parts);
+    return true;
+}
+
+template <typename ctype, class Cmp>
+void exec_heap(
+        naive::HandleImpl* handle, Mode mode, const TopKPlan& plan, size_t m, size_t n,
+        ptrdiff_t lda, const ctype* data, ctype* values, int* indices,
+        Item<ctype>* workspace) {
+    size_t K = plan.K, nr_chunks = plan.nr_chunks, nr_parts = plan.nr_parts;
+    if (nr_chunks == 1) {
+        auto run = [=](size_t part, size_t) {
+            size_t begin, end;
+            split(m, nr_parts, part, begin, end);
+            Item<ctype>* heap = workspace + part * K;
+            for (size_t i = begin; i < end; ++i) {
+                heap_select<ctype, Cmp>(data + i * lda, 0, n, K, heap);
+                heap_emit<ctype, Cmp>(mode, heap, K, i, values, indices);
+            }
+        };
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, run);
+        return;
+    }
+
+    auto select = [=](size_t part, size_t) {
+        size_t begin, end;
+        split(m * nr_chunks, nr_parts, part, begin, end);
+        for (size_t t = begin; t < end; ++t) {
+            size_t row = t / nr_chunks, chunk_begin, chunk_end;
+            split(n, nr_chunks, t % nr_chunks, chunk_begin, chunk_end);
+            heap_select<ctype, Cmp>(
+                    data + row * lda, chunk_begin, chunk_end, K, workspace + t * K);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, select);
+
+    size_t nr_merge_parts = std::min(m, nr_parts);
+    auto merge = [=](size_t part, size_t) {
+        size_t begin, end;
+        split(m, nr_merge_parts, part, begin, end);
+        for (size_t i = begin; i < end; ++i) {
+            Item<ctype>* heap = workspace + i * nr_chunks * K;
+            heap_merge<ctype, Cmp>(heap, K, nr_chunks);
+            heap_emit<ctype, Cmp>(mode, heap, K, i, values, indices);
+        }
+    };
+    MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_merge_parts, merge);
+}
+
+}  // namespace
+
+void TopKImpl::do_exec(
+        int k, _megdnn_tensor_in data, _megdnn_tensor_out values, int32_t* indices,
+        _megdnn_workspace workspace) {
+    size_t m = data.layout[0], n = data.layout[1];
+    TopKPlan plan;
+    if (!make_plan(handle(), data.layout.dtype, k, m, n, plan)) {
+        naive::TopKImpl::do_exec(k, data, values, indices, workspace);
+        return;
+    }
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    ptrdiff_t lda = data.layout.stride[0];
+#define cb(DType)                                                          \
+    if (data.layout.dtype == DType()) {                                    \
+        using ct = DTypeTrait<DType>::ctype;                               \
+        auto wptr = reinterpret_cast<Item<ct>*>(workspace.raw_ptr);        \
+        if (k > 0) {                                                       \
+            exec_heap<ct, Smallest<ct>>(                                   \
+                    handle, param().mode, plan, m, n, lda, data.ptr<ct>(), \
+                    values.ptr<ct>(), indices, wptr);                      \
+        } else {                                                           \
+            exec_heap<ct, Largest<ct>>(                                    \
+                    handle, param().mode, plan, m, n, lda, data.ptr<ct>(), \
+                    values.ptr<ct>(), indices, wptr);                      \
+        }                                                                  \
+        return;                                                            \
+    }
+    cb(dtype::Float32);
+    cb(dtype::Int32);
+#undef cb
+    megdnn_throw("unsupported dtype in fallback TopKImpl");
+}
+
+size_t TopKImpl::get_workspace_in_bytes(
+        int k, const TensorLayout& data, const TensorLayout& values,
+        const TensorLayout& indices) {
+    TopKPlan plan;
+    if (!make_plan(handle(), data.dtype, k, data[0], data[1], plan)) {
+        return naive::TopKImpl::get_workspace_in_bytes(k, data, values, indices);
+    }
+    return plan.workspace * ITEM_SIZE;
+}
+
+// vim: syntax=cpp.doxygen
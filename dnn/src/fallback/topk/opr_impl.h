@@ -0,0 +1,32 @@
+#pragma once
+
+#include "src/naive/topk/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief TopK for fp32 and int32 by bounded heap selection
+ *
+ * rows are distributed over the cpu dispatcher; when there are fewer rows than
+ * threads, long rows are split into chunks whose candidates are merged in a
+ * second pass. Large k and the other dtypes use the naive implementation.
+ */
+class TopKImpl : public naive::TopKImpl {
+protected:
+    void do_exec(
+            int k, _megdnn_tensor_in data, _megdnn_tensor_out values, int32_t* indices,
+            _megdnn_workspace workspace) override;
+
+public:
+    using naive::TopKImpl::TopKImpl;
+
+    size_t get_workspace_in_bytes(
+            int k, const TensorLayout& data, const TensorLayout& values,
+            const TensorLayout& indices) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,67 @@
+#include "src/fallback/where/opr_impl.h"
+#include "src/common/utils.h"
+#include "src/fallback/compact_helper.h"
+#include "src/fallback/select_helper.h"
+#include "src/naive/handle.h"
+
+using namespace megdnn;
+using namespace fallback;
+
+namespace {
+
+size_t get_nr_threads(Handle* handle) {
+    return static_cast<naive::HandleImpl*>(handle)->megcore_dispatcher()->nr_threads();
+}
+
+template <typename ctype>
+void where_part(
+        const dt_bool* mask, const ctype* data1, const ctype* data2, ctype* dst,
+        size_t begin, size_t end) {
+    size_t i = begin;
+    if (sizeof(ctype) == sizeof(int32_t)) {
+        auto x = reinterpret_cast<const int32_t*>(data1),
+             y = reinterpret_cast<const int32_t*>(data2);
+        auto z = reinterpret_cast<int32_t*>(dst);
+        for (; i + select::STEP <= end; i += select::STEP) {
+            select::select_step(
+                    mask + i, select::VecSrc{x + i}, select::VecSrc{y + i}, z + i);
+        }
+    }
+    for (; i < end; ++i) {
+        dst[i] = mask[i] ? data1[i] : data2[i];
+    }
+}
+
+}  // anonymous namespace
+
+void WhereForwardImpl::exec(
+        _megdnn_tensor_in mask, _megdnn_tensor_in data1, _megdnn_tensor_in data2,
+        _megdnn_tensor_out dst, _megdnn_workspace workspace) {
+    check_exec(mask.layout, data1.layout, data2.layout, dst.layout, workspace.size);
+    size_t n = data1.layout.total_nr_elems();
+    if (!n) {
+        return;
+    }
+    auto handle = static_cast<naive::HandleImpl*>(this->handle());
+    size_t nr_parts = compact::nr_parts(n, get_nr_threads(handle));
+#define cb(DType)                                                            \
+    if (data1.layout.dtype == DType()) {                                     \
+        using ctype = typename DTypeTrait<DType>::ctype;                     \
+        auto mask_ptr = mask.ptr<dt_bool>();                                 \
+        auto data1_ptr = data1.ptr<ctype>(), data2_ptr = data2.ptr<ctype>(); \
+        auto dst_ptr = dst.ptr<ctype>();                                     \
+        auto kern = [=](size_t part, size_t) {                               \
+            size_t begin, end;                                               \
+            compact::split(n, nr_parts, part, begin, end);                   \
+            where_part(mask_ptr, data1_ptr, data2_ptr, dst_ptr, begin, end); \
+        };                                                                   \
+        MEGDNN_DISPATCH_MULTI_THREAD_CPU_KERN(handle, nr_parts, kern);       \
+        return;                                                              \
+    }
+    MEGDNN_FOREACH_COMPUTING_DTYPE(cb)
+    cb(::megdnn::dtype::Bool)
+#undef cb
+    megdnn_assert_internal(0);
+}
+
+// vim: syntax=cpp.doxygen
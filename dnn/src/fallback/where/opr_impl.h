@@ -0,0 +1,25 @@
+#pragma once
+
+#include "src/naive/where/opr_impl.h"
+
+namespace megdnn {
+namespace fallback {
+
+/*!
+ * \brief WhereForward by branchless selection in parallel
+ *
+ * 4-byte dtypes are blended in vector registers with lane masks widened from
+ * the mask bytes; the other dtypes use a scalar select loop.
+ */
+class WhereForwardImpl : public naive::WhereForwardImpl {
+public:
+    using naive::WhereForwardImpl::WhereForwardImpl;
+    void exec(
+            _megdnn_tensor_in mask, _megdnn_tensor_in data1, _megdnn_tensor_in data2,
+            _megdnn_tensor_out dst, _megdnn_workspace workspace) override;
+};
+
+}  // namespace fallback
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
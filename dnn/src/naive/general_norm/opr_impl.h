@@ -4,7 +4,7 @@
 namespace megdnn {
 namespace naive {
 
-class GeneralNormForwardImpl final : public GeneralNormForward {
+class GeneralNormForwardImpl : public GeneralNormForward {
 public:
     using GeneralNormForward::GeneralNormForward;
     void exec(
@@ -18,7 +18,7 @@ public:
     }
 };
 
-class GeneralNormBackwardImpl final : public GeneralNormBackward {
+class GeneralNormBackwardImpl : public GeneralNormBackward {
 public:
     using GeneralNormBackward::GeneralNormBackward;
     void exec(
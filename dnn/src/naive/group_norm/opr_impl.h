@@ -5,7 +5,7 @@
 namespace megdnn {
 namespace naive {
 
-class GroupNormForwardImpl final : public GroupNormForward {
+class GroupNormForwardImpl : public GroupNormForward {
 public:
     using GroupNormForward::GroupNormForward;
     void exec(
@@ -19,7 +19,7 @@ public:
     }
 };
 
-class GroupNormBackwardImpl final : public GroupNormBackward {
+class GroupNormBackwardImpl : public GroupNormBackward {
 public:
     using GroupNormBackward::GroupNormBackward;
     void exec(
@@ -5,7 +5,7 @@
 namespace megdnn {
 namespace naive {
 
-class IndexingOneHotForwardImpl final : public IndexingOneHotForward {
+class IndexingOneHotForwardImpl : public IndexingOneHotForward {
 public:
     using IndexingOneHotForward::IndexingOneHotForward;
     void exec(
@@ -17,7 +17,7 @@ public:
     }
 };
 
-class IndexingSetOneHotForwardImpl final : public IndexingSetOneHotForward {
+class IndexingSetOneHotForwardImpl : public IndexingSetOneHotForward {
 public:
     using IndexingSetOneHotForward::IndexingSetOneHotForward;
     void exec(
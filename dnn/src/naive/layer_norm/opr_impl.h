@@ -4,7 +4,7 @@
 namespace megdnn {
 namespace naive {
 
-class LayerNormForwardImpl final : public LayerNormForward {
+class LayerNormForwardImpl : public LayerNormForward {
 public:
     using LayerNormForward::LayerNormForward;
     void exec(
@@ -18,7 +18,7 @@ public:
     }
 };
 
-class LayerNormBackwardImpl final : public LayerNormBackward {
+class LayerNormBackwardImpl : public LayerNormBackward {
 public:
     using LayerNormBackward::LayerNormBackward;
     void exec(
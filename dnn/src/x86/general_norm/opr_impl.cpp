@@ -0,0 +1,20 @@
+#include "src/x86/general_norm/opr_impl.h"
+#include "src/x86/norm_helper.h"
+
+namespace megdnn {
+namespace x86 {
+
+GeneralNormForwardImpl::GeneralNormForwardImpl(Handle* handle)
+        : fallback::GeneralNormForwardImpl(handle) {
+    m_kern = get_best_norm_kern();
+}
+
+GeneralNormBackwardImpl::GeneralNormBackwardImpl(Handle* handle)
+        : fallback::GeneralNormBackwardImpl(handle) {
+    m_kern = get_best_norm_kern();
+}
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,20 @@
+#pragma once
+#include "src/fallback/general_norm/opr_impl.h"
+
+namespace megdnn {
+namespace x86 {
+
+class GeneralNormForwardImpl : public fallback::GeneralNormForwardImpl {
+public:
+    GeneralNormForwardImpl(Handle* handle);
+};
+
+class GeneralNormBackwardImpl : public fallback::GeneralNormBackwardImpl {
+public:
+    GeneralNormBackwardImpl(Handle* handle);
+};
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
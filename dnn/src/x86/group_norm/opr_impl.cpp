@@ -0,0 +1,20 @@
+#include "src/x86/group_norm/opr_impl.h"
+#include "src/x86/norm_helper.h"
+
+namespace megdnn {
+namespace x86 {
+
+GroupNormForwardImpl::GroupNormForwardImpl(Handle* handle)
+        : fallback::GroupNormForwardImpl(handle) {
+    m_kern = get_best_norm_kern();
+}
+
+GroupNormBackwardImpl::GroupNormBackwardImpl(Handle* handle)
+        : fallback::GroupNormBackwardImpl(handle) {
+    m_kern = get_best_norm_kern();
+}
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
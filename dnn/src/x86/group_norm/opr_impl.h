@@ -0,0 +1,20 @@
+#pragma once
+#include "src/fallback/group_norm/opr_impl.h"
+
+namespace megdnn {
+namespace x86 {
+
+class GroupNormForwardImpl : public fallback::GroupNormForwardImpl {
+public:
+    GroupNormForwardImpl(Handle* handle);
+};
+
+class GroupNormBackwardImpl : public fallback::GroupNormBackwardImpl {
+public:
+    GroupNormBackwardImpl(Handle* handle);
+};
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -9,9 +9,13 @@
 #include "src/x86/elemwise/opr_impl.h"
 #include "src/x86/elemwise_multi_type/opr_impl.h"
 #include "src/x86/gaussian_blur/opr_impl.h"
+#include "src/x86/general_norm/opr_impl.h"
+#include "src/x86/group_norm/opr_impl.h"
+#include "src/x86/layer_norm/opr_impl.h"
 #include "src/x86/local/opr_impl.h"
 #include "src/x86/lrn/opr_impl.h"
 #include "src/x86/matrix_mul/opr_impl.h"
+#include "src/x86/multi_head_attn/opr_impl.h"
 #include "src/x86/pooling/opr_impl.h"
 #include "src/x86/resize/opr_impl.h"
 #include "src/x86/separable_conv/opr_impl.h"
@@ -76,6 +80,14 @@ MEGDNN_SPECIALIZE_CREATE_OPERATOR(WarpPerspective)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(AddUpdate)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(TypeCvt)
 MEGDNN_SPECIALIZE_CREATE_OPERATOR(ConvBias)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(MultiHeadAttnForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(MultiHeadAttnBackward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(LayerNormForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(LayerNormBackward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GroupNormForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GroupNormBackward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GeneralNormForward)
+MEGDNN_SPECIALIZE_CREATE_OPERATOR(GeneralNormBackward)
 
 #pragma GCC diagnostic push
 #pragma GCC diagnostic ignored "-Wpragmas"
@@ -0,0 +1,20 @@
+#include "src/x86/layer_norm/opr_impl.h"
+#include "src/x86/norm_helper.h"
+
+namespace megdnn {
+namespace x86 {
+
+LayerNormForwardImpl::LayerNormForwardImpl(Handle* handle)
+        : fallback::LayerNormForwardImpl(handle) {
+    m_kern = get_best_norm_kern();
+}
+
+LayerNormBackwardImpl::LayerNormBackwardImpl(Handle* handle)
+        : fallback::LayerNormBackwardImpl(handle) {
+    m_kern = get_best_norm_kern();
+}
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
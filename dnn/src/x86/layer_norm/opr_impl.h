@@ -0,0 +1,20 @@
+#pragma once
+#include "src/fallback/layer_norm/opr_impl.h"
+
+namespace megdnn {
+namespace x86 {
+
+class LayerNormForwardImpl : public fallback::LayerNormForwardImpl {
+public:
+    LayerNormForwardImpl(Handle* handle);
+};
+
+class LayerNormBackwardImpl : public fallback::LayerNormBackwardImpl {
+public:
+    LayerNormBackwardImpl(Handle* handle);
+};
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
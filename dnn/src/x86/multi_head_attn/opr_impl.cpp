@@ -0,0 +1,44 @@
+#include "src/x86/multi_head_attn/opr_impl.h"
+#include "src/fallback/multi_head_attn/attn_kern.h"
+#include "src/x86/simd_helper.h"
+#include "src/x86/utils.h"
+
+namespace megdnn {
+namespace fallback {
+
+template MEGDNN_ATTRIBUTE_TARGET("fma") void attn_fwd<
+        x86::simd_traits<x86::SIMDType::FMA>>(const AttnFwdParam&);
+template MEGDNN_ATTRIBUTE_TARGET("avx") void attn_fwd<
+        x86::simd_traits<x86::SIMDType::AVX>>(const AttnFwdParam&);
+template MEGDNN_ATTRIBUTE_TARGET("fma") void attn_bwd<
+        x86::simd_traits<x86::SIMDType::FMA>>(const AttnBwdParam&);
+template MEGDNN_ATTRIBUTE_TARGET("avx") void attn_bwd<
+        x86::simd_traits<x86::SIMDType::AVX>>(const AttnBwdParam&);
+
+}  // namespace fallback
+
+namespace x86 {
+
+MultiHeadAttnForwardImpl::MultiHeadAttnForwardImpl(Handle* handle)
+        : fallback::MultiHeadAttnForwardImpl(handle) {
+    // the general intrinsic kernel set by fallback is used without avx
+    if (is_supported(SIMDType::FMA)) {
+        proxy_opr.kern = &fallback::attn_fwd<simd_traits<SIMDType::FMA>>;
+    } else if (is_supported(SIMDType::AVX)) {
+        proxy_opr.kern = &fallback::attn_fwd<simd_traits<SIMDType::AVX>>;
+    }
+}
+
+MultiHeadAttnBackwardImpl::MultiHeadAttnBackwardImpl(Handle* handle)
+        : fallback::MultiHeadAttnBackwardImpl(handle) {
+    if (is_supported(SIMDType::FMA)) {
+        proxy_opr.kern = &fallback::attn_bwd<simd_traits<SIMDType::FMA>>;
+    } else if (is_supported(SIMDType::AVX)) {
+        proxy_opr.kern = &fallback::attn_bwd<simd_traits<SIMDType::AVX>>;
+    }
+}
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,20 @@
+#pragma once
+#include "src/fallback/multi_head_attn/opr_impl.h"
+
+namespace megdnn {
+namespace x86 {
+
+class MultiHeadAttnForwardImpl : public fallback::MultiHeadAttnForwardImpl {
+public:
+    MultiHeadAttnForwardImpl(Handle* handle);
+};
+
+class MultiHeadAttnBackwardImpl : public fallback::MultiHeadAttnBackwardImpl {
+public:
+    MultiHeadAttnBackwardImpl(Handle* handle);
+};
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
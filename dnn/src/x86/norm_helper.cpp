@@ -0,0 +1,43 @@
+#include "src/x86/norm_helper.h"
+#include "src/fallback/gi_simd_traits.h"
+#include "src/x86/simd_helper.h"
+#include "src/x86/utils.h"
+
+namespace megdnn {
+namespace fallback {
+
+#define INST(_simd, _target)                                                      \
+    template MEGDNN_ATTRIBUTE_TARGET(_target) void norm_fwd_rows<                 \
+            x86::simd_traits<x86::SIMDType::_simd>>(const NormParam&);            \
+    template MEGDNN_ATTRIBUTE_TARGET(_target) void norm_fwd_group<                \
+            x86::simd_traits<x86::SIMDType::_simd>>(const NormParam&);            \
+    template MEGDNN_ATTRIBUTE_TARGET(_target) void norm_fwd_cols<                 \
+            x86::simd_traits<x86::SIMDType::_simd>>(const NormParam&);            \
+    template MEGDNN_ATTRIBUTE_TARGET(_target) void norm_bwd_rows<                 \
+            x86::simd_traits<x86::SIMDType::_simd>>(const NormParam&);            \
+    template MEGDNN_ATTRIBUTE_TARGET(_target) void norm_bwd_group<                \
+            x86::simd_traits<x86::SIMDType::_simd>>(const NormParam&);            \
+    template MEGDNN_ATTRIBUTE_TARGET(_target) void norm_bwd_cols<                 \
+            x86::simd_traits<x86::SIMDType::_simd>>(const NormParam&);
+INST(FMA, "fma")
+INST(AVX, "avx")
+#undef INST
+
+}  // namespace fallback
+
+namespace x86 {
+
+fallback::NormKern get_best_norm_kern() {
+    if (is_supported(SIMDType::FMA)) {
+        return fallback::get_norm_kern<simd_traits<SIMDType::FMA>>();
+    }
+    if (is_supported(SIMDType::AVX)) {
+        return fallback::get_norm_kern<simd_traits<SIMDType::AVX>>();
+    }
+    return fallback::get_norm_kern<fallback::GiSimdTraits>();
+}
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
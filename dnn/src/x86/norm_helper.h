@@ -0,0 +1,14 @@
+#pragma once
+#include "src/fallback/norm_helper.h"
+
+namespace megdnn {
+namespace x86 {
+
+//! the norm kernels of the best simd type supported by the cpu, or the
+//! general intrinsic ones without avx
+fallback::NormKern get_best_norm_kern();
+
+}  // namespace x86
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
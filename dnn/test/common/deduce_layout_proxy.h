@@ -147,6 +147,22 @@ struct DeduceLayoutProxy<Opr, 13, false> {
     static void deduce_layout(Opr*, TensorLayoutArray&) {}
 };
 
+template <typename Opr>
+struct DeduceLayoutProxy<Opr, 15, true> {
+    static void deduce_layout(Opr* opr, TensorLayoutArray& layouts) {
+        megdnn_assert(layouts.size() == 15);
+        opr->deduce_layout(
+                layouts[0], layouts[1], layouts[2], layouts[3], layouts[4], layouts[5],
+                layouts[6], layouts[7], layouts[8], layouts[9], layouts[10],
+                layouts[11], layouts[12], layouts[13], layouts[14]);
+    }
+};
+
+template <typename Opr>
+struct DeduceLayoutProxy<Opr, 15, false> {
+    static void deduce_layout(Opr*, TensorLayoutArray&) {}
+};
+
 }  // namespace test
 }  // namespace megdnn
 
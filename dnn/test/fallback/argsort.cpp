@@ -0,0 +1,70 @@
+#include "test/fallback/fixture.h"
+
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+void run_argsort_forward(Handle* handle) {
+    using Order = Argsort::Param::Order;
+    Checker<ArgsortForward> checker(handle);
+    UniformFloatRNG float_rng{-100.f, 100.f};
+    // narrow range so that equal keys check tie breaking
+    UniformIntRNG int_rng{-20, 20};
+    checker.set_dtype(2, dtype::Int32());
+    for (auto order : {Order::ASCENDING, Order::DESCENDING}) {
+        Argsort::Param param;
+        param.order = order;
+        checker.set_param(param);
+        for (size_t n : {1, 7, 63, 64, 100, 1023, 20000})
+            for (size_t m : {1, 3, 17}) {
+                checker.set_dtype(0, dtype::Float32())
+                        .set_rng(0, &float_rng)
+                        .execs({{m, n}, {}, {}});
+                checker.set_dtype(0, dtype::Int32())
+                        .set_rng(0, &int_rng)
+                        .execs({{m, n}, {}, {}});
+            }
+    }
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, ARGSORT_FORWARD) {
+    run_argsort_forward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, ARGSORT_FORWARD) {
+    run_argsort_forward(handle());
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_ARGSORT_FORWARD) {
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<ArgsortForward> benchmarker_naive(handle_naive.get());
+    Benchmarker<ArgsortForward> benchmarker_fallback(handle());
+    constexpr size_t RUN = 10;
+    auto run = [&](size_t m, size_t n) {
+        TensorShapeArray shapes{{m, n}, {}, {}};
+        auto t0 = benchmarker_naive.set_display(false).set_times(RUN).execs(shapes) /
+                  RUN;
+        auto t1 =
+                benchmarker_fallback.set_display(false).set_times(RUN).execs(shapes) /
+                RUN;
+        printf("m=%zu n=%zu: naive=%.3fms fallback=%.3fms speedup=%.2f\n", m, n, t0,
+               t1, t0 / t1);
+    };
+    run(4096, 32);
+    run(1024, 1024);
+    run(64, 65536);
+    run(1, 1000000);
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,116 @@
+#include "test/common/cond_take.h"
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+#include "test/common/rng.h"
+#include "test/common/tensor.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+using Param = CondTake::Param;
+
+void run_cond_take_test(Handle* handle) {
+    auto handle_naive = create_cpu_handle(2);
+    auto opr_naive = handle_naive->create_operator<CondTake>();
+    auto opr = handle->create_operator<CondTake>();
+    size_t tot_size = 0;
+    for (auto&& i : CondTakeTestcase::make()) {
+        auto ret_naive = i.run(opr_naive.get()), ret = i.run(opr.get());
+        MEGDNN_ASSERT_TENSOR_EQ(*ret_naive.first, *ret.first);
+        MEGDNN_ASSERT_TENSOR_EQ(*ret_naive.second, *ret.second);
+        tot_size += ret_naive.first->layout.total_nr_elems();
+    }
+    ASSERT_GT(tot_size, (size_t)0);
+}
+
+//! run cond_take on host tensors and return (data, idx)
+std::pair<std::vector<float>, std::vector<int>> exec_cond_take(
+        Handle* handle, const Param& param, const TensorND& data,
+        const TensorND& mask) {
+    auto opr = handle->create_operator<CondTake>();
+    opr->param() = param;
+    DynOutMallocPolicyImpl malloc_policy(handle);
+    auto workspace_size = opr->get_workspace_in_bytes(data.layout, mask.layout);
+    auto workspace_ptr = malloc_policy.alloc_workspace(workspace_size, nullptr);
+    auto result = opr->exec(
+            data, mask, {(dt_byte*)workspace_ptr, workspace_size}, &malloc_policy);
+    malloc_policy.free_workspace(workspace_ptr, nullptr);
+    megcore_check(megcoreSynchronize(handle->megcore_computing_handle()));
+    auto holder0 = malloc_policy.make_output_refholder(result[0]),
+         holder1 = malloc_policy.make_output_refholder(result[1]);
+    size_t n = result[0].layout.total_nr_elems();
+    auto pdata = result[0].ptr<dt_float32>();
+    auto pidx = result[1].ptr<dt_int32>();
+    return {{pdata, pdata + n}, {pidx, pidx + n}};
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, COND_TAKE) {
+    run_cond_take_test(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, COND_TAKE) {
+    run_cond_take_test(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, COND_TAKE_LARGE) {
+    // large inputs are compacted by several threads
+    auto handle_naive = create_cpu_handle(2);
+    size_t n = 300007;
+    TensorLayout layout{{n}, dtype::Float32()};
+    std::vector<float> data_storage(n), mask_storage(n);
+    TensorND data{data_storage.data(), layout}, mask{mask_storage.data(), layout};
+    UniformFloatRNG data_rng{-1, 1};
+    UniformIntRNG mask_rng{-2, 2};
+    data_rng.gen(data);
+    mask_rng.gen(mask);
+    for (uint32_t mode = 0; mode < Param::MODE_NR_MEMBER; ++mode) {
+        Param param{static_cast<Param::Mode>(mode), 1.f, 0.1f};
+        auto expect = exec_cond_take(handle_naive.get(), param, data, mask);
+        auto get = exec_cond_take(handle(), param, data, mask);
+        ASSERT_EQ(expect.first, get.first);
+        ASSERT_EQ(expect.second, get.second);
+    }
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_COND_TAKE) {
+    auto handle_naive = create_cpu_handle(2);
+    auto run = [&](size_t n, float ratio) {
+        TensorLayout layout{{n}, dtype::Float32()};
+        std::vector<float> data_storage(n), mask_storage(n);
+        TensorND data{data_storage.data(), layout}, mask{mask_storage.data(), layout};
+        UniformFloatRNG rng{0, 1};
+        rng.gen(data);
+        rng.gen(mask);
+        Param param{Param::Mode::LT, ratio};
+        auto bench = [&](Handle* handle) {
+            constexpr size_t RUN = 10;
+            exec_cond_take(handle, param, data, mask);
+            test::Timer timer;
+            timer.start();
+            for (size_t i = 0; i < RUN; ++i) {
+                exec_cond_take(handle, param, data, mask);
+            }
+            timer.stop();
+            return timer.get_time_in_us() / 1e3 / RUN;
+        };
+        auto t0 = bench(handle_naive.get()), t1 = bench(handle());
+        printf("n=%zu ratio=%.2f: naive=%.3fms fallback=%.3fms speedup=%.2f\n", n,
+               ratio, t0, t1, t0 / t1);
+    };
+    for (float ratio : {0.01f, 0.5f, 0.99f}) {
+        run(1000000, ratio);
+        run(10000000, ratio);
+    }
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
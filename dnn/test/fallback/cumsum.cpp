@@ -0,0 +1,72 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_cumsum_test(Handle* handle, const TensorShapeArray& shapes) {
+    Checker<Cumsum> checker(handle);
+    // integer values keep the float sums exact in any order of addition
+    UniformIntRNG rng{-5, 5};
+    checker.set_rng(0, &rng);
+    for (auto dtype :
+         std::vector<DType>{dtype::Float32(), dtype::Int32(), dtype::Int16()})
+        for (auto&& shape : shapes)
+            for (size_t axis = 0; axis < shape.ndim; ++axis)
+                for (bool exclusive : {false, true})
+                    for (bool reverse : {false, true}) {
+                        checker.set_param(param::Cumsum(axis, exclusive, reverse))
+                                .set_dtype(0, dtype)
+                                .execs({shape, {}});
+                    }
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, CUMSUM) {
+    run_cumsum_test(
+            handle(), {{1}, {3}, {4}, {1000}, {33, 33}, {3, 1000, 5}, {7, 300, 1}});
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, CUMSUM) {
+    run_cumsum_test(
+            handle(), {{1}, {3}, {1000}, {33, 33}, {3, 1000, 5}, {2, 3, 600}});
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, CUMSUM_LONG_ROW) {
+    // few long rows are split into chunks scanned in two passes
+    run_cumsum_test(handle(), {{100003}, {1, 50001}});
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_CUMSUM) {
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<Cumsum> benchmarker_naive(handle_naive.get());
+    Benchmarker<Cumsum> benchmarker_fallback(handle());
+    constexpr size_t RUN = 10;
+    auto run = [&](const TensorShape& shape, size_t axis) {
+        auto bench = [&](Benchmarker<Cumsum>& benchmarker) {
+            return benchmarker.set_display(false)
+                           .set_times(RUN)
+                           .set_param(param::Cumsum(axis, false, false))
+                           .execs({shape, {}}) /
+                   RUN;
+        };
+        auto t0 = bench(benchmarker_naive), t1 = bench(benchmarker_fallback);
+        printf("shape=%s axis=%zu: naive=%.3fms fallback=%.3fms speedup=%.2f\n",
+               shape.to_string().c_str(), axis, t0, t1, t0 / t1);
+    };
+    run({1000000}, 0);
+    run({1000, 1000}, 0);
+    run({1000, 1000}, 1);
+    run({64, 256, 64}, 1);
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,117 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs/nn.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+//! the normalized axes [start, end) of shape and the shape of the affine params
+TensorShape get_weight_shape(const TensorShape& shape, size_t start, size_t end) {
+    TensorShape weight;
+    weight.ndim = end - start;
+    for (size_t i = start; i < end; ++i) {
+        weight[i - start] = shape[i];
+    }
+    return weight;
+}
+
+void run_general_norm_forward(Handle* handle) {
+    using Param = GeneralNormForward::Param;
+    Checker<GeneralNormForward> checker(handle);
+    auto run = [&](DType dtype, float epsilon) {
+        checker.set_epsilon(epsilon);
+        TensorShape shape{5, 9, 13, 70};
+        for (bool affine : {false, true})
+            for (size_t start = 0; start < shape.ndim; ++start)
+                for (size_t end = start + 1; end <= shape.ndim; ++end) {
+                    if (end - start == shape.ndim) {
+                        // mean and rstd would be scalars
+                        continue;
+                    }
+                    Param param;
+                    param.affine = affine;
+                    param.eps = 1e-5;
+                    param.axis_start = start;
+                    param.axis_end = end;
+                    auto weight = get_weight_shape(shape, start, end);
+                    checker.set_param(param)
+                            .set_dtype(0, dtype)
+                            .set_dtype(1, dtype)
+                            .set_dtype(2, dtype)
+                            .set_dtype(3, dtype)
+                            .set_dtype(4, dtype::Float32())
+                            .set_dtype(5, dtype::Float32())
+                            .execs({shape, weight, weight, {}, {}, {}});
+                }
+    };
+    run(dtype::Float32(), 1e-3);
+    run(dtype::Float16(), 1e-2);
+}
+
+void run_general_norm_backward(Handle* handle) {
+    using Param = GeneralNormBackward::Param;
+    Checker<GeneralNormBackward> checker(handle);
+    auto run = [&](DType dtype, float epsilon) {
+        checker.set_epsilon(epsilon);
+        TensorShape shape{5, 9, 13, 70};
+        for (bool affine : {false, true})
+            for (size_t start = 0; start < shape.ndim; ++start)
+                for (size_t end = start + 1; end <= shape.ndim; ++end) {
+                    if (end - start == shape.ndim) {
+                        // mean and rstd would be scalars
+                        continue;
+                    }
+                    Param param;
+                    param.affine = affine;
+                    param.eps = 1e-5;
+                    param.axis_start = start;
+                    param.axis_end = end;
+                    auto weight = get_weight_shape(shape, start, end);
+                    TensorShape stat;
+                    for (size_t i = 0; i < shape.ndim; ++i) {
+                        if (i < start || i >= end) {
+                            stat[stat.ndim++] = shape[i];
+                        }
+                    }
+                    checker.set_param(param)
+                            .set_dtype(0, dtype)
+                            .set_dtype(1, dtype)
+                            .set_dtype(2, dtype)
+                            .set_dtype(3, dtype::Float32())
+                            .set_dtype(4, dtype::Float32())
+                            .set_dtype(5, dtype)
+                            .set_dtype(6, dtype)
+                            .set_dtype(7, dtype)
+                            .execs({shape, shape, weight, stat, stat, shape, weight,
+                                    weight});
+                }
+    };
+    run(dtype::Float32(), 1e-3);
+    run(dtype::Float16(), 1e-1);
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, GENERALNORM_FORWARD) {
+    run_general_norm_forward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, GENERALNORM_FORWARD) {
+    run_general_norm_forward(handle());
+}
+
+TEST_F(FALLBACK, GENERALNORM_BACKWARD) {
+    run_general_norm_backward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, GENERALNORM_BACKWARD) {
+    run_general_norm_backward(handle());
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,104 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs/nn.h"
+#include "test/common/checker.h"
+#include "test/common/rng.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+void run_group_norm_forward(Handle* handle) {
+    using Param = GroupNormForward::Param;
+    Checker<GroupNormForward> checker(handle);
+    auto run = [&](DType dtype, float epsilon) {
+        checker.set_epsilon(epsilon);
+        for (bool affine : {false, true})
+            for (size_t group : {1, 3})
+                for (size_t C : {6, 9})
+                    for (size_t HW : {1, 5, 16}) {
+                        Param param;
+                        param.affine = affine;
+                        param.eps = 1e-5;
+                        param.group = group;
+                        checker.set_param(param)
+                                .set_dtype(0, dtype)
+                                .set_dtype(1, dtype)
+                                .set_dtype(2, dtype)
+                                .set_dtype(3, dtype)
+                                .set_dtype(4, dtype::Float32())
+                                .set_dtype(5, dtype::Float32())
+                                .execs({{3, C, HW, 3},
+                                        {C},
+                                        {C},
+                                        {3, C, HW, 3},
+                                        {3, group},
+                                        {3, group}});
+                    }
+    };
+    run(dtype::Float32(), 1e-3);
+    run(dtype::Float16(), 1e-2);
+}
+
+void run_group_norm_backward(Handle* handle) {
+    using Param = GroupNormBackward::Param;
+    Checker<GroupNormBackward> checker(handle);
+    // the saved rstd of GroupNorm is the variance
+    UniformFloatRNG var_rng(0.1f, 2.f);
+    checker.set_rng(4, &var_rng);
+    auto run = [&](DType dtype, float epsilon) {
+        checker.set_epsilon(epsilon);
+        for (bool affine : {false, true})
+            for (size_t group : {1, 3})
+                for (size_t C : {6, 9})
+                    for (size_t HW : {1, 5, 16}) {
+                        Param param;
+                        param.affine = affine;
+                        param.eps = 1e-5;
+                        param.group = group;
+                        checker.set_param(param)
+                                .set_dtype(0, dtype)
+                                .set_dtype(1, dtype)
+                                .set_dtype(2, dtype)
+                                .set_dtype(3, dtype::Float32())
+                                .set_dtype(4, dtype::Float32())
+                                .set_dtype(5, dtype)
+                                .set_dtype(6, dtype)
+                                .set_dtype(7, dtype)
+                                .execs({{3, C, HW, 3},
+                                        {3, C, HW, 3},
+                                        {C},
+                                        {3, group},
+                                        {3, group},
+                                        {3, C, HW, 3},
+                                        {C},
+                                        {C}});
+                    }
+    };
+    run(dtype::Float32(), 1e-3);
+    run(dtype::Float16(), 1e-1);
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, GROUPNORM_FORWARD) {
+    run_group_norm_forward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, GROUPNORM_FORWARD) {
+    run_group_norm_forward(handle());
+}
+
+TEST_F(FALLBACK, GROUPNORM_BACKWARD) {
+    run_group_norm_backward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, GROUPNORM_BACKWARD) {
+    run_group_norm_backward(handle());
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,166 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+#include "test/common/index.h"
+#include "test/common/indexing_multi_axis_vec.h"
+#include "test/common/mesh_indexing.h"
+#include "test/common/timer.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+template <class Opr>
+void run_check(Handle* handle, size_t n) {
+    // see OprProxyIndexingMultiAxisVecHelper for more details
+    // set_proxy() sets the axes to index on
+    // execs() give input, output and index layouts
+    Checker<Opr> checker(handle);
+    size_t idx_size0, idx_size1;
+    IndexRNG rng0{idx_size0, 2}, rng1{idx_size1, 3};
+    checker.set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .set_dtype(2, dtype::Int32())
+            .set_dtype(3, dtype::Int32())
+            .set_rng(2, &rng0)
+            .set_rng(3, &rng1);
+
+    idx_size0 = 23;
+    checker.set_proxy({{0}})
+            .execs({{23}, {n}, {n}})
+            .execs({{23, 5}, {n, 5}, {n}});
+
+    idx_size0 = 2;
+    idx_size1 = 3;
+    checker.set_proxy({{0, 1}})
+            .execs({{2, 3}, {n}, {n}, {n}})
+            .execs({{2, 3, 5}, {n, 5}, {n}, {n}});
+
+    idx_size0 = 4;
+    idx_size1 = 6;
+    TensorLayout inp_layout{{3, 4, 5, 6}, dtype::Float32()};
+    inp_layout.stride[0] *= 8;
+    inp_layout.stride[1] *= 2;
+    checker.set_proxy({{1, 3}}).execl({
+            inp_layout,
+            {{n, 3, 5}, dtype::Float32()},
+            {{n}, dtype::Int32()},
+            {{1}, dtype::Int32()},
+    });
+
+    idx_size0 = 4;
+    idx_size1 = 5;
+    checker.set_proxy({{2, 3}}).execs(
+            {{2, 3, 4, 5, 6, 7}, {2, 3, n, 6, 7}, {n}, {n}});
+
+    idx_size0 = 4;
+    checker.set_proxy({{1}}).execs({{1, 4}, {1, n}, {n}});
+
+    if (std::is_same<Opr, IndexingIncrMultiAxisVec>::value) {
+        // broadcast value accumulated on duplicated indices
+        idx_size0 = 4;
+        TensorLayout val_layout{{n}, dtype::Float32()};
+        val_layout.stride[0] = 0;
+        checker.set_proxy({{0}}).execl(
+                {{{4}, dtype::Float32()}, val_layout, {{n}, dtype::Int32()}});
+        checker.set_dtype(0, dtype::Int32()).set_dtype(1, dtype::Int32());
+        checker.set_proxy({{1}}).execs({{5, 8, 3}, {5, n, 3}, {n}});
+    }
+}
+
+void run_set_check(Handle* handle, size_t n) {
+    Checker<IndexingSetMultiAxisVec> checker(handle);
+    size_t idx_size0 = n;
+    mesh_indexing::NoReplacementIndexRNG rng0{idx_size0, 2};
+    checker.set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .set_dtype(2, dtype::Int32())
+            .set_rng(2, &rng0);
+    checker.set_proxy({{1}})
+            .execs({{5, n, 3}, {5, n, 3}, {n}})
+            .execs({{5, n}, {5, n}, {n}});
+    checker.set_proxy({{0}}).execs({{n, 7}, {n, 7}, {n}});
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, INDEXING_MULTI_AXIS_VEC) {
+    run_check<IndexingMultiAxisVec>(handle(), 100);
+}
+
+TEST_F(FALLBACK, INDEXING_INCR_MULTI_AXIS_VEC) {
+    run_check<IndexingIncrMultiAxisVec>(handle(), 100);
+}
+
+TEST_F(FALLBACK, INDEXING_SET_MULTI_AXIS_VEC) {
+    run_set_check(handle(), 10);
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, INDEXING_MULTI_AXIS_VEC) {
+    run_check<IndexingMultiAxisVec>(handle(), 100003);
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, INDEXING_INCR_MULTI_AXIS_VEC) {
+    run_check<IndexingIncrMultiAxisVec>(handle(), 100003);
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, INDEXING_SET_MULTI_AXIS_VEC) {
+    run_set_check(handle(), 20011);
+}
+
+#if MEGDNN_WITH_BENCHMARK
+namespace {
+template <class Opr>
+void run_benchmark(Handle* handle, const char* name) {
+    auto handle_naive = create_cpu_handle(2);
+    auto run = [&](const TensorShape& data, const TensorShape& value, size_t axis) {
+        size_t idx_size = data[axis];
+        TensorShape idx{value[axis]};
+        std::vector<float> data_storage(data.total_nr_elems()),
+                value_storage(value.total_nr_elems());
+        std::vector<int> idx_storage(idx.total_nr_elems());
+        TensorNDArray tensors{
+                {data_storage.data(), {data, dtype::Float32()}},
+                {value_storage.data(), {value, dtype::Float32()}},
+                {idx_storage.data(), {idx, dtype::Int32()}}};
+        UniformFloatRNG rng{-1, 1};
+        IndexRNG rng_idx{idx_size, 2};
+        rng.gen(tensors[0]);
+        rng.gen(tensors[1]);
+        rng_idx.gen(tensors[2]);
+        OprProxy<Opr> proxy{{axis}};
+        auto bench = [&](Handle* handle) {
+            constexpr size_t RUN = 10;
+            auto opr = handle->create_operator<Opr>();
+            proxy.exec(opr.get(), tensors);
+            megcore_check(megcoreSynchronize(handle->megcore_computing_handle()));
+            test::Timer timer;
+            timer.start();
+            for (size_t i = 0; i < RUN; ++i) {
+                proxy.exec(opr.get(), tensors);
+            }
+            megcore_check(megcoreSynchronize(handle->megcore_computing_handle()));
+            timer.stop();
+            return timer.get_time_in_us() / 1e3 / RUN;
+        };
+        auto t0 = bench(handle_naive.get()), t1 = bench(handle);
+        printf("%s data=%s value=%s: naive=%.3fms fallback=%.3fms speedup=%.2f\n",
+               name, data.to_string().c_str(), value.to_string().c_str(), t0, t1,
+               t0 / t1);
+    };
+    run({1000, 256}, {100000, 256}, 0);
+    run({64, 1000}, {64, 100000}, 1);
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, BENCHMARK_INDEXING_MULTI_AXIS_VEC) {
+    run_benchmark<IndexingMultiAxisVec>(handle(), "fwd");
+    run_benchmark<IndexingIncrMultiAxisVec>(handle(), "incr");
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,52 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/checker.h"
+#include "test/common/indexing_one_hot.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_one_hot_test(Handle* handle, size_t n) {
+    UniformIntRNG rng_idx{0, 7};
+    for (uint32_t axis : {0, 1, 2}) {
+        // idx is src with the indexed axis of size 8 removed
+        TensorShape idx{n, 4}, src;
+        src.ndim = 3;
+        for (size_t i = 0, j = 0; i < 3; ++i) {
+            src[i] = i == axis ? 8 : idx[j++];
+        }
+        TensorShape sub = src;
+        sub[axis] = 1;
+        Checker<IndexingOneHot> checker(handle);
+        checker.set_param({axis}).set_dtype(1, dtype::Int32{}).set_rng(1, &rng_idx);
+        checker.execs({src, idx, {}});
+        Checker<IndexingSetOneHot> set_checker(handle);
+        set_checker.set_param({axis})
+                .set_dtype(1, dtype::Int32{})
+                .set_rng(1, &rng_idx);
+        set_checker.execs({src, idx, sub});
+    }
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, INDEXING_ONE_HOT) {
+    run_indexing_one_hot_test(handle());
+    run_one_hot_test(handle(), 3);
+}
+
+TEST_F(FALLBACK, INDEXING_SET_ONE_HOT) {
+    run_indexing_set_one_hot_test(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, INDEXING_ONE_HOT) {
+    run_indexing_one_hot_test(handle());
+    run_indexing_set_one_hot_test(handle());
+    run_one_hot_test(handle(), 10007);
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
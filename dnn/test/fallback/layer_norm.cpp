@@ -0,0 +1,132 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs/nn.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+void run_layer_norm_forward(Handle* handle) {
+    using Param = LayerNormForward::Param;
+    Checker<LayerNormForward> checker(handle);
+    auto run = [&](DType dtype, float epsilon) {
+        checker.set_epsilon(epsilon);
+        for (bool affine : {false, true})
+            for (size_t n_slices : {1, 7, 30})
+                for (size_t slice_len : {1, 3, 8, 33, 100}) {
+                    Param param;
+                    param.affine = affine;
+                    param.eps = 1e-5;
+                    param.normalized_dim = 1;
+                    param.normalized_size = slice_len;
+                    checker.set_param(param)
+                            .set_dtype(0, dtype)
+                            .set_dtype(1, dtype)
+                            .set_dtype(2, dtype)
+                            .set_dtype(3, dtype)
+                            .set_dtype(4, dtype::Float32())
+                            .set_dtype(5, dtype::Float32())
+                            .execs({{n_slices, slice_len},
+                                    {slice_len},
+                                    {slice_len},
+                                    {n_slices, slice_len},
+                                    {n_slices},
+                                    {n_slices}});
+                }
+    };
+    run(dtype::Float32(), 1e-3);
+    run(dtype::Float16(), 1e-2);
+}
+
+void run_layer_norm_backward(Handle* handle) {
+    using Param = LayerNormBackward::Param;
+    Checker<LayerNormBackward> checker(handle);
+    auto run = [&](DType dtype, float epsilon) {
+        checker.set_epsilon(epsilon);
+        for (bool affine : {false, true})
+            for (size_t n_slices : {1, 7, 30})
+                for (size_t slice_len : {1, 3, 8, 33, 100}) {
+                    Param param;
+                    param.affine = affine;
+                    param.eps = 1e-5;
+                    param.normalized_dim = 1;
+                    param.normalized_size = slice_len;
+                    checker.set_param(param)
+                            .set_dtype(0, dtype)
+                            .set_dtype(1, dtype)
+                            .set_dtype(2, dtype)
+                            .set_dtype(3, dtype::Float32())
+                            .set_dtype(4, dtype::Float32())
+                            .set_dtype(5, dtype)
+                            .set_dtype(6, dtype)
+                            .set_dtype(7, dtype)
+                            .execs({{n_slices, slice_len},
+                                    {n_slices, slice_len},
+                                    {slice_len},
+                                    {n_slices},
+                                    {n_slices},
+                                    {n_slices, slice_len},
+                                    {slice_len},
+                                    {slice_len}});
+                }
+    };
+    run(dtype::Float32(), 1e-3);
+    run(dtype::Float16(), 1e-1);
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, LAYERNORM_FORWARD) {
+    run_layer_norm_forward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, LAYERNORM_FORWARD) {
+    run_layer_norm_forward(handle());
+}
+
+TEST_F(FALLBACK, LAYERNORM_BACKWARD) {
+    run_layer_norm_backward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, LAYERNORM_BACKWARD) {
+    run_layer_norm_backward(handle());
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_LAYERNORM_FORWARD) {
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<LayerNormForward> benchmarker_naive(handle_naive.get());
+    Benchmarker<LayerNormForward> benchmarker_fallback(handle());
+    constexpr size_t RUN = 10;
+    auto run = [&](size_t n_slices, size_t slice_len) {
+        LayerNormForward::Param param;
+        param.normalized_dim = 1;
+        param.normalized_size = slice_len;
+        TensorShapeArray shapes{
+                {n_slices, slice_len}, {slice_len}, {slice_len}, {}, {}, {}};
+        auto t0 = benchmarker_naive.set_display(false)
+                          .set_times(RUN)
+                          .set_param(param)
+                          .execs(shapes) /
+                  RUN;
+        auto t1 = benchmarker_fallback.set_display(false)
+                          .set_times(RUN)
+                          .set_param(param)
+                          .execs(shapes) /
+                  RUN;
+        printf("slices=%zu len=%zu: naive=%.3fms fallback=%.3fms speedup=%.2f\n",
+               n_slices, slice_len, t0, t1, t0 / t1);
+    };
+    run(128, 768);
+    run(1024, 1024);
+    run(4096, 4096);
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
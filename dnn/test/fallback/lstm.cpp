@@ -0,0 +1,117 @@
+#include "test/fallback/fixture.h"
+
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+size_t get_flatten_size(
+        size_t input_size, size_t hidden_size, size_t D, size_t num_layers,
+        bool bias) {
+    size_t ret = 0;
+    for (size_t layer = 0; layer < num_layers; ++layer) {
+        ret += D * ((layer ? D * hidden_size : input_size) + hidden_size);
+    }
+    return ret + (bias ? 2 * D * num_layers : 0);
+}
+
+void run_lstm(Handle* handle) {
+    Checker<LSTM> checker(handle);
+    //! tanh and exp differ slightly from the naive impl and the error grows
+    //! with the timesteps
+    checker.set_epsilon(1e-2);
+    for (bool bias : {false, true})
+        for (bool bidirectional : {false, true}) {
+            size_t D = bidirectional ? 2 : 1;
+            LSTM::Param param;
+            param.bias = bias;
+            param.bidirectional = bidirectional;
+            auto run = [&](size_t seq_len, size_t batch, size_t input_size,
+                           size_t hidden_size, size_t num_layers) {
+                param.hidden_size = hidden_size;
+                param.num_layers = num_layers;
+                size_t flatten_size = get_flatten_size(
+                        input_size, hidden_size, D, num_layers, bias);
+                checker.set_param(param).execs(
+                        {{seq_len, batch, input_size},
+                         {num_layers * D, batch, hidden_size},
+                         {num_layers * D, batch, hidden_size},
+                         {4 * hidden_size, flatten_size},
+                         {},
+                         {},
+                         {},
+                         {}});
+            };
+            for (size_t seq_len : {1, 5})
+                for (size_t batch : {1, 3})
+                    for (size_t num_layers : {1, 2, 3}) {
+                        run(seq_len, batch, 13, 17, num_layers);
+                        run(seq_len, batch, 4, 8, num_layers);
+                    }
+            //! more rows than one packed block
+            run(4, 53, 16, 32, 2);
+        }
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, LSTM_FORWARD) {
+    run_lstm(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, LSTM_FORWARD) {
+    run_lstm(handle());
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_LSTM_FORWARD) {
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<LSTM> benchmarker_naive(handle_naive.get());
+    Benchmarker<LSTM> benchmarker_fallback(handle());
+    constexpr size_t RUN = 5;
+    auto run = [&](size_t seq_len, size_t batch, size_t input_size,
+                   size_t hidden_size, size_t num_layers, bool bidirectional) {
+        LSTM::Param param;
+        param.hidden_size = hidden_size;
+        param.num_layers = num_layers;
+        param.bidirectional = bidirectional;
+        size_t D = bidirectional ? 2 : 1;
+        TensorShapeArray shapes{
+                {seq_len, batch, input_size},
+                {num_layers * D, batch, hidden_size},
+                {num_layers * D, batch, hidden_size},
+                {4 * hidden_size,
+                 get_flatten_size(input_size, hidden_size, D, num_layers, true)},
+                {},
+                {},
+                {},
+                {}};
+        auto t0 = benchmarker_naive.set_param(param)
+                          .set_display(false)
+                          .set_times(RUN)
+                          .execs(shapes) /
+                  RUN;
+        auto t1 = benchmarker_fallback.set_param(param)
+                          .set_display(false)
+                          .set_times(RUN)
+                          .execs(shapes) /
+                  RUN;
+        printf("seq=%zu batch=%zu input=%zu hidden=%zu layers=%zu D=%zu: "
+               "naive=%.3fms fallback=%.3fms speedup=%.2f\n",
+               seq_len, batch, input_size, hidden_size, num_layers, D, t0, t1,
+               t0 / t1);
+    };
+    run(32, 1, 128, 128, 1, false);
+    run(32, 16, 256, 256, 1, false);
+    run(32, 16, 256, 256, 2, true);
+    run(100, 64, 512, 512, 1, false);
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,48 @@
+#include "test/fallback/fixture.h"
+
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+void run_lstm_cell(Handle* handle) {
+    Checker<LSTMCell> checker(handle);
+    checker.set_epsilon(1e-3);
+    for (size_t batch : {1, 2, 5})
+        for (size_t input_size : {3, 16, 23})
+            for (size_t hidden_size : {1, 4, 13, 32}) {
+                size_t gate_hidden_size = 4 * hidden_size;
+                for (TensorShape bias :
+                     {TensorShape{gate_hidden_size}, TensorShape{1, gate_hidden_size},
+                      TensorShape{batch, gate_hidden_size}}) {
+                    checker.execs(
+                            {{batch, input_size},
+                             {gate_hidden_size, input_size},
+                             bias,
+                             {batch, hidden_size},
+                             {gate_hidden_size, hidden_size},
+                             bias,
+                             {batch, hidden_size},
+                             {},
+                             {},
+                             {}});
+                }
+            }
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, LSTMCell) {
+    run_lstm_cell(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, LSTMCell) {
+    run_lstm_cell(handle());
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,75 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_masked_fill_test(Handle* handle, size_t n) {
+    using Param = MaskedFill::Param;
+    Param param;
+    param.value = 3.0;
+    Checker<MaskedFill> checker(handle);
+    for (auto dtype :
+         std::vector<DType>{dtype::Float32(), dtype::Int32(), dtype::Float16(),
+                            dtype::Uint8(), dtype::Bool()}) {
+        checker.set_param(param)
+                .set_dtype(0, dtype)
+                .set_dtype(1, dtype::Bool())
+                .set_dtype(2, dtype);
+        // masks covering blocks of trailing elements
+        checker.execs({{2, n, 3, 1}, {2, n}, {}});
+        checker.execs({{3, n, 5}, {3}, {}});
+        // masks of the same shape as origin
+        checker.execs({{2, n, 3}, {2, n, 3}, {}});
+        checker.execs({{n}, {n}, {}});
+    }
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, MASKED_FILL) {
+    for (size_t n : {1, 7, 16, 33}) {
+        run_masked_fill_test(handle(), n);
+    }
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, MASKED_FILL) {
+    for (size_t n : {7, 33, 100003}) {
+        run_masked_fill_test(handle(), n);
+    }
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_MASKED_FILL) {
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<MaskedFill> benchmarker_naive(handle_naive.get());
+    Benchmarker<MaskedFill> benchmarker_fallback(handle());
+    constexpr size_t RUN = 10;
+    auto run = [&](const TensorShape& origin, const TensorShape& mask) {
+        auto bench = [&](Benchmarker<MaskedFill>& benchmarker) {
+            return benchmarker.set_display(false)
+                           .set_times(RUN)
+                           .set_dtype(0, dtype::Float32())
+                           .set_dtype(1, dtype::Bool())
+                           .set_dtype(2, dtype::Float32())
+                           .execs({origin, mask, {}}) /
+                   RUN;
+        };
+        auto t0 = bench(benchmarker_naive), t1 = bench(benchmarker_fallback);
+        printf("origin=%s mask=%s: naive=%.3fms fallback=%.3fms speedup=%.2f\n",
+               origin.to_string().c_str(), mask.to_string().c_str(), t0, t1,
+               t0 / t1);
+    };
+    run({1000000}, {1000000});
+    run({64, 256, 256}, {64, 256});
+    run({64, 256, 256}, {64});
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
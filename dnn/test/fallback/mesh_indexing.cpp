@@ -0,0 +1,144 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/checker.h"
+#include "test/common/index.h"
+#include "test/common/mesh_indexing.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_mesh_test(Handle* handle, size_t n) {
+    Checker<MeshIndexing> checker(handle);
+    size_t idx_size0, idx_size1;
+    IndexRNG rng0{idx_size0, 2}, rng1{idx_size1, 3};
+    checker.set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .set_dtype(2, dtype::Int32())
+            .set_dtype(3, dtype::Int32())
+            .set_rng(2, &rng0)
+            .set_rng(3, &rng1);
+
+    idx_size0 = 23;
+    checker.set_proxy({{0}}).execs({{23}, {n}, {n}}).execs({{23, 5}, {n, 5}, {n}});
+
+    idx_size0 = 3;
+    checker.set_proxy({{1}})
+            .execs({{2, 3}, {2, n}, {n}})
+            .execs({{2, 3, 5, 7}, {2, n, 5, 7}, {n}});
+
+    idx_size0 = 23;
+    idx_size1 = 17;
+    checker.set_proxy({{3, 1}})
+            .execs({{3, 17, 9, 23}, {3, 100, 9, n}, {n}, {100}})
+            .execs({{3, 17, 29, 30}, {3, 66, 29, 99}, {99}, {66}});
+}
+
+void run_batched_mesh_test(Handle* handle, size_t n) {
+    Checker<BatchedMeshIndexing> checker(handle);
+    size_t idx_size0, idx_size1;
+    IndexRNG rng0{idx_size0, 2}, rng1{idx_size1, 3};
+    checker.set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .set_dtype(2, dtype::Int32())
+            .set_dtype(3, dtype::Int32())
+            .set_rng(2, &rng0)
+            .set_rng(3, &rng1);
+
+    idx_size0 = 5;
+    checker.set_proxy({{1}}).execs({{2, 5}, {2, n}, {2, n}});
+
+    idx_size0 = 23;
+    idx_size1 = 17;
+    checker.set_proxy({{3, 1}})
+            .execs({{3, 17, 9, 23}, {3, 100, 9, 100}, {3, 100}, {3, 100}});
+
+    // index broadcast on the batch axis
+    idx_size0 = 5;
+    TensorLayout index_layout{TensorShape{1, n}, dtype::Int32()};
+    index_layout = index_layout.broadcast({2, n});
+    checker.set_proxy({{1}}).execl(
+            {TensorLayout{TensorShape{2, idx_size0}, dtype::Float32()},
+             TensorLayout{TensorShape{2, n}, dtype::Float32()}, index_layout});
+}
+
+template <typename T, typename RNG>
+void run_modify_test(Handle* handle, size_t n) {
+    Checker<T> checker(handle);
+    size_t idx_size0;
+    RNG rng0{idx_size0, 2};
+    checker.set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .set_dtype(2, dtype::Int32())
+            .set_rng(2, &rng0);
+
+    idx_size0 = n;
+    checker.set_proxy({{0}})
+            .execs({{n}, {n / 2}, {n / 2}})
+            .execs({{n, 5}, {n / 3, 5}, {n / 3}});
+
+    idx_size0 = 30;
+    checker.set_proxy({{1}})
+            .execs({{2, 30}, {2, 10}, {10}})
+            .execs({{n, 30, 5}, {n, 20, 5}, {20}})
+            .execs({{2, 30, 5, n}, {2, 25, 5, n}, {25}});
+}
+
+template <typename T, typename RNG>
+void run_batch_modify_test(Handle* handle, size_t n) {
+    Checker<T> checker(handle);
+    size_t idx_size0, idx_size1;
+    RNG rng0{idx_size0, 2}, rng1{idx_size1, 3};
+    checker.set_dtype(0, dtype::Float32())
+            .set_dtype(1, dtype::Float32())
+            .set_dtype(2, dtype::Int32())
+            .set_dtype(3, dtype::Int32())
+            .set_rng(2, &rng0)
+            .set_rng(3, &rng1);
+
+    idx_size0 = 5;
+    checker.set_proxy({{1}}).execs({{2, 5}, {2, 3}, {2, 3}});
+
+    idx_size0 = 23;
+    idx_size1 = 17;
+    checker.set_proxy({{3, 1}})
+            .execs({{3, 17, n, 23}, {3, 10, n, 10}, {3, 10}, {3, 10}})
+            .execs({{3, 17, 29, 30}, {3, 11, 29, 22}, {3, 22}, {3, 11}});
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, MESH_INDEXING) {
+    run_mesh_test(handle(), 100);
+    run_batched_mesh_test(handle(), 3);
+}
+
+TEST_F(FALLBACK, MESH_MODIFY) {
+    run_modify_test<IncrMeshIndexing, IndexRNG>(handle(), 230);
+    run_modify_test<SetMeshIndexing, mesh_indexing::NoReplacementIndexRNG>(
+            handle(), 230);
+    run_batch_modify_test<BatchedIncrMeshIndexing, IndexRNG>(handle(), 9);
+    run_batch_modify_test<
+            BatchedSetMeshIndexing, mesh_indexing::NoReplacementIndexRNG>(handle(), 9);
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, MESH_INDEXING) {
+    run_mesh_test(handle(), 1003);
+    run_batched_mesh_test(handle(), 50021);
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, MESH_MODIFY) {
+    // duplicated indices are accumulated by the incr oprs
+    run_modify_test<IncrMeshIndexing, IndexRNG>(handle(), 6007);
+    run_modify_test<SetMeshIndexing, mesh_indexing::NoReplacementIndexRNG>(
+            handle(), 6007);
+    run_batch_modify_test<BatchedIncrMeshIndexing, IndexRNG>(handle(), 503);
+    run_batch_modify_test<
+            BatchedSetMeshIndexing, mesh_indexing::NoReplacementIndexRNG>(
+            handle(), 503);
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
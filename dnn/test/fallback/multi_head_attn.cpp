@@ -0,0 +1,204 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs/nn.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+using Param = MultiHeadAttnForward::Param;
+
+//! inference-mode param with the projections of all q/k/v/o enabled or not
+Param make_param(size_t num_heads, size_t embeding_size, bool proj, bool mask) {
+    Param param;
+    param.training = false;
+    param.need_weights = true;
+    param.num_heads = num_heads;
+    param.embeding_size = embeding_size;
+    param.k_size = embeding_size;
+    param.v_size = embeding_size;
+    param.qproj_size = proj ? embeding_size : 0;
+    param.kproj_size = proj ? embeding_size : 0;
+    param.vproj_size = proj ? embeding_size : 0;
+    param.oproj_size = proj ? embeding_size : 0;
+    param.qbias = param.kbias = param.vbias = param.obias = proj;
+    size_t head_dim = proj ? embeding_size / num_heads : embeding_size;
+    param.sm_scaler = 1.f / std::sqrt(static_cast<float>(head_dim));
+    if (mask) {
+        param.attn_mask_type = param::MultiHeadAttn::AttnMaskType::USER_DEFINED_MASK;
+        param.tensor_combination_type =
+                param::MultiHeadAttn::TensorCombinationType::ONLY_MASK;
+    }
+    return param;
+}
+
+size_t get_weight_len(const Param& param) {
+    size_t len = 0;
+    if (param.qproj_size) {
+        len += param.embeding_size * param.qproj_size + param.qproj_size;
+        len += param.k_size * param.kproj_size + param.kproj_size;
+        len += param.v_size * param.vproj_size + param.vproj_size;
+        len += param.vproj_size * param.oproj_size + param.oproj_size;
+    }
+    return len;
+}
+
+void run_mha_forward(Handle* handle) {
+    Checker<MultiHeadAttnForward> checker(handle);
+    checker.set_epsilon(1e-4);
+    for (size_t batch : {1, 3})
+        for (size_t seq_qlen : {1, 17})
+            for (size_t seq_klen : {1, 9, 70})
+                for (size_t num_heads : {1, 2, 4})
+                    for (bool proj : {false, true})
+                        for (bool mask : {false, true}) {
+                            size_t embeding_size = 8;
+                            auto param =
+                                    make_param(num_heads, embeding_size, proj, mask);
+                            TensorShape attn_mask{};
+                            if (mask) {
+                                attn_mask = {batch * num_heads, seq_qlen, seq_klen};
+                            }
+                            checker.set_param(param).set_bypass(9).set_bypass(10);
+                            checker.execs(
+                                    {{batch, seq_qlen, embeding_size},
+                                     {batch, seq_klen, embeding_size},
+                                     {batch, seq_klen, embeding_size},
+                                     {get_weight_len(param)},
+                                     attn_mask,
+                                     {},
+                                     {},
+                                     {},
+                                     {},
+                                     {},
+                                     {}});
+                        }
+}
+
+/*!
+ * the backward consumes attn_weight and the reservespaces of the training forward,
+ * so they are produced by the naive forward from the generated inputs rather than
+ * being random. mask_ndim is 0 for no mask, 2 for a (L, S) mask and 3 for a
+ * (N * num_heads, L, S) mask; a non-zero attn_prob takes the unfused backward
+ */
+void run_mha_backward(Handle* handle) {
+    auto handle_naive = create_cpu_handle(2);
+    auto forward = handle_naive->create_operator<MultiHeadAttnForward>();
+    Checker<MultiHeadAttnBackward> checker(handle);
+    checker.set_epsilon(1e-3).set_dtype(7, dtype::Uint8());
+    auto run = [&](size_t batch, size_t seq_qlen, size_t seq_klen, size_t num_heads,
+                   bool proj, size_t mask_ndim, float attn_prob) {
+        size_t embeding_size = 8;
+        auto param = make_param(num_heads, embeding_size, proj, mask_ndim != 0);
+        param.training = true;
+        param.attn_prob = attn_prob;
+        TensorShape attn_mask{};
+        if (mask_ndim == 2) {
+            attn_mask = {seq_qlen, seq_klen};
+        } else if (mask_ndim == 3) {
+            attn_mask = {batch * num_heads, seq_qlen, seq_klen};
+        }
+        TensorLayout queries{{batch, seq_qlen, embeding_size}, dtype::Float32()};
+        TensorLayout keys{{batch, seq_klen, embeding_size}, dtype::Float32()};
+        TensorLayout weight{{get_weight_len(param)}, dtype::Float32()};
+        TensorLayout mask{attn_mask, dtype::Float32()};
+        TensorLayout empty{dtype::Float32()};
+        TensorLayout out, attn_weight, mask_reservespace, othr_reservespace;
+        forward->param() = param;
+        forward->deduce_layout(
+                queries, keys, keys, weight, mask, empty, empty, out, attn_weight,
+                mask_reservespace, othr_reservespace);
+        size_t workspace_size = forward->get_workspace_in_bytes(
+                queries, keys, keys, weight, mask, empty, empty, out, attn_weight,
+                mask_reservespace, othr_reservespace);
+        auto opr = forward.get();
+        checker.set_tensors_constraint([=](TensorNDArray& tensors) {
+            std::vector<dt_float32> out_storage(out.total_nr_elems());
+            std::vector<dt_byte> workspace(workspace_size);
+            TensorND bias_kv{nullptr, empty};
+            opr->exec(
+                    tensors[1], tensors[2], tensors[3], tensors[4], tensors[5],
+                    bias_kv, bias_kv, {out_storage.data(), out}, tensors[6],
+                    tensors[7], tensors[8], {workspace.data(), workspace_size});
+        });
+        checker.set_param(param).execs(
+                {out, queries, keys, keys, weight, attn_mask, attn_weight,
+                 mask_reservespace, othr_reservespace, {}, {}, {}, {}, {}, {}});
+    };
+    for (size_t batch : {1, 2})
+        for (size_t seq_qlen : {1, 7})
+            for (size_t seq_klen : {1, 9})
+                for (size_t num_heads : {1, 2})
+                    for (bool proj : {false, true})
+                        for (size_t mask_ndim : {0, 2, 3})
+                            for (float attn_prob : {0.f, 0.1f})
+                                run(batch, seq_qlen, seq_klen, num_heads, proj,
+                                    mask_ndim, attn_prob);
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, MULTIHEADATTN_FORWARD) {
+    run_mha_forward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, MULTIHEADATTN_FORWARD) {
+    run_mha_forward(handle());
+}
+
+TEST_F(FALLBACK, MULTIHEADATTN_BACKWARD) {
+    run_mha_backward(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, MULTIHEADATTN_BACKWARD) {
+    run_mha_backward(handle());
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_MULTIHEADATTN_FORWARD) {
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<MultiHeadAttnForward> benchmarker_naive(handle_naive.get());
+    Benchmarker<MultiHeadAttnForward> benchmarker_fallback(handle());
+    constexpr size_t RUN = 10;
+    auto run = [&](size_t batch, size_t seq_len, size_t num_heads,
+                   size_t embeding_size) {
+        auto param = make_param(num_heads, embeding_size, true, false);
+        TensorShapeArray shapes{
+                {batch, seq_len, embeding_size},
+                {batch, seq_len, embeding_size},
+                {batch, seq_len, embeding_size},
+                {get_weight_len(param)},
+                {},
+                {},
+                {},
+                {},
+                {},
+                {},
+                {}};
+        auto t0 = benchmarker_naive.set_display(false)
+                          .set_times(RUN)
+                          .set_param(param)
+                          .execs(shapes) /
+                  RUN;
+        auto t1 = benchmarker_fallback.set_display(false)
+                          .set_times(RUN)
+                          .set_param(param)
+                          .execs(shapes) /
+                  RUN;
+        printf("batch=%zu seq=%zu heads=%zu embed=%zu: naive=%.3fms fused=%.3fms "
+               "speedup=%.2f\n",
+               batch, seq_len, num_heads, embeding_size, t0, t1, t0 / t1);
+    };
+    run(1, 128, 8, 512);
+    run(4, 256, 8, 512);
+    run(1, 1024, 12, 768);
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
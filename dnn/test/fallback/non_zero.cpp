@@ -0,0 +1,78 @@
+#include "test/common/non_zero.h"
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_non_zero_test(Handle* handle) {
+    auto handle_naive = create_cpu_handle(2);
+    auto opr_naive = handle_naive->create_operator<NonZero>();
+    auto opr = handle->create_operator<NonZero>();
+    for (NonZeroTestcase& test_case : NonZeroTestcase::make()) {
+        auto data = test_case.run_cuda(opr.get());
+        auto data_naive = test_case.run_cuda(opr_naive.get());
+        MEGDNN_ASSERT_TENSOR_EQ(*data, *data_naive);
+    }
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, NON_ZERO) {
+    run_non_zero_test(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, NON_ZERO) {
+    run_non_zero_test(handle());
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_NON_ZERO) {
+    auto handle_naive = create_cpu_handle(2);
+    auto run = [&](const TensorShape& shape, float ratio) {
+        TensorLayout layout{shape, dtype::Float32()};
+        std::vector<float> storage(layout.total_nr_elems());
+        for (auto&& i : storage) {
+            i = static_cast<float>(rand()) / RAND_MAX < ratio;
+        }
+        TensorND data{storage.data(), layout};
+        auto bench = [&](Handle* handle) {
+            constexpr size_t RUN = 10;
+            auto opr = handle->create_operator<NonZero>();
+            DynOutMallocPolicyImpl malloc_policy(handle);
+            auto workspace_size = opr->get_workspace_in_bytes(layout);
+            auto workspace_ptr = malloc_policy.alloc_workspace(workspace_size, nullptr);
+            Workspace workspace{(dt_byte*)workspace_ptr, workspace_size};
+            auto exec = [&]() {
+                auto ret = opr->exec(data, workspace, &malloc_policy);
+                megcore_check(megcoreSynchronize(handle->megcore_computing_handle()));
+                malloc_policy.make_output_refholder(ret);
+            };
+            exec();
+            test::Timer timer;
+            timer.start();
+            for (size_t i = 0; i < RUN; ++i) {
+                exec();
+            }
+            timer.stop();
+            malloc_policy.free_workspace(workspace_ptr, nullptr);
+            return timer.get_time_in_us() / 1e3 / RUN;
+        };
+        auto t0 = bench(handle_naive.get()), t1 = bench(handle());
+        printf("shape=%s ratio=%.2f: naive=%.3fms fallback=%.3fms speedup=%.2f\n",
+               shape.to_string().c_str(), ratio, t0, t1, t0 / t1);
+    };
+    for (float ratio : {0.01f, 0.5f}) {
+        run({1000000}, ratio);
+        run({100, 100, 100}, ratio);
+    }
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,63 @@
+#include "test/fallback/fixture.h"
+
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+
+void run_rnn(Handle* handle) {
+    using NonlineMode = RNN::Param::NonlineMode;
+    Checker<RNN> checker(handle);
+    checker.set_epsilon(1e-2);
+    for (auto mode : {NonlineMode::IDENTITY, NonlineMode::RELU, NonlineMode::TANH})
+        for (bool bias : {false, true})
+            for (bool bidirectional : {false, true}) {
+                size_t D = bidirectional ? 2 : 1;
+                RNN::Param param;
+                param.nonlineMode = mode;
+                param.bias = bias;
+                param.bidirectional = bidirectional;
+                auto run = [&](size_t seq_len, size_t batch, size_t input_size,
+                               size_t hidden_size, size_t num_layers) {
+                    param.hidden_size = hidden_size;
+                    param.num_layers = num_layers;
+                    size_t flatten_size = 0;
+                    for (size_t layer = 0; layer < num_layers; ++layer) {
+                        flatten_size +=
+                                D * ((layer ? D * hidden_size : input_size) +
+                                     hidden_size);
+                    }
+                    flatten_size += bias ? 2 * D * num_layers : 0;
+                    checker.set_param(param).execs(
+                            {{seq_len, batch, input_size},
+                             {num_layers * D, batch, hidden_size},
+                             {hidden_size, flatten_size},
+                             {},
+                             {},
+                             {}});
+                };
+                for (size_t seq_len : {1, 4})
+                    for (size_t batch : {1, 3})
+                        for (size_t num_layers : {1, 3}) {
+                            run(seq_len, batch, 7, 9, num_layers);
+                        }
+                run(3, 50, 16, 24, 2);
+            }
+}
+
+}  // namespace
+
+TEST_F(FALLBACK, RNN_FORWARD) {
+    run_rnn(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, RNN_FORWARD) {
+    run_rnn(handle());
+}
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,76 @@
+#include "test/common/topk.h"
+#include "test/fallback/fixture.h"
+
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+TEST_F(FALLBACK, TOPK_F32) {
+    run_topk_test<dtype::Float32>(handle());
+}
+
+TEST_F(FALLBACK, TOPK_I32) {
+    run_topk_test<dtype::Int32>(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, TOPK_F32) {
+    run_topk_test<dtype::Float32>(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, TOPK_I32) {
+    run_topk_test<dtype::Int32>(handle());
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, TOPK_LONG_ROW) {
+    using Mode = TopK::Param::Mode;
+    Checker<TopK> checker(handle());
+    UniformIntRNG rng{-50, 50};
+    checker.set_dtype(0, dtype::Int32()).set_rng(0, &rng);
+    // few long rows are split into chunks; duplicated values check tie breaking
+    for (auto mode : {Mode::KTH_ONLY, Mode::VALUE_IDX_NOSORT, Mode::VALUE_IDX_SORTED})
+        for (int k : {1, -1, 17, -17, 500})
+            for (size_t m : {1, 2}) {
+                checker.set_proxy(k).set_param(mode);
+                if (mode == Mode::KTH_ONLY) {
+                    checker.execs({{m, 100003}, {}});
+                } else {
+                    checker.execs({{m, 100003}, {}, {}});
+                }
+            }
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_TOPK) {
+    using Mode = TopK::Param::Mode;
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<TopK> benchmarker_naive(handle_naive.get());
+    Benchmarker<TopK> benchmarker_fallback(handle());
+    constexpr size_t RUN = 10;
+    auto run = [&](size_t m, size_t n, int k) {
+        auto bench = [&](Benchmarker<TopK>& benchmarker) {
+            std::unique_ptr<OprProxy<TopK>> proxy{new OprProxy<TopK>{k}};
+            return benchmarker.set_display(false)
+                           .set_times(RUN)
+                           .set_proxy(proxy)
+                           .set_param(Mode::VALUE_IDX_SORTED)
+                           .execs({{m, n}, {}, {}}) /
+                   RUN;
+        };
+        auto t0 = bench(benchmarker_naive), t1 = bench(benchmarker_fallback);
+        printf("m=%zu n=%zu k=%d: naive=%.3fms fallback=%.3fms speedup=%.2f\n", m, n,
+               k, t0, t1, t0 / t1);
+    };
+    for (int k : {1, 10, 100, 1000}) {
+        run(1, 1000000, k);
+        run(64, 50000, k);
+        run(1024, 8192, -k);
+    }
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -0,0 +1,63 @@
+#include "test/fallback/fixture.h"
+
+#include "megdnn/oprs.h"
+#include "test/common/benchmarker.h"
+#include "test/common/checker.h"
+
+namespace megdnn {
+namespace test {
+
+namespace {
+void run_where_test(Handle* handle, const TensorShapeArray& shapes) {
+    Checker<WhereForward> checker(handle);
+    for (auto dtype :
+         std::vector<DType>{dtype::Float32(), dtype::Int32(), dtype::Float16(),
+                            dtype::Int8(), dtype::Bool()})
+        for (auto&& shape : shapes) {
+            checker.set_dtype(0, dtype::Bool())
+                    .set_dtype(1, dtype)
+                    .set_dtype(2, dtype)
+                    .execs({shape, shape, shape, {}});
+        }
+}
+}  // anonymous namespace
+
+TEST_F(FALLBACK, WHERE) {
+    run_where_test(handle(), {{1}, {15}, {16}, {33}, {4, 7, 9}, {1000}});
+}
+
+TEST_F(FALLBACK_MULTI_THREADS, WHERE) {
+    run_where_test(handle(), {{15}, {4, 7, 9}, {1000}, {3, 100003}});
+}
+
+#if MEGDNN_WITH_BENCHMARK
+TEST_F(FALLBACK, BENCHMARK_WHERE) {
+    auto handle_naive = create_cpu_handle(2);
+    Benchmarker<WhereForward> benchmarker_naive(handle_naive.get());
+    Benchmarker<WhereForward> benchmarker_fallback(handle());
+    constexpr size_t RUN = 10;
+    auto run = [&](const TensorShape& shape, DType dtype) {
+        auto bench = [&](Benchmarker<WhereForward>& benchmarker) {
+            return benchmarker.set_display(false)
+                           .set_times(RUN)
+                           .set_dtype(0, dtype::Bool())
+                           .set_dtype(1, dtype)
+                           .set_dtype(2, dtype)
+                           .execs({shape, shape, shape, {}}) /
+                   RUN;
+        };
+        auto t0 = bench(benchmarker_naive), t1 = bench(benchmarker_fallback);
+        printf("shape=%s dtype=%s: naive=%.3fms fallback=%.3fms speedup=%.2f\n",
+               shape.to_string().c_str(), dtype.name(), t0, t1, t0 / t1);
+    };
+    for (auto dtype : std::vector<DType>{dtype::Float32(), dtype::Int8()}) {
+        run({1000000}, dtype);
+        run({64, 256, 256}, dtype);
+    }
+}
+#endif
+
+}  // namespace test
+}  // namespace megdnn
+
+// vim: syntax=cpp.doxygen
@@ -5,8 +5,10 @@ from contextlib import contextmanager
 from ._imperative_rt.core2 import (
     _clear_algorithm_cache,
     get_auto_format_convert,
+    get_elemwise_fusion,
     get_option,
     set_auto_format_convert,
+    set_elemwise_fusion,
     set_option,
 )
 
@@ -22,6 +24,7 @@ __all__ = [
     "deterministic_kernel",
     "async_level",
     "disable_memory_forwarding",
+    "elemwise_fusion",
     "_compute_mode",
     "_auto_format_convert",
     "_override",
@@ -141,6 +144,27 @@ def disable_memory_forwarding(mod, disable: bool):
     set_option("disable_memory_forwarding", disable)
 
 
+@property
+def elemwise_fusion(mod) -> bool:
+    r"""Get or set config whether to fuse consecutive elemwise, astype and broadcast
+    ops in eager mode. The default option is false. When enabled, such ops on the same
+    device are recorded and executed as a single compiled op when their results are
+    read or another op is applied.
+
+    Examples:
+        .. code-block::
+
+           import megengine as mge
+           mge.config.elemwise_fusion = True
+    """
+    return get_elemwise_fusion()
+
+
+@elemwise_fusion.setter
+def elemwise_fusion(mod, enabled: bool):
+    set_elemwise_fusion(enabled)
+
+
 @property
 def _compute_mode(mod):
     r"""Get or set the precision of intermediate results for conv, matmul. The default
@@ -380,6 +380,7 @@ def dump_graph(
     dump_format=None,
     model_version: int = 2,
     compat_older_version: str = None,
+    tensor_value_alignment: int = 0,
 ) -> Tuple[bytes, CompGraphDumpResult]:
     r"""serialize the computing graph of `output_vars` and get byte result.
 
@@ -414,6 +415,10 @@ def dump_graph(
         model_version: the model version of "FBS_V2", begin with version 2, this
             works only when dump format is "FBS_V2".
         compat_older_version: the specified megbrain version which is less than 8.16 for model forward compatibility, only support "8.14" currently. Default: None.
+        tensor_value_alignment: alignment in bytes of the param values relative to
+            the start of the model, so that they can be shared without copy when
+            the model file is mmaped (e.g. by ``load_and_run --mmap_model``); 0
+            to disable. this works only when dump format is "FBS_V2". Default: 0.
 
     Note:
         The underlying C++ API only accepts a var list. If a dict is given,
@@ -479,6 +484,7 @@ def dump_graph(
         dump_format,
         model_version,
         compat_older_version,
+        tensor_value_alignment,
         stat,
         inputs,
         outputs,
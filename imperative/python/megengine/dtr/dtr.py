@@ -4,10 +4,14 @@ from typing import Union
 
 from ..core import set_option as _set_option
 from ..core._imperative_rt.core2 import clear_candidates as _clear_candidates
+from ..core._imperative_rt.core2 import get_dtr_stats as _get_dtr_stats
+from ..core._imperative_rt.core2 import sync as _sync
 
 _eviction_threshold = 0
 _evictee_minimum_size = 1024 ** 2
 _enable_sqrt_sampling = False
+_enable_compression = False
+_enable_spill = False
 
 
 def _str2bytes(text: str) -> int:
@@ -109,6 +113,74 @@ def enable_sqrt_sampling(mod, value: bool):
     _set_option("enable_dtr_sqrt_sampling", _enable_sqrt_sampling)
 
 
+@property
+def enable_compression(mod):
+    r"""Get or set whether tensors could be evicted by lossless compression in host
+    memory. If enabled, the cost of recomputing a tensor, measured from the device
+    time of its producer, is compared with the cost of compressing and decompressing
+    it, and the cheaper one is chosen when the tensor is evicted.
+
+    Note:
+       Compression works well on sparse tensors, e.g. activations after relu.
+
+    Examples:
+        .. code-block::
+
+           import megengine as mge
+           mge.dtr.enable_compression = True
+    """
+    return _enable_compression
+
+
+@enable_compression.setter
+def enable_compression(mod, value: bool):
+    global _enable_compression
+    _enable_compression = value
+    _set_option("enable_dtr_compression", _enable_compression)
+
+
+@property
+def enable_spill(mod):
+    r"""Get or set whether tensors could be evicted to a local spill file. If enabled,
+    the cost of recomputing a tensor is compared with the measured cost of writing
+    and reading it back, and the cheaper one is chosen when the tensor is evicted.
+
+    Note:
+       The spill file is created in the directory given by environment variable
+       ``MEGENGINE_DTR_SPILL_DIR``, or the system temporary directory if not set.
+
+    Examples:
+        .. code-block::
+
+           import megengine as mge
+           mge.dtr.enable_spill = True
+    """
+    return _enable_spill
+
+
+@enable_spill.setter
+def enable_spill(mod, value: bool):
+    global _enable_spill
+    _enable_spill = value
+    _set_option("enable_dtr_spill", _enable_spill)
+
+
+def stats() -> dict:
+    r"""Get the counters of DTR, including the number of drops, compressions, spills,
+    recomputations and restorations, bytes compressed and spilled, and the time
+    spent on recomputation (estimated by the cost model) and on compression and
+    spill (measured) in microseconds.
+
+    Examples:
+        .. code-block::
+
+           import megengine as mge
+           print(mge.dtr.stats()["nr_recomputes"])
+    """
+    _sync()
+    return dict(_get_dtr_stats())
+
+
 def enable():
     r"""Enable to record computing path of tensors and to perform DTR policy."""
     _set_option("enable_dtr_auto_drop", 1)
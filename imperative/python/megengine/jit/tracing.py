@@ -1057,6 +1057,7 @@ class trace:
         dump_format: str = None,
         model_version: int = 2,
         compat_older_version: str = None,
+        tensor_value_alignment: int = 0,
         **kwargs
     ):
         r"""Serializes trace to file system.
@@ -1122,6 +1123,10 @@ class trace:
             model_version: the model version of FBS_V2, begin with version 2, this
                 works only when dump format is FBS_V2.
             compat_older_version: the specified megbrain version which is less than 8.16 for model forward compatibility, only support "8.14" currently. Default: None.
+            tensor_value_alignment: alignment in bytes of the param values relative to
+                the start of the model, so that they can be shared without copy when
+                the model file is mmaped (e.g. by ``load_and_run --mmap_model``); 0
+                to disable. this works only when dump format is FBS_V2. Default: 0.
 
 
         Keyword Arguments:
@@ -1291,6 +1296,7 @@ class trace:
             dump_format=dump_format,
             model_version=model_version,
             compat_older_version=compat_older_version,
+            tensor_value_alignment=tensor_value_alignment,
         )
         file.write(dump_content)
 
@@ -65,6 +65,8 @@ class Profiler(ContextDecorator):
         "profile_device": 1,
         "num_tensor_watch": 10,
         "enable_cupti": 0,
+        "profile_hw_counter": 0,
+        "profile_thread_pool": 0,
     }
     valid_formats = {"chrome_timeline.json", "memory_flow.svg"}
 
@@ -51,14 +51,14 @@ void set_default_device(const std::string& device) {
 }
 
 void init_nccl_env(const std::string& ip, int port, int nranks, int rank, int root) {
-#if MGB_ENABLE_OPR_MM
+#if MGB_ENABLE_OPR_MM && MGB_ENABLE_MEGRAY
     auto&& help = mgb::opr::BatchSendRecvHelper::getInstance();
     bool res = help->init(nranks, rank, ip, port, root);
     auto p = help->get(std::string("init_all_cards"));
 #else
     mgb_throw(
             MegBrainError,
-            "MegEngine compiled without MM opr, doesn't support init_nccl_env");
+            "MegEngine compiled without MegRay, doesn't support init_nccl_env");
 #endif
 }
 
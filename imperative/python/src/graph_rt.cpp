@@ -388,8 +388,9 @@ void init_graph_rt(py::module m) {
              bool no_change_graph, std::optional<_SerializationMetadata> metadata,
              std::optional<_SerializationFormat> dump_format,
              std::optional<int> model_version,
-             std::optional<std::string> compat_older_version, py::list& stat,
-             py::list& inputs, py::list& outputs, py::list& params) {
+             std::optional<std::string> compat_older_version,
+             size_t tensor_value_alignment, py::list& stat, py::list& inputs,
+             py::list& outputs, py::list& params) {
               std::vector<uint8_t> buf;
               ser::GraphDumpFormat format = ser::GraphDumpFormat::FLATBUFFERS_V2;
               int version = 2;
@@ -406,6 +407,7 @@ void init_graph_rt(py::module m) {
               ser::GraphDumper::DumpConfig config{
                       keep_var_name, keep_param_name, keep_opr_priority, keep_opr_name};
               config.no_change_graph = no_change_graph;
+              config.tensor_value_alignment = tensor_value_alignment;
               if (compat_older_version) {
                   mgb_assert(!no_change_graph);
                   config.compat_older_version = compat_older_version.value();
@@ -509,7 +511,8 @@ void init_graph_rt(py::module m) {
 
     py::class_<cg::ComputingGraph::Options::SeqOpt>(PyComputingGraphOptions, "SeqOpt")
             DEF_READWRITE(enable_mem_plan_opt) DEF_READWRITE(enable_mem_reuse_alloc)
-                    DEF_READWRITE(enable_seq_comp_node_opt);
+                    DEF_READWRITE(enable_seq_comp_node_opt)
+                            DEF_READWRITE(static_mem_search_budget);
 
 #undef CURRENT_CLASS
 #define CURRENT_CLASS cg::ComputingGraph::Options::GraphOpt
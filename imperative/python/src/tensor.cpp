@@ -13,6 +13,7 @@
 #include "megbrain/imperative/transformations/complex.h"
 #include "megbrain/imperative/transformations/dim_expansion.h"
 #include "megbrain/imperative/transformations/dtype_promote.h"
+#include "megbrain/imperative/transformations/elemwise_fusion.h"
 #include "megbrain/imperative/transformations/eval.h"
 #include "megbrain/imperative/transformations/format.h"
 #include "megbrain/imperative/transformations/group_comm.h"
@@ -1024,6 +1025,7 @@ void init_tensor(py::module m) {
     };
 
     m.def("clear_candidates", [channel]() { channel->clear_candidates(); });
+    m.def("get_dtr_stats", [channel]() { return channel->get_dtr_stats(); });
     m.def("set_option", [channel](std::string name, size_t value) {
         channel->set_option(name, value);
     });
@@ -1096,13 +1098,35 @@ void init_tensor(py::module m) {
         group_comm_guard = transformations.register_at<Segment::GroupComm>(commtrans);
     });
     m.def("group_end", []() { group_comm_guard.reset(); });
+
+    static std::shared_ptr<ElemwiseFusionTransformation> elemwise_fusion;
+    static std::unique_ptr<CleanupGuard<>> elemwise_fusion_guard;
+    m.def("set_elemwise_fusion", [](bool enabled) {
+        bool prev = bool(elemwise_fusion);
+        if (enabled && !prev) {
+            elemwise_fusion = std::make_shared<ElemwiseFusionTransformation>();
+            elemwise_fusion_guard =
+                    transformations.register_at<Segment::Fusion>(elemwise_fusion);
+        } else if (!enabled && prev) {
+            elemwise_fusion_guard.reset();
+            elemwise_fusion.reset();
+        }
+        return prev;
+    });
+    m.def("get_elemwise_fusion", []() { return bool(elemwise_fusion); });
     m.def("sync", [channel]() {
+        if (elemwise_fusion) {
+            elemwise_fusion->flush();
+        }
         if (channel->check_available()) {
             channel->sync();
         }
         sync_py_task_q();
     });
     m.def("full_sync", [channel]() {
+        if (elemwise_fusion) {
+            elemwise_fusion->flush();
+        }
         if (channel->check_available()) {
             channel->sync();
         }
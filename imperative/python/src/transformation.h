@@ -26,6 +26,7 @@ public:
         Scalar,
         Symbol,
         Trace,
+        Fusion,
         Eval,
         SEGMENT_COUNT,
     };
@@ -55,6 +55,8 @@ def run_around_tests():
         "enable_dtr_sqrt_sampling": get_option("enable_dtr_sqrt_sampling"),
         "dtr_eviction_threshold": get_option("dtr_eviction_threshold"),
         "dtr_evictee_minimum_size": get_option("dtr_evictee_minimum_size"),
+        "enable_dtr_compression": get_option("enable_dtr_compression"),
+        "enable_dtr_spill": get_option("enable_dtr_spill"),
         "benchmark_kernel": config.benchmark_kernel,
         "deterministic_kernel": config.deterministic_kernel,
         "compute_mode": config._compute_mode,
@@ -78,6 +80,8 @@ def run_around_tests():
         "enable_dtr_sqrt_sampling": get_option("enable_dtr_sqrt_sampling"),
         "dtr_eviction_threshold": get_option("dtr_eviction_threshold"),
         "dtr_evictee_minimum_size": get_option("dtr_evictee_minimum_size"),
+        "enable_dtr_compression": get_option("enable_dtr_compression"),
+        "enable_dtr_spill": get_option("enable_dtr_spill"),
         "benchmark_kernel": config.benchmark_kernel,
         "deterministic_kernel": config.deterministic_kernel,
         "compute_mode": config._compute_mode,
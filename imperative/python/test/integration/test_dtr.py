@@ -1,4 +1,7 @@
 import multiprocessing as mp
+import os
+import subprocess
+import sys
 
 import numpy as np
 import pytest
@@ -163,3 +166,47 @@ def test_dtr_drop_copy_dev_tensor():
 def test_dtr_drop_tensor():
     for i in range(50):
         test_dtr_drop_copy_dev_tensor()
+
+
+def test_dtr_offload_cpu(tmp_path):
+    # used memory of cpu comp nodes is tracked by the size class allocator
+    prog = """
+import numpy as np
+import megengine as mge
+import megengine.functional as F
+from megengine.autodiff import GradManager
+
+mge.set_default_device("cpux")
+np.random.seed(0)
+data = np.random.randn(64, 256).astype("float32")
+weights = [np.random.randn(256, 256).astype("float32") / 16 for _ in range(8)]
+
+def run():
+    x = mge.tensor(data)
+    ws = [mge.tensor(w) for w in weights]
+    gm = GradManager().attach(ws)
+    with gm:
+        y = x
+        for w in ws:
+            y = F.relu(F.matmul(y, w))
+        gm.backward(y.sum())
+    return [w.grad.numpy() for w in ws]
+
+expect = run()
+mge.dtr.evictee_minimum_size = 1024
+mge.dtr.eviction_threshold = 1024
+mge.dtr.enable_compression = True
+mge.dtr.enable_spill = True
+mge.dtr.enable()
+for _ in range(3):
+    for g, e in zip(run(), expect):
+        np.testing.assert_allclose(g, e, rtol=1e-5)
+stats = mge.dtr.stats()
+mge.dtr.disable()
+assert stats["nr_compressions"] + stats["nr_spills"] > 0, stats
+assert stats["nr_restores"] > 0, stats
+"""
+    env = dict(os.environ)
+    env["MGB_CPU_SIZE_CLASS_ALLOC"] = "1"
+    env["MEGENGINE_DTR_SPILL_DIR"] = str(tmp_path)
+    subprocess.check_call([sys.executable, "-c", prog], env=env)
@@ -122,3 +122,30 @@ def test_async_error():
             F.utils._simulate_error()
     finally:
         mge.config.async_level = orig_lvl
+
+
+def test_elemwise_fusion():
+    x_np = np.random.rand(16, 32).astype("float32")
+    y_np = np.random.rand(32).astype("float32")
+    x, y = mge.tensor(x_np), mge.tensor(y_np)
+    orig = mge.config.elemwise_fusion
+    try:
+        mge.config.elemwise_fusion = True
+        a = F.relu(x * 2 - y)
+        # never read, thus never computed
+        unused = a + 1
+        del unused
+        b = (a - x).astype("float16")
+        c = F.broadcast_to(y, (16, 32)) * b.astype("float32")
+        assert c.shape == (16, 32)
+        assert c.dtype == np.float32
+        a_np = np.maximum(x_np * 2 - y_np, 0)
+        b_np = (a_np - x_np).astype("float16")
+        c_np = np.broadcast_to(y_np, (16, 32)) * b_np.astype("float32")
+        np.testing.assert_allclose(c.numpy(), c_np, rtol=1e-3, atol=1e-3)
+        np.testing.assert_allclose(a.numpy(), a_np, rtol=1e-6)
+        # ops on small tensors are left to host compute
+        s = mge.tensor([1, 32], dtype="int32") * 2
+        np.testing.assert_equal(F.reshape(x, s * 2).shape, (4, 128))
+    finally:
+        mge.config.elemwise_fusion = orig
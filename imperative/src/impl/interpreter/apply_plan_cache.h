@@ -0,0 +1,126 @@
+#pragma once
+
+#include <list>
+#include <optional>
+#include <unordered_map>
+
+#include "megbrain/comp_node.h"
+#include "megbrain/imperative/op_def.h"
+#include "megbrain/utils/hash.h"
+
+namespace mgb::imperative::interpreter::intl {
+
+/*!
+ * \brief result of dispatching an op on inputs of given layouts and comp nodes
+ *
+ * Only plans inferred without any input value are kept, so that a plan is fully
+ * determined by the op and the layouts and comp nodes of its inputs; then
+ * repeated applies on inputs of the same layouts could skip attribute inference
+ * (and the proxy graph behind it) altogether.
+ */
+struct ApplyPlan {
+    SmallVector<LogicalTensorDesc> output_descs;
+};
+
+/*!
+ * \brief LRU cache of ApplyPlan, which is only accessed by the channel thread
+ */
+class ApplyPlanCache final : public CompNodeDepedentObject {
+public:
+    struct Key {
+        std::shared_ptr<OpDef> op;
+        SmallVector<LogicalTensorDesc> inputs;
+        size_t hash;
+
+        bool operator==(const Key& rhs) const {
+            if (hash != rhs.hash || inputs.size() != rhs.inputs.size() ||
+                !op->is_same(*rhs.op)) {
+                return false;
+            }
+            for (size_t i = 0; i < inputs.size(); ++i) {
+                auto &&lhs_desc = inputs[i], &&rhs_desc = rhs.inputs[i];
+                if (lhs_desc.comp_node != rhs_desc.comp_node ||
+                    !lhs_desc.layout.eq_layout(rhs_desc.layout)) {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        struct hash_t {
+            size_t operator()(const Key& key) const { return key.hash; }
+        };
+    };
+
+    /*!
+     * \brief make the key of applying \p op on \p inputs, or nothing if the plan
+     *      would depend on input values or unknown shapes
+     */
+    static std::optional<Key> make_key(
+            const std::shared_ptr<OpDef>& op,
+            const SmallVector<LogicalTensorDesc>& inputs) {
+        XXHash state;
+        size_t op_hash = op->hash();
+        state.update(&op_hash, sizeof(op_hash));
+        for (auto&& i : inputs) {
+            if (!i.value.empty() || !i.layout.ndim) {
+                return std::nullopt;
+            }
+            size_t data[3 + TensorLayout::MAX_NDIM * 2];
+            size_t length = 0;
+            data[length++] = mgb::hash(i.layout.dtype.handle());
+            data[length++] = mgb::hash(i.comp_node);
+            data[length++] = i.layout.ndim;
+            for (size_t j = 0; j < i.layout.ndim; ++j) {
+                data[length++] = i.layout.shape[j];
+                data[length++] = i.layout.stride[j];
+            }
+            state.update(data, length * sizeof(size_t));
+        }
+        return Key{op, inputs, state.digest()};
+    }
+
+    //! get the plan of \p key and mark it as recently used, or nullptr if missing
+    const ApplyPlan* get(const Key& key) {
+        auto iter = m_map.find(key);
+        if (iter == m_map.end()) {
+            return nullptr;
+        }
+        m_entries.splice(m_entries.begin(), m_entries, iter->second);
+        return &iter->second->second;
+    }
+
+    //! insert the plan of \p key and evict the least recently used plans beyond
+    //! \p capacity
+    void put(Key key, ApplyPlan plan, size_t capacity) {
+        check_not_finalized();
+        if (!capacity || m_map.count(key)) {
+            return;
+        }
+        m_entries.emplace_front(std::move(key), std::move(plan));
+        m_map.emplace(m_entries.front().first, m_entries.begin());
+        while (m_entries.size() > capacity) {
+            m_map.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+    }
+
+    size_t size() const { return m_entries.size(); }
+
+    void clear() {
+        m_map.clear();
+        m_entries.clear();
+    }
+
+private:
+    using Entry = std::pair<Key, ApplyPlan>;
+    std::list<Entry> m_entries;
+    std::unordered_map<Key, std::list<Entry>::iterator, Key::hash_t> m_map;
+
+    std::shared_ptr<void> on_comp_node_finalize() override {
+        clear();
+        return {};
+    }
+};
+
+}  // namespace mgb::imperative::interpreter::intl
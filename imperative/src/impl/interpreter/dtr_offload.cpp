@@ -0,0 +1,282 @@
+#include "./dtr_offload.h"
+
+#include <algorithm>
+
+#include "megbrain/common.h"
+#include "megbrain/utils/zero_word_codec.h"
+
+#ifndef WIN32
+#include <unistd.h>
+#endif
+
+using namespace mgb;
+using namespace imperative;
+using namespace interpreter::intl;
+
+namespace {
+
+//! weight of the latest sample in moving averages
+constexpr double MOMENTUM = 0.2;
+
+//! number of ops of each type which are always measured
+constexpr size_t NR_WARMUP_SAMPLES = 4;
+
+//! then one op out of SAMPLE_INTERVAL ops of the same type is measured
+constexpr size_t SAMPLE_INTERVAL = 16;
+
+}  // anonymous namespace
+
+/* ======================== DTRStats ======================== */
+
+std::unordered_map<std::string, size_t> DTRStats::dump() const {
+    return {
+            {"nr_drops", nr_drops.load()},
+            {"nr_compressions", nr_compressions.load()},
+            {"nr_spills", nr_spills.load()},
+            {"nr_recomputes", nr_recomputes.load()},
+            {"nr_restores", nr_restores.load()},
+            {"bytes_compressed", bytes_compressed.load()},
+            {"bytes_compressed_kept", bytes_compressed_kept.load()},
+            {"bytes_spilled", bytes_spilled.load()},
+            {"recompute_time_us", recompute_time_us.load()},
+            {"offload_time_us", offload_time_us.load()},
+    };
+}
+
+void DTRStats::reset() {
+    for (auto* i :
+         {&nr_drops, &nr_compressions, &nr_spills, &nr_recomputes, &nr_restores,
+          &bytes_compressed, &bytes_compressed_kept, &bytes_spilled,
+          &recompute_time_us, &offload_time_us}) {
+        i->store(0);
+    }
+}
+
+/* ======================== SpillFile ======================== */
+
+SpillFile::SpillFile() {
+    if (const char* dir = MGB_GETENV("MEGENGINE_DTR_SPILL_DIR")) {
+        m_path = ssprintf(
+                "%s/megengine_dtr_spill_%p_XXXXXX", dir, static_cast<void*>(this));
+#ifndef WIN32
+        int fd = mkstemp(&m_path[0]);
+        mgb_assert(fd >= 0, "failed to create spill file %s", m_path.c_str());
+        m_file = fdopen(fd, "w+b");
+#else
+        m_file = fopen(m_path.c_str(), "w+b");
+#endif
+        mgb_assert(m_file, "failed to open spill file %s", m_path.c_str());
+#ifndef WIN32
+        // the file would be reclaimed by the system once closed
+        unlink(m_path.c_str());
+        m_path.clear();
+#endif
+    } else {
+        m_file = std::tmpfile();
+        mgb_assert(m_file, "failed to create temporary spill file");
+    }
+}
+
+SpillFile::~SpillFile() {
+    fclose(m_file);
+    if (!m_path.empty()) {
+        remove(m_path.c_str());
+    }
+}
+
+void SpillFile::seek(size_t offset) {
+#ifdef WIN32
+    int ret = _fseeki64(m_file, offset, SEEK_SET);
+#else
+    int ret = fseeko(m_file, offset, SEEK_SET);
+#endif
+    mgb_assert(!ret, "failed to seek spill file to %zu", offset);
+}
+
+size_t SpillFile::write(const void* ptr, size_t size) {
+    // first fit in free extents
+    size_t offset = m_size;
+    for (auto iter = m_free.begin(); iter != m_free.end(); ++iter) {
+        if (iter->second >= size) {
+            offset = iter->first;
+            if (iter->second > size) {
+                m_free.emplace(offset + size, iter->second - size);
+            }
+            m_free.erase(iter);
+            break;
+        }
+    }
+    seek(offset);
+    mgb_assert(
+            fwrite(ptr, 1, size, m_file) == size,
+            "failed to write %zu bytes to spill file", size);
+    m_size = std::max(m_size, offset + size);
+    return offset;
+}
+
+void SpillFile::read(size_t offset, void* ptr, size_t size) {
+    fflush(m_file);
+    seek(offset);
+    mgb_assert(
+            fread(ptr, 1, size, m_file) == size,
+            "failed to read %zu bytes from spill file", size);
+}
+
+void SpillFile::release(size_t offset, size_t size) {
+    if (!size) {
+        return;
+    }
+    auto iter = m_free.emplace(offset, size).first;
+    auto next = std::next(iter);
+    if (next != m_free.end() && iter->first + iter->second == next->first) {
+        iter->second += next->second;
+        m_free.erase(next);
+    }
+    if (iter != m_free.begin()) {
+        auto prev = std::prev(iter);
+        if (prev->first + prev->second == iter->first) {
+            prev->second += iter->second;
+            m_free.erase(iter);
+        }
+    }
+}
+
+/* ======================== OffloadedValue ======================== */
+
+std::unique_ptr<OffloadedValue> OffloadedValue::compress(
+        const void* ptr, size_t size, double max_ratio) {
+    std::unique_ptr<OffloadedValue> ret{new OffloadedValue()};
+    ret->m_size = size;
+    if (!ZeroWordCodec::encode(
+                ptr, size, static_cast<size_t>(size * max_ratio), ret->m_compressed)) {
+        return nullptr;
+    }
+    return ret;
+}
+
+std::unique_ptr<OffloadedValue> OffloadedValue::spill(
+        std::shared_ptr<SpillFile> file, const void* ptr, size_t size) {
+    std::unique_ptr<OffloadedValue> ret{new OffloadedValue()};
+    ret->m_size = size;
+    ret->m_file_offset = file->write(ptr, size);
+    ret->m_file = std::move(file);
+    return ret;
+}
+
+OffloadedValue::~OffloadedValue() {
+    if (m_file) {
+        m_file->release(m_file_offset, m_size);
+    }
+}
+
+void OffloadedValue::restore(void* ptr) const {
+    if (m_file) {
+        m_file->read(m_file_offset, ptr, m_size);
+        return;
+    }
+    ZeroWordCodec::decode(m_compressed.data(), m_size, ptr);
+}
+
+/* ======================== DTRCostModel ======================== */
+
+void DTRCostModel::Throughput::update(double secs, size_t size) {
+    if (!size) {
+        return;
+    }
+    double value = secs / size;
+    if (nr_samples++) {
+        secs_per_byte = secs_per_byte * (1 - MOMENTUM) + value * MOMENTUM;
+    } else {
+        secs_per_byte = value;
+    }
+}
+
+bool DTRCostModel::should_sample(const OpDef& op) {
+    auto&& stat = m_op_stats[op.dyn_typeinfo()];
+    return stat.nr_calls++ < NR_WARMUP_SAMPLES || stat.nr_calls % SAMPLE_INTERVAL == 0;
+}
+
+void DTRCostModel::add_sample(
+        const OpDef& op, size_t traffic, std::shared_ptr<CompNode::Event> start,
+        std::shared_ptr<CompNode::Event> end) {
+    m_samples.push_back({op.dyn_typeinfo(), traffic, std::move(start), std::move(end)});
+}
+
+void DTRCostModel::poll() {
+    // samples on the same comp node finish in order, so that polling the front is
+    // enough for the common case of a single comp node
+    while (!m_samples.empty() && m_samples.front().end->finished()) {
+        auto&& sample = m_samples.front();
+        double secs = sample.start->elapsed_time_until(*sample.end);
+        m_op_stats[sample.type].compute.update(secs, sample.traffic);
+        m_samples.pop_front();
+    }
+}
+
+double DTRCostModel::op_cost(const OpDef& op, size_t traffic) const {
+    auto iter = m_op_stats.find(op.dyn_typeinfo());
+    if (iter == m_op_stats.end()) {
+        return OpStat{}.compute.estimate(traffic);
+    }
+    return iter->second.compute.estimate(traffic);
+}
+
+DTRCostModel::Choice DTRCostModel::choose(
+        size_t size, double recompute_cost, const OpDef* producer, bool allow_compress,
+        bool allow_spill) const {
+    Choice best{NR_METHOD, -1};
+    auto update = [&](Method method, double cost) {
+        if (best.method == NR_METHOD || cost < best.cost) {
+            best = {method, cost};
+        }
+    };
+    if (recompute_cost >= 0) {
+        update(RECOMPUTE, recompute_cost);
+    }
+    if (allow_compress) {
+        double ratio = m_compress_ratio;
+        if (producer) {
+            auto iter = m_op_stats.find(producer->dyn_typeinfo());
+            if (iter != m_op_stats.end()) {
+                ratio = iter->second.compress_ratio;
+            }
+        }
+        if (ratio < MAX_COMPRESS_RATIO) {
+            // only part of the memory is saved by compression
+            double cost = m_compress.estimate(size) + m_decompress.estimate(size);
+            update(COMPRESS, cost / (1 - ratio));
+        }
+    }
+    if (allow_spill) {
+        update(SPILL, m_spill_write.estimate(size) + m_spill_read.estimate(size));
+    }
+    return best;
+}
+
+void DTRCostModel::record_compress(
+        const OpDef* producer, size_t size, size_t kept, double secs) {
+    m_compress.update(secs, size);
+    if (!size) {
+        return;
+    }
+    double ratio = static_cast<double>(kept) / size;
+    m_compress_ratio = m_compress_ratio * (1 - MOMENTUM) + ratio * MOMENTUM;
+    if (producer) {
+        auto&& stat = m_op_stats[producer->dyn_typeinfo()];
+        stat.compress_ratio = stat.compress_ratio * (1 - MOMENTUM) + ratio * MOMENTUM;
+    }
+}
+
+void DTRCostModel::record_decompress(size_t size, double secs) {
+    m_decompress.update(secs, size);
+}
+
+void DTRCostModel::record_spill(size_t size, double write_secs) {
+    m_spill_write.update(write_secs, size);
+}
+
+void DTRCostModel::record_load(size_t size, double read_secs) {
+    m_spill_read.update(read_secs, size);
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
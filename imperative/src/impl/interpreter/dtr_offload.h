@@ -0,0 +1,185 @@
+#pragma once
+
+#include <atomic>
+#include <cstdio>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "megbrain/comp_node.h"
+#include "megbrain/imperative/op_def.h"
+
+namespace mgb::imperative::interpreter::intl {
+
+/*!
+ * \brief counters of DTR evictions, which are written by the worker thread and
+ * could be read from any thread
+ */
+struct DTRStats {
+    std::atomic_size_t nr_drops{0};
+    std::atomic_size_t nr_compressions{0};
+    std::atomic_size_t nr_spills{0};
+    std::atomic_size_t nr_recomputes{0};
+    std::atomic_size_t nr_restores{0};
+    //! bytes of tensors evicted by compression and the compressed bytes kept
+    std::atomic_size_t bytes_compressed{0};
+    std::atomic_size_t bytes_compressed_kept{0};
+    std::atomic_size_t bytes_spilled{0};
+    //! estimated time spent on recomputation, in microseconds
+    std::atomic_size_t recompute_time_us{0};
+    //! measured time spent on (de)compression and spill file io, in microseconds
+    std::atomic_size_t offload_time_us{0};
+
+    std::unordered_map<std::string, size_t> dump() const;
+    void reset();
+};
+
+/*!
+ * \brief an unlinked local file holding spilled tensors
+ *
+ * Space of released tensors is reused by later spills, adjacent free extents are
+ * merged. The file is created in $MEGENGINE_DTR_SPILL_DIR if set, or the system
+ * temporary directory otherwise.
+ */
+class SpillFile : public NonCopyableObj {
+public:
+    SpillFile();
+    ~SpillFile();
+
+    //! write \p size bytes and return the offset
+    size_t write(const void* ptr, size_t size);
+    void read(size_t offset, void* ptr, size_t size);
+    void release(size_t offset, size_t size);
+
+private:
+    FILE* m_file = nullptr;
+    std::string m_path;
+    size_t m_size = 0;
+    //! offset to size of free extents
+    std::map<size_t, size_t> m_free;
+
+    void seek(size_t offset);
+};
+
+/*!
+ * \brief content of a tensor which is evicted by compression or spill
+ *
+ * Compression is lossless by ZeroWordCodec, which works well on activations after
+ * relu, dropout or masking.
+ */
+class OffloadedValue : public NonCopyableObj {
+public:
+    /*!
+     * \brief compress \p size bytes at \p ptr, or return nullptr if the compressed
+     *      size would exceed \p max_ratio of the original one
+     */
+    static std::unique_ptr<OffloadedValue> compress(
+            const void* ptr, size_t size, double max_ratio);
+    static std::unique_ptr<OffloadedValue> spill(
+            std::shared_ptr<SpillFile> file, const void* ptr, size_t size);
+
+    ~OffloadedValue();
+
+    //! write the original content to \p ptr
+    void restore(void* ptr) const;
+
+    //! bytes kept in host memory
+    size_t kept_size() const { return m_compressed.size(); }
+
+private:
+    size_t m_size = 0;
+    std::vector<uint8_t> m_compressed;
+    std::shared_ptr<SpillFile> m_file;
+    size_t m_file_offset = 0;
+
+    OffloadedValue() = default;
+};
+
+/*!
+ * \brief choose how to evict a tensor by the measured costs of recomputation,
+ * compression and spill
+ *
+ * Device time of ops is sampled by the timer events of the profiler, which are
+ * polled without blocking; (de)compression and file io are timed on host. All
+ * costs are kept as exponential moving averages of seconds per byte, so that the
+ * cost of recomputing a tensor (with its evicted neighbors) could be compared with
+ * the round trip of compressing or spilling it.
+ */
+class DTRCostModel {
+public:
+    //! max ratio of compressed size to original size to keep the compressed value
+    static constexpr double MAX_COMPRESS_RATIO = 0.6;
+
+    enum Method { RECOMPUTE, COMPRESS, SPILL, NR_METHOD };
+
+    struct Choice {
+        Method method;
+        //! estimated time to pay per byte of memory saved
+        double cost;
+    };
+
+    //! whether device time of the op should be measured
+    bool should_sample(const OpDef& op);
+
+    void add_sample(
+            const OpDef& op, size_t traffic, std::shared_ptr<CompNode::Event> start,
+            std::shared_ptr<CompNode::Event> end);
+
+    //! consume finished samples
+    void poll();
+
+    //! estimated time of an op which reads and writes \p traffic bytes
+    double op_cost(const OpDef& op, size_t traffic) const;
+
+    /*!
+     * \brief choose the cheapest method to evict a tensor of \p size bytes
+     *
+     * \param recompute_cost cost to recompute the tensor, or negative if it could
+     *      not be recomputed
+     * \param producer op producing the tensor, used to estimate compression ratio
+     */
+    Choice choose(
+            size_t size, double recompute_cost, const OpDef* producer,
+            bool allow_compress, bool allow_spill) const;
+
+    void record_compress(const OpDef* producer, size_t size, size_t kept, double secs);
+    void record_decompress(size_t size, double secs);
+    void record_spill(size_t size, double write_secs);
+    void record_load(size_t size, double read_secs);
+
+private:
+    struct Throughput {
+        double secs_per_byte;
+        size_t nr_samples = 0;
+
+        explicit Throughput(double init) : secs_per_byte(init) {}
+
+        void update(double secs, size_t size);
+        double estimate(size_t size) const { return secs_per_byte * size; }
+    };
+
+    struct OpStat {
+        // initial guess of about 1GB/s
+        Throughput compute{1e-9};
+        //! compressed size / original size of outputs
+        double compress_ratio = 0.5;
+        size_t nr_calls = 0;
+    };
+
+    struct Sample {
+        Typeinfo* type;
+        size_t traffic;
+        std::shared_ptr<CompNode::Event> start, end;
+    };
+
+    std::unordered_map<Typeinfo*, OpStat> m_op_stats;
+    std::deque<Sample> m_samples;
+    double m_compress_ratio = 0.5;
+    Throughput m_compress{1e-9}, m_decompress{5e-10}, m_spill_write{2e-9},
+            m_spill_read{1e-9};
+};
+
+}  // namespace mgb::imperative::interpreter::intl
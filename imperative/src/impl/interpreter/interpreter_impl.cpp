@@ -3,12 +3,14 @@
 #include "range/v3/all.hpp"
 
 #include "megbrain/common.h"
+#include "megbrain/comp_node_env.h"
 #include "megbrain/imperative/opr_utility.h"
 #include "megbrain/imperative/ops/autogen.h"
 #include "megbrain/imperative/ops/backward_graph.h"
 #include "megbrain/imperative/ops/opr_attr.h"
 #include "megbrain/imperative/ops/utility.h"
 #include "megbrain/imperative/utils/to_string.h"
+#include "megbrain/utils/timer.h"
 
 #include "../blob_manager_impl.h"
 #include "../event_pool.h"
@@ -253,6 +255,36 @@ void ChannelImpl::drop(Handle handle) {
     }
 }
 
+std::tuple<SmallVector<LogicalTensorDesc>, bool> ChannelImpl::infer_output_attrs(
+        const std::shared_ptr<OpDef>& op,
+        const SmallVector<LogicalTensorDesc>& input_descs) {
+    auto& state = get_channel_state();
+    auto capacity = state.options.apply_plan_cache_size;
+    std::optional<ApplyPlanCache::Key> key;
+    if (capacity) {
+        key = ApplyPlanCache::make_key(op, input_descs);
+    }
+    if (key) {
+        if (auto plan = m_apply_plan_cache.get(*key)) {
+            MGB_RECORD_EVENT(ApplyPlanCacheEvent, true);
+            return {plan->output_descs, true};
+        }
+        MGB_RECORD_EVENT(ApplyPlanCacheEvent, false);
+    }
+    auto [output_descs, validated] =
+            OpDef::infer_output_attrs_fallible(*op, input_descs);
+    MGB_RECORD_EVENT(ShapeInferEvent, validated);
+    // plans with partially inferred or value-dependent outputs are not reusable
+    bool cacheable = key && validated;
+    for (auto&& desc : output_descs) {
+        cacheable &= desc.value.empty();
+    }
+    if (cacheable) {
+        m_apply_plan_cache.put(std::move(*key), {output_descs}, capacity);
+    }
+    return {std::move(output_descs), validated};
+}
+
 void ChannelImpl::dispatch_default_cpu(
         std::shared_ptr<OpDef> op, const SmallVector<TensorInfo*>& input_infos,
         const SmallVector<LogicalTensorDesc>& input_descs,
@@ -264,9 +296,7 @@ void ChannelImpl::dispatch_default_cpu(
         guard.emplace(op->trait()->make_name(*op), &state.stack_manager);
     }
 
-    auto [output_descs, validated] =
-            OpDef::infer_output_attrs_fallible(*op, input_descs);
-    MGB_RECORD_EVENT(ShapeInferEvent, validated);
+    auto [output_descs, validated] = infer_output_attrs(op, input_descs);
 
     SmallVector<DeviceTensorND> input_tensornds;
     CompNode output_cn;
@@ -361,9 +391,7 @@ void ChannelImpl::dispatch_kernel(
         guard.emplace(op->trait()->make_name(*op), &state.stack_manager);
     }
 
-    auto [output_descs, validated] =
-            OpDef::infer_output_attrs_fallible(*op, input_descs);
-    MGB_RECORD_EVENT(ShapeInferEvent, validated);
+    auto [output_descs, validated] = infer_output_attrs(op, input_descs);
 
     SmallVector<TensorInfo*> output_infos;
     output_infos.reserve(output_descs.size());
@@ -624,6 +652,12 @@ void ChannelImpl::clear_candidates() {
     m_dtr.candidates.clear();
 }
 
+std::unordered_map<std::string, size_t> ChannelImpl::get_dtr_stats() {
+    MGB_LOCK_GUARD(m_spin);
+    assert_available();
+    return m_dtr.stats.dump();
+}
+
 TensorInfo* ChannelImpl::alloc() {
     auto& state = get_channel_state();
     auto info = [this] {
@@ -662,6 +696,7 @@ void ChannelImpl::do_drop(TensorInfo* ptr, bool user = false) {
     }
     ptr->evict_type = EvictType::DROP;
     ptr->status = TensorInfo::Dropped;
+    m_dtr.stats.nr_drops++;
     release_tensor(ptr);
 }
 
@@ -777,7 +812,90 @@ void ChannelImpl::regenerate(TensorInfo* dest) {
                  "dtr"});
         if (!m_applying)
             flush_apply_stack();
+    } else if (dest->evict_type != EvictType::NONE) {
+        restore_tensor(dest);
+    }
+}
+
+bool ChannelImpl::dtr_offload_enabled() {
+    auto& options = get_worker_state().options;
+    return options.enable_dtr_auto_drop &&
+           (options.enable_dtr_compression || options.enable_dtr_spill);
+}
+
+bool ChannelImpl::offload_tensor(TensorInfo* dest, DTRCostModel::Method method) {
+    auto dv = dest->ptr->dev_tensor();
+    mgb_assert(dv.layout().is_contiguous());
+    size_t size = dv.layout().span().dist_byte();
+    auto comp_node = dv.comp_node();
+    HostTensorND staging;
+    const void* data;
+    if (comp_node.device_type() == CompNode::DeviceType::CPU) {
+        // memory of cpu comp nodes could be read in place once the kernels are done
+        comp_node.sync();
+        data = dv.raw_ptr();
+    } else {
+        staging.copy_from(dv).sync();
+        data = staging.raw_ptr();
+    }
+    auto&& stats = m_dtr.stats;
+    auto* producer = dest->producer ? dest->producer->op.get() : nullptr;
+    std::unique_ptr<OffloadedValue> value;
+    RealTimer timer;
+    if (method == DTRCostModel::COMPRESS) {
+        value = OffloadedValue::compress(data, size, DTRCostModel::MAX_COMPRESS_RATIO);
+        double secs = timer.get_secs();
+        stats.offload_time_us += static_cast<size_t>(secs * 1e6);
+        m_dtr.cost_model.record_compress(
+                producer, size, value ? value->kept_size() : size, secs);
+        if (!value) {
+            dest->incompressible = true;
+            return false;
+        }
+        stats.nr_compressions++;
+        stats.bytes_compressed += size;
+        stats.bytes_compressed_kept += value->kept_size();
+        dest->evict_type = EvictType::COMPRESS;
+    } else {
+        mgb_assert(method == DTRCostModel::SPILL);
+        if (!m_dtr.spill_file) {
+            m_dtr.spill_file = std::make_shared<SpillFile>();
+        }
+        value = OffloadedValue::spill(m_dtr.spill_file, data, size);
+        double secs = timer.get_secs();
+        stats.offload_time_us += static_cast<size_t>(secs * 1e6);
+        m_dtr.cost_model.record_spill(size, secs);
+        stats.nr_spills++;
+        stats.bytes_spilled += size;
+        dest->evict_type = EvictType::SPILL;
+    }
+    dest->offloaded = std::move(value);
+    dest->status = TensorInfo::Dropped;
+    release_tensor(dest);
+    return true;
+}
+
+void ChannelImpl::restore_tensor(TensorInfo* dest) {
+    mgb_assert(dest->offloaded, "tensor %p has no offloaded value", dest);
+    auto comp_node = dest->desc.comp_node;
+    TensorLayout layout = dest->desc.layout;
+    layout.init_contiguous_stride();
+    HostTensorND staging{comp_node, layout};
+    RealTimer timer;
+    dest->offloaded->restore(staging.raw_ptr());
+    double secs = timer.get_secs();
+    size_t size = layout.span().dist_byte();
+    if (dest->evict_type == EvictType::COMPRESS) {
+        m_dtr.cost_model.record_decompress(size, secs);
+    } else {
+        m_dtr.cost_model.record_load(size, secs);
     }
+    m_dtr.stats.offload_time_us += static_cast<size_t>(secs * 1e6);
+    m_dtr.stats.nr_restores++;
+    auto tensor = Tensor::make(layout, comp_node);
+    tensor->dev_tensor().copy_from_fixlayout(staging).sync();
+    dest->offloaded.reset();
+    produce_tensor(dest, std::move(tensor));
 }
 
 void ChannelImpl::do_apply_op(const ApplyOp& cmd, std::string reason) {
@@ -855,6 +973,21 @@ void ChannelImpl::do_apply_op(const ApplyOp& cmd, std::string reason) {
             }
         }
     }
+    // the multi-thread kernels on cpu are submitted to the thread pool by the
+    // dispatcher thread of the comp node, so the trace is tagged there as what
+    // ProfilerPlugin::trace_thread_pool does for graph oprs
+    SmallVector<CompNode> pool_devices;
+    if (Profiler::is_profiling() && Profiler::get_option("profile_thread_pool", 0)) {
+        for (auto&& i : concat(cmd.inputs, cmd.outputs)) {
+            if (i == nullptr || count(pool_devices, i->desc.comp_node) != 0) {
+                continue;
+            }
+            auto&& env = CompNodeEnv::from_comp_node(i->desc.comp_node);
+            if (env.property().type == CompNode::DeviceType::CPU) {
+                pool_devices.push_back(i->desc.comp_node);
+            }
+        }
+    }
     for (auto* input : cmd.inputs) {
         auto input_id = input->id;
         MGB_RECORD_EVENT(OpInputEvent, input_id);
@@ -870,6 +1003,18 @@ void ChannelImpl::do_apply_op(const ApplyOp& cmd, std::string reason) {
                 (Profiler::get_option("profile_device", 0)), RecordDeviceEvent,
                 Timer::record_device(device));
     }
+    // sample device time of the op for the cost model of dtr
+    std::shared_ptr<CompNode::Event> cost_start, cost_end;
+    CompNode cost_comp_node;
+    if (dtr_offload_enabled() && !cmd.inputs.empty() &&
+        m_dtr.cost_model.should_sample(*cmd.op)) {
+        cost_comp_node = cmd.inputs[0]->desc.comp_node;
+        cost_start = Timer::record_device(cost_comp_node);
+    }
+    for (auto&& device : pool_devices) {
+        CompNodeEnv::from_comp_node(device).cpu_env().dispatch(
+                [apply_id]() { ThreadPoolTrace::set_tag(apply_id); });
+    }
     // Apply op
     SmallVector<LogicalTensorDesc> output_descs;
     bool validated = cmd.validated;
@@ -888,6 +1033,9 @@ void ChannelImpl::do_apply_op(const ApplyOp& cmd, std::string reason) {
     auto outputs = apply_on_physical_tensor(
             apply_on_physical_tensor, *cmd.op, std::move(inputs), output_descs,
             validated);
+    if (cost_start) {
+        cost_end = Timer::record_device(cost_comp_node);
+    }
     // After execute
     for (auto&& [device, kernel_id] : kernels) {
         MGB_RECORD_EVENT_IF(
@@ -895,6 +1043,15 @@ void ChannelImpl::do_apply_op(const ApplyOp& cmd, std::string reason) {
                 Timer::record_device(device));
         MGB_RECORD_EVENT(KernelLaunchFinishEvent, apply_id, kernel_id, device);
     }
+    for (auto&& device : pool_devices) {
+        CompNodeEnv::from_comp_node(device).cpu_env().dispatch([apply_id]() {
+            ThreadPoolTrace::set_tag(0);
+            auto records = ThreadPoolTrace::collect(apply_id);
+            if (!records.empty()) {
+                MGB_RECORD_EVENT(OpThreadPoolTraceEvent, apply_id, std::move(records));
+            }
+        });
+    }
     // End profiling operator
     mgb_assert(outputs.size() == cmd.outputs.size());
     for (size_t i = 0; i < outputs.size(); ++i) {
@@ -922,6 +1079,17 @@ void ChannelImpl::do_apply_op(const ApplyOp& cmd, std::string reason) {
             estimate_compute_time += i->blob()->size();
         }
         m_dtr.estimate_timestamp += estimate_compute_time / 1e8;
+        if (dtr_offload_enabled()) {
+            // compare recomputation with compression and spill in seconds
+            auto&& cost_model = m_dtr.cost_model;
+            if (cost_end) {
+                cost_model.add_sample(
+                        *cmd.op, estimate_compute_time, std::move(cost_start),
+                        std::move(cost_end));
+            }
+            cost_model.poll();
+            estimate_compute_time = cost_model.op_cost(*cmd.op, estimate_compute_time);
+        }
         for (auto i : cmd.outputs) {
             if (i != nullptr) {
                 i->compute_time = estimate_compute_time;
@@ -974,6 +1142,11 @@ void ChannelImpl::flush_apply_stack() {
             MGB_RECORD_EVENT(
                     TensorCommandFinishEvent, recomp_backup->id,
                     TensorCommandKind::ReGen);
+            m_dtr.stats.nr_recomputes++;
+            if (dtr_offload_enabled()) {
+                m_dtr.stats.recompute_time_us +=
+                        static_cast<size_t>(recomp_backup->compute_time * 1e6);
+            }
             for (auto o : cmd_backup.outputs) {
                 if (o) {
                     m_dtr.update_dsu_after_recompute(o);
@@ -996,22 +1169,34 @@ bool ChannelImpl::auto_evict(size_t force_num) {
            force_num > 0) {
         MGB_RECORD_EVENT(AutoEvictEvent);
         sample_on_device(m_dtr.comp_node, false);
-        auto best = m_dtr.find_best_tensor(state.options.enable_dtr_sqrt_sampling);
+        bool offload = dtr_offload_enabled();
+        auto method = DTRCostModel::RECOMPUTE;
+        auto best = m_dtr.find_best_tensor(
+                state.options.enable_dtr_sqrt_sampling,
+                offload && state.options.enable_dtr_compression,
+                offload && state.options.enable_dtr_spill, method);
         if (!best) {
             MGB_RECORD_EVENT(AutoEvictFinishEvent);
             break;
         }
-        if (best->ptr.unique() && best->ptr->blob().unique()) {
+        bool unique = best->ptr.unique() && best->ptr->blob().unique();
+        if (method == DTRCostModel::RECOMPUTE) {
+            do_drop(best);
+            if (best->evict_type == EvictType::DROP) {
+                m_dtr.update_dsu_after_evict(best);
+            }
+        } else if (!offload_tensor(best, method)) {
+            // not compressible, which would be excluded in next round
+            MGB_RECORD_EVENT(AutoEvictFinishEvent);
+            continue;
+        }
+        if (unique) {
             current_memory -= best->memory;
             if (force_num > 0) {
                 force_num--;
             }
             flag = true;
         }
-        do_drop(best);
-        if (best->evict_type == EvictType::DROP) {
-            m_dtr.update_dsu_after_evict(best);
-        }
         sample_on_device(m_dtr.comp_node, false);
         MGB_RECORD_EVENT(AutoEvictFinishEvent);
     }
@@ -1031,7 +1216,10 @@ void ChannelImpl::detach_users(TensorInfo* dest) {
             if (output == nullptr) {
                 continue;
             }
-            regenerate(output);
+            // offloaded tensors are restored without their inputs
+            if (output->evict_type == EvictType::DROP) {
+                regenerate(output);
+            }
             output->detach_producer();
             for (auto* input : inputs) {
                 input->ref_cnt--;
@@ -1624,7 +1812,9 @@ double ChannelImpl::DynamicSublinear::estimate_neighbor_cost(TensorInfo* ptr) {
 }
 
 TensorInfo* ChannelImpl::DynamicSublinear::find_best_tensor(
-        bool enable_dtr_sqrt_sampling = false) {
+        bool enable_dtr_sqrt_sampling, bool allow_compress, bool allow_spill,
+        DTRCostModel::Method& method) {
+    method = DTRCostModel::RECOMPUTE;
     if (candidates.empty())
         return nullptr;
 
@@ -1645,18 +1835,38 @@ TensorInfo* ChannelImpl::DynamicSublinear::find_best_tensor(
             ti = vi;
         }
         auto i = candidates[ti];
-        if (i->producer && i->ptr && i->evict_type == EvictType::NONE) {
-            double neighbor_cost = estimate_neighbor_cost(i);
-            size_t begin_ptr =
-                    reinterpret_cast<size_t>(i->ptr->blob()->storage().get());
-            auto side_info = i->ptr->comp_node().get_free_left_and_right(
-                    begin_ptr, begin_ptr + i->ptr->blob()->size());
-            double free_mem = side_info.first + side_info.second;
-            double msps = i->eval_func(
-                    neighbor_cost, free_mem, estimate_timestamp, 1.0, 1.0, 1.0, 1.0001);
-            if (min_msps < 0 || msps < min_msps) {
-                min_msps = msps;
-                best = i;
+        bool offload = allow_compress || allow_spill;
+        if ((i->producer || offload) && i->ptr && i->evict_type == EvictType::NONE) {
+            double cost = 0;
+            auto choice = DTRCostModel::RECOMPUTE;
+            if (offload) {
+                // offloading only pays off if the memory is released
+                bool unique = i->ptr.unique() && i->ptr->blob().unique();
+                double recompute_cost =
+                        i->producer ? i->compute_time + estimate_neighbor_cost(i) : -1;
+                auto result = cost_model.choose(
+                        i->memory, recompute_cost,
+                        i->producer ? i->producer->op.get() : nullptr,
+                        allow_compress && unique && !i->incompressible,
+                        allow_spill && unique);
+                choice = result.method;
+                cost = result.cost;
+            } else {
+                cost = estimate_neighbor_cost(i);
+            }
+            if (choice != DTRCostModel::NR_METHOD) {
+                size_t begin_ptr =
+                        reinterpret_cast<size_t>(i->ptr->blob()->storage().get());
+                auto side_info = i->ptr->comp_node().get_free_left_and_right(
+                        begin_ptr, begin_ptr + i->ptr->blob()->size());
+                double free_mem = side_info.first + side_info.second;
+                double msps = i->eval_func(
+                        cost, free_mem, estimate_timestamp, 1.0, 1.0, 1.0, 1.0001);
+                if (min_msps < 0 || msps < min_msps) {
+                    min_msps = msps;
+                    best = i;
+                    method = choice;
+                }
             }
         }
         if (enable_dtr_sqrt_sampling) {
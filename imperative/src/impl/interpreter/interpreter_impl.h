@@ -12,6 +12,7 @@
 #include "megbrain/imperative/profiler.h"
 #include "megbrain/utils/mempool.h"
 
+#include "./apply_plan_cache.h"
 #include "./commands.h"
 #include "./option_manager.h"
 #include "./stack_manager.h"
@@ -60,6 +61,7 @@ struct ChannelImpl : Interpreter::Channel, NonCopyableObj, NonMoveableObj {
     size_t get_option(std::string name) override;
     void set_option(std::string name, size_t value) override;
     void clear_candidates() override;
+    std::unordered_map<std::string, size_t> get_dtr_stats() override;
 
     void start_profile() override;
     void stop_profile() override;
@@ -76,6 +78,9 @@ struct ChannelImpl : Interpreter::Channel, NonCopyableObj, NonMoveableObj {
     void update_status_to_forked(void);
     void assert_available() const;
 
+    //! only for test
+    const ApplyPlanCache& apply_plan_cache() const { return m_apply_plan_cache; }
+
     static std::unordered_set<ChannelImpl*> m_all_active_channels;
     static MGB_MUTEX m_all_active_channels_mutex;
 
@@ -109,9 +114,21 @@ private:
     void release_tensor(TensorInfo* dest);
 
     void regenerate(TensorInfo* dest);
+
+    //! evict \p dest by compression or spill, returns false if not worth it
+    bool offload_tensor(TensorInfo* dest, DTRCostModel::Method method);
+    //! restore tensors evicted by offload_tensor
+    void restore_tensor(TensorInfo* dest);
+    //! whether DTR could evict tensors other than dropping them
+    bool dtr_offload_enabled();
+
     void flush_apply_stack();
     void do_apply_op(const ApplyOp& cmd, std::string reason);
 
+    //! infer output attrs of \p op through the apply plan cache if possible
+    std::tuple<SmallVector<LogicalTensorDesc>, bool> infer_output_attrs(
+            const std::shared_ptr<OpDef>& op,
+            const SmallVector<LogicalTensorDesc>& input_descs);
     void dispatch_default_cpu(
             std::shared_ptr<OpDef> op, const SmallVector<TensorInfo*>& input_infos,
             const SmallVector<LogicalTensorDesc>& input_descs,
@@ -149,6 +166,7 @@ private:
     // TODO: use explicit struct
     std::stack<std::tuple<ApplyOp, size_t, TensorInfo*, std::string>> m_apply_stack;
     bool m_applying = false;
+    ApplyPlanCache m_apply_plan_cache;
 
     enum class ChannelRunningStatus { RUNING, CLOSED, FORKED };
     ChannelRunningStatus m_status = ChannelRunningStatus::RUNING;
@@ -209,10 +227,17 @@ private:
          * (2) is in memory, (3) is not pinned. Evaluation function refers to:
          * @see: TensorInfo::eval_func.
          *
+         * If compression or spill is allowed, tensors without computing path are
+         * also available, and the cost of each tensor is the cheapest one of the
+         * allowed methods estimated by the cost model, which is returned by
+         * \p method.
+         *
          * \return the pointer of the best tensor; nullptr is returned if no
          * available tensor is found
          */
-        TensorInfo* find_best_tensor(bool);
+        TensorInfo* find_best_tensor(
+                bool enable_dtr_sqrt_sampling, bool allow_compress, bool allow_spill,
+                DTRCostModel::Method& method);
 
         /*!
          * \brief estimate the cost of recomputing tensor ptr
@@ -293,6 +318,13 @@ private:
         //! store all tensors that may be evicted
         SmallVector<TensorInfo*> candidates;
 
+        DTRCostModel cost_model;
+
+        DTRStats stats;
+
+        //! created on the first spill
+        std::shared_ptr<SpillFile> spill_file;
+
         bool is_bad_op(std::string op_name) {
             return std::find(op_blacklist.begin(), op_blacklist.end(), op_name) !=
                    op_blacklist.end();
@@ -45,6 +45,19 @@ public:
             dtr_evictee_minimum_size, "MEGENGINE_DTR_EVICTEE_MINIMUM_SIZE", 1048576,
             "the minimum memory value of a tensor added to the candidate set");
     DEF_OPTION(record_computing_path, "MEGENGINE_RECORD_COMPUTING_PATH", 0, "");
+    DEF_OPTION(
+            enable_dtr_compression, "MEGENGINE_DTR_COMPRESSION", 0,
+            "allow auto drop to evict tensors by compressing them in host memory, "
+            "if it is cheaper than recomputing them by measured costs.");
+    DEF_OPTION(
+            enable_dtr_spill, "MEGENGINE_DTR_SPILL", 0,
+            "allow auto drop to evict tensors to a spill file in "
+            "MEGENGINE_DTR_SPILL_DIR, if it is cheaper than recomputing them by "
+            "measured costs.");
+    DEF_OPTION(
+            apply_plan_cache_size, "MEGENGINE_APPLY_PLAN_CACHE_SIZE", 1024,
+            "max number of cached apply plans, i.e. output attrs inferred from input "
+            "layouts, which are reused by later applies; 0 to disable the cache.");
 
 #undef DEF_OPTION
 
@@ -4,13 +4,20 @@
 #include "megbrain/imperative/physical_tensor.h"
 #include "megbrain/imperative/utils/to_string.h"
 
+#include "./dtr_offload.h"
+
 namespace mgb::imperative {
 
 namespace interpreter::intl {
 
 enum EvictType {
     NONE = 0,
+    //! released, and regenerated by recomputing its producer
     DROP = 1,
+    //! kept compressed in host memory
+    COMPRESS = 2,
+    //! written to the spill file
+    SPILL = 3,
 };
 
 /*!
@@ -59,6 +66,11 @@ struct TensorInfo {
 
     EvictType evict_type = NONE;
 
+    // content of tensors evicted by COMPRESS or SPILL
+    std::unique_ptr<OffloadedValue> offloaded;
+    // set if compression was tried but not worth it
+    bool incompressible = false;
+
     // Status should be only modified in worker thread
     Status status = InvalidStatus;
 
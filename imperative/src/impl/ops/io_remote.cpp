@@ -51,6 +51,7 @@ cg::OperatorNodeBase* apply_on_var_node_remote_recv(
             recv.backend));
 }
 
+#if MGB_ENABLE_MEGRAY
 TensorPtr megray_recv_tensor(
         std::shared_ptr<MegRay::Communicator> megray_comm, TensorLayout& layout,
         CompNode cn, uint32_t rank_from) {
@@ -77,6 +78,7 @@ void megray_send_tensor(
             mgb::opr::get_megray_dtype(src->layout().dtype), rank_to, megray_ctx);
     mgb_assert(status == MegRay::MEGRAY_OK, "MegRay send failed");
 }
+#endif
 
 TensorLayout create_layout(const std::vector<int32_t>& shape, DType dtype) {
     TensorShape tshape;
@@ -96,6 +98,7 @@ std::tuple<SmallVector<LogicalTensorDesc>, bool> infer_output_attrs_fallible_rem
 SmallVector<TensorPtr> apply_on_physical_tensor_remote_send(
         const OpDef& def, const SmallVector<TensorPtr>& inputs,
         SmallVector<LogicalTensorDesc>& output_descs, const bool& validated) {
+#if MGB_ENABLE_MEGRAY
     auto&& op = def.cast_final_safe<RemoteSend>();
     auto megray_comm = mgb::opr::BatchSendRecvHelper::getInstance()->get(
             std::string("init_all_cards"));
@@ -107,6 +110,11 @@ SmallVector<TensorPtr> apply_on_physical_tensor_remote_send(
     megray_send_tensor(megray_comm, inputs[0], op.rank_to);
     TensorLayout layout({0}, inputs[0]->dtype());
     return {Tensor::make(layout, inputs[0]->comp_node())};
+#else
+    // without MegRay the opr falls back to the graph opr, which reports the error
+    return proxy_graph_detail::apply_on_physical_tensor(
+            def, inputs, output_descs, validated);
+#endif
 }
 
 std::tuple<SmallVector<LogicalTensorDesc>, bool> infer_output_attrs_fallible_remote_recv(
@@ -118,6 +126,7 @@ std::tuple<SmallVector<LogicalTensorDesc>, bool> infer_output_attrs_fallible_rem
 SmallVector<TensorPtr> apply_on_physical_tensor_remote_recv(
         const OpDef& def, const SmallVector<TensorPtr>& inputs,
         SmallVector<LogicalTensorDesc>& output_descs, const bool& validated) {
+#if MGB_ENABLE_MEGRAY
     auto&& op = def.cast_final_safe<RemoteRecv>();
     auto layout = create_layout(op.shape, op.dtype);
     auto megray_comm = mgb::opr::BatchSendRecvHelper::getInstance()->get(
@@ -128,6 +137,11 @@ SmallVector<TensorPtr> apply_on_physical_tensor_remote_recv(
     }
     auto&& out = megray_recv_tensor(megray_comm, layout, op.cn, op.rank_from);
     return {out};
+#else
+    // without MegRay the opr falls back to the graph opr, which reports the error
+    return proxy_graph_detail::apply_on_physical_tensor(
+            def, inputs, output_descs, validated);
+#endif
 }
 
 SmallVector<VarNode::LayoutConstraintCallback> get_input_layout_constraint(
@@ -158,6 +172,7 @@ OP_TRAIT_REG(RemoteRecv, RemoteRecv, mgb::opr::RemoteRecv)
 SmallVector<TensorPtr> apply_on_physical_tensor_batch_send_recv(
         const OpDef& def, const SmallVector<TensorPtr>& inputs,
         SmallVector<LogicalTensorDesc>& output_descs, const bool& validated) {
+#if MGB_ENABLE_MEGRAY
     auto&& op = def.cast_final_safe<BatchSendRecvOp>();
     auto megray_comm = mgb::opr::BatchSendRecvHelper::getInstance()->get(
             std::string("init_all_cards"));
@@ -182,6 +197,11 @@ SmallVector<TensorPtr> apply_on_physical_tensor_batch_send_recv(
     }
     megray_comm->group_end();
     return outputs;
+#else
+    mgb_throw(
+            MegBrainError,
+            "BatchSendRecvOp requires MegRay, which is only built with CUDA or ROCm");
+#endif
 }
 
 std::tuple<SmallVector<LogicalTensorDesc>, bool>
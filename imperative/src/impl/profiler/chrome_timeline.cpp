@@ -6,6 +6,8 @@
 #error Unsupported platform
 #endif
 
+#include <unordered_set>
+
 #include "nlohmann/json.hpp"
 
 #include "megbrain/imperative/utils/platform.h"
@@ -193,6 +195,8 @@ struct ChromeTimelineEventVisitor : EventVisitor<ChromeTimelineEventVisitor> {
     ChromeTraceEvents trace_events;
     decltype(getpid()) pid = getpid();
     std::string pid_str = std::to_string(pid);
+    //! thread pool workers, which record no event by themselves
+    std::unordered_map<std::thread::id, size_t> pool_threads;
 
     ChromeTimelineEventVisitor() {}
 
@@ -295,6 +299,44 @@ struct ChromeTimelineEventVisitor : EventVisitor<ChromeTimelineEventVisitor> {
             new_device_event(current_op->name, 'E', event.device)
                     .cat("Kernel")
                     .args(current_op->detail());
+        } else if constexpr (std::is_same_v<TEvent, OpHwCounterEvent>) {
+            nlohmann::json args;
+            for (auto&& [key, value] : event.metrics) {
+                args[key] = value;
+            }
+            new_host_event(current_op->name, 'i').cat("HwCounter").args(args);
+            // derived metrics are also plotted as counters
+            static const std::unordered_set<std::string> plotted = {
+                    "ipc", "gflops", "bytes_per_cycle", "roofline_efficiency"};
+            for (auto&& [key, value] : event.metrics) {
+                if (plotted.count(key)) {
+                    new_host_event(std::string("hw_") + key, 'C').arg("value", value);
+                }
+            }
+        } else if constexpr (std::is_same_v<TEvent, OpThreadPoolTraceEvent>) {
+            // chunks on the track of each thread, nested in the kernel on the
+            // submitter thread
+            for (auto&& record : event.records) {
+                pool_threads.emplace(record.thread, record.thread_id);
+                new_event(current_op->name, 'B', to_tid(record.thread), record.begin)
+                        .cat("ThreadPool");
+                new_event(current_op->name, 'E', to_tid(record.thread), record.end)
+                        .cat("ThreadPool")
+                        .arg("job", record.job)
+                        .arg("thread_id", record.thread_id)
+                        .arg("nr_tasks", record.nr_tasks);
+            }
+            auto stat = ThreadPoolTrace::Stat::make(event.records);
+            nlohmann::json args;
+            args["nr_jobs"] = stat.nr_jobs;
+            args["nr_tasks"] = stat.nr_tasks;
+            args["max_busy_ms"] = stat.max_busy_ms;
+            args["mean_busy_ms"] = stat.mean_busy_ms;
+            args["straggler_ms"] = stat.straggler_ms;
+            args["imbalance"] = stat.imbalance();
+            args["thread_nr_tasks"] = stat.thread_nr_tasks;
+            new_host_event(current_op->name, 'i').cat("ThreadPool").args(args);
+            new_host_event("thread_pool_imbalance", 'C').arg("value", stat.imbalance());
         } else if constexpr (std::is_same_v<TEvent, TensorProduceEvent>) {
             if (current_tensor->living_time == profiler::Duration::zero()) {
                 new_host_event(pid_str, 's')
@@ -507,6 +549,14 @@ struct ChromeTimelineEventVisitor : EventVisitor<ChromeTimelineEventVisitor> {
                         .pid(pid)
                         .tid(to_tid(host))
                         .arg("name", thread_dict.at(host));
+            } else if (pool_threads.count(host)) {
+                trace_events.new_event()
+                        .name("thread_name")
+                        .ph('M')
+                        .pid(pid)
+                        .tid(to_tid(host))
+                        .arg("name", "ThreadPool worker " +
+                                             std::to_string(pool_threads.at(host)));
             }
         }
         for (auto&& device : devices()) {
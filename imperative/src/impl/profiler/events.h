@@ -2,6 +2,7 @@
 
 #include "megbrain/imperative/profiler.h"
 #include "megbrain/utils/small_vector.h"
+#include "megbrain/utils/thread_pool.h"
 
 #include "../interpreter/stack_manager.h"
 #include "../op_trait.h"
@@ -90,6 +91,19 @@ DEF_DUR_EVENT(KernelLaunch, {
     CompNode device;
 });
 
+//! hardware counters of a kernel on CPU, with metrics from HwCounterStat::metrics
+DEF_EVENT(OpHwCounter, {
+    uint64_t op_id;
+    CompNode device;
+    std::vector<std::pair<const char*, double>> metrics;
+});
+
+//! chunks run by ThreadPool for the multi-thread kernels of an op on CPU
+DEF_EVENT(OpThreadPoolTrace, {
+    uint64_t op_id;
+    std::vector<ThreadPoolTrace::Record> records;
+});
+
 DEF_EVENT(TensorDeclare, {
     uint64_t tensor_id;
     std::string name;
@@ -139,6 +153,8 @@ DEF_EVENT(WorkerException, {});
 
 DEF_EVENT(ShapeInfer, { bool success; });
 
+DEF_EVENT(ApplyPlanCache, { bool hit; });
+
 DEF_DUR_EVENT(Scope, {
     std::string name;
     ScopeType type = ScopeType::DEFAULT;
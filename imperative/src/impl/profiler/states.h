@@ -296,18 +296,20 @@ public:
         auto& self = static_cast<TSelf&>(*this);
         AnyToVariantConverter<
                 OpDispatchEvent, OpExecuteEvent, OpExecuteFinishEvent,
-                KernelLaunchEvent, KernelLaunchFinishEvent, OpInputEvent,
-                OpInputFinishEvent, OpOutputEvent, OpOutputFinishEvent,
+                KernelLaunchEvent, KernelLaunchFinishEvent, OpHwCounterEvent,
+                OpThreadPoolTraceEvent, OpInputEvent, OpInputFinishEvent,
+                OpOutputEvent, OpOutputFinishEvent,
                 TensorDeclareEvent, TensorProduceEvent, TensorUsageEvent,
                 TensorReleaseEvent, TensorEraseEvent, TensorGetPropEvent,
                 TensorNotifyPropEvent, TensorWaitPropEvent, TensorWaitPropFinishEvent,
                 SampleDeviceEvent, SampleDeviceFinishEvent, WorkerExceptionEvent,
-                ShapeInferEvent, SyncEvent, SyncFinishEvent, StartProfileEvent,
-                StartProfileFinishEvent, StopProfileEvent, StopProfileFinishEvent,
-                StopStepEvent, TensorCommandEvent, TensorCommandFinishEvent,
-                AutoEvictEvent, AutoEvictFinishEvent, CustomEvent, CustomFinishEvent,
-                RecordDeviceEvent, ScopeEvent, ScopeFinishEvent, HostToDeviceEvent,
-                HostToDeviceFinishEvent, CUPTITimestampEvent, CUPTIKernelLaunchEvent,
+                ShapeInferEvent, ApplyPlanCacheEvent, SyncEvent, SyncFinishEvent,
+                StartProfileEvent, StartProfileFinishEvent, StopProfileEvent,
+                StopProfileFinishEvent, StopStepEvent, TensorCommandEvent,
+                TensorCommandFinishEvent, AutoEvictEvent, AutoEvictFinishEvent,
+                CustomEvent, CustomFinishEvent, RecordDeviceEvent, ScopeEvent,
+                ScopeFinishEvent, HostToDeviceEvent, HostToDeviceFinishEvent,
+                CUPTITimestampEvent, CUPTIKernelLaunchEvent,
                 CUPTIKernelLaunchFinishEvent, CUPTIKernelExecuteEvent,
                 CUPTIMemcpyLaunchEvent, CUPTIMemcpyLaunchFinishEvent, CUPTIMemcpyEvent,
                 CUPTIRuntimeEvent, CUPTIRuntimeFinishEvent, CUPTIDriverEvent,
@@ -365,6 +367,14 @@ public:
             if (!m_host_tid_table.count(current->tid)) {
                 m_host_tid_table[current->tid] = next_tid();
             }
+            using T = std::decay_t<decltype(event)>;
+            if constexpr (std::is_same_v<T, OpThreadPoolTraceEvent>) {
+                for (auto&& record : event.records) {
+                    if (!m_host_tid_table.count(record.thread)) {
+                        m_host_tid_table[record.thread] = next_tid();
+                    }
+                }
+            }
         });
 
         for_each_entry([&](auto&& event) {
@@ -464,6 +474,11 @@ public:
                 if (!event.success) {
                     inc_counter("nr_shape_infer_failure", 1);
                 }
+            } else if constexpr (std::is_same_v<T, ApplyPlanCacheEvent>) {
+                inc_counter(
+                        event.hit ? "nr_apply_plan_cache_hit"
+                                  : "nr_apply_plan_cache_miss",
+                        1);
             } else if constexpr (std::is_same_v<T, WorkerExceptionEvent>) {
                 inc_counter("nr_exception", 1);
             } else if constexpr (std::is_same_v<T, KernelLaunchFinishEvent>) {
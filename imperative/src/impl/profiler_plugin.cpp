@@ -1,5 +1,6 @@
 #include "megbrain/imperative/profiler_plugin.h"
 
+#include "megbrain/comp_node_env.h"
 #include "megbrain/graph.h"
 #include "megbrain/graph/event.h"
 
@@ -126,9 +127,13 @@ ProfilerPlugin::ProfilerPlugin(cg::ComputingGraph* graph) : PluginBase(graph) {
         MGB_RECORD_EVENT_IF(
                 (Profiler::get_option("profile_device", 0)), RecordDeviceEvent,
                 Timer::record_device(event.comp_node));
+        record_hw_counter(opr, event.comp_node, true);
+        trace_thread_pool(opr, event.comp_node, true);
     };
     auto on_after_kern = [this](AfterKernel const& event) {
         OperatorNodeBase* opr = event.opr;
+        record_hw_counter(opr, event.comp_node, false);
+        trace_thread_pool(opr, event.comp_node, false);
         MGB_RECORD_EVENT_IF(
                 (Profiler::get_option("profile_device", 0)), RecordDeviceEvent,
                 Timer::record_device(event.comp_node));
@@ -184,6 +189,59 @@ void ProfilerPlugin::init_seq(cg::AsyncExecutable* comp_seq) {
     });
 }
 
+void ProfilerPlugin::record_hw_counter(
+        cg::OperatorNodeBase* opr, CompNode comp_node, bool start) {
+    using namespace profiler;
+    if (!Profiler::get_option("profile_hw_counter", 0))
+        return;
+    auto&& env = CompNodeEnv::from_comp_node(comp_node);
+    if (env.property().type != CompNode::DeviceType::CPU)
+        return;
+    auto& opr_info = get_opr_info(opr);
+    if (start) {
+        opr_info.footprint = m_opr_footprint.calc_footprint(opr);
+        env.cpu_env().dispatch([this, &opr_info]() {
+            opr_info.hw_counter_start_time = m_timer.get_secs();
+            opr_info.hw_counter_start = HwCounter::read_this_thread();
+        });
+    } else {
+        size_t nr_threads = env.cpu_env().dispatcher->nr_threads();
+        env.cpu_env().dispatch([this, &opr_info, comp_node, nr_threads]() {
+            HwCounterStat stat;
+            stat.nr_threads = nr_threads;
+            stat.add(
+                    HwCounter::read_this_thread() - opr_info.hw_counter_start,
+                    m_timer.get_secs() - opr_info.hw_counter_start_time);
+            Profiler::record<OpHwCounterEvent>(
+                    opr_info.id, comp_node,
+                    stat.metrics(opr_info.footprint, m_roofline_peak));
+        });
+    }
+}
+
+void ProfilerPlugin::trace_thread_pool(
+        cg::OperatorNodeBase* opr, CompNode comp_node, bool start) {
+    using namespace profiler;
+    if (!Profiler::get_option("profile_thread_pool", 0))
+        return;
+    auto&& env = CompNodeEnv::from_comp_node(comp_node);
+    if (env.property().type != CompNode::DeviceType::CPU)
+        return;
+    // the kernel is submitted to the thread pool by the dispatcher thread
+    auto op_id = get_opr_info(opr).id;
+    if (start) {
+        env.cpu_env().dispatch([op_id]() { ThreadPoolTrace::set_tag(op_id); });
+    } else {
+        env.cpu_env().dispatch([op_id]() {
+            ThreadPoolTrace::set_tag(0);
+            auto records = ThreadPoolTrace::collect(op_id);
+            if (!records.empty()) {
+                Profiler::record<OpThreadPoolTraceEvent>(op_id, std::move(records));
+            }
+        });
+    }
+}
+
 ProfilerPlugin::OprInfo& ProfilerPlugin::register_opr(cg::OperatorNodeBase* opr) {
     OprInfo info;
     auto params = std::make_shared<std::unordered_map<std::string, std::string>>();
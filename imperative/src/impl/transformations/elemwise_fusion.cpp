@@ -0,0 +1,265 @@
+#include "megbrain/imperative/transformations/elemwise_fusion.h"
+#include "megbrain/imperative/ops/autogen.h"
+#include "megbrain/imperative/ops/utility.h"
+
+#include <unordered_set>
+
+namespace mgb {
+namespace imperative {
+
+namespace {
+
+//! graph_opt_level of fused subgraphs, which enables JIT fusion if available
+constexpr int FUSION_GOPT_LEVEL = 3;
+
+/**
+ * \brief key of fused subgraphs, which are the same if they have the same structure
+ */
+struct FusedElemwiseKey final : Hashable {
+private:
+    Subgraph m_graph;
+    size_t m_hash;
+
+public:
+    FusedElemwiseKey(Subgraph graph) : m_graph(std::move(graph)) {
+        SmallVector<size_t> data;
+        auto append_vars = [&](const Subgraph::vars_t& vars) {
+            data.push_back(vars.size());
+            data.append(vars.begin(), vars.end());
+        };
+        append_vars(m_graph.inputs);
+        for (auto&& expr : m_graph.exprs) {
+            data.push_back(expr.op->hash());
+            append_vars(expr.inputs);
+            append_vars(expr.outputs);
+        }
+        append_vars(m_graph.outputs);
+        m_hash = XXHash{}.update(data.data(), data.size() * sizeof(size_t)).digest();
+    }
+
+    size_t hash() const override { return m_hash; }
+
+protected:
+    bool is_same_st(const Hashable& rhs_) const override {
+        auto&& rhs = rhs_.cast_final_safe<FusedElemwiseKey>().m_graph;
+        auto&& lhs = m_graph;
+        if (lhs.inputs != rhs.inputs || lhs.outputs != rhs.outputs ||
+            lhs.exprs.size() != rhs.exprs.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < lhs.exprs.size(); ++i) {
+            auto &&lhs_expr = lhs.exprs[i], &&rhs_expr = rhs.exprs[i];
+            if (lhs_expr.inputs != rhs_expr.inputs ||
+                lhs_expr.outputs != rhs_expr.outputs ||
+                !lhs_expr.op->is_same(*rhs_expr.op)) {
+                return false;
+            }
+        }
+        return true;
+    }
+    MGB_DYN_TYPE_OBJ_FINAL_DECL;
+};
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(FusedElemwiseKey);
+
+bool is_fusible_op(const OpDef& op) {
+    return op.same_type<Elemwise>() || op.same_type<TypeCvt>() ||
+           op.same_type<Broadcast>();
+}
+
+}  // namespace
+
+ValueRefList ElemwiseFusionTransformation::try_record(
+        const OpDef& op, Span<ValueRef> inputs) {
+    if (!is_fusible_op(op) || !inputs.size()) {
+        return {};
+    }
+    bool is_broadcast = op.same_type<Broadcast>();
+    if (is_broadcast && (inputs.size() != 2 || inputs[1].is(m_value_type))) {
+        return {};
+    }
+    SmallVector<LogicalTensorDesc> input_descs;
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        auto&& input = inputs[i];
+        if (auto* fusion_value = input.as(m_value_type)) {
+            input_descs.push_back(fusion_value->desc());
+            continue;
+        }
+        auto shape = input.shape();
+        if (!shape || shape->is_scalar()) {
+            return {};
+        }
+        LogicalTensorDesc desc{
+                TensorLayout(shape->as_tensor_shape(), *input.dtype()),
+                *input.device()};
+        if (is_broadcast && i == 1) {
+            // target shape is required to infer the output layout
+            auto value = input.numpy();
+            if (!value) {
+                return {};
+            }
+            desc.value = value->as_nd().proxy_to_default_cpu();
+        }
+        input_descs.push_back(desc);
+    }
+    auto comp_node = input_descs[0].comp_node;
+    for (auto&& desc : input_descs) {
+        if (desc.comp_node != comp_node) {
+            return {};
+        }
+    }
+    auto [output_descs, validated] =
+            OpDef::infer_output_attrs_fallible(op, input_descs);
+    if (!validated) {
+        return {};
+    }
+    for (auto&& desc : output_descs) {
+        // leave shape-like tensors to host compute, so that their values are known
+        if (!desc.layout.ndim ||
+            desc.layout.total_nr_elems() <= TensorShape::MAX_NDIM) {
+            return {};
+        }
+    }
+    if (m_window.comp_node != comp_node ||
+        m_window.exprs.size() >= m_max_window_size) {
+        flush();
+        m_window.comp_node = comp_node;
+    }
+    Subgraph::expr_t expr{const_cast<OpDef&>(op).shared_from_this()};
+    for (auto&& input : inputs) {
+        // inputs which were FusionValues are concrete if the window was flushed above
+        if (auto* fusion_value = input.as(m_value_type)) {
+            expr.inputs.push_back(fusion_value->var());
+            continue;
+        }
+        auto [iter, inserted] =
+                m_window.input_var_map.insert({input.id(), m_window.next_var});
+        if (inserted) {
+            m_window.inputs.push_back(input);
+            m_window.input_vars.push_back(m_window.next_var++);
+        }
+        expr.inputs.push_back(iter->second);
+    }
+    ValueRefList outputs(output_descs.size());
+    for (size_t i = 0; i < output_descs.size(); ++i) {
+        auto var = m_window.next_var++;
+        auto output = m_value_type.make(var, output_descs[i]);
+        expr.outputs.push_back(var);
+        m_window.outputs.push_back({output, var});
+        outputs[i] = output;
+    }
+    m_window.exprs.push_back(std::move(expr));
+    return outputs;
+}
+
+ValueRefList ElemwiseFusionTransformation::apply_transformation(
+        const Operator& op, Span<ValueRef> inputs) {
+    if (auto* apply_op = op.as<ApplyOp>()) {
+        auto outputs = try_record(apply_op->op(), inputs);
+        if (outputs.size()) {
+            return outputs;
+        }
+        if (!is_fusible_op(apply_op->op())) {
+            // side effects of other ops (e.g. inplace updates) must not be reordered
+            flush();
+        }
+    } else if (auto* get_attr = op.as<GetAttr>()) {
+        if (auto* fusion_value = inputs.item().as(m_value_type)) {
+            auto&& desc = fusion_value->desc();
+            switch (get_attr->attr()) {
+                case GetAttr::DType:
+                    return {DTypeValue::make(desc.layout.dtype)};
+                case GetAttr::Device:
+                    return {CompNodeValue::make(desc.comp_node)};
+                case GetAttr::Shape:
+                    return {ShapeValue::make(ValueShape::from(desc.layout))};
+                default:
+                    break;
+            }
+        }
+    } else if (op.is<PushScope>() || op.is<PopScope>()) {
+        return imperative::apply(op, inputs);
+    }
+    for (auto&& input : inputs) {
+        if (input.is(m_value_type)) {
+            flush();
+            break;
+        }
+    }
+    return imperative::apply(op, inputs);
+}
+
+void ElemwiseFusionTransformation::flush() {
+    // flush may be requested out of apply_transformation (e.g. by unwrap or sync),
+    // where requests should be sent downstairs as well
+    TransformationGuard _{static_cast<size_t>(pos() - top()) + 1};
+    auto window = std::move(m_window);
+    m_window = {};
+    Subgraph graph;
+    std::vector<FusionValue::ref_t> fusion_values;
+    for (auto&& [weak_value, var] : window.outputs) {
+        if (auto value = weak_value.lock()) {
+            fusion_values.push_back(value);
+            graph.outputs.push_back(var);
+        }
+    }
+    if (fusion_values.empty()) {
+        return;
+    }
+    graph.exprs = std::move(window.exprs);
+    graph.remove_unused_exprs();
+    std::unordered_set<Subgraph::var_t> used_vars;
+    for (auto&& expr : graph.exprs) {
+        used_vars.insert(expr.inputs.begin(), expr.inputs.end());
+    }
+    SmallVector<ValueRef> inputs;
+    std::unordered_map<Subgraph::var_t, ValueRef> var2input;
+    for (size_t i = 0; i < window.inputs.size(); ++i) {
+        if (used_vars.count(window.input_vars[i])) {
+            graph.inputs.push_back(window.input_vars[i]);
+            inputs.push_back(window.inputs[i]);
+            var2input[window.input_vars[i]] = window.inputs[i];
+        }
+    }
+    std::shared_ptr<OpDef> fused_op;
+    if (graph.exprs.size() == 1 && graph.exprs[0].outputs == graph.outputs) {
+        // nothing to fuse, apply the op as is
+        auto&& expr = graph.exprs[0];
+        fused_op = expr.op;
+        inputs.clear();
+        for (auto var : expr.inputs) {
+            inputs.push_back(var2input.at(var));
+        }
+    } else {
+        auto key = std::make_shared<FusedElemwiseKey>(graph);
+        fused_op = CompiledOp::make(
+                SubgraphOp::make(
+                        "FusedElemwise", std::make_shared<Subgraph>(std::move(graph)),
+                        SmallVector<bool>{}, key),
+                FUSION_GOPT_LEVEL);
+    }
+    ValueRefList outputs;
+    try {
+        outputs = imperative::apply(ApplyOp(*fused_op), inputs);
+    } catch (std::exception& exc) {
+        for (auto&& value : fusion_values) {
+            value.reset(ErrorValue::make(exc.what()));
+        }
+        throw;
+    }
+    mgb_assert(outputs.size() == fusion_values.size());
+    for (size_t i = 0; i < outputs.size(); ++i) {
+        fusion_values[i].reset(outputs[i]);
+    }
+}
+
+void ElemwiseFusionTransformation::on_unregister() noexcept {
+    try {
+        flush();
+    } catch (...) {
+        // errors are kept in the pending FusionValues
+    }
+}
+
+}  // namespace imperative
+}  // namespace mgb
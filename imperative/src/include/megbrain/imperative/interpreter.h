@@ -2,6 +2,7 @@
 
 #include <any>
 #include <atomic>
+#include <unordered_map>
 
 #include "./backtrace.h"
 #include "megbrain/imperative/op_def.h"
@@ -59,6 +60,8 @@ struct Interpreter {
         virtual size_t get_option(std::string name) = 0;
         virtual void set_option(std::string name, size_t value) = 0;
         virtual void clear_candidates() = 0;
+        //! counters of DTR evictions, see interpreter::intl::DTRStats
+        virtual std::unordered_map<std::string, size_t> get_dtr_stats() = 0;
 
         virtual void start_profile() = 0;
         virtual void stop_profile() = 0;
@@ -1,6 +1,8 @@
 #pragma once
 
 #include "megbrain/plugin/base.h"
+#include "megbrain/plugin/hw_counter.h"
+#include "megbrain/utils/timer.h"
 
 #include "megbrain/imperative/profiler.h"
 
@@ -12,6 +14,10 @@ public:
         uint64_t id;
         CompNode comp_node;
         std::shared_ptr<std::unordered_map<std::string, std::string>> params;
+        //! footprint and counters at kernel start, for profile_hw_counter
+        OprFootprint::Result footprint;
+        HwCounter::Values hw_counter_start;
+        double hw_counter_start_time = 0;
     };
 
     struct VarInfo {
@@ -24,6 +30,15 @@ public:
 private:
     std::unordered_map<cg::OperatorNodeBase*, OprInfo> m_opr_dict;
     std::unordered_map<cg::VarNode*, std::unique_ptr<VarInfo>> m_var_dict;
+    OprFootprint m_opr_footprint;
+    RooflinePeak m_roofline_peak = RooflinePeak::from_env();
+    RealTimer m_timer;
+
+    //! start or stop hardware counters of a kernel if it runs on CPU
+    void record_hw_counter(cg::OperatorNodeBase* opr, CompNode comp_node, bool start);
+
+    //! start or stop ThreadPoolTrace of a kernel if it runs on CPU
+    void trace_thread_pool(cg::OperatorNodeBase* opr, CompNode comp_node, bool start);
 
 public:
     explicit ProfilerPlugin(cg::ComputingGraph* graph);
@@ -0,0 +1,96 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "megbrain/imperative/basic_operators.h"
+#include "megbrain/imperative/dispatch.h"
+#include "megbrain/imperative/subgraph.h"
+
+namespace mgb::imperative {
+
+/**
+ * \brief stub of the output of an op recorded in the fusion window, which would be
+ * reset to the concrete value when the window is flushed
+ */
+class FusionValue final : public ObjectValue<FusionValue> {
+private:
+    Subgraph::var_t m_var;
+    LogicalTensorDesc m_desc;
+
+public:
+    FusionValue(Subgraph::var_t var, LogicalTensorDesc desc)
+            : m_var(var), m_desc(std::move(desc)) {}
+
+    Subgraph::var_t var() const { return m_var; }
+    const LogicalTensorDesc& desc() const { return m_desc; }
+
+    std::string to_string() const override {
+        return ssprintf(
+                "FusionValue{var=%zu, layout=%s}", m_var,
+                m_desc.layout.to_string().c_str());
+    }
+
+    void clear() override { m_desc = {}; }
+};
+
+/**
+ * \brief fuse pointwise ops in eager mode
+ *
+ * 1. Record consecutive Elemwise, TypeCvt and Broadcast ops on the same comp node
+ * into a subgraph, return FusionValue (with inferred layout) as stub;
+ * 2. Answer dtype, device and shape queries on FusionValue from the inferred layout;
+ * 3. Flush the window when a non-fusible op, a value read or an op on another comp
+ * node arrives: apply the subgraph as a single CompiledOp on the external inputs and
+ * replace FusionValues by the results. Outputs which are no longer referenced are not
+ * computed at all.
+ *
+ * Subgraphs of the same structure share the same key, so that the compiled graph
+ * (where elemwise chains are fused by graph optimization) is reused by later flushes.
+ */
+class ElemwiseFusionTransformation final : public Transformation {
+private:
+    struct Window {
+        CompNode comp_node;
+        SmallVector<ValueRef> inputs;
+        SmallVector<Subgraph::var_t> input_vars;
+        //! value id of external inputs to var
+        std::unordered_map<uint64_t, Subgraph::var_t> input_var_map;
+        SmallVector<Subgraph::expr_t> exprs;
+        std::vector<std::pair<FusionValue::weak_ref_t, Subgraph::var_t>> outputs;
+        //! var 0 is reserved by Subgraph
+        Subgraph::var_t next_var = 1;
+    };
+
+    size_t m_max_window_size;
+    Window m_window;
+    ObjectType<FusionValue> m_value_type{"FusionValue"};
+
+    /**
+     * \brief record op into the window, returns empty list if op is not fusible on
+     * given inputs
+     */
+    ValueRefList try_record(const OpDef& op, Span<ValueRef> inputs);
+
+public:
+    ElemwiseFusionTransformation(size_t max_window_size = 64)
+            : m_max_window_size(max_window_size) {}
+
+    ValueRefList apply_transformation(
+            const Operator& op, Span<ValueRef> inputs) override;
+
+    //! apply recorded ops and reset their outputs to concrete values
+    void flush();
+
+    ValueRef unwrap(ValueRef value) override {
+        if (value.is(m_value_type)) {
+            flush();
+        }
+        return value;
+    }
+
+    std::string name() const override { return "ElemwiseFusionTransformation"; }
+
+    void on_unregister() noexcept override;
+};
+
+}  // namespace mgb::imperative
@@ -1,4 +1,5 @@
 #include "megbrain/imperative/interpreter.h"
+#include "../impl/interpreter/interpreter_impl.h"
 #include "../impl/interpreter/tensor_info.h"
 #include "./helper.h"
 #include "megbrain/comp_node_env.h"
@@ -78,4 +79,81 @@ TEST(TestImperative, InterpreterApplyOp) {
     }
 }
 
+TEST(TestImperative, InterpreterApplyPlanCache) {
+    HostTensorGenerator<> gen;
+    auto&& channel = Interpreter::inst().create_channel();
+    auto&& plan_cache =
+            static_cast<intl::ChannelImpl*>(channel.get())->apply_plan_cache();
+
+    auto op = OprAttr::make("Elemwise");
+    auto&& attr = op->cast_final_safe<OprAttr>();
+    using Param = opr::Elemwise::Param;
+    Param param{Param::Mode::ADD};
+    attr.param.write_pod(param);
+
+    auto run = [&](const TensorShape& shape) {
+        auto h0 = gen(shape), h1 = gen(shape);
+        auto handle0 = channel->put(*h0, true), handle1 = channel->put(*h1, true);
+        auto outputs = channel->apply_op(op, {handle0, handle1});
+        auto out = channel->get_value(outputs[0]);
+        ASSERT_TRUE(out.shape().eq_shape(shape));
+        for (size_t i = 0; i < shape.total_nr_elems(); i++) {
+            ASSERT_EQ(h0->ptr<float>()[i] + h1->ptr<float>()[i], out.ptr<float>()[i]);
+        }
+        channel->del(handle0);
+        channel->del(handle1);
+        channel->del(outputs[0]);
+    };
+
+    run({5, 10});
+    ASSERT_EQ(1u, plan_cache.size());
+    run({5, 10});
+    ASSERT_EQ(1u, plan_cache.size());
+    run({10, 5});
+    ASSERT_EQ(2u, plan_cache.size());
+
+    // the least recently used plan is evicted
+    channel->set_option("apply_plan_cache_size", 2);
+    run({5, 10});
+    run({7, 10});
+    ASSERT_EQ(2u, plan_cache.size());
+    run({5, 10});
+    ASSERT_EQ(2u, plan_cache.size());
+
+    channel->set_option("apply_plan_cache_size", 0);
+    run({10, 5});
+    ASSERT_EQ(2u, plan_cache.size());
+}
+
+TEST(TestImperative, DTROffloadedValue) {
+    using namespace interpreter::intl;
+    // sparse content with a tail which is not a whole word
+    std::vector<uint8_t> data(4099, 0);
+    for (size_t i = 0; i < data.size(); i += 37) {
+        data[i] = i % 251 + 1;
+    }
+    std::vector<uint8_t> restored(data.size(), 0xff);
+    auto compressed = OffloadedValue::compress(data.data(), data.size(), 0.6);
+    ASSERT_NE(nullptr, compressed);
+    ASSERT_LT(compressed->kept_size(), data.size() * 0.6);
+    compressed->restore(restored.data());
+    ASSERT_EQ(data, restored);
+
+    // dense content is not worth compressing
+    std::vector<uint8_t> dense(4096, 1);
+    ASSERT_EQ(nullptr, OffloadedValue::compress(dense.data(), dense.size(), 0.6));
+
+    auto file = std::make_shared<SpillFile>();
+    auto spilled0 = OffloadedValue::spill(file, data.data(), data.size());
+    auto spilled1 = OffloadedValue::spill(file, dense.data(), dense.size());
+    spilled0.reset();
+    // reuse the space released by spilled0
+    auto spilled2 = OffloadedValue::spill(file, dense.data(), 1024);
+    std::fill(restored.begin(), restored.end(), 0);
+    spilled1->restore(restored.data());
+    ASSERT_TRUE(std::equal(dense.begin(), dense.end(), restored.begin()));
+    spilled2->restore(restored.data());
+    ASSERT_TRUE(std::equal(dense.begin(), dense.begin() + 1024, restored.begin()));
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -230,6 +230,49 @@ public:
  */
 using ThreadAffinityCallback = std::function<void(int thread_id)>;
 
+/**
+ * @brief the waiting statistics of the cpu worker threads of a network
+ *
+ * @param spin_ms the total time in milliseconds the workers spent on spinning
+ * for new tasks
+ * @param park_ms the total time in milliseconds the workers spent on parking
+ * @param nr_park the number of times the workers parked
+ */
+struct LITE_API CpuThreadsWaitStat {
+    double spin_ms = 0;
+    double park_ms = 0;
+    size_t nr_park = 0;
+};
+
+/**
+ * @brief the shape bucket of an input of a network, the given axis of the input
+ * is padded with zeros to the smallest size in the bucket that is not less than
+ * it, so that the inputs of close shapes share the same compiled executable
+ *
+ * @param input_name the name of the input to pad
+ * @param axis the axis of the input to pad
+ * @param sizes the sizes of the bucket in ascending order, the input is not
+ * padded if it is larger than all of them
+ */
+struct LITE_API ShapeBucket {
+    std::string input_name;
+    size_t axis = 0;
+    std::vector<size_t> sizes;
+};
+
+/**
+ * @brief the statistics of the shape cache of a network
+ *
+ * @param nr_hit the number of forwards whose input shapes are already compiled
+ * @param nr_miss the number of forwards that need to compile for new input shapes
+ * @param nr_executable the number of compiled executables in the cache
+ */
+struct LITE_API ShapeCacheStat {
+    size_t nr_hit = 0;
+    size_t nr_miss = 0;
+    size_t nr_executable = 0;
+};
+
 /**
  * @brief the network async callback function type
  */
@@ -424,6 +467,54 @@ public:
             std::shared_ptr<Network> network,
             const ThreadAffinityCallback& thread_affinity_callback);
 
+    /** @brief set the spin budget of the cpu worker threads, an idle worker
+     * spins at most spin_budget_us microseconds waiting for new tasks, then it
+     * parks until woken up by a new task, which releases the core on shared
+     * hosts
+     *
+     * @param dst_network the target network to set the spin budget
+     * @param spin_budget_us the max spin time in microseconds, 0 means park
+     * immediately
+     */
+    static void set_cpu_threads_spin_budget(
+            std::shared_ptr<Network> dst_network, size_t spin_budget_us);
+
+    /** @brief get the waiting statistics of the cpu worker threads
+     *
+     * @param dst_network the target network to get the statistics
+     */
+    static CpuThreadsWaitStat get_cpu_threads_wait_stat(
+            std::shared_ptr<Network> dst_network);
+
+    /** @brief keep the compiled executables of the most recently used input
+     * shapes, so that switching between seen input shapes needs no shape
+     * inference, memory planning or algo selection again; the executables share
+     * the weights and the runtime memory
+     *
+     * \verbatim embed:rst:leading-asterisk
+     *
+     *  .. note::
+     *
+     *     only host inputs are supported, and the outputs of a padded input are
+     *     computed on the padded shape
+     *
+     * \endverbatim
+     *
+     * @param dst_network the target network to enable the shape cache
+     * @param capacity the max number of executables, the least recently used one
+     * is recompiled for new input shapes when the cache is full
+     * @param buckets the shape buckets to pad the inputs
+     */
+    static void enable_shape_cache(
+            std::shared_ptr<Network> dst_network, size_t capacity,
+            const std::vector<ShapeBucket>& buckets = {});
+
+    /** @brief get the statistics of the shape cache
+     *
+     * @param dst_network the target network to get the statistics
+     */
+    static ShapeCacheStat get_shape_cache_stat(std::shared_ptr<Network> dst_network);
+
     /** @brief Set cpu default mode when device is CPU, in some low computation
      * device or single core device, this mode will get good performace
      *
@@ -0,0 +1,200 @@
+#pragma once
+
+#include "macro.h"
+#include "network.h"
+
+#include <future>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace lite {
+
+/**
+ * @brief the configuration of a NetworkServing
+ *
+ * @param nr_contexts the number of execution contexts, i.e. the max number of
+ * requests running at the same time, 0 means the number of cpu cores left by
+ * the workers of the thread pool
+ *
+ * @param nr_threads the number of threads of the thread pool shared by all the
+ * contexts, the thread of the context running a kernel is also counted, so the
+ * pool has nr_threads - 1 workers and 1 means no pool
+ *
+ * @param max_pending_requests the max number of requests waiting for a free
+ * context, submit() blocks when it is reached, 0 means no limit
+ */
+struct LITE_API ServingConfig {
+    size_t nr_contexts = 0;
+    size_t nr_threads = 1;
+    size_t max_pending_requests = 0;
+};
+
+/**
+ * @brief the input or output tensors of a request, map from the io tensor name
+ * to the tensor
+ */
+using ServingTensorMap = std::unordered_map<std::string, std::shared_ptr<Tensor>>;
+
+/**
+ * @brief serve concurrent requests of one model
+ *
+ * The model is loaded once, and the weights are shared by all the execution
+ * contexts. All the contexts run in cpu inplace mode on one comp node, so they
+ * share its thread pool: each context runs the kernels on its own thread and
+ * the parallel kernels are also executed by the workers of the pool. A context
+ * only owns its compiled graph, whose memory plan holds the activations of one
+ * request, and the requests admitted by submit() are executed in parallel by
+ * the free contexts.
+ *
+ * \verbatim embed:rst:leading-asterisk
+ *
+ *  .. note::
+ *
+ *      * only cpu device is supported
+ *      * the input tensors of a request must stay valid until its future is ready
+ *
+ * \endverbatim
+ */
+class LITE_API NetworkServing {
+public:
+    class Impl;
+
+    NetworkServing(
+            const Config& config = {}, const NetworkIO& network_io = {},
+            const ServingConfig& serving_config = {});
+    ~NetworkServing();
+
+    //! load the model form memory, the memory must be valid until the serving
+    //! is destroyed
+    void load_model(void* model_mem, size_t size);
+
+    //! load the model from a model path
+    void load_model(std::string model_path);
+
+    /** @brief admit a request, it is thread safe
+     *
+     * @param inputs the input tensors of the request, all the inputs of the
+     * model should be given, their memory is used by the context without copy
+     *
+     * @return the future of the output tensors, which are owned by the caller.
+     * The future holds the exception if the forwarding failed.
+     */
+    std::future<ServingTensorMap> submit(ServingTensorMap inputs);
+
+    //! wait until all the submitted requests finish
+    void wait();
+
+    //! get the number of execution contexts
+    size_t nr_contexts() const;
+
+    //! get the network of the given context, it can be used to get the model io
+    //! information, but should not be forwarded by user
+    std::shared_ptr<Network> get_network(size_t context_id) const;
+
+private:
+    std::unique_ptr<Impl> m_impl;
+};
+
+/**
+ * @brief the configuration of a NetworkBatching
+ *
+ * @param max_batch_size the max number of samples coalesced into one batch
+ *
+ * @param max_wait_us the max time in microseconds the oldest pending request
+ * waits for more requests before its batch is forwarded
+ *
+ * @param batch_buckets the batch sizes the model is compiled for, a batch is
+ * padded to the smallest bucket not less than it; empty means the powers of 2
+ * up to max_batch_size
+ */
+struct LITE_API BatchingConfig {
+    size_t max_batch_size = 8;
+    size_t max_wait_us = 1000;
+    std::vector<size_t> batch_buckets = {};
+};
+
+/**
+ * @brief the statistics of a NetworkBatching
+ *
+ * @param nr_requests the number of finished requests
+ * @param nr_batches the number of forwarded batches
+ * @param avg_batch_size the average number of samples of a batch, without the
+ * padding
+ * @param p50_latency_ms the median latency from submit() to the output ready of
+ * the recent requests
+ * @param p99_latency_ms the 99th percentile latency of the recent requests
+ */
+struct LITE_API BatchingStat {
+    size_t nr_requests = 0;
+    size_t nr_batches = 0;
+    double avg_batch_size = 0;
+    double p50_latency_ms = 0;
+    double p99_latency_ms = 0;
+};
+
+/**
+ * @brief coalesce small requests of one model into batches
+ *
+ * The requests are concatenated along the first dim of every input and
+ * forwarded together. A network sharing the weights is loaded for each batch
+ * bucket, so each executable keeps a fixed input shape and is never recompiled
+ * when the batch size changes. The networks run in async mode and the outputs
+ * are scattered back to the callers by the async callback.
+ *
+ * \verbatim embed:rst:leading-asterisk
+ *
+ *  .. note::
+ *
+ *      * only cpu device is supported
+ *      * all the inputs and outputs of the model should be batched on the first
+ *        dim, and the samples should not affect each other
+ *
+ * \endverbatim
+ */
+class LITE_API NetworkBatching {
+public:
+    class Impl;
+
+    NetworkBatching(
+            const Config& config = {}, const NetworkIO& network_io = {},
+            const BatchingConfig& batching_config = {});
+    ~NetworkBatching();
+
+    //! load the model form memory, the memory must be valid until the batching
+    //! is destroyed
+    void load_model(void* model_mem, size_t size);
+
+    //! load the model from a model path
+    void load_model(std::string model_path);
+
+    /** @brief admit a request, it is thread safe
+     *
+     * @param inputs the input tensors of the request, all the inputs of the
+     * model should be given with the same size of the first dim, which is not
+     * greater than max_batch_size
+     *
+     * @return the future of the output tensors, which are owned by the caller
+     */
+    std::future<ServingTensorMap> submit(ServingTensorMap inputs);
+
+    //! wait until all the submitted requests finish
+    void wait();
+
+    //! get the batch sizes the model is compiled for
+    std::vector<size_t> get_batch_buckets() const;
+
+    //! get the statistics since loaded or last reset_stat()
+    BatchingStat get_stat() const;
+
+    //! reset the statistics
+    void reset_stat();
+
+private:
+    std::unique_ptr<Impl> m_impl;
+};
+
+}  // namespace lite
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
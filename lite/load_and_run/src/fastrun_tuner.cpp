@@ -0,0 +1,71 @@
+#include <gflags/gflags.h>
+#include <sstream>
+#include <string>
+#include "misc.h"
+#include "strategys/strategy_tuning.h"
+
+DEFINE_string(
+        tuning_inputs, "",
+        "input shapes or data to tune for, separated by '|', each in the format of "
+        "--input, e.g. \"data:{1,3,224,224}|data:{4,3,224,224}\"; --input is used "
+        "if it is empty");
+DEFINE_string(
+        tuning_threads, "",
+        "thread numbers to tune for, separated by ',', each passed to "
+        "--multithread, e.g. \"1,2,4\"; the device options are used if it is empty");
+DEFINE_string(tuning_output, "fastrun_policy.cache", "path of the algo-policy file");
+
+std::string simple_usage = R"(
+fastrun_tuner: fastrun_tuner <model_path> [options Flags...]
+
+Profile the algorithms of a model with fast-run for each combination of
+--tuning_inputs and --tuning_threads, and write all the results to the
+algo-policy file given by --tuning_output. The file can be loaded by
+lite::set_persistent_cache() or load_and_run --fast-run-algo-policy, so that
+no profiling is needed at runtime on hosts with the same CPU and libraries.
+
+Other flags of load_and_run are supported, e.g. --lite, --cpu, --iter and
+--warmup_iter. More details using "--help" to get!!
+
+)";
+
+namespace {
+std::vector<std::string> split(const std::string& str, char sep) {
+    std::vector<std::string> ret;
+    std::stringstream ss{str};
+    std::string item;
+    while (std::getline(ss, item, sep)) {
+        if (!item.empty()) {
+            ret.push_back(item);
+        }
+    }
+    return ret;
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+    mgb::set_log_level(mgb::LogLevel::INFO);
+    lite::set_log_level(LiteLogLevel::INFO);
+    std::string usage = "fastrun_tuner <model_path> [options Flags...]";
+    if (argc < 2) {
+        printf("usage: %s\n", simple_usage.c_str());
+        return -1;
+    }
+    gflags::SetUsageMessage(usage);
+    gflags::SetVersionString("1.0");
+    gflags::ParseCommandLineFlags(&argc, &argv, true);
+    std::string model_path = argv[1];
+    std::vector<int> threads;
+    for (auto&& i : split(FLAGS_tuning_threads, ',')) {
+        threads.push_back(std::stoi(i));
+    }
+    lar::TuningStrategy strategy{
+            model_path, split(FLAGS_tuning_inputs, '|'), threads,
+            FLAGS_tuning_output};
+    strategy.run();
+    gflags::ShutDownCommandLineFlags();
+
+    return 0;
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
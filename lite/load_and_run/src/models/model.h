@@ -25,6 +25,9 @@ public:
 
     virtual void set_shared_mem(bool state) = 0;
 
+    //! set whether to load the model by mapping the file into memory
+    virtual void set_mmap_model(bool) {}
+
     virtual void create_network(){};
 
     //! load model interface for load and run strategy
@@ -14,7 +14,10 @@ ModelMdl::ModelMdl(const std::string& path) : model_path(path) {
 
 void ModelMdl::load_model() {
     //! read dump file
-    if (share_model_mem) {
+    if (mmap_model) {
+        mgb_log("enable mmap model file");
+        m_model_file = mgb::serialization::InputFile::make_mmap(model_path.c_str());
+    } else if (share_model_mem) {
         mgb_log("enable share model memory");
         FILE* fin = fopen(model_path.c_str(), "rb");
         mgb_assert(fin, "failed to open %s: %s", model_path.c_str(), strerror(errno));
@@ -172,11 +175,9 @@ std::shared_ptr<mgb::json::Object> ModelMdl::get_io_info() {
 std::vector<uint8_t> ModelMdl::get_model_data() {
     std::vector<uint8_t> out_data;
     auto out_file = mgb::serialization::OutputFile::make_vector_proxy(&out_data);
-    using DumpConfig = mgb::serialization::GraphDumper::DumpConfig;
-    DumpConfig config{1, false, false};
     auto dumper =
             mgb::serialization::GraphDumper::make(std::move(out_file), m_format.val());
-    dumper->dump(m_load_result.output_var_list, config);
+    dumper->dump(m_load_result.output_var_list, get_dump_config());
     return out_data;
 }
 
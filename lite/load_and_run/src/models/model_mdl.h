@@ -25,6 +25,8 @@ public:
 
     void set_shared_mem(bool state) override { share_model_mem = state; }
 
+    void set_mmap_model(bool state) override { mmap_model = state; }
+
     void load_model() override;
 
     void make_output_spec();
@@ -104,6 +106,16 @@ public:
                 std::move(out_file), m_format.val());
     }
 
+    //! config to dump the model; the params are aligned if the model is
+    //! mmaped, so that the dumped model can also be mmaped without copy
+    mgb::serialization::GraphDumpConfig get_dump_config() const {
+        mgb::serialization::GraphDumpConfig config{1, false, false};
+        if (mmap_model) {
+            config.tensor_value_alignment = 64;
+        }
+        return config;
+    }
+
     const std::string& get_model_path() const override { return model_path; }
 
     std::vector<uint8_t> get_model_data() override;
@@ -112,6 +124,7 @@ public:
 
 private:
     bool share_model_mem;
+    bool mmap_model = false;
     std::string model_path;
     std::unique_ptr<mgb::serialization::InputFile> m_model_file;
     mgb::serialization::GraphLoadConfig m_load_config;
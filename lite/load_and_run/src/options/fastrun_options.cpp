@@ -10,6 +10,7 @@
 #include "fastrun_options.h"
 #include "megbrain/gopt/inference.h"
 #include "megbrain/utils/infile_persistent_cache.h"
+#include "megbrain/utils/mmap_persistent_cache.h"
 #include "misc.h"
 #include "models/model_lite.h"
 #include "models/model_mdl.h"
@@ -31,8 +32,10 @@ void FastRunOption::config_model_internel<ModelLite>(
             LITE_LOG("enable fast-run strategy for algo profile");
             strategy = static_cast<uint32_t>(Strategy::LITE_ALGO_PROFILE) |
                        static_cast<uint32_t>(Strategy::LITE_ALGO_OPTIMIZED) | strategy;
-        } else if ((!m_fast_run_cache.empty() &&
-                    !access(m_fast_run_cache.c_str(), F_OK))) {
+        } else if (
+                (!m_fast_run_cache.empty() &&
+                 !access(m_fast_run_cache.c_str(), F_OK)) ||
+                !m_fast_run_shared_cache.empty()) {
             LITE_LOG(
                     "detect fast-run cache usable set LITE_ALGO_PROFILE for algo "
                     "profile");
@@ -63,6 +66,10 @@ void FastRunOption::config_model_internel<ModelLite>(
                 lite::set_persistent_cache(m_fast_run_cache, true);
             }
         }
+        if (!m_fast_run_shared_cache.empty()) {
+            mgb::PersistentCache::set_impl(std::make_shared<mgb::MmapPersistentCache>(
+                    m_fast_run_shared_cache.c_str()));
+        }
     } else if (runtime_param.stage == RunStage::AFTER_MODEL_RUNNING) {
 #if MGB_ENABLE_FASTRUN
         //! dump algo cache
@@ -128,6 +135,15 @@ void FastRunOption::config_model_internel<ModelMdl>(
             }
 #if MGB_ENABLE_FASTRUN
             if (!enable_full_run && !enable_fast_run)
+#endif
+                mgb::gopt::enable_opr_use_profiling_cache_inplace(vars);
+        }
+        if (!m_fast_run_shared_cache.empty()) {
+            //! profiling results are written to the file when they are put
+            mgb::PersistentCache::set_impl(std::make_shared<mgb::MmapPersistentCache>(
+                    m_fast_run_shared_cache.c_str()));
+#if MGB_ENABLE_FASTRUN
+            if (!enable_full_run && !enable_fast_run)
 #endif
                 mgb::gopt::enable_opr_use_profiling_cache_inplace(vars);
         }
@@ -155,6 +171,11 @@ void FastRunOption::update() {
     batch_binary_equal = FLAGS_binary_equal_between_batch;
     enable_reproducible = FLAGS_reproducible;
     m_fast_run_cache = FLAGS_fast_run_algo_policy;
+    m_fast_run_shared_cache = FLAGS_fast_run_shared_cache;
+    mgb_assert(
+            m_fast_run_cache.empty() || m_fast_run_shared_cache.empty(),
+            "--fast-run-algo-policy and --fast-run-shared-cache can not be used "
+            "together");
     share_batch_size = FLAGS_fast_run_shared_batch_size;
     m_option = {
 #if MGB_ENABLE_FASTRUN
@@ -184,9 +205,11 @@ void FastRunOption::update() {
     }
     if (share_batch_size) {
         mgb_assert(
-                enable_full_run || enable_fast_run || !m_fast_run_cache.empty(),
+                enable_full_run || enable_fast_run || !m_fast_run_cache.empty() ||
+                        !m_fast_run_shared_cache.empty(),
                 "--fast-run-shared-batch-size should be used with "
-                "--fast-run|--full-run|--fast-run-algo-policy");
+                "--fast-run|--full-run|--fast-run-algo-policy|"
+                "--fast-run-shared-cache");
     }
 #endif
 }
@@ -201,6 +224,7 @@ bool FastRunOption::is_valid() {
     ret = ret || FLAGS_fast_run_shared_batch_size > 0;
     ret = ret || FLAGS_reproducible;
     ret = ret || FLAGS_fast_run_algo_policy.size() > 0;
+    ret = ret || FLAGS_fast_run_shared_cache.size() > 0;
 
     return ret || m_valid;
 }
@@ -254,6 +278,12 @@ DEFINE_bool(
         "for more details.");
 DEFINE_int32(fast_run_shared_batch_size, 0, "Set the batch size used during fastrun");
 DEFINE_string(fast_run_algo_policy, "", "fast-run cache path.");
+DEFINE_string(
+        fast_run_shared_cache, "",
+        "path of a memory-mapped fast-run cache which can be used by several "
+        "processes at the same time; new profiling results are written to it "
+        "immediately, and it is recreated if the versions or CPU features do "
+        "not match");
 
 REGIST_OPTION_CREATOR(fastrun, lar::FastRunOption::create_option);
 REGIST_OPTION_VALIDATER(fastrun, lar::FastRunOption::set_valid);
@@ -75,10 +75,8 @@ void GoptLayoutOption::config_model_internel<ModelMdl>(
                     out_file->write(&testcase_num, sizeof(testcase_num));
                 }
 
-                using DumpConfig = mgb::serialization::GraphDumper::DumpConfig;
-                DumpConfig config{1, false, false};
                 auto dumper = model->get_dumper(std::move(out_file));
-                dumper->dump(load_result.output_var_list, config);
+                dumper->dump(load_result.output_var_list, model->get_dump_config());
 
                 if (testcase_num) {
                     auto input_file = model->get_loader()->reset_file();
@@ -29,6 +29,7 @@ void StrategyOption::config_model(
         RuntimeParam& runtime_param, std::shared_ptr<ModelBase> model) {
     if (runtime_param.stage == RunStage::BEFORE_MODEL_LOAD) {
         model->set_shared_mem(FLAGS_share_param_mem);
+        model->set_mmap_model(FLAGS_mmap_model);
         runtime_param.warmup_iter = warmup_iter;
         runtime_param.run_iter = run_iter;
         runtime_param.threads = threads;
@@ -111,6 +112,13 @@ DEFINE_int32(
 
 DEFINE_bool(share_param_mem, false, "load model from shared memeory");
 
+DEFINE_bool(
+        mmap_model, false,
+        "map the model file into memory and share the aligned params without "
+        "copy (only for mdl model on CPU); the params are aligned if the model "
+        "is dumped with tensor_value_alignment, as is done for the models "
+        "dumped by load_and_run with this option");
+
 REGIST_OPTION_CREATOR(run_strategy, lar::StrategyOption::create_option);
 
 REGIST_OPTION_CREATOR(run_testcase, lar::TestcaseOption::create_option);
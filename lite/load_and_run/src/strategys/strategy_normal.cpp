@@ -1,4 +1,5 @@
 #include "strategy_normal.h"
+#include <fstream>
 #include <iostream>
 #include <thread>
 #include "megbrain/common.h"
@@ -8,6 +9,29 @@
 
 using namespace lar;
 
+namespace {
+//! log the current and peak resident memory of this process, in MB
+void log_rss(const char* stage) {
+#if defined(__linux__) || defined(ANDROID)
+    std::ifstream fin("/proc/self/status");
+    std::string line;
+    double rss = -1, peak = -1;
+    while (std::getline(fin, line)) {
+        if (!line.compare(0, 6, "VmRSS:")) {
+            rss = std::stod(line.substr(6)) / 1024;
+        } else if (!line.compare(0, 6, "VmHWM:")) {
+            peak = std::stod(line.substr(6)) / 1024;
+        }
+    }
+    if (rss >= 0) {
+        mgb_log("%s: rss %.2fMB, peak rss %.2fMB", stage, rss, peak);
+    }
+#else
+    MGB_MARK_USED_VAR(stage);
+#endif
+}
+}  // namespace
+
 NormalStrategy::NormalStrategy(std::string model_path) {
     m_options = std::make_shared<OptionMap>();
     m_model_path = model_path;
@@ -46,9 +70,10 @@ void NormalStrategy::run_subline() {
     model->create_network();
     stage_config_model();
 
-    mgb::RealTimer timer;
+    mgb::RealTimer timer, cold_start_timer;
     model->load_model();
     mgb_log("load model: %.3fms\n", timer.get_msecs_reset());
+    log_rss("after load model");
 
     //! after load configure
     auto config_after_load = [&]() {
@@ -119,6 +144,9 @@ void NormalStrategy::run_subline() {
 
         if (idx == 0) {
             warm_up();
+            mgb_log("cold start (load and warm up): %.3fms",
+                    cold_start_timer.get_msecs());
+            log_rss("after warm up");
         }
         tot_time += run_iter(idx);
 
@@ -0,0 +1,68 @@
+#include "strategy_tuning.h"
+#include <gflags/gflags.h>
+#include "megbrain/utils/infile_persistent_cache.h"
+#include "megbrain/utils/timer.h"
+#include "options/fastrun_options.h"
+#include "options/io_options.h"
+#include "strategy_normal.h"
+
+using namespace lar;
+
+namespace {
+void set_flag(const char* name, const std::string& value) {
+    auto ret = gflags::SetCommandLineOption(name, value.c_str());
+    mgb_assert(!ret.empty(), "failed to set --%s=%s", name, value.c_str());
+}
+}  // namespace
+
+TuningStrategy::TuningStrategy(
+        std::string model_path, std::vector<std::string> inputs,
+        std::vector<int> threads, std::string output)
+        : m_model_path{std::move(model_path)},
+          m_inputs{std::move(inputs)},
+          m_threads{std::move(threads)},
+          m_output{std::move(output)} {
+    mgb_assert(!m_output.empty(), "the output algo-policy path is empty");
+    if (m_inputs.empty()) {
+        m_inputs.push_back(FLAGS_input);
+    }
+    if (m_threads.empty()) {
+        m_threads.push_back(0);
+    }
+}
+
+void TuningStrategy::run() {
+#if MGB_ENABLE_FASTRUN
+    // the profiling results are loaded from and dumped to the output file by
+    // FastRunOption in each run
+    if (!FLAGS_full_run) {
+        set_flag("fast_run", "true");
+    }
+    set_flag("fast_run_algo_policy", m_output);
+    mgb::RealTimer timer;
+    for (auto nr_thread : m_threads) {
+        if (nr_thread > 0) {
+            set_flag("multithread", std::to_string(nr_thread));
+        }
+        for (auto&& input : m_inputs) {
+            set_flag("input", input);
+            mgb_log("=== tuning with input \"%s\" and %d threads", input.c_str(),
+                    nr_thread);
+            NormalStrategy strategy{m_model_path};
+            strategy.run();
+        }
+    }
+
+    auto cache = std::make_shared<mgb::InFilePersistentCache>(m_output.c_str());
+    cache->put_host_signature();
+    cache->dump_cache(m_output.c_str());
+    mgb_log("=== algo-policy for %zu configs is written to %s in %.3fs",
+            m_inputs.size() * m_threads.size(), m_output.c_str(), timer.get_secs());
+#else
+    mgb_throw(
+            mgb::MegBrainError,
+            "fast-run tuning needs to be compiled with MGB_ENABLE_FASTRUN");
+#endif
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <vector>
+#include "strategy.h"
+
+namespace lar {
+/*!
+ * \brief strategy that profiles the algorithms of a model offline
+ *
+ * The model is run once with fast-run for each combination of the input
+ * shapes and thread numbers, and all the profiling results are accumulated in
+ * one algo-policy file, which can be loaded by lite::set_persistent_cache() or
+ * --fast-run-algo-policy without profiling at runtime. The file records the
+ * signature of the tuning host, which is checked when it is loaded.
+ */
+class TuningStrategy : public StrategyBase {
+public:
+    /*!
+     * \param inputs values of --input to tune for; empty to use --input
+     * \param threads values of --multithread to tune for; empty to use the
+     *      device options
+     * \param output path of the algo-policy file
+     */
+    TuningStrategy(
+            std::string model_path, std::vector<std::string> inputs,
+            std::vector<int> threads, std::string output);
+
+    void run() override;
+
+private:
+    std::string m_model_path;
+    std::vector<std::string> m_inputs;
+    std::vector<int> m_threads;
+    std::string m_output;
+};
+}  // namespace lar
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
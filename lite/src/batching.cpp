@@ -0,0 +1,475 @@
+#include "lite/serving.h"
+#include "misc.h"
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace lite;
+
+/*!
+ * \brief implement the NetworkBatching
+ *
+ * A batcher thread takes the pending requests in FIFO order until the batch is
+ * full or the oldest one has waited for max_wait_us, then copies them into the
+ * inputs of the network of the smallest fitting bucket and forwards it
+ * asynchronously. The async callback runs on the comp node thread, scatters the
+ * outputs back to the requests and releases the bucket.
+ */
+class NetworkBatching::Impl {
+public:
+    Impl(const Config& config, const NetworkIO& network_io,
+         const BatchingConfig& batching_config);
+    ~Impl();
+
+    void load_model(const std::function<void(Network&)>& load);
+
+    std::future<ServingTensorMap> submit(ServingTensorMap inputs);
+
+    void wait();
+
+    std::vector<size_t> get_batch_buckets() const { return m_batch_buckets; }
+
+    BatchingStat get_stat() const;
+
+    void reset_stat();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    //! number of the recent requests whose latency is used for the percentiles
+    static constexpr size_t LATENCY_WINDOW = 4096;
+
+    struct Request {
+        ServingTensorMap inputs;
+        size_t batch;
+        Clock::time_point submit_time;
+        std::promise<ServingTensorMap> promise;
+    };
+
+    struct Bucket {
+        size_t batch;
+        std::shared_ptr<Network> network;
+        //! the requests being forwarded, empty if the bucket is free
+        std::vector<Request> requests;
+    };
+
+    void run_batcher();
+
+    //! fill the inputs of the bucket and forward it, called without lock
+    void forward(Bucket& bucket);
+
+    //! async callback of the network of the bucket
+    void on_finish(Bucket& bucket);
+
+    //! set the exception to the requests of the bucket and release it
+    void release_with_error(Bucket& bucket, std::exception_ptr error);
+
+    //! mark a forwarded batch finished, it must be the last access to this
+    void finish_bucket();
+
+    Config m_config;
+    NetworkIO m_network_io;
+    BatchingConfig m_batching_config;
+    std::vector<size_t> m_batch_buckets;
+    std::vector<std::unique_ptr<Bucket>> m_buckets;
+    std::vector<std::string> m_input_names, m_output_names;
+    bool m_loaded = false;
+    std::thread m_batcher;
+
+    mutable std::mutex m_mtx;
+    //! notified when a request is submitted, a bucket is released or the
+    //! batching is destroyed
+    std::condition_variable m_cv;
+    //! notified when a forwarded batch finishes
+    std::condition_variable m_cv_finish;
+    std::deque<Request> m_pending;
+    size_t m_nr_pending_samples = 0;
+    size_t m_nr_running_buckets = 0;
+    bool m_should_exit = false;
+
+    size_t m_nr_requests = 0, m_nr_batches = 0, m_nr_samples = 0;
+    std::vector<double> m_latency_ms;
+    size_t m_latency_pos = 0;
+};
+
+NetworkBatching::Impl::Impl(
+        const Config& config, const NetworkIO& network_io,
+        const BatchingConfig& batching_config)
+        : m_config{config},
+          m_network_io{network_io},
+          m_batching_config{batching_config} {
+    LITE_ASSERT(
+            config.device_type == LiteDeviceType::LITE_CPU,
+            "NetworkBatching is only avaliable in CPU.");
+    LITE_ASSERT(
+            !config.options.force_output_use_user_specified_memory,
+            "NetworkBatching owns the output memory of the networks.");
+    size_t max_batch = batching_config.max_batch_size;
+    LITE_ASSERT(max_batch > 0, "max_batch_size should be positive");
+    m_batch_buckets = batching_config.batch_buckets;
+    if (m_batch_buckets.empty()) {
+        for (size_t i = 1; i < max_batch; i *= 2) {
+            m_batch_buckets.push_back(i);
+        }
+    }
+    m_batch_buckets.push_back(max_batch);
+    std::sort(m_batch_buckets.begin(), m_batch_buckets.end());
+    m_batch_buckets.erase(
+            std::unique(m_batch_buckets.begin(), m_batch_buckets.end()),
+            m_batch_buckets.end());
+    LITE_ASSERT(
+            m_batch_buckets.front() > 0 && m_batch_buckets.back() == max_batch,
+            "batch buckets should be in (0, max_batch_size]");
+}
+
+NetworkBatching::Impl::~Impl() {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_should_exit = true;
+    }
+    m_cv.notify_all();
+    if (m_batcher.joinable()) {
+        m_batcher.join();
+    }
+    // the networks should not be destroyed before their async callbacks
+    wait();
+}
+
+void NetworkBatching::Impl::load_model(const std::function<void(Network&)>& load) {
+    LITE_ASSERT(!m_loaded, "the model of NetworkBatching is already loaded.");
+    for (size_t batch : m_batch_buckets) {
+        auto bucket = std::make_unique<Bucket>();
+        bucket->batch = batch;
+        bucket->network = std::make_shared<Network>(m_config, m_network_io);
+        auto bucket_ptr = bucket.get();
+        bucket->network->set_async_callback(
+                [this, bucket_ptr]() { on_finish(*bucket_ptr); });
+        if (m_buckets.empty()) {
+            load(*bucket->network);
+        } else {
+            Runtime::shared_weight_with_network(
+                    bucket->network, m_buckets[0]->network);
+        }
+        m_buckets.emplace_back(std::move(bucket));
+    }
+
+    auto&& network = *m_buckets[0]->network;
+    m_input_names = network.get_all_input_name();
+    m_output_names = network.get_all_output_name();
+    for (auto&& bucket : m_buckets) {
+        for (auto&& name : m_input_names) {
+            auto input =
+                    bucket->network->get_io_tensor(name, LiteTensorPhase::LITE_INPUT);
+            auto layout = input->get_layout();
+            LITE_ASSERT(
+                    layout.ndim > 0, "the input %s should be batched on dim 0",
+                    name.c_str());
+            layout.shapes[0] = bucket->batch;
+            input->set_layout(layout);
+            // the padded samples are never read back, but keep them initialized
+            input->fill_zero();
+        }
+    }
+    m_loaded = true;
+    m_batcher = std::thread{&Impl::run_batcher, this};
+}
+
+std::future<ServingTensorMap> NetworkBatching::Impl::submit(ServingTensorMap inputs) {
+    LITE_ASSERT(m_loaded, "submit should be used after model loaded.");
+    LITE_ASSERT(
+            inputs.size() == m_input_names.size(),
+            "%zu inputs are given, but %zu are expected", inputs.size(),
+            m_input_names.size());
+    size_t batch = 0;
+    for (auto&& i : inputs) {
+        LITE_CHECK_NON_NULL_POINTER(i.second);
+        auto&& layout = i.second->get_layout();
+        LITE_ASSERT(
+                layout.ndim > 0 && i.second->is_continue_memory(),
+                "the input %s should be a contiguous tensor", i.first.c_str());
+        LITE_ASSERT(
+                !batch || batch == layout.shapes[0],
+                "the inputs have different batch sizes");
+        batch = layout.shapes[0];
+    }
+    LITE_ASSERT(
+            batch > 0 && batch <= m_batching_config.max_batch_size,
+            "the batch size %zu of the request is not in (0, %zu]", batch,
+            m_batching_config.max_batch_size);
+
+    std::future<ServingTensorMap> ret;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_pending.emplace_back();
+        auto&& request = m_pending.back();
+        request.inputs = std::move(inputs);
+        request.batch = batch;
+        request.submit_time = Clock::now();
+        ret = request.promise.get_future();
+        m_nr_pending_samples += batch;
+    }
+    m_cv.notify_all();
+    return ret;
+}
+
+void NetworkBatching::Impl::wait() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_cv_finish.wait(
+            lock, [this]() { return m_pending.empty() && !m_nr_running_buckets; });
+}
+
+void NetworkBatching::Impl::run_batcher() {
+    size_t max_batch = m_batching_config.max_batch_size;
+    auto max_wait = std::chrono::microseconds(m_batching_config.max_wait_us);
+    std::unique_lock<std::mutex> lock(m_mtx);
+    for (;;) {
+        m_cv.wait(lock, [this]() { return !m_pending.empty() || m_should_exit; });
+        // pending requests are still served when the batching is destroyed
+        if (m_pending.empty()) {
+            return;
+        }
+        auto deadline = m_pending.front().submit_time + max_wait;
+        m_cv.wait_until(lock, deadline, [&]() {
+            return m_nr_pending_samples >= max_batch || m_should_exit;
+        });
+
+        size_t nr_requests = 0, batch = 0;
+        while (nr_requests < m_pending.size() &&
+               batch + m_pending[nr_requests].batch <= max_batch) {
+            batch += m_pending[nr_requests++].batch;
+        }
+        auto fit = [batch](const std::unique_ptr<Bucket>& i) {
+            return i->batch >= batch;
+        };
+        auto&& bucket = **std::find_if(m_buckets.begin(), m_buckets.end(), fit);
+        // wait for the previous batch forwarded by the same bucket
+        m_cv.wait(lock, [&bucket]() { return bucket.requests.empty(); });
+
+        for (size_t i = 0; i < nr_requests; ++i) {
+            bucket.requests.emplace_back(std::move(m_pending.front()));
+            m_pending.pop_front();
+        }
+        m_nr_pending_samples -= batch;
+        ++m_nr_running_buckets;
+        lock.unlock();
+        forward(bucket);
+        lock.lock();
+    }
+}
+
+void NetworkBatching::Impl::forward(Bucket& bucket) {
+#if LITE_ENABLE_EXCEPTION
+    try {
+#endif
+        auto&& network = *bucket.network;
+        for (auto&& name : m_input_names) {
+            auto dst = network.get_io_tensor(name, LiteTensorPhase::LITE_INPUT);
+            auto&& dst_layout = dst->get_layout();
+            size_t sample_size = dst->get_tensor_total_size_in_byte() / bucket.batch;
+            auto dst_ptr = static_cast<uint8_t*>(dst->get_memory_ptr());
+            for (auto&& request : bucket.requests) {
+                auto iter = request.inputs.find(name);
+                LITE_ASSERT(
+                        iter != request.inputs.end(), "the input %s is not given",
+                        name.c_str());
+                auto&& src = *iter->second;
+                auto&& src_layout = src.get_layout();
+                bool same_sample = src_layout.ndim == dst_layout.ndim &&
+                                   src_layout.data_type == dst_layout.data_type;
+                for (size_t i = 1; same_sample && i < src_layout.ndim; ++i) {
+                    same_sample = src_layout.shapes[i] == dst_layout.shapes[i];
+                }
+                LITE_ASSERT(
+                        same_sample, "the sample layout of the input %s mismatches",
+                        name.c_str());
+                size_t size = request.batch * sample_size;
+                memcpy(dst_ptr, src.get_memory_ptr(), size);
+                dst_ptr += size;
+            }
+        }
+        network.forward();
+#if LITE_ENABLE_EXCEPTION
+    } catch (...) {
+        release_with_error(bucket, std::current_exception());
+    }
+#endif
+}
+
+void NetworkBatching::Impl::on_finish(Bucket& bucket) {
+    auto finish_time = Clock::now();
+#if LITE_ENABLE_EXCEPTION
+    try {
+#endif
+        auto&& network = *bucket.network;
+        for (auto&& request : bucket.requests) {
+            request.inputs.clear();
+        }
+        std::vector<ServingTensorMap> outputs(bucket.requests.size());
+        for (auto&& name : m_output_names) {
+            auto src = network.get_io_tensor(name, LiteTensorPhase::LITE_OUTPUT);
+            auto layout = src->get_layout();
+            LITE_ASSERT(
+                    layout.ndim > 0 && layout.shapes[0] == bucket.batch,
+                    "the output %s should be batched on dim 0", name.c_str());
+            size_t sample_size = src->get_tensor_total_size_in_byte() / bucket.batch;
+            auto src_ptr = static_cast<const uint8_t*>(src->get_memory_ptr());
+            for (size_t i = 0; i < bucket.requests.size(); ++i) {
+                layout.shapes[0] = bucket.requests[i].batch;
+                auto dst = std::make_shared<Tensor>(LiteDeviceType::LITE_CPU, layout);
+                size_t size = layout.shapes[0] * sample_size;
+                memcpy(dst->get_memory_ptr(), src_ptr, size);
+                src_ptr += size;
+                outputs[i][name] = std::move(dst);
+            }
+        }
+        std::vector<Request> requests;
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            size_t batch = 0;
+            for (auto&& request : bucket.requests) {
+                std::chrono::duration<double, std::milli> latency =
+                        finish_time - request.submit_time;
+                if (m_latency_ms.size() < LATENCY_WINDOW) {
+                    m_latency_ms.push_back(latency.count());
+                } else {
+                    m_latency_ms[m_latency_pos] = latency.count();
+                    m_latency_pos = (m_latency_pos + 1) % LATENCY_WINDOW;
+                }
+                batch += request.batch;
+            }
+            m_nr_requests += bucket.requests.size();
+            m_nr_samples += batch;
+            ++m_nr_batches;
+            requests.swap(bucket.requests);
+        }
+        // the bucket is released before setting the promises, so a caller
+        // waiting on the future can submit to the same bucket at once
+        m_cv.notify_all();
+        for (size_t i = 0; i < requests.size(); ++i) {
+            requests[i].promise.set_value(std::move(outputs[i]));
+        }
+        finish_bucket();
+#if LITE_ENABLE_EXCEPTION
+    } catch (...) {
+        release_with_error(bucket, std::current_exception());
+    }
+#endif
+}
+
+void NetworkBatching::Impl::release_with_error(
+        Bucket& bucket, std::exception_ptr error) {
+    std::vector<Request> requests;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        requests.swap(bucket.requests);
+    }
+    m_cv.notify_all();
+    for (auto&& request : requests) {
+        request.promise.set_exception(error);
+    }
+    finish_bucket();
+}
+
+void NetworkBatching::Impl::finish_bucket() {
+    // notify under the lock, as the batching may be destroyed once wait()
+    // returns
+    std::lock_guard<std::mutex> lock(m_mtx);
+    --m_nr_running_buckets;
+    m_cv_finish.notify_all();
+}
+
+BatchingStat NetworkBatching::Impl::get_stat() const {
+    std::vector<double> latency_ms;
+    BatchingStat ret;
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        latency_ms = m_latency_ms;
+        ret.nr_requests = m_nr_requests;
+        ret.nr_batches = m_nr_batches;
+        if (m_nr_batches) {
+            ret.avg_batch_size = static_cast<double>(m_nr_samples) / m_nr_batches;
+        }
+    }
+    if (!latency_ms.empty()) {
+        auto percentile = [&latency_ms](double p) {
+            size_t idx = std::min<size_t>(
+                    latency_ms.size() * p / 100, latency_ms.size() - 1);
+            std::nth_element(
+                    latency_ms.begin(), latency_ms.begin() + idx, latency_ms.end());
+            return latency_ms[idx];
+        };
+        ret.p50_latency_ms = percentile(50);
+        ret.p99_latency_ms = percentile(99);
+    }
+    return ret;
+}
+
+void NetworkBatching::Impl::reset_stat() {
+    std::lock_guard<std::mutex> lock(m_mtx);
+    m_nr_requests = m_nr_batches = m_nr_samples = 0;
+    m_latency_ms.clear();
+    m_latency_pos = 0;
+}
+
+/*********************** NetworkBatching ***************/
+
+NetworkBatching::NetworkBatching(
+        const Config& config, const NetworkIO& network_io,
+        const BatchingConfig& batching_config) {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl = std::make_unique<Impl>(config, network_io, batching_config);
+    LITE_ERROR_HANDLER_END
+}
+
+NetworkBatching::~NetworkBatching() = default;
+
+void NetworkBatching::load_model(void* model_mem, size_t size) {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl->load_model(
+            [&](Network& network) { network.load_model(model_mem, size); });
+    LITE_ERROR_HANDLER_END
+}
+
+void NetworkBatching::load_model(std::string model_path) {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl->load_model([&](Network& network) { network.load_model(model_path); });
+    LITE_ERROR_HANDLER_END
+}
+
+std::future<ServingTensorMap> NetworkBatching::submit(ServingTensorMap inputs) {
+    LITE_ERROR_HANDLER_BEGIN
+    return m_impl->submit(std::move(inputs));
+    LITE_ERROR_HANDLER_END
+}
+
+void NetworkBatching::wait() {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl->wait();
+    LITE_ERROR_HANDLER_END
+}
+
+std::vector<size_t> NetworkBatching::get_batch_buckets() const {
+    LITE_ERROR_HANDLER_BEGIN
+    return m_impl->get_batch_buckets();
+    LITE_ERROR_HANDLER_END
+}
+
+BatchingStat NetworkBatching::get_stat() const {
+    LITE_ERROR_HANDLER_BEGIN
+    return m_impl->get_stat();
+    LITE_ERROR_HANDLER_END
+}
+
+void NetworkBatching::reset_stat() {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl->reset_stat();
+    LITE_ERROR_HANDLER_END
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
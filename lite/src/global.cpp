@@ -162,6 +162,12 @@ void lite::set_persistent_cache(const std::string& cache_path, bool always_sync)
     cache_control.config_algo_times++;
     mgb::PersistentCache::set_impl(std::make_shared<mgb::InFilePersistentCache>(
             cache_path.c_str(), always_sync));
+    if (!mgb::PersistentCache::inst().check_host_signature()) {
+        LITE_WARN(
+                "The cache %s is tuned on a host with different CPU or library "
+                "versions, the algorithms in it may be not optimal.",
+                cache_path.c_str());
+    }
 }
 
 void lite::dump_persistent_cache(const std::string& cache_path) {
@@ -98,6 +98,8 @@ inline void call_func<NetworkImplDft, void>(
         CALL_FUNC(set_cpu_threads_number, num);
     } else if (func_name == "set_network_algo_workspace_limit") {
         CALL_FUNC(set_network_algo_workspace_limit, num);
+    } else if (func_name == "set_cpu_threads_spin_budget") {
+        CALL_FUNC(set_cpu_threads_spin_budget, num);
     } else {
         THROW_FUNC_ERROR(func_name);
     }
@@ -126,6 +128,35 @@ inline size_t call_func<NetworkImplDft, size_t>(
     THROW_FUNC_ERROR(func_name);
 }
 
+template <>
+inline CpuThreadsWaitStat call_func<NetworkImplDft, CpuThreadsWaitStat>(
+        std::string func_name, Network::NetworkImplBase* network_impl) {
+    if (func_name == "get_cpu_threads_wait_stat") {
+        return CALL_FUNC(get_cpu_threads_wait_stat);
+    }
+    THROW_FUNC_ERROR(func_name);
+}
+
+template <>
+inline ShapeCacheStat call_func<NetworkImplDft, ShapeCacheStat>(
+        std::string func_name, Network::NetworkImplBase* network_impl) {
+    if (func_name == "get_shape_cache_stat") {
+        return CALL_FUNC(get_shape_cache_stat);
+    }
+    THROW_FUNC_ERROR(func_name);
+}
+
+template <>
+inline void call_func<NetworkImplDft, void>(
+        std::string func_name, Network::NetworkImplBase* network_impl,
+        size_t capacity, std::vector<ShapeBucket> buckets) {
+    if (func_name == "enable_shape_cache") {
+        CALL_FUNC(enable_shape_cache, capacity, std::move(buckets));
+    } else {
+        THROW_FUNC_ERROR(func_name);
+    }
+}
+
 template <>
 inline bool call_func<NetworkImplDft, bool>(
         std::string func_name, Network::NetworkImplBase* network_impl) {
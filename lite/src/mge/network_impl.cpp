@@ -17,6 +17,7 @@
 #include "megbrain/opr/io.h"
 #include "megbrain/opr/tensor_manip.h"
 #include "megbrain/tensor.h"
+#include "megbrain/utils/thread_pool.h"
 
 #if MGB_OPENCL
 #include "megcore_opencl.h"
@@ -26,6 +27,8 @@
 #include "cpuinfo.h"
 #endif
 
+#include <algorithm>
+#include <cstring>
 #include <fstream>
 #include <memory>
 #include <set>
@@ -200,6 +203,39 @@ void NetworkImplDft::set_runtime_thread_affinity(
     }
 }
 
+void NetworkImplDft::set_cpu_threads_spin_budget(size_t spin_budget_us) {
+    LITE_ASSERT(
+            m_user_config->device_type == LiteDeviceType::LITE_CPU,
+            "multi threads mode is only avaliable in CPU.");
+    mgb::CompNode::Locator loc;
+    m_load_config.comp_node_mapper(loc);
+    auto cn = mgb::CompNode::load(loc);
+    auto thread_pool = mgb::CompNodeEnv::from_comp_node(cn).cpu_env().get_thread_pool();
+    if (thread_pool) {
+        thread_pool->set_spin_budget_us(spin_budget_us);
+    } else {
+        LITE_WARN("spin budget is ignored as the network runs in single thread");
+    }
+}
+
+CpuThreadsWaitStat NetworkImplDft::get_cpu_threads_wait_stat() {
+    LITE_ASSERT(
+            m_user_config->device_type == LiteDeviceType::LITE_CPU,
+            "multi threads mode is only avaliable in CPU.");
+    mgb::CompNode::Locator loc;
+    m_load_config.comp_node_mapper(loc);
+    auto cn = mgb::CompNode::load(loc);
+    CpuThreadsWaitStat ret;
+    if (auto thread_pool =
+                mgb::CompNodeEnv::from_comp_node(cn).cpu_env().get_thread_pool()) {
+        auto stat = thread_pool->get_wait_stat();
+        ret.spin_ms = stat.spin_ms;
+        ret.park_ms = stat.park_ms;
+        ret.nr_park = stat.nr_park;
+    }
+    return ret;
+}
+
 void NetworkImplDft::set_device_id(int device_id) {
     m_compnode_locator.device = device_id;
     m_user_config->device_id = device_id;
@@ -616,6 +652,173 @@ void NetworkImplDft::compile_graph() {
     m_execute_func = m_load_result.graph_compile(m_output_spec);
 }
 
+void NetworkImplDft::enable_shape_cache(
+        size_t capacity, std::vector<ShapeBucket> buckets) {
+    LITE_ASSERT(capacity > 0, "the capacity of the shape cache should be positive.");
+    LITE_ASSERT(
+            m_user_config->options.comp_node_seq_record_level == 0 &&
+                    !m_user_config->options.force_output_use_user_specified_memory,
+            "shape cache can not be used with comp_node_seq_record_level or "
+            "force_output_use_user_specified_memory.");
+    LITE_ASSERT(
+            m_user_config->discrete_input_name.empty(),
+            "shape cache can not be used with discrete input.");
+    for (auto&& in : m_network_io->inputs) {
+        LITE_ASSERT(
+                in.is_host, "shape cache only supports host input, but %s is not.",
+                in.name.c_str());
+    }
+    for (auto&& bucket : buckets) {
+        LITE_ASSERT(
+                m_load_result.tensor_map.count(bucket.input_name),
+                "no input named %s to pad.", bucket.input_name.c_str());
+        LITE_ASSERT(
+                std::is_sorted(bucket.sizes.begin(), bucket.sizes.end()),
+                "the sizes of the shape bucket of %s should be in ascending order.",
+                bucket.input_name.c_str());
+    }
+    if (!m_shape_cache_capacity) {
+        //! detach the input lite tensors from the graph, the graph inputs would
+        //! be reset from them before each forward
+        for (auto&& in : m_network_io->inputs) {
+            auto&& impl = TensorHelper::implement(in.lite_tensor)
+                                  ->cast_final_safe<TensorImplDft>();
+            impl.m_host_tensor =
+                    std::make_shared<mgb::HostTensorND>(*impl.m_host_tensor);
+        }
+    }
+    m_shape_cache_capacity = capacity;
+    m_shape_buckets = std::move(buckets);
+    while (m_shape_cache.size() >= capacity) {
+        m_shape_cache.pop_back();
+    }
+}
+
+ShapeCacheStat NetworkImplDft::get_shape_cache_stat() const {
+    auto ret = m_shape_cache_stat;
+    ret.nr_executable = m_shape_cache.size() + m_shape_cache_keyed;
+    return ret;
+}
+
+void NetworkImplDft::prepare_shape_cache() {
+    ShapeKey key;
+    for (auto&& in : m_network_io->inputs) {
+        auto shape = TensorHelper::implement(in.lite_tensor)
+                             ->cast_final_safe<TensorImplDft>()
+                             .m_host_tensor->shape();
+        for (auto&& bucket : m_shape_buckets) {
+            if (bucket.input_name != in.name || bucket.axis >= shape.ndim) {
+                continue;
+            }
+            auto iter = std::lower_bound(
+                    bucket.sizes.begin(), bucket.sizes.end(), shape[bucket.axis]);
+            if (iter != bucket.sizes.end()) {
+                shape[bucket.axis] = *iter;
+            }
+        }
+        key.push_back(shape);
+    }
+    switch_shape_cache(key);
+
+    for (size_t i = 0; i < key.size(); ++i) {
+        auto&& in = m_network_io->inputs[i];
+        auto&& src = *TensorHelper::implement(in.lite_tensor)
+                              ->cast_final_safe<TensorImplDft>()
+                              .m_host_tensor;
+        auto&& dst = *m_load_result.tensor_map.at(in.name);
+        if (key[i].eq_shape(src.shape())) {
+            dst = src;
+            continue;
+        }
+        //! copy the input to the corner of a zero filled buffer
+        auto&& padded = m_shape_cache_padded[in.name];
+        if (!padded) {
+            padded = std::make_shared<mgb::HostTensorND>(src.comp_node(), src.dtype());
+        }
+        padded->resize(key[i]);
+        memset(padded->raw_ptr(), 0, padded->layout().span().dist_byte());
+        auto layout = padded->layout();
+        for (size_t j = 0; j < layout.ndim; ++j) {
+            layout.shape[j] = src.shape(j);
+        }
+        mgb::HostTensorND view;
+        view.reset(padded->storage(), layout);
+        view.copy_from_fixlayout(src);
+        dst = *padded;
+    }
+}
+
+void NetworkImplDft::switch_shape_cache(const ShapeKey& key) {
+    auto same_key = [&key](const ShapeKey& other) {
+        if (other.size() != key.size()) {
+            return false;
+        }
+        for (size_t i = 0; i < key.size(); ++i) {
+            if (!other[i].eq_shape(key[i])) {
+                return false;
+            }
+        }
+        return true;
+    };
+    if (!m_shape_cache_keyed) {
+        //! the current executable is compiled on the first forward
+        ++m_shape_cache_stat.nr_miss;
+        m_shape_cache_keyed = true;
+        m_shape_cache_key = key;
+        return;
+    }
+    if (same_key(m_shape_cache_key)) {
+        ++m_shape_cache_stat.nr_hit;
+        return;
+    }
+    auto iter = std::find_if(
+            m_shape_cache.begin(), m_shape_cache.end(),
+            [&](const ShapeCacheEntry& entry) { return same_key(entry.key); });
+    if (iter != m_shape_cache.end()) {
+        ++m_shape_cache_stat.nr_hit;
+    } else {
+        ++m_shape_cache_stat.nr_miss;
+        if (m_shape_cache.size() + 1 >= m_shape_cache_capacity) {
+            if (m_shape_cache.empty()) {
+                //! the current executable is recompiled on execution
+                m_shape_cache_key = key;
+                return;
+            }
+            //! recompile the least recently used executable for the new shapes
+            iter = std::prev(m_shape_cache.end());
+        }
+    }
+
+    ShapeCacheEntry cur;
+    cur.key = std::move(m_shape_cache_key);
+    cur.load_result = std::move(m_load_result);
+    cur.output_spec = std::move(m_output_spec);
+    cur.execute_func = std::move(m_execute_func);
+    if (iter != m_shape_cache.end()) {
+        m_load_result = std::move(iter->load_result);
+        m_output_spec = std::move(iter->output_spec);
+        m_execute_func = std::move(iter->execute_func);
+        m_shape_cache.erase(iter);
+    } else {
+        //! load the model to a new graph which shares the weights and the
+        //! runtime memory with the current one
+        auto graph = m_load_config.comp_graph;
+        m_load_config.comp_graph = mgb::ComputingGraph::make();
+        application_config();
+        auto&& options = m_load_config.comp_graph->options();
+        options.graph_opt = graph->options().graph_opt;
+        options.fast_run_config = graph->options().fast_run_config;
+        m_load_config.comp_graph->share_device_memory_with(*graph);
+        m_load_result = m_loader->load(m_load_config, true);
+        m_load_config.comp_graph = graph;
+        modify_exection_policy();
+        layout_transform_optimization();
+        compile_graph();
+    }
+    m_shape_cache.push_front(std::move(cur));
+    m_shape_cache_key = key;
+}
+
 void NetworkImplDft::start() const {
     if (m_start_callback) {
         std::unordered_map<std::string, std::pair<IO, std::shared_ptr<Tensor>>>
@@ -637,6 +840,9 @@ void NetworkImplDft::forward() {
         m_load_config.comp_graph.reset();
     }
     LITE_ASSERT(m_execute_func, "forward must be called after network loaded.");
+    if (m_shape_cache_capacity) {
+        prepare_shape_cache();
+    }
     m_execute_func->execute();
 }
 
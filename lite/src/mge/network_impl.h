@@ -8,6 +8,7 @@
 #include "network_impl_base.h"
 #include "tensor_impl.h"
 
+#include <list>
 #include <memory>
 #include <unordered_map>
 #include "megbrain/gopt/inference.h"
@@ -149,6 +150,16 @@ public:
     void set_runtime_thread_affinity(
             const ThreadAffinityCallback& thread_affinity_callback);
 
+    //! set the spin budget of the cpu worker threads
+    void set_cpu_threads_spin_budget(size_t spin_budget_us);
+    //! get the waiting statistics of the cpu worker threads
+    CpuThreadsWaitStat get_cpu_threads_wait_stat();
+
+    //! keep the compiled executables of the recently used input shapes
+    void enable_shape_cache(size_t capacity, std::vector<ShapeBucket> buckets);
+    //! get the statistics of the shape cache
+    ShapeCacheStat get_shape_cache_stat() const;
+
     //! set the network memroy allocator, the allocator is defined by user
     void set_memory_allocator(std::shared_ptr<Allocator> user_allocator);
 
@@ -242,6 +253,16 @@ private:
     //! configure and optimize network after loaded
     void configure_after_loaded();
 
+    //! shapes of the inputs of the graph, used as the key of the shape cache
+    using ShapeKey = std::vector<mgb::TensorShape>;
+
+    //! share or pad the input lite tensors to the inputs of the graph and switch
+    //! to the executable compiled for their shapes
+    void prepare_shape_cache();
+
+    //! make the executable for given shapes current, compile it if needed
+    void switch_shape_cache(const ShapeKey& key);
+
 private:
     bool m_async = false;
     bool m_is_cpu_inplace_mode = false;
@@ -277,6 +298,27 @@ private:
     std::string m_profiler_output_file;
 #endif
     std::unique_ptr<mgb::OprIODumpBase> m_iodump;
+
+    //! an executable compiled in its own graph, which shares the weights and
+    //! runtime memory with the network
+    struct ShapeCacheEntry {
+        ShapeKey key;
+        mgb::serialization::GraphLoader::LoadResult load_result;
+        mgb::ComputingGraph::OutputSpec output_spec;
+        std::unique_ptr<mgb::cg::AsyncExecutable> execute_func;
+    };
+
+    //! shape cache related data; the current executable is held by the members
+    //! above, and the others are ordered from the most recently used
+    size_t m_shape_cache_capacity = 0;
+    bool m_shape_cache_keyed = false;
+    ShapeKey m_shape_cache_key;
+    std::vector<ShapeBucket> m_shape_buckets;
+    std::list<ShapeCacheEntry> m_shape_cache;
+    //! buffers of the padded inputs
+    std::unordered_map<std::string, std::shared_ptr<mgb::HostTensorND>>
+            m_shape_cache_padded;
+    ShapeCacheStat m_shape_cache_stat;
 };
 //! get the model information before model loaded by Network
 NetworkIO get_model_io_info_dft(const std::string& model_path, const Config& config);
@@ -384,6 +384,65 @@ void Runtime::set_runtime_thread_affinity(
     LITE_ERROR_HANDLER_END
 }
 
+void Runtime::set_cpu_threads_spin_budget(
+        std::shared_ptr<Network> network, size_t spin_budget_us) {
+    LITE_ERROR_HANDLER_BEGIN
+    auto network_impl = NetworkHelper::implement(network);
+    if (network_impl->get_backend_type() == LiteBackend::LITE_DEFAULT) {
+        LITE_ASSERT(
+                NetworkHelper::loaded(network),
+                "set_cpu_threads_spin_budget should be used after model loaded.");
+        call_func<NetworkImplDft, void>(
+                "set_cpu_threads_spin_budget", network_impl, spin_budget_us);
+        return;
+    }
+    LITE_THROW("set_cpu_threads_spin_budget is not aviliable in the backend.");
+    LITE_ERROR_HANDLER_END
+}
+
+CpuThreadsWaitStat Runtime::get_cpu_threads_wait_stat(
+        std::shared_ptr<Network> network) {
+    LITE_ERROR_HANDLER_BEGIN
+    auto network_impl = NetworkHelper::implement(network);
+    if (network_impl->get_backend_type() == LiteBackend::LITE_DEFAULT) {
+        LITE_ASSERT(
+                NetworkHelper::loaded(network),
+                "get_cpu_threads_wait_stat should be used after model loaded.");
+        return call_func<NetworkImplDft, CpuThreadsWaitStat>(
+                "get_cpu_threads_wait_stat", network_impl);
+    }
+    LITE_THROW("get_cpu_threads_wait_stat is not aviliable in the backend.");
+    LITE_ERROR_HANDLER_END
+}
+
+void Runtime::enable_shape_cache(
+        std::shared_ptr<Network> network, size_t capacity,
+        const std::vector<ShapeBucket>& buckets) {
+    LITE_ERROR_HANDLER_BEGIN
+    auto network_impl = NetworkHelper::implement(network);
+    if (network_impl->get_backend_type() == LiteBackend::LITE_DEFAULT) {
+        LITE_ASSERT(
+                NetworkHelper::loaded(network),
+                "enable_shape_cache should be used after model loaded.");
+        call_func<NetworkImplDft, void>(
+                "enable_shape_cache", network_impl, capacity, buckets);
+        return;
+    }
+    LITE_THROW("enable_shape_cache is not aviliable in the backend.");
+    LITE_ERROR_HANDLER_END
+}
+
+ShapeCacheStat Runtime::get_shape_cache_stat(std::shared_ptr<Network> network) {
+    LITE_ERROR_HANDLER_BEGIN
+    auto network_impl = NetworkHelper::implement(network);
+    if (network_impl->get_backend_type() == LiteBackend::LITE_DEFAULT) {
+        return call_func<NetworkImplDft, ShapeCacheStat>(
+                "get_shape_cache_stat", network_impl);
+    }
+    LITE_THROW("get_shape_cache_stat is not aviliable in the backend.");
+    LITE_ERROR_HANDLER_END
+}
+
 void Runtime::set_cpu_inplace_mode(std::shared_ptr<Network> network) {
     LITE_ERROR_HANDLER_BEGIN
     auto network_impl = NetworkHelper::implement(network);
@@ -0,0 +1,276 @@
+#include "lite/serving.h"
+#include "misc.h"
+
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+using namespace lite;
+
+/*!
+ * \brief implement the NetworkServing
+ *
+ * Context 0 loads the model and the others share its weights by
+ * Runtime::shared_weight_with_network. Every context is a Network in cpu
+ * inplace mode, so all of them map to the same comp node (cpu:default, or
+ * multithread:default:nr_threads with a thread pool). Such a comp node has no
+ * worker queue: the kernels are executed by the thread calling forward(), and
+ * the multi-threading kernels of all the contexts are submitted to the one
+ * thread pool, which supports concurrent submitters. Each context is driven by
+ * one serving thread, which takes the requests from the shared queue in FIFO
+ * order.
+ *
+ * The default number of contexts makes the serving threads and the pool
+ * workers together use up the cpu cores.
+ */
+class NetworkServing::Impl {
+public:
+    Impl(const Config& config, const NetworkIO& network_io,
+         const ServingConfig& serving_config);
+    ~Impl();
+
+    void load_model(const std::function<void(Network&)>& load);
+
+    std::future<ServingTensorMap> submit(ServingTensorMap inputs);
+
+    void wait();
+
+    size_t nr_contexts() const { return m_networks.size(); }
+
+    std::shared_ptr<Network> get_network(size_t context_id) const {
+        LITE_ASSERT(
+                context_id < m_networks.size(), "invalid context id %zu of %zu",
+                context_id, m_networks.size());
+        return m_networks[context_id];
+    }
+
+private:
+    struct Request {
+        ServingTensorMap inputs;
+        std::promise<ServingTensorMap> promise;
+    };
+
+    void serve(size_t context_id);
+    ServingTensorMap forward(Network& network, const ServingTensorMap& inputs);
+
+    Config m_config;
+    NetworkIO m_network_io;
+    ServingConfig m_serving_config;
+    bool m_loaded = false;
+    std::vector<std::shared_ptr<Network>> m_networks;
+    std::vector<std::thread> m_threads;
+
+    std::mutex m_mtx;
+    //! notified when a request is submitted or the serving is destroyed
+    std::condition_variable m_cv_request;
+    //! notified when a request is taken or finished
+    std::condition_variable m_cv_finish;
+    std::deque<Request> m_requests;
+    size_t m_nr_running = 0;
+    bool m_should_exit = false;
+};
+
+NetworkServing::Impl::Impl(
+        const Config& config, const NetworkIO& network_io,
+        const ServingConfig& serving_config)
+        : m_config{config},
+          m_network_io{network_io},
+          m_serving_config{serving_config} {
+    LITE_ASSERT(
+            config.device_type == LiteDeviceType::LITE_CPU,
+            "NetworkServing is only avaliable in CPU.");
+    LITE_ASSERT(
+            !config.options.force_output_use_user_specified_memory,
+            "NetworkServing owns the output memory of the contexts.");
+    auto&& nr_threads = m_serving_config.nr_threads;
+    if (!nr_threads) {
+        nr_threads = 1;
+    }
+    size_t nr_cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    size_t nr_workers = nr_threads - 1;
+    auto&& nr_contexts = m_serving_config.nr_contexts;
+    if (!nr_contexts) {
+        nr_contexts = nr_cores > nr_workers ? nr_cores - nr_workers : 1;
+    } else if (nr_contexts + nr_workers > nr_cores) {
+        LITE_WARN(
+                "NetworkServing uses %zu contexts and %zu pool workers on %zu cpu "
+                "cores, the cores are oversubscribed.",
+                nr_contexts, nr_workers, nr_cores);
+    }
+}
+
+NetworkServing::Impl::~Impl() {
+    {
+        std::lock_guard<std::mutex> lock(m_mtx);
+        m_should_exit = true;
+    }
+    m_cv_request.notify_all();
+    m_cv_finish.notify_all();
+    for (auto&& thread : m_threads) {
+        thread.join();
+    }
+}
+
+void NetworkServing::Impl::load_model(const std::function<void(Network&)>& load) {
+    LITE_ASSERT(!m_loaded, "the model of NetworkServing is already loaded.");
+    size_t nr_contexts = m_serving_config.nr_contexts;
+    size_t nr_threads = m_serving_config.nr_threads;
+    for (size_t i = 0; i < nr_contexts; ++i) {
+        auto network = std::make_shared<Network>(m_config, m_network_io);
+        // the same locator of every context loads the same comp node
+        Runtime::set_cpu_inplace_mode(network);
+        if (nr_threads > 1) {
+            Runtime::set_cpu_threads_number(network, nr_threads);
+        }
+        if (i == 0) {
+            load(*network);
+        } else {
+            Runtime::shared_weight_with_network(network, m_networks[0]);
+        }
+        m_networks.emplace_back(std::move(network));
+    }
+    m_loaded = true;
+    for (size_t i = 0; i < nr_contexts; ++i) {
+        m_threads.emplace_back(&Impl::serve, this, i);
+    }
+}
+
+std::future<ServingTensorMap> NetworkServing::Impl::submit(ServingTensorMap inputs) {
+    LITE_ASSERT(m_loaded, "submit should be used after model loaded.");
+    std::future<ServingTensorMap> ret;
+    {
+        std::unique_lock<std::mutex> lock(m_mtx);
+        if (size_t max_pending = m_serving_config.max_pending_requests) {
+            m_cv_finish.wait(lock, [&]() {
+                return m_requests.size() < max_pending || m_should_exit;
+            });
+        }
+        m_requests.emplace_back();
+        m_requests.back().inputs = std::move(inputs);
+        ret = m_requests.back().promise.get_future();
+    }
+    m_cv_request.notify_one();
+    return ret;
+}
+
+void NetworkServing::Impl::wait() {
+    std::unique_lock<std::mutex> lock(m_mtx);
+    m_cv_finish.wait(lock, [this]() { return m_requests.empty() && !m_nr_running; });
+}
+
+void NetworkServing::Impl::serve(size_t context_id) {
+    auto&& network = *m_networks[context_id];
+    for (;;) {
+        Request request;
+        {
+            std::unique_lock<std::mutex> lock(m_mtx);
+            m_cv_request.wait(
+                    lock, [this]() { return !m_requests.empty() || m_should_exit; });
+            // pending requests are still served when the serving is destroyed
+            if (m_requests.empty()) {
+                return;
+            }
+            request = std::move(m_requests.front());
+            m_requests.pop_front();
+            ++m_nr_running;
+        }
+        m_cv_finish.notify_all();
+#if LITE_ENABLE_EXCEPTION
+        try {
+            request.promise.set_value(forward(network, request.inputs));
+        } catch (...) {
+            request.promise.set_exception(std::current_exception());
+        }
+#else
+        request.promise.set_value(forward(network, request.inputs));
+#endif
+        {
+            std::lock_guard<std::mutex> lock(m_mtx);
+            --m_nr_running;
+        }
+        m_cv_finish.notify_all();
+    }
+}
+
+ServingTensorMap NetworkServing::Impl::forward(
+        Network& network, const ServingTensorMap& inputs) {
+    // an input kept from the last request would refer to the memory of its caller
+    auto nr_inputs = network.get_all_input_name().size();
+    LITE_ASSERT(
+            inputs.size() == nr_inputs, "%zu inputs are given, but %zu are expected",
+            inputs.size(), nr_inputs);
+    for (auto&& i : inputs) {
+        LITE_CHECK_NON_NULL_POINTER(i.second);
+        auto dst = network.get_io_tensor(i.first, LiteTensorPhase::LITE_INPUT);
+        LITE_ASSERT(dst, "the network has no input named %s", i.first.c_str());
+        // the input memory is borrowed, so nothing is copied
+        dst->reset(i.second->get_memory_ptr(), i.second->get_layout());
+    }
+    network.forward();
+    network.wait();
+
+    // the output memory of the context is reused by the next request
+    ServingTensorMap outputs;
+    for (auto&& name : network.get_all_output_name()) {
+        auto src = network.get_io_tensor(name, LiteTensorPhase::LITE_OUTPUT);
+        auto dst = std::make_shared<Tensor>(
+                LiteDeviceType::LITE_CPU, src->get_layout());
+        dst->copy_from(*src);
+        outputs[name] = std::move(dst);
+    }
+    return outputs;
+}
+
+/*********************** NetworkServing ***************/
+
+NetworkServing::NetworkServing(
+        const Config& config, const NetworkIO& network_io,
+        const ServingConfig& serving_config) {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl = std::make_unique<Impl>(config, network_io, serving_config);
+    LITE_ERROR_HANDLER_END
+}
+
+NetworkServing::~NetworkServing() = default;
+
+void NetworkServing::load_model(void* model_mem, size_t size) {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl->load_model(
+            [&](Network& network) { network.load_model(model_mem, size); });
+    LITE_ERROR_HANDLER_END
+}
+
+void NetworkServing::load_model(std::string model_path) {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl->load_model([&](Network& network) { network.load_model(model_path); });
+    LITE_ERROR_HANDLER_END
+}
+
+std::future<ServingTensorMap> NetworkServing::submit(ServingTensorMap inputs) {
+    LITE_ERROR_HANDLER_BEGIN
+    return m_impl->submit(std::move(inputs));
+    LITE_ERROR_HANDLER_END
+}
+
+void NetworkServing::wait() {
+    LITE_ERROR_HANDLER_BEGIN
+    m_impl->wait();
+    LITE_ERROR_HANDLER_END
+}
+
+size_t NetworkServing::nr_contexts() const {
+    LITE_ERROR_HANDLER_BEGIN
+    return m_impl->nr_contexts();
+    LITE_ERROR_HANDLER_END
+}
+
+std::shared_ptr<Network> NetworkServing::get_network(size_t context_id) const {
+    LITE_ERROR_HANDLER_BEGIN
+    return m_impl->get_network(context_id);
+    LITE_ERROR_HANDLER_END
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
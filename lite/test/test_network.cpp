@@ -3,6 +3,7 @@
 
 #if LITE_BUILD_WITH_MGE
 #include "./test_common.h"
+#include "lite/serving.h"
 #include "megbrain/tensor.h"
 
 #ifndef WIN32
@@ -379,6 +380,117 @@ TEST(TestNetWork, SharedRuntimeMem) {
     network_dst->load_model(model_path);
 }
 
+TEST(TestNetWork, Serving) {
+    Config config;
+    auto lite_tensor = get_input_data("./input_data.npy");
+    std::string model_path = "./shufflenet.mge";
+
+    auto result_mgb = mgb_lar(model_path, config, "data", lite_tensor);
+
+    ServingConfig serving_config;
+    serving_config.nr_contexts = 2;
+    NetworkServing serving(config, {}, serving_config);
+    serving.load_model(model_path);
+    ASSERT_EQ(serving.nr_contexts(), 2u);
+    ASSERT_NE(serving.get_network(0), serving.get_network(1));
+
+    std::mutex mtx;
+    std::vector<std::future<ServingTensorMap>> results;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&]() {
+            for (size_t j = 0; j < 3; ++j) {
+                auto result = serving.submit({{"data", lite_tensor}});
+                MGB_LOCK_GUARD(mtx);
+                results.emplace_back(std::move(result));
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    serving.wait();
+    ASSERT_EQ(results.size(), 12u);
+    for (auto&& result : results) {
+        auto outputs = result.get();
+        ASSERT_EQ(outputs.size(), 1u);
+        compare_lite_tensor<float>(outputs.begin()->second, result_mgb);
+    }
+
+    auto bad_result = serving.submit({});
+    ASSERT_THROW(bad_result.get(), std::exception);
+}
+
+TEST(TestNetWork, ServingDefaultContexts) {
+    Config config;
+    std::string model_path = "./shufflenet.mge";
+
+    // the contexts and the pool workers should not oversubscribe the cpu cores
+    ServingConfig serving_config;
+    serving_config.nr_threads = 2;
+    NetworkServing serving(config, {}, serving_config);
+    serving.load_model(model_path);
+    size_t nr_cores = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    ASSERT_EQ(serving.nr_contexts(), std::max<size_t>(nr_cores - 1, 1));
+
+    // all the contexts run on the inplace comp node with one shared thread pool
+    for (size_t i = 0; i < serving.nr_contexts(); ++i) {
+        auto network = serving.get_network(i);
+        ASSERT_TRUE(Runtime::is_cpu_inplace_mode(network));
+        ASSERT_EQ(Runtime::get_cpu_threads_number(network), 2u);
+    }
+}
+
+TEST(TestNetWork, Batching) {
+    Config config;
+    auto lite_tensor = get_input_data("./input_data.npy");
+    std::string model_path = "./shufflenet.mge";
+
+    auto result_mgb = mgb_lar(model_path, config, "data", lite_tensor);
+
+    BatchingConfig batching_config;
+    batching_config.max_batch_size = 4;
+    batching_config.max_wait_us = 2000;
+    NetworkBatching batching(config, {}, batching_config);
+    batching.load_model(model_path);
+    ASSERT_EQ(batching.get_batch_buckets(), (std::vector<size_t>{1, 2, 4}));
+
+    std::mutex mtx;
+    std::vector<std::future<ServingTensorMap>> results;
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < 4; ++i) {
+        threads.emplace_back([&]() {
+            for (size_t j = 0; j < 5; ++j) {
+                auto result = batching.submit({{"data", lite_tensor}});
+                MGB_LOCK_GUARD(mtx);
+                results.emplace_back(std::move(result));
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    batching.wait();
+    ASSERT_EQ(results.size(), 20u);
+    for (auto&& result : results) {
+        auto outputs = result.get();
+        ASSERT_EQ(outputs.size(), 1u);
+        auto output = outputs.begin()->second;
+        ASSERT_EQ(output->get_layout().shapes[0], 1u);
+        compare_lite_tensor<float>(output, result_mgb);
+    }
+
+    auto stat = batching.get_stat();
+    ASSERT_EQ(stat.nr_requests, 20u);
+    ASSERT_LE(stat.nr_batches, 20u);
+    ASSERT_GE(stat.avg_batch_size, 1.0);
+    ASSERT_LE(stat.p50_latency_ms, stat.p99_latency_ms);
+    batching.reset_stat();
+    ASSERT_EQ(batching.get_stat().nr_requests, 0u);
+
+    ASSERT_THROW(batching.submit({}), std::exception);
+}
+
 TEST(TestNetWork, UserAllocator) {
     auto allocator = std::make_shared<CheckAllocator>();
     {
@@ -433,6 +545,113 @@ TEST(TestNetWork, BasicMultiThread) {
     compare_lite_tensor<float>(output_tensor, result_mgb);
 }
 
+TEST(TestNetWork, MultiThreadSpinBudget) {
+    Config config;
+    auto lite_tensor = get_input_data("./input_data.npy");
+    std::string model_path = "./shufflenet.mge";
+
+    auto result_mgb = mgb_lar(model_path, config, "data", lite_tensor);
+
+    std::shared_ptr<Network> network = std::make_shared<Network>(config);
+    Runtime::set_cpu_threads_number(network, 4);
+    ASSERT_THROW(Runtime::set_cpu_threads_spin_budget(network, 0), std::exception);
+
+    network->load_model(model_path);
+    Runtime::set_cpu_threads_spin_budget(network, 0);
+    std::shared_ptr<Tensor> input_tensor = network->get_input_tensor(0);
+
+    auto src_ptr = lite_tensor->get_memory_ptr();
+    auto src_layout = lite_tensor->get_layout();
+    input_tensor->reset(src_ptr, src_layout);
+
+    for (size_t i = 0; i < 3; i++) {
+        network->forward();
+        network->wait();
+    }
+    std::shared_ptr<Tensor> output_tensor = network->get_output_tensor(0);
+    compare_lite_tensor<float>(output_tensor, result_mgb);
+
+    auto stat = Runtime::get_cpu_threads_wait_stat(network);
+    ASSERT_GT(stat.nr_park, 0u);
+}
+
+namespace {
+std::shared_ptr<Tensor> repeat_batch(std::shared_ptr<Tensor> src, size_t nr) {
+    auto layout = src->get_layout();
+    layout.shapes[0] *= nr;
+    auto dst = std::make_shared<Tensor>(LiteDeviceType::LITE_CPU, layout);
+    size_t size = src->get_tensor_total_size_in_byte();
+    for (size_t i = 0; i < nr; i++) {
+        memcpy(static_cast<char*>(dst->get_memory_ptr()) + i * size,
+               src->get_memory_ptr(), size);
+    }
+    return dst;
+}
+}  // namespace
+
+TEST(TestNetWork, ShapeCache) {
+    Config config;
+    auto lite_tensor = get_input_data("./input_data.npy");
+    std::string model_path = "./shufflenet.mge";
+
+    auto result_mgb = mgb_lar(model_path, config, "data", lite_tensor);
+
+    std::shared_ptr<Network> network = std::make_shared<Network>(config);
+    network->load_model(model_path);
+    Runtime::enable_shape_cache(network, 2);
+    std::shared_ptr<Tensor> input_tensor = network->get_input_tensor(0);
+
+    auto batch2_tensor = repeat_batch(lite_tensor, 2);
+    for (size_t i = 0; i < 6; i++) {
+        auto src = i % 2 ? batch2_tensor : lite_tensor;
+        input_tensor->reset(src->get_memory_ptr(), src->get_layout());
+        network->forward();
+        network->wait();
+        std::shared_ptr<Tensor> output_tensor = network->get_output_tensor(0);
+        ASSERT_EQ(
+                src->get_layout().shapes[0], output_tensor->get_layout().shapes[0]);
+        compare_lite_tensor<float>(result_mgb, output_tensor);
+    }
+
+    auto stat = Runtime::get_shape_cache_stat(network);
+    ASSERT_EQ(2u, stat.nr_miss);
+    ASSERT_EQ(4u, stat.nr_hit);
+    ASSERT_EQ(2u, stat.nr_executable);
+}
+
+TEST(TestNetWork, ShapeCacheBucket) {
+    Config config;
+    auto lite_tensor = get_input_data("./input_data.npy");
+    std::string model_path = "./shufflenet.mge";
+
+    auto result_mgb = mgb_lar(model_path, config, "data", lite_tensor);
+
+    std::shared_ptr<Network> network = std::make_shared<Network>(config);
+    network->load_model(model_path);
+    ASSERT_THROW(
+            Runtime::enable_shape_cache(network, 2, {{"no_such_input", 0, {2}}}),
+            std::exception);
+    Runtime::enable_shape_cache(network, 2, {{"data", 0, {2, 4}}});
+    std::shared_ptr<Tensor> input_tensor = network->get_input_tensor(0);
+
+    auto batch2_tensor = repeat_batch(lite_tensor, 2);
+    for (size_t i = 0; i < 4; i++) {
+        auto src = i % 2 ? batch2_tensor : lite_tensor;
+        input_tensor->reset(src->get_memory_ptr(), src->get_layout());
+        network->forward();
+        network->wait();
+        //! the input of batch 1 is padded to batch 2
+        std::shared_ptr<Tensor> output_tensor = network->get_output_tensor(0);
+        ASSERT_EQ(2u, output_tensor->get_layout().shapes[0]);
+        compare_lite_tensor<float>(result_mgb, output_tensor);
+    }
+
+    auto stat = Runtime::get_shape_cache_stat(network);
+    ASSERT_EQ(1u, stat.nr_miss);
+    ASSERT_EQ(3u, stat.nr_hit);
+    ASSERT_EQ(1u, stat.nr_executable);
+}
+
 TEST(TestNetWork, ThreadAffinity) {
     size_t nr_threads = 4;
     Config config;
@@ -1,6 +1,7 @@
 #include "./comp_node.h"
 
 #include "megbrain/common.h"
+#include "megbrain/comp_node/alloc.h"
 #include "megbrain/comp_node_env.h"
 #include "megbrain/system.h"
 #include "megbrain/utils/arith_helper.h"
@@ -37,7 +38,7 @@ void CpuCompNode::CpuDispatchableBase::add_callback(Task&& task) {
     dispatch(std::move(task));
 }
 
-class CpuCompNode::WorkerQueue final : public AsyncQueueSC<TaskElem, WorkerQueue> {
+class CpuCompNode::WorkerQueue final : public AsyncRingQueueSC<TaskElem, WorkerQueue> {
     const Locator m_locator;
     std::shared_ptr<ThreadPool> m_thread_pool = nullptr;
 
@@ -240,9 +241,40 @@ using CompNodeRecorderImpl = CpuCompNode::CompNodeRecorderImpl;
 
 //! ==================== CompNodeBaseImpl ======================
 class CpuCompNode::CompNodeBaseImpl : public CpuDispatchableBase {
+    class CpuRawAllocator final : public mem_alloc::RawAllocator {
+        CompNodeBaseImpl* const m_comp_node;
+
+    public:
+        explicit CpuRawAllocator(CompNodeBaseImpl* comp_node)
+                : m_comp_node{comp_node} {}
+
+        void* alloc(size_t size) override {
+            return m_comp_node->mgb_aligned_alloc(size);
+        }
+
+        void free(void* ptr) override { mgb_aligned_free(ptr); }
+
+        void get_mem_info(size_t& free, size_t& tot) override {
+            std::tie(tot, free) = sys::get_ram_status_bytes();
+        }
+    };
+
+    //! the allocator of device memory if size class allocation is enabled
+    std::unique_ptr<mem_alloc::SimpleCachingAlloc> m_size_class_alloc;
+    std::atomic_bool m_device_mem_allocated{false};
+
 protected:
     Locator m_locator, m_locator_logical;
 
+    //! release device memory in the caller thread
+    void free_device_now(void* ptr) {
+        if (m_size_class_alloc) {
+            m_size_class_alloc->free(ptr);
+        } else {
+            mgb_aligned_free(ptr);
+        }
+    }
+
 public:
     CompNodeBaseImpl(
             const Locator& locator, const Locator& locator_logical, free_func_t fd,
@@ -253,6 +285,25 @@ public:
 
     virtual ~CompNodeBaseImpl() {}
 
+    //! enable the size class allocator if MGB_CPU_SIZE_CLASS_ALLOC is set; this
+    //! should be called after m_env is initialized
+    void init_size_class_alloc_from_env() {
+        if (MGB_GETENV("MGB_CPU_SIZE_CLASS_ALLOC")) {
+            enable_size_class_alloc(mem_alloc::SizeClassConfig{});
+        }
+    }
+
+    void enable_size_class_alloc(const mem_alloc::SizeClassConfig& config) override {
+        mgb_assert(
+                !m_device_mem_allocated,
+                "size class alloc must be enabled before any device memory is "
+                "allocated on %s",
+                m_locator.to_string().c_str());
+        m_size_class_alloc = mem_alloc::SimpleCachingAlloc::make(
+                std::make_unique<CpuRawAllocator>(this), config);
+        m_size_class_alloc->alignment(get_mem_addr_alignment());
+    }
+
     void* mgb_aligned_alloc(size_t size) {
         auto alignment = get_mem_addr_alignment();
 #ifdef WIN32
@@ -275,7 +326,13 @@ public:
 #endif
     }
 
-    void* alloc_device(size_t size) override { return mgb_aligned_alloc(size); }
+    void* alloc_device(size_t size) override {
+        m_device_mem_allocated = true;
+        if (m_size_class_alloc) {
+            return m_size_class_alloc->alloc(std::max<size_t>(size, 1));
+        }
+        return mgb_aligned_alloc(size);
+    }
 
     void* alloc_host(size_t size) override { return mgb_aligned_alloc(size); }
 
@@ -339,6 +396,20 @@ public:
         return sys::get_ram_status_bytes();
     }
 
+#if !MGB_BUILD_SLIM_SERVING
+    void log_mem_pool_details() override {
+        if (m_size_class_alloc) {
+            m_size_class_alloc->print_memory_state();
+        } else {
+            CpuDispatchableBase::log_mem_pool_details();
+        }
+    }
+
+    size_t get_used_memory() override {
+        return m_size_class_alloc ? m_size_class_alloc->get_used_memory() : 0;
+    }
+#endif
+
     Locator locator() override { return m_locator; }
 
     Locator locator_logical() override { return m_locator_logical; }
@@ -409,6 +480,18 @@ public:
             m_queue->add_task({affinity_run, 1_z});
         }
     }
+    ThreadPool* get_thread_pool() override { return m_queue->get_thread_pool(); }
+
+    void enable_dispatch_stat(bool enable) override {
+        if (enable) {
+            m_queue->reset_latency_stat();
+        }
+        m_queue->enable_latency_stat(enable);
+    }
+
+    AsyncQueueLatencyStat get_dispatch_stat() const override {
+        return m_queue->get_latency_stat();
+    }
 };
 
 //! implementation of InplaceCPUDispatcher
@@ -475,6 +558,7 @@ public:
             affinity_cb(0);
         }
     }
+    ThreadPool* get_thread_pool() override { return m_thread_pool.get(); }
 };
 
 //! ==================== CompNodeDefaultImpl ======================
@@ -508,6 +592,7 @@ public:
                 "CompNodeNoRecorder is only constructed On DEVICE_CPU_DEFAULT");
         auto cn = make_comp_node_from_impl(this);
         m_env.init_cpu({std::make_shared<InplaceCPUDispatcher>(this)}, cn);
+        init_size_class_alloc_from_env();
         sm_default_cpu_comp_node_ptr = this;
     }
 
@@ -534,10 +619,10 @@ public:
 
     void free_device(void* ptr) {
         if (check_global_finalized("free_device()")) {
-            CompNodeBaseImpl::mgb_aligned_free(ptr);
+            free_device_now(ptr);
             return;
         } else {
-            auto do_free = [ptr]() { CompNodeBaseImpl::mgb_aligned_free(ptr); };
+            auto do_free = [this, ptr]() { free_device_now(ptr); };
             m_env.cpu_env().dispatch(do_free);
         }
     }
@@ -671,6 +756,7 @@ public:
                         cn);
             }
         }
+        init_size_class_alloc_from_env();
     }
 
     ~CompNodeRecorderImpl() {
@@ -715,13 +801,13 @@ public:
 
     void free_device(void* ptr) {
         if (sm_cur_recorder || check_global_finalized("free_device()")) {
-            CompNodeBaseImpl::mgb_aligned_free(ptr);
+            free_device_now(ptr);
             if (sm_cur_recorder) {
                 sm_cur_recorder->on_free(this);
             }
             return;
         } else {
-            auto do_free = [ptr]() { CompNodeBaseImpl::mgb_aligned_free(ptr); };
+            auto do_free = [this, ptr]() { free_device_now(ptr); };
             m_env.cpu_env().dispatch(do_free);
         }
     }
@@ -5,6 +5,7 @@
 #include "megbrain/utils/arith_helper.h"
 
 #include <algorithm>
+#include <thread>
 
 using namespace mgb;
 using namespace mem_alloc;
@@ -130,9 +131,11 @@ void MemAllocImplHelper::print_memory_state() {
     auto stat = get_free_memory();
     MGB_MARK_USED_VAR(stat);
     mgb_log("device memory allocator stats: %s: "
-            "used=%zu free={tot:%zu, min_blk:%zu, max_blk:%zu, nr:%zu}",
+            "used=%zu free={tot:%zu, min_blk:%zu, max_blk:%zu, nr:%zu, "
+            "frag:%.3f} size_class={cached:%zu, hit:%zu, miss:%zu}",
             get_name().c_str(), get_used_memory(), stat.tot, stat.min, stat.max,
-            stat.nr_blk);
+            stat.nr_blk, stat.fragmentation(), stat.cached, stat.nr_cache_hit,
+            stat.nr_cache_miss);
 }
 
 FreeMemStat MemAllocImplHelper::get_free_memory_self_unsafe() {
@@ -513,25 +516,183 @@ DevMemAllocImpl::~DevMemAllocImpl() {
         m_raw_allocator->free(i.first);
 }
 
+/* ===================== SizeClassCache ===================== */
+
+size_t SizeClassCache::class_of(size_t size) {
+    mgb_assert(size);
+    if (size <= GRANULARITY * NR_LINEAR_CLASS) {
+        return (size - 1) / GRANULARITY;
+    }
+    // four classes for each power of 2 above the linear classes
+    size_t lg = 0;
+    for (size_t s = size - 1; s >>= 1;) {
+        ++lg;
+    }
+    size_t step = size_t(1) << (lg - 2), k = (size - 1) / step + 1;
+    return NR_LINEAR_CLASS + (lg - 9) * 4 + (k - 5);
+}
+
+size_t SizeClassCache::class_upper(size_t cls) {
+    if (cls < NR_LINEAR_CLASS) {
+        return (cls + 1) * GRANULARITY;
+    }
+    cls -= NR_LINEAR_CLASS;
+    size_t lg = 9 + cls / 4, k = 5 + cls % 4;
+    return k << (lg - 2);
+}
+
+size_t SizeClassCache::shard_id_of_thread() const {
+    static std::atomic_size_t next_thread_id{0};
+    thread_local size_t thread_id = next_thread_id++;
+    return thread_id % m_shards.size();
+}
+
+SizeClassCache::SizeClassCache(const SizeClassConfig& config) : m_config{config} {
+    static_assert(GRANULARITY * NR_LINEAR_CLASS == 512, "bad linear classes");
+    size_t nr_shards = config.nr_shards;
+    if (!nr_shards) {
+        nr_shards = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    }
+    size_t nr_class = config.max_size ? class_of(config.max_size) + 1 : 0;
+    for (size_t i = 0; i < nr_shards; ++i) {
+        m_shards.emplace_back(std::make_unique<Shard>());
+        m_shards.back()->free_list.resize(nr_class);
+        m_shards.back()->cached_size.resize(nr_class);
+    }
+}
+
+void* SizeClassCache::alloc(size_t size) {
+    auto cls = class_of(size);
+    auto&& shard = *m_shards[shard_id_of_thread()];
+    void* ptr = nullptr;
+    {
+        MGB_LOCK_GUARD(shard.mtx);
+        auto&& list = shard.free_list[cls];
+        if (!list.empty()) {
+            ptr = list.back();
+            list.pop_back();
+        }
+    }
+    if (!ptr) {
+        ++m_nr_miss;
+        return nullptr;
+    }
+    // the block is tracked by the shard of its address, which is locked after
+    // the shard of the thread is released
+    size_t blk_size;
+    {
+        auto&& addr_shard = shard_of_addr(ptr);
+        MGB_LOCK_GUARD(addr_shard.mtx);
+        blk_size = addr_shard.blocks.at(ptr).size;
+    }
+    {
+        MGB_LOCK_GUARD(shard.mtx);
+        shard.cached_size[cls] -= blk_size;
+    }
+    m_cached_size -= blk_size;
+    ++m_nr_hit;
+    return ptr;
+}
+
+void SizeClassCache::add(void* ptr, size_t size, size_t block_size) {
+    BlockInfo info{
+            static_cast<uint32_t>(class_of(size)),
+            static_cast<uint32_t>(shard_id_of_thread()), block_size};
+    auto&& addr_shard = shard_of_addr(ptr);
+    MGB_LOCK_GUARD(addr_shard.mtx);
+    addr_shard.blocks[ptr] = info;
+}
+
+bool SizeClassCache::free(void* ptr) {
+    BlockInfo info;
+    {
+        auto&& addr_shard = shard_of_addr(ptr);
+        MGB_LOCK_GUARD(addr_shard.mtx);
+        auto iter = addr_shard.blocks.find(ptr);
+        if (iter == addr_shard.blocks.end()) {
+            return false;
+        }
+        info = iter->second;
+    }
+    // the block goes back to the shard it was allocated from, so that memory
+    // freed by a consumer thread is reused by the producer thread
+    bool cached = false;
+    {
+        auto&& owner = *m_shards[info.shard];
+        MGB_LOCK_GUARD(owner.mtx);
+        auto&& cached_size = owner.cached_size[info.cls];
+        if (cached_size + info.size <= m_config.max_cached_per_class) {
+            cached_size += info.size;
+            owner.free_list[info.cls].push_back(ptr);
+            cached = true;
+        }
+    }
+    if (cached) {
+        m_cached_size += info.size;
+        return true;
+    }
+    auto&& addr_shard = shard_of_addr(ptr);
+    MGB_LOCK_GUARD(addr_shard.mtx);
+    addr_shard.blocks.erase(ptr);
+    return false;
+}
+
+void SizeClassCache::update_stat(FreeMemStat& stat) const {
+    stat.cached += m_cached_size;
+    stat.nr_cache_hit += m_nr_hit;
+    stat.nr_cache_miss += m_nr_miss;
+}
+
+/* ===================== SimpleCachingAllocImpl ===================== */
+
 std::unique_ptr<SimpleCachingAlloc> SimpleCachingAlloc::make(
         std::unique_ptr<RawAllocator> raw_alloc) {
     return std::make_unique<SimpleCachingAllocImpl>(std::move(raw_alloc));
 }
 
-SimpleCachingAllocImpl::SimpleCachingAllocImpl(std::unique_ptr<RawAllocator> raw_alloc)
-        : m_raw_alloc(std::move(raw_alloc)) {}
+std::unique_ptr<SimpleCachingAlloc> SimpleCachingAlloc::make(
+        std::unique_ptr<RawAllocator> raw_alloc, const SizeClassConfig& config) {
+    return std::make_unique<SimpleCachingAllocImpl>(std::move(raw_alloc), &config);
+}
+
+SimpleCachingAllocImpl::SimpleCachingAllocImpl(
+        std::unique_ptr<RawAllocator> raw_alloc,
+        const SizeClassConfig* size_class_config)
+        : m_raw_alloc(std::move(raw_alloc)) {
+    if (size_class_config) {
+        m_size_class_cache = std::make_unique<SizeClassCache>(*size_class_config);
+    }
+}
 
 void* SimpleCachingAllocImpl::alloc(size_t size) {
-    size = get_aligned_power2(size, m_alignment);
-    auto&& addr = do_alloc(size, true);
+    size_t class_blk_size = 0;
+    if (m_size_class_cache) {
+        class_blk_size = m_size_class_cache->block_size(size, m_alignment);
+        if (class_blk_size) {
+            if (auto ptr = m_size_class_cache->alloc(size)) {
+                return ptr;
+            }
+        }
+    }
+    auto blk_size =
+            class_blk_size ? class_blk_size : get_aligned_power2(size, m_alignment);
+    auto&& addr = do_alloc(blk_size, true);
     auto ptr = addr.addr_ptr();
-    MGB_LOCK_GUARD(m_mutex);
-    m_allocated_blocks[ptr] = {addr.is_head, size};
-    m_used_size += size;
+    {
+        MGB_LOCK_GUARD(m_mutex);
+        m_allocated_blocks[ptr] = {addr.is_head, blk_size};
+        m_used_size += blk_size;
+    }
+    if (class_blk_size) {
+        m_size_class_cache->add(ptr, size, blk_size);
+    }
     return ptr;
 }
 
 void SimpleCachingAllocImpl::free(void* ptr) {
+    if (m_size_class_cache && m_size_class_cache->free(ptr)) {
+        return;
+    }
     MGB_LOCK_GUARD(m_mutex);
     auto&& iter = m_allocated_blocks.find(ptr);
     mgb_assert(iter != m_allocated_blocks.end(), "releasing bad pointer: %p", ptr);
@@ -559,9 +720,20 @@ std::string SimpleCachingAllocImpl::get_name() const {
 }
 
 size_t SimpleCachingAllocImpl::get_used_memory() {
+    if (m_size_class_cache) {
+        return m_used_size - m_size_class_cache->cached_size();
+    }
     return m_used_size;
 }
 
+FreeMemStat SimpleCachingAllocImpl::get_free_memory() {
+    auto stat = MemAllocImplHelper::get_free_memory();
+    if (m_size_class_cache) {
+        m_size_class_cache->update_stat(stat);
+    }
+    return stat;
+}
+
 FreeMemStat SimpleCachingAllocImpl::get_free_memory_dev() {
     return get_free_memory();
 }
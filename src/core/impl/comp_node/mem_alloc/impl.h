@@ -1,6 +1,7 @@
 #pragma once
 
 #include "megbrain/comp_node/alloc.h"
+#include "megbrain/utils/arith_helper.h"
 
 #include <atomic>
 #include <map>
@@ -106,7 +107,7 @@ protected:
 public:
     void print_memory_state() override;
 
-    FreeMemStat get_free_memory() override final;
+    FreeMemStat get_free_memory() override;
 
 #if !MGB_BUILD_SLIM_SERVING
     size_t get_max_block_size_available() override final;
@@ -219,6 +220,87 @@ public:
     FreeMemStat get_free_memory_dev() override;
 };
 
+/*!
+ * \brief the size class free lists in front of the best-fit free tree of a
+ *      MemAllocImplHelper; see SizeClassConfig
+ *
+ * A block allocated for a size class stays allocated in the view of the
+ * backing allocator while it is cached, so the cache needs no lock of the
+ * backing allocator.
+ */
+class SizeClassCache {
+    static constexpr size_t GRANULARITY = 64, NR_LINEAR_CLASS = 8;
+
+    struct BlockInfo {
+        uint32_t cls, shard;
+        size_t size;
+    };
+
+    struct Shard {
+        MGB_MUTEX mtx;
+        //! cached free blocks of each size class allocated from this shard
+        std::vector<std::vector<void*>> free_list;
+        //! bytes of the blocks in each free list
+        std::vector<size_t> cached_size;
+        //! all blocks of the size classes whose address hashes to this shard
+        std::unordered_map<void*, BlockInfo> blocks;
+    };
+
+    const SizeClassConfig m_config;
+    std::vector<std::unique_ptr<Shard>> m_shards;
+    std::atomic_size_t m_cached_size{0}, m_nr_hit{0}, m_nr_miss{0};
+
+    //! size class of a size not greater than m_config.max_size
+    static size_t class_of(size_t size);
+
+    //! upper bound of the sizes of a size class
+    static size_t class_upper(size_t cls);
+
+    size_t shard_id_of_thread() const;
+
+    Shard& shard_of_addr(void* ptr) {
+        return *m_shards[(reinterpret_cast<size_t>(ptr) / GRANULARITY) %
+                         m_shards.size()];
+    }
+
+public:
+    explicit SizeClassCache(const SizeClassConfig& config);
+
+    /*!
+     * \brief get the size of blocks to be allocated for a request
+     * \return 0 if the request is not served by the size classes
+     */
+    size_t block_size(size_t size, size_t alignment) const {
+        if (!size || size > m_config.max_size) {
+            return 0;
+        }
+        return get_aligned_power2(class_upper(class_of(size)), alignment);
+    }
+
+    /*!
+     * \brief take a cached block for a request whose block_size() is non-zero
+     * \return nullptr if the cache of the size class is empty
+     */
+    void* alloc(size_t size);
+
+    //! track a block of given size newly allocated for a request
+    void add(void* ptr, size_t size, size_t block_size);
+
+    /*!
+     * \brief cache a freed block
+     * \return false if the block is not allocated for a size class or its
+     *      free list is full; in the latter case the block is no longer
+     *      tracked and should be released to the backing allocator
+     */
+    bool free(void* ptr);
+
+    //! total bytes of the cached blocks
+    size_t cached_size() const { return m_cached_size; }
+
+    //! add the cached bytes and the hit counts into the stat
+    void update_stat(FreeMemStat& stat) const;
+};
+
 class SimpleCachingAllocImpl : public SimpleCachingAlloc, public MemAllocImplHelper {
     struct AllocatedBlock {
         bool is_head;
@@ -228,15 +310,20 @@ class SimpleCachingAllocImpl : public SimpleCachingAlloc, public MemAllocImplHel
     std::unique_ptr<RawAllocator> m_raw_alloc;
     std::unordered_map<void*, size_t> m_alloc_from_raw;
     std::unordered_map<void*, AllocatedBlock> m_allocated_blocks;
-    size_t m_used_size = 0;
+    std::unique_ptr<SizeClassCache> m_size_class_cache;
+    //! bytes allocated from the free tree, including the cached blocks
+    std::atomic_size_t m_used_size{0};
 
 public:
-    SimpleCachingAllocImpl(std::unique_ptr<RawAllocator> m_raw_alloc);
+    SimpleCachingAllocImpl(
+            std::unique_ptr<RawAllocator> m_raw_alloc,
+            const SizeClassConfig* size_class_config = nullptr);
     ~SimpleCachingAllocImpl();
 
     void* alloc(size_t size) override;
     void free(void* ptr) override;
     size_t get_used_memory() override;
+    FreeMemStat get_free_memory() override;
     FreeMemStat get_free_memory_dev() override;
 
 protected:
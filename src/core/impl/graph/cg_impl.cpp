@@ -257,7 +257,7 @@ ComputingGraphImpl::Components::Components(ComputingGraphImpl* owner)
 #if MGB_ENABLE_DTR
           seq_modifier_for_dtr{owner, &(owner->options().dtr_config)},
 #endif
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
           memory_swap_support{owner},
 #endif
           eager_eval_manager{owner}
@@ -655,7 +655,7 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
         opr_seq = topo_sorter().get_comp_seq(extra_info, dest_vars);
     };
 
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
     bool enable_swap_memory_after_sublinear =
             options().enable_sublinear_memory_opt && options().enable_memory_swap;
 
@@ -682,7 +682,7 @@ ComputingGraphImpl::CompileState ComputingGraphImpl::compile_prepare(
     if (options().enable_sublinear_memory_opt) {
         MGB_TRY {
             seq_modifier_for_sublinear_memory().modify_endpoint_vars(dest_vars);
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
             if (enable_swap_memory_after_sublinear) {
                 cmpnt.memory_swap_support.modify_dest_var_inplace(dest_vars);
             }
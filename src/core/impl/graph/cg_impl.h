@@ -72,7 +72,7 @@ class ComputingGraphImpl final : public ComputingGraph {
 #if MGB_ENABLE_DTR
         SeqModifierForDTR seq_modifier_for_dtr;
 #endif
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
         swap::MemorySwap memory_swap_support;
 #endif
         EagerEvalManager eager_eval_manager;
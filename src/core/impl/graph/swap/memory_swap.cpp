@@ -10,7 +10,7 @@
 
 #include <queue>
 
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 using namespace mgb;
 using namespace swap;
 using namespace swap::opr;
@@ -19,6 +19,13 @@ MGB_TYPEINFO_OBJ_IMPL(SwapCopyThreadPool);
 
 using SharedDeviceTensor = mgb::opr::SharedDeviceTensor;
 
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+namespace {
+//! rough bandwidth of saving and loading vars on host in bytes per second
+constexpr double HOST_SWAP_BANDWIDTH = 2e9;
+}  // anonymous namespace
+#endif
+
 /* ================ SegmentTree ================ */
 class SegmentTree {
     size_t m_len = 0;
@@ -382,7 +389,7 @@ void MemorySwap::determine_swap_edge(
                 std::max(m_max_swap_out_var_size, m_segmentToRace[tmp_vec[0]]->m_mem);
         m_swapped_pair.insert(PSS(u, v));
 
-        if (involved / m_cpu_gpu_bandwidth > m_swap_time_limit)
+        if (involved / m_swap_bandwidth > m_swap_time_limit)
             break;
     }
 
@@ -420,10 +427,36 @@ void MemorySwap::modify_dest_var_inplace(VarNodeArray& vars) {
     tmp->topo_sorter().restore_opr_prop();
 
     auto opr_seq = *opr_seqs;
-    auto nr_gpu = CompNode::get_device_count(CompNode::DeviceType::CUDA);
-    if (!nr_gpu) {
-        mgb_log_debug("No device exists, stop memory swap phase");
+    m_host_swap = true;
+    for (auto opr : opr_seq) {
+        for (auto var : opr->output()) {
+            if (var->comp_node().device_type() != CompNode::DeviceType::CPU) {
+                m_host_swap = false;
+            }
+        }
+    }
+    if (m_host_swap) {
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+        auto&& config = m_owner_graph->options().host_swap_config;
+        mgb_assert(config.prefetch_distance > 0);
+        m_swap_out_var_size_lb = config.min_var_size;
+        m_swap_in_prev = config.prefetch_distance;
+        m_swap_bandwidth = HOST_SWAP_BANDWIDTH;
+#else
+        mgb_log_debug("host memory swap is disabled, stop memory swap phase");
+        return;
+#endif
+    } else {
+#if MGB_ENABLE_MEMORY_SWAP
+        auto nr_gpu = CompNode::get_device_count(CompNode::DeviceType::CUDA);
+        if (!nr_gpu) {
+            mgb_log_debug("No device exists, stop memory swap phase");
+            return;
+        }
+#else
+        mgb_log_debug("memory swap on devices is disabled, stop memory swap phase");
         return;
+#endif
     }
 
     /*
@@ -475,7 +508,7 @@ void MemorySwap::modify_dest_var_inplace(VarNodeArray& vars) {
     } else {
         m_lb_for_distance = std::min(m_lb_for_distance, (long long)opr_seq.size() / 20);
     }
-    if (!m_bucket_implement)
+    if (!m_bucket_implement && !m_host_swap)
         m_swap_in_prev = 1;
 
     std::queue<OperatorNodeBase*> rst;
@@ -754,7 +787,15 @@ void MemorySwap::modify_dest_var_inplace(VarNodeArray& vars) {
                     flag = 1;
                     auto dep_node = rewriter.get_var(m_var_map[dep_idx]);
                     VarNode* swap_res_var;
-                    if (!m_bucket_implement) {
+                    if (m_host_swap) {
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+                        auto wait_dep_idx =
+                                opr_seq[m_opr_seq_dist[opr->id()] - 1]->output(0)->id();
+                        auto wait_dep = rewriter.get_var(m_var_map[wait_dep_idx]);
+                        swap_res_var = apply_host(
+                                rewriter.get_var(opr->input()[i]), dep_node, wait_dep);
+#endif
+                    } else if (!m_bucket_implement) {
                         auto vd1_idx =
                                 opr_seq[m_opr_seq_dist
                                                 [opr->input()[i]->owner_opr()->id()] +
@@ -924,6 +965,38 @@ VarNode* MemorySwap::apply(
         return ret;
     }
 }
-#endif  // MGB_ENABLE_MEMORY_SWAP
+
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+VarNode* MemorySwap::apply_host(VarNode* lhs, VarNode* dep_node, VarNode* wait_dep) {
+    auto swap_iter = m_swap_map.find(lhs);
+    if (swap_iter != m_swap_map.end()) {
+        auto iter = swap_iter->second.find(dep_node);
+        if (iter != swap_iter->second.end()) {
+            return iter->second;
+        }
+    }
+    auto graph = m_owner_graph;
+    auto&& swap_out = m_swap_out_map[lhs];
+    if (!swap_out) {
+        auto&& store = m_host_swap_stores[lhs->comp_node()];
+        if (!store) {
+            store = std::make_shared<HostSwapStore>(
+                    lhs->comp_node(), graph->options().host_swap_config);
+        }
+        swap_out = opr::HostSwapOut::make(*graph, lhs, {store, store->new_slot()})
+                           .node();
+        swap_out->owner_opr()->node_prop().attribute().priority =
+                std::numeric_limits<int>::min();
+    }
+    auto mid = opr::HostSwapIn::make(*graph, swap_out, dep_node).node();
+    auto ret = opr::WaitHostSwapIn::make(*graph, mid, wait_dep).node();
+    mid->owner_opr()->node_prop().attribute().priority =
+            ret->owner_opr()->node_prop().attribute().priority =
+                    std::numeric_limits<int>::min();
+    m_swap_map[lhs][dep_node] = ret;
+    return ret;
+}
+#endif  // MGB_ENABLE_HOST_MEMORY_SWAP
+#endif  // MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
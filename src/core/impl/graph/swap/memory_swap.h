@@ -2,9 +2,11 @@
 
 #include "megbrain/graph.h"
 
+#include "./swap_helper.h"
+
 #include <set>
 
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 namespace mgb {
 namespace swap {
 
@@ -117,7 +119,15 @@ class MemorySwap {
      */
     size_t m_max_swap_out_var_size = 0;
 
-    const double m_cpu_gpu_bandwidth = 10000000000.0;
+    //! bandwidth of swapping in bytes per second, used by m_swap_time_limit
+    double m_swap_bandwidth = 10000000000.0;
+
+    /*!
+     * whether all the vars are on CPU comp nodes, then they are swapped to
+     * HostSwapStore, and m_swap_out_var_size_lb and m_swap_in_prev are taken
+     * from host_swap_config
+     */
+    bool m_host_swap = false;
 
     ComputingGraph* m_owner_graph;
     /*!
@@ -181,6 +191,24 @@ class MemorySwap {
      */
     VarNode* apply_bucket(VarNode* lhs, VarNode* dep_node, VarNode* wait_node);
 
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+    ThinHashMap<CompNode, std::shared_ptr<HostSwapStore>> m_host_swap_stores;
+
+    /*!
+     * swap vars on CPU comp nodes to HostSwapStore
+     *   host-swap-out  host-swap-in   wait-host-swap-in
+     *        * ------------ * -------------- *
+     *       /              / swap_in_prev   / \
+     *      /              /                / 1 \
+     *     * ------------ * -------------- * --- *
+     *    lhs          dep_node       wait_node  rhs
+     * the var is saved right after being computed, and the host-swap-in opr
+     * starts loading it asynchronously, which is waited by the
+     * wait-host-swap-in opr before being consumed
+     */
+    VarNode* apply_host(VarNode* lhs, VarNode* dep_node, VarNode* wait_node);
+#endif
+
 public:
     MemorySwap(ComputingGraph* graph);
     ~MemorySwap() noexcept;
@@ -189,6 +217,6 @@ public:
 };
 }  // namespace swap
 }  // namespace mgb
-#endif  // MGB_ENABLE_MEMORY_SWAP
+#endif  // MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
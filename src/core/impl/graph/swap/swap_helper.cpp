@@ -1,7 +1,17 @@
 #include "./swap_helper.h"
 #include "megbrain/comp_node_env.h"
+#include "megbrain/exception.h"
+#include "megbrain/utils/zero_word_codec.h"
 
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 using namespace mgb;
 using namespace swap;
@@ -121,6 +131,114 @@ void SwapVarRecorder::wait_mission_finish(const DeviceTensorND* waiting_dev_tens
         }
 }
 
-#endif  // MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+/* ===================== HostSwapStore ===================== */
+
+HostSwapStore::HostSwapStore(CompNode comp_node, const Config& config)
+        : m_comp_node{comp_node},
+          m_config{config},
+          m_copy_threadpool{SwapCopyThreadPool::inst(comp_node)} {
+    m_copy_threadpool.start();
+}
+
+HostSwapStore::~HostSwapStore() {
+    m_copy_threadpool.stop();
+    for (auto&& slot : m_slots) {
+        if (slot->mapping) {
+            munmap(slot->mapping, slot->file_capacity);
+        }
+    }
+    if (m_fd >= 0) {
+        close(m_fd);
+    }
+}
+
+size_t HostSwapStore::new_slot() {
+    m_slots.emplace_back(std::make_unique<Slot>());
+    return m_slots.size() - 1;
+}
+
+void HostSwapStore::save(size_t slot_id, const void* ptr, size_t size) {
+    auto&& slot = *m_slots.at(slot_id);
+    slot.size = size;
+    if (m_config.storage == Config::Storage::COMPRESSED) {
+        auto limit = static_cast<size_t>(size * MAX_COMPRESS_RATIO);
+        if (ZeroWordCodec::encode(ptr, size, limit, slot.compressed)) {
+            slot.in_file = false;
+            return;
+        }
+        slot.compressed.clear();
+        slot.compressed.shrink_to_fit();
+    }
+    save_to_file(slot, ptr);
+}
+
+void HostSwapStore::save_to_file(Slot& slot, const void* ptr) {
+    if (m_fd < 0) {
+        std::string dir = m_config.spill_dir;
+        if (dir.empty()) {
+            auto tmpdir = MGB_GETENV("TMPDIR");
+            dir = tmpdir ? tmpdir : "/tmp";
+        }
+        auto path = dir + "/megbrain_swap_XXXXXX";
+        m_fd = mkstemp(&path[0]);
+        mgb_throw_if(
+                m_fd < 0, SystemError, "failed to create swap file %s: %s",
+                path.c_str(), strerror(errno));
+        // the file would be reclaimed by the system once closed
+        unlink(path.c_str());
+    }
+    if (slot.file_capacity < slot.size) {
+        // regions are not reused as the shapes of vars rarely change
+        if (slot.mapping) {
+            munmap(slot.mapping, slot.file_capacity);
+            slot.mapping = nullptr;
+        }
+        size_t page_size = sysconf(_SC_PAGESIZE);
+        slot.file_offset = m_file_size;
+        slot.file_capacity = (slot.size + page_size - 1) / page_size * page_size;
+        m_file_size += slot.file_capacity;
+        mgb_throw_if(
+                ftruncate(m_fd, m_file_size), SystemError,
+                "failed to grow swap file to %zu bytes: %s", m_file_size,
+                strerror(errno));
+        auto mapping = mmap(
+                nullptr, slot.file_capacity, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd,
+                slot.file_offset);
+        mgb_throw_if(
+                mapping == MAP_FAILED, SystemError, "failed to mmap swap file: %s",
+                strerror(errno));
+        slot.mapping = mapping;
+    }
+    memcpy(slot.mapping, ptr, slot.size);
+    // dirty pages are kept in the page cache of the file
+    madvise(slot.mapping, slot.file_capacity, MADV_DONTNEED);
+    slot.in_file = true;
+}
+
+void HostSwapStore::load(const Slot& slot, void* ptr) const {
+    if (!slot.in_file) {
+        ZeroWordCodec::decode(slot.compressed.data(), slot.size, ptr);
+        return;
+    }
+    madvise(slot.mapping, slot.file_capacity, MADV_WILLNEED);
+    memcpy(ptr, slot.mapping, slot.size);
+    madvise(slot.mapping, slot.file_capacity, MADV_DONTNEED);
+}
+
+FutureThreadPool<void>::Future HostSwapStore::load_async(
+        size_t slot_id, const DeviceTensorND& dest) {
+    auto slot = m_slots.at(slot_id).get();
+    mgb_assert(
+            dest.comp_node() == m_comp_node && dest.layout().is_contiguous() &&
+                    dest.layout().span().dist_byte() == slot->size,
+            "bad swap in dest: %s", dest.layout().to_string().c_str());
+    // dest is captured by value to hold its storage
+    auto task = [this, slot, dest]() { load(*slot, dest.raw_ptr()); };
+    return m_copy_threadpool.launch(task);
+}
+#endif  // MGB_ENABLE_HOST_MEMORY_SWAP
+
+#endif  // MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -4,7 +4,7 @@
 #include "megbrain/graph.h"
 #include "megbrain/utils/async_worker.h"
 
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 namespace mgb {
 namespace swap {
 
@@ -152,9 +152,68 @@ public:
     SwapVarInfo* swap_var_info() const { return m_swap_var_info; }
 };
 
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+/* ===================== HostSwapStore ===================== */
+/*!
+ * \brief storage of vars swapped out from a CPU comp node
+ *
+ * Each swapped var owns a slot. In SPILL_FILE mode, a slot is a page-aligned
+ * region of an unlinked local file mapped by mmap: the var is copied into the
+ * mapping on swap out and its pages are released from the process, so that the
+ * system could write them back and reclaim the memory; they are read back with
+ * MADV_WILLNEED on prefetch. In COMPRESSED mode, the var is encoded by
+ * ZeroWordCodec into host memory, and it falls back to the spill file if it is
+ * incompressible.
+ *
+ * Vars are saved on the worker of the comp node, and loaded by its
+ * SwapCopyThreadPool. A slot would not be saved and loaded at the same time, as
+ * the loads of an execution are waited before the next one starts.
+ */
+class HostSwapStore final : public NonCopyableObj {
+public:
+    using Config = cg::ComputingGraph::Options::HostSwapConfig;
+
+    //! max ratio of compressed size to original size to keep the compressed value
+    static constexpr double MAX_COMPRESS_RATIO = 0.6;
+
+    HostSwapStore(CompNode comp_node, const Config& config);
+    ~HostSwapStore();
+
+    //! allocate a new slot, which must be called before execution
+    size_t new_slot();
+
+    //! save \p size bytes at \p ptr to \p slot; called on the worker of the comp node
+    void save(size_t slot, const void* ptr, size_t size);
+
+    //! load \p slot to \p dest asynchronously
+    FutureThreadPool<void>::Future load_async(size_t slot, const DeviceTensorND& dest);
+
+private:
+    struct Slot {
+        size_t size = 0;
+        //! whether the value is kept in the spill file
+        bool in_file = false;
+        //! mapping of the region in spill file; capacity is 0 if not allocated
+        void* mapping = nullptr;
+        size_t file_offset = 0, file_capacity = 0;
+        std::vector<uint8_t> compressed;
+    };
+
+    const CompNode m_comp_node;
+    const Config m_config;
+    SwapCopyThreadPool& m_copy_threadpool;
+    std::vector<std::unique_ptr<Slot>> m_slots;
+    int m_fd = -1;
+    size_t m_file_size = 0;
+
+    void save_to_file(Slot& slot, const void* ptr);
+    void load(const Slot& slot, void* ptr) const;
+};
+#endif  // MGB_ENABLE_HOST_MEMORY_SWAP
+
 }  // namespace swap
 }  // namespace mgb
 
-#endif  // MGB_ENABLE_MEMORY_SWAP
+#endif  // MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
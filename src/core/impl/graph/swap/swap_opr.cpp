@@ -5,7 +5,7 @@
 #include "megbrain/opr/internal/megdnn_opr_wrapper.h"
 #include "megbrain/serialization/opr_shallow_copy.h"
 
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 using namespace mgb;
 using namespace swap::opr;
 
@@ -262,6 +262,159 @@ SymbolVar SwapOut::make(
             ->output(0);
 }
 
-#endif  // MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+/* ===================== HostSwapOut ===================== */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(HostSwapOut);
+HostSwapOut::HostSwapOut(
+        ComputingGraph& graph, VarNode* inp, const Param& param,
+        const OperatorNodeConfig& config)
+        : Super{&graph, config, "host-swap-out", {inp}}, m_param{param} {
+    mgb_assert(
+            inp->comp_node().device_type() == CompNode::DeviceType::CPU,
+            "host swap only works on CPU comp nodes, got %s",
+            inp->comp_node().to_string().c_str());
+    add_input({inp});
+    add_output(None);
+    add_equivalence_component<ScalarHash<void*>>(param.store.get());
+    add_equivalence_component<ScalarHash<size_t>>(param.slot);
+}
+
+void HostSwapOut::scn_do_execute() {
+    auto inp = input(0)->dev_tensor();
+    auto param = m_param;
+    auto save = [param, inp]() {
+        param.store->save(
+                param.slot, inp.raw_ptr(), inp.layout().span().dist_byte());
+    };
+    CompNodeEnv::from_comp_node(comp_node()).cpu_env().dispatch(save);
+}
+
+void HostSwapOut::init_output_static_infer_desc() {
+    using namespace cg::static_infer;
+    owner_graph()->static_infer_manager().register_shape_infer(
+            output(0), ShapeInferDesc::make_const({1}));
+}
+
+void HostSwapOut::add_input_layout_constraint() {
+    input(0)->add_layout_constraint_contiguous();
+}
+
+SymbolVar HostSwapOut::make(
+        ComputingGraph& graph, SymbolVar inp, const Param& param,
+        const OperatorNodeConfig& config) {
+    return graph
+            .insert_opr(std::make_unique<HostSwapOut>(graph, inp.node(), param, config))
+            ->output(0);
+}
+
+/* ===================== HostSwapIn ===================== */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(HostSwapIn);
+HostSwapIn::HostSwapIn(
+        ComputingGraph& graph, VarNode* swap_out_var, VarNode* dep_var,
+        const OperatorNodeConfig& config)
+        : Super{&graph, config, "host-swap-in", {swap_out_var}},
+          m_param{swap_out_var->owner_opr()->cast_final_safe<HostSwapOut>().param()} {
+    add_input({swap_out_var, dep_var});
+    add_output(None)->dtype(swap_out_var->owner_opr()->input(0)->dtype());
+    // the output is written asynchronously
+    output(0)->add_flag(VarNode::Flag::DISALLOW_VAR_SANITY_CHECK);
+}
+
+HostSwapIn::~HostSwapIn() {
+    // the load may still be running if the execution is aborted
+    if (m_pending.valid()) {
+        m_pending.wait();
+    }
+}
+
+void HostSwapIn::wait_load() {
+    mgb_assert(m_pending.valid(), "swap in of %s is not started", cname());
+    m_pending.get();
+}
+
+void HostSwapIn::scn_do_execute() {
+    auto od = output(0)->dev_tensor();
+    // launch the load on the worker, so that the output would not be written before
+    // previous kernels using the same memory finish
+    auto launch = [this, od]() {
+        m_pending = m_param.store->load_async(m_param.slot, od);
+    };
+    CompNodeEnv::from_comp_node(comp_node()).cpu_env().dispatch(launch);
+}
+
+void HostSwapIn::init_output_static_infer_desc() {
+    using namespace cg::static_infer;
+    owner_graph()->static_infer_manager().register_shape_infer(
+            output(0), ShapeInferDesc::make_identity(input(0)->owner_opr()->input(0)));
+}
+
+cg::OperatorNodeBase::NodeProp* HostSwapIn::do_make_node_prop() const {
+    auto ret = Super::do_make_node_prop();
+    ret->reset_dep_type(
+            input(), {NodeProp::DepType::DEV_COMP_ORDER,
+                      NodeProp::DepType::DEV_COMP_ORDER});
+    return ret;
+}
+
+SymbolVar HostSwapIn::make(
+        ComputingGraph& graph, SymbolVar swap_out_var, SymbolVar dep_var,
+        const OperatorNodeConfig& config) {
+    return graph
+            .insert_opr(std::make_unique<HostSwapIn>(
+                    graph, swap_out_var.node(), dep_var.node(), config))
+            ->output(0);
+}
+
+/* ===================== WaitHostSwapIn ===================== */
+
+MGB_DYN_TYPE_OBJ_FINAL_IMPL(WaitHostSwapIn);
+WaitHostSwapIn::WaitHostSwapIn(
+        ComputingGraph& graph, VarNode* swap_in_var, VarNode* wait_var,
+        const OperatorNodeConfig& config)
+        : Super{&graph, config, "wait-host-swap-in", {swap_in_var}} {
+    add_input({swap_in_var, wait_var});
+    add_output(None)->dtype(swap_in_var->dtype());
+}
+
+void WaitHostSwapIn::scn_do_execute() {
+    auto swap_in = &input(0)->owner_opr()->cast_final_safe<HostSwapIn>();
+    auto wait = [swap_in]() { swap_in->wait_load(); };
+    CompNodeEnv::from_comp_node(comp_node()).cpu_env().dispatch(wait);
+    mixin_scn_do_execute(*this);
+}
+
+void WaitHostSwapIn::init_output_static_infer_desc() {
+    mixin_init_output_static_infer_desc(*this);
+}
+
+void WaitHostSwapIn::mem_plan_fwd_in2out_readonly() {
+    mixin_mem_plan_fwd_in2out_readonly(*this);
+}
+
+void WaitHostSwapIn::init_rt_force_dynamic_mem_alloc_imply_chain() {
+    mixin_init_rt_force_dynamic_mem_alloc_imply_chain(*this);
+}
+
+cg::OperatorNodeBase::NodeProp* WaitHostSwapIn::do_make_node_prop() const {
+    auto ret = Super::do_make_node_prop();
+    ret->reset_dep_type(
+            input(),
+            {NodeProp::DepType::DEV_VALUE, NodeProp::DepType::DEV_COMP_ORDER});
+    return ret;
+}
+
+SymbolVar WaitHostSwapIn::make(
+        ComputingGraph& graph, SymbolVar swap_in_var, SymbolVar wait_var,
+        const OperatorNodeConfig& config) {
+    return graph
+            .insert_opr(std::make_unique<WaitHostSwapIn>(
+                    graph, swap_in_var.node(), wait_var.node(), config))
+            ->output(0);
+}
+#endif  // MGB_ENABLE_HOST_MEMORY_SWAP
+
+#endif  // MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -7,7 +7,7 @@
 
 #include "megbrain/opr/internal/identical_fwd.h"
 
-#if MGB_ENABLE_MEMORY_SWAP
+#if MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 namespace mgb {
 namespace swap {
@@ -152,10 +152,89 @@ private:
     NodeProp* do_make_node_prop() const override;
 };
 
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+/*!
+ * \brief save the input on a CPU comp node into a HostSwapStore slot
+ *
+ * The output is a virtual var of shape {1} for HostSwapIn to depend on.
+ */
+MGB_DEFINE_OPR_CLASS(HostSwapOut, cg::SingleCNOperatorNodeBase) // {
+public:
+    struct Param {
+        std::shared_ptr<HostSwapStore> store;
+        size_t slot;
+    };
+    HostSwapOut(
+            ComputingGraph& graph, VarNode* inp, const Param& param,
+            const OperatorNodeConfig& config);
+    static SymbolVar make(
+            ComputingGraph& graph, SymbolVar inp, const Param& param,
+            const OperatorNodeConfig& config = {});
+
+    const Param& param() const { return m_param; }
+
+private:
+    const Param m_param;
+    void scn_do_execute() override;
+    void init_output_static_infer_desc() override;
+    void add_input_layout_constraint() override;
+};
+
+/*!
+ * \brief start loading the value saved by HostSwapOut into the output
+ *      asynchronously, once dep_var is computed
+ *
+ * The load must be waited by a WaitHostSwapIn before the output is read.
+ */
+MGB_DEFINE_OPR_CLASS(HostSwapIn, cg::SingleCNOperatorNodeBase) // {
+public:
+    HostSwapIn(
+            ComputingGraph& graph, VarNode* swap_out_var, VarNode* dep_var,
+            const OperatorNodeConfig& config);
+    ~HostSwapIn();
+    static SymbolVar make(
+            ComputingGraph& graph, SymbolVar swap_out_var, SymbolVar dep_var,
+            const OperatorNodeConfig& config = {});
+
+    //! wait for the pending load; called on the worker of the comp node
+    void wait_load();
+
+private:
+    HostSwapOut::Param m_param;
+    FutureThreadPool<void>::Future m_pending;
+    void scn_do_execute() override;
+    void init_output_static_infer_desc() override;
+    NodeProp* do_make_node_prop() const override;
+};
+
+/*!
+ * \brief forward the output of HostSwapIn after its load finishes, which is
+ *      scheduled after wait_var to overlap the load with computation
+ */
+MGB_DEFINE_OPR_CLASS(
+        WaitHostSwapIn, cg::SingleCNOperatorNodeBase,
+        mgb::opr::mixin::ForwardInputToOutput) // {
+public:
+    WaitHostSwapIn(
+            ComputingGraph& graph, VarNode* swap_in_var, VarNode* wait_var,
+            const OperatorNodeConfig& config);
+    static SymbolVar make(
+            ComputingGraph& graph, SymbolVar swap_in_var, SymbolVar wait_var,
+            const OperatorNodeConfig& config = {});
+
+private:
+    void scn_do_execute() override;
+    NodeProp* do_make_node_prop() const override;
+    void init_output_static_infer_desc() override;
+    void mem_plan_fwd_in2out_readonly() override;
+    void init_rt_force_dynamic_mem_alloc_imply_chain() override;
+};
+#endif  // MGB_ENABLE_HOST_MEMORY_SWAP
+
 }  // namespace opr
 }  // namespace swap
 }  // namespace mgb
 
-#endif  // MGB_ENABLE_MEMORY_SWAP
+#endif  // MGB_ENABLE_MEMORY_SWAP || MGB_ENABLE_HOST_MEMORY_SWAP
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
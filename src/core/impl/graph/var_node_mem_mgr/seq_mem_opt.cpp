@@ -5,6 +5,7 @@
 #include "megbrain/graph/event.h"
 #include "megbrain/graph/exc_extra_info.h"
 #include "megbrain/graph/helper.h"
+#include "megbrain/graph/static_mem_plan.h"
 #include "megbrain/utils/arith_helper.h"
 #include "megbrain/utils/metahelper.h"
 
@@ -257,6 +258,7 @@ bool SeqMemOptimizer::run_static_mem_alloc() {
 #endif
 
     bool ret = false;
+    m_static_mem_plan_keys.clear();
     for (auto&& i : group_by_cn) {
         auto cmp = [](const MemChunkLifeInterval& a, const MemChunkLifeInterval& b) {
             return a.begin < b.begin || (a.begin == b.begin && a.end < b.end);
@@ -266,6 +268,7 @@ bool SeqMemOptimizer::run_static_mem_alloc() {
         ret |= run_static_mem_alloc_on_comp_node(i.first, i.second, *logger);
     }
     logger->flush();
+    StaticMemPlanCache::set_graph_plan_keys(*m_graph, m_static_mem_plan_keys);
 
     // trigger event for other comp nodes
     for (auto i : m_all_comp_nodes) {
@@ -288,7 +291,14 @@ bool SeqMemOptimizer::run_static_mem_alloc_on_comp_node(
         StaticMemAllocLogger& static_mem_alloc_logger) {
     size_t size_ub = 0;
 
-    auto allocator = StaticMemAlloc::make(StaticMemAlloc::AllocatorAlgo::PUSHDOWN);
+    // SEARCH falls back to PUSHDOWN with zero budget, but it is also needed to
+    // look up the plans loaded from model files
+    auto search_budget = m_graph->options().seq_opt.static_mem_search_budget;
+    auto allocator = StaticMemAlloc::make(
+            search_budget > 0 || !StaticMemPlanCache::empty()
+                    ? StaticMemAlloc::AllocatorAlgo::SEARCH
+                    : StaticMemAlloc::AllocatorAlgo::PUSHDOWN);
+    allocator->time_budget(search_budget);
     allocator->alignment(comp_node.get_mem_addr_alignment());
     allocator->padding(comp_node.get_mem_padding());
 #if MGB_ENABLE_DEBUG_UTIL
@@ -322,6 +332,9 @@ bool SeqMemOptimizer::run_static_mem_alloc_on_comp_node(
     }
 
     allocator->solve();
+    if (auto key = allocator->plan_key()) {
+        m_static_mem_plan_keys.push_back(key);
+    }
     size_t size = allocator->tot_alloc(), size_lb = allocator->tot_alloc_lower_bound();
 
     static_mem_alloc_logger.push(comp_node, size, size_lb, size_ub);
@@ -35,6 +35,9 @@ class SeqMemOptimizer {
     size_t m_status = 0;
     std::vector<std::pair<MemAllocPlan*, MemAllocPlan*>> m_writable_fwd_mem_plans;
 
+    //! keys of the cached plans used by the current static memory allocation
+    std::vector<uint64_t> m_static_mem_plan_keys;
+
     bool should_static_alloc_var(VarNode* var);
 
     bool in_sys_alloc(OperatorNodeBase* opr) const {
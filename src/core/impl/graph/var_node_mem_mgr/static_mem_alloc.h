@@ -29,6 +29,10 @@ public:
 
         //! O(n log n) allocator with better performance
         PUSHDOWN,
+
+        //! search over placement orders within a time budget, starting from
+        //! PUSHDOWN; plans are cached by the interval list
+        SEARCH,
     };
 
     static std::unique_ptr<StaticMemAlloc> make(AllocatorAlgo algo);
@@ -88,6 +92,22 @@ public:
      */
     virtual StaticMemAlloc& padding(size_t padding) = 0;
 
+    /*!
+     * \brief set the time budget in seconds for algorithms that search for
+     *      better plans; ignored by other algorithms
+     *
+     * Must be called before calling solve()
+     */
+    virtual StaticMemAlloc& time_budget(double /* seconds */) { return *this; }
+
+    /*!
+     * \brief key of the solved plan in StaticMemPlanCache, or 0 if the plan
+     *      is not cached
+     *
+     * Must be called after calling solve()
+     */
+    virtual uint64_t plan_key() const { return 0; }
+
 #if MGB_ENABLE_DEBUG_UTIL
     //! set by the caller to convert key to VarNode* for debug logging
     VarNode* (*dbg_key2varnode)(UserKeyType) = nullptr;
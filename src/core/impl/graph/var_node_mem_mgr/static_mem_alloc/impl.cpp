@@ -2,6 +2,7 @@
 #include "./best_fit.h"
 #include "./interval_move.h"
 #include "./pushdown.h"
+#include "./search.h"
 
 #include <map>
 
@@ -377,6 +378,8 @@ std::unique_ptr<StaticMemAlloc> StaticMemAlloc::make(AllocatorAlgo algo) {
 #endif
         case AllocatorAlgo::PUSHDOWN:
             return std::make_unique<StaticMemAllocPushdown>();
+        case AllocatorAlgo::SEARCH:
+            return std::make_unique<StaticMemAllocSearch>();
         default:
             mgb_assert(0, "unknown mem allocator algorithm");
     }
@@ -55,7 +55,9 @@ protected:
     /*!
      * \brief get aligned address
      */
-    size_t align(size_t addr) { return get_aligned_power2(addr, m_alignment); }
+    size_t align(size_t addr) const { return get_aligned_power2(addr, m_alignment); }
+
+    size_t get_alignment() const { return m_alignment; }
 
 private:
     size_t m_alignment = 1, m_padding = 0, m_peak_lower_bound = 0;
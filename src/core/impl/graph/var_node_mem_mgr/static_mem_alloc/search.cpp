@@ -0,0 +1,300 @@
+#include "./search.h"
+#include "./pushdown.h"
+
+#include "megbrain/graph/static_mem_plan.h"
+#include "megbrain/utils/hash.h"
+#include "megbrain/utils/timer.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+using namespace mgb;
+using namespace cg;
+
+constexpr double StaticMemAllocSearch::DEFAULT_TIME_BUDGET;
+
+/* ======================== StaticMemAllocSearch ======================== */
+
+void StaticMemAllocSearch::init_units() {
+    m_units.clear();
+    m_interval2unit.assign(m_interval.size(), INVALID);
+    for (auto i : m_interval) {
+        if (i->is_overwrite_root()) {
+            m_interval2unit.at(i->id) = m_units.size();
+            m_units.push_back({i, i->time_begin, i->time_end, i->size, {}});
+        }
+    }
+    for (auto i : m_interval) {
+        auto root = i->is_overwrite_root() ? i : i->overwrite_dest_root();
+        auto unit_id = m_interval2unit.at(root->id);
+        auto&& unit = m_units[unit_id];
+        auto offset = i->offset_in_overwrite_dest_root();
+        unit.blocks.push_back({i->time_begin, i->time_end, offset, i->size});
+        update_min(unit.time_begin, i->time_begin);
+        update_max(unit.time_end, i->time_end);
+        update_max(unit.size, offset + i->size);
+        m_interval2unit.at(i->id) = unit_id;
+    }
+    for (auto&& unit : m_units) {
+        std::sort(
+                unit.blocks.begin(), unit.blocks.end(),
+                [](const Block& a, const Block& b) {
+                    return a.time_begin < b.time_begin;
+                });
+    }
+}
+
+size_t StaticMemAllocSearch::live_set_lower_bound() const {
+    // each unit contributes the size of one block at any time: an overwriter
+    // starts at the last time step of the block it overwrites, and that step
+    // is counted for the overwritten block only; sizes are extended to the
+    // alignment boundaries as in check_result_and_calc_lower_bound()
+    std::vector<std::pair<size_t, ptrdiff_t>> events;
+    for (auto&& unit : m_units) {
+        size_t prev_end = 0;
+        for (auto&& blk : unit.blocks) {
+            auto begin = std::max(blk.time_begin, prev_end);
+            if (begin < blk.time_end) {
+                auto size = static_cast<ptrdiff_t>(
+                        align(blk.offset + blk.size) -
+                        (blk.offset & ~(get_alignment() - 1)));
+                events.emplace_back(begin, size);
+                events.emplace_back(blk.time_end, -size);
+            }
+            prev_end = blk.time_end;
+        }
+    }
+    // free before alloc at the same time
+    std::sort(events.begin(), events.end());
+    ptrdiff_t usage = 0, peak = 0;
+    for (auto&& i : events) {
+        usage += i.second;
+        update_max(peak, usage);
+    }
+    mgb_assert(!usage);
+    return peak;
+}
+
+size_t StaticMemAllocSearch::place(
+        const std::vector<size_t>& order, std::vector<size_t>& addr) const {
+    addr.assign(m_units.size(), INVALID);
+    std::vector<size_t> placed;
+    placed.reserve(order.size());
+    //! [begin, end) of forbidden addresses of the unit to be placed
+    std::vector<std::pair<size_t, size_t>> forbidden;
+    size_t peak = 0;
+    for (auto uid : order) {
+        auto&& unit = m_units[uid];
+        forbidden.clear();
+        for (auto pid : placed) {
+            auto&& other = m_units[pid];
+            if (unit.time_begin >= other.time_end ||
+                other.time_begin >= unit.time_end) {
+                continue;
+            }
+            for (auto&& a : unit.blocks) {
+                for (auto&& b : other.blocks) {
+                    if (a.time_begin >= b.time_end || b.time_begin >= a.time_end) {
+                        continue;
+                    }
+                    // a conflicts with b iff addr_b - off_a - size_a < x and
+                    // x < addr_b + size_b - off_a, where x is the unit address
+                    size_t b_begin = addr[pid] + b.offset, b_end = b_begin + b.size,
+                           a_end = a.offset + a.size;
+                    size_t lo = b_begin + 1 > a_end ? b_begin + 1 - a_end : 0,
+                           hi = b_end > a.offset ? b_end - a.offset : 0;
+                    if (lo < hi) {
+                        forbidden.emplace_back(lo, hi);
+                    }
+                }
+            }
+        }
+        std::sort(forbidden.begin(), forbidden.end());
+        size_t cur = 0;
+        for (auto&& i : forbidden) {
+            if (i.first > cur) {
+                break;
+            }
+            if (i.second > cur) {
+                cur = align(i.second);
+            }
+        }
+        addr[uid] = cur;
+        update_max(peak, cur + unit.size);
+        placed.push_back(uid);
+    }
+    return peak;
+}
+
+size_t StaticMemAllocSearch::peak_usage(const std::vector<size_t>& addr) const {
+    size_t peak = 0;
+    for (size_t i = 0; i < m_units.size(); ++i) {
+        update_max(peak, addr[i] + m_units[i].size);
+    }
+    return peak;
+}
+
+std::vector<size_t> StaticMemAllocSearch::solve_by_pushdown() const {
+    StaticMemAllocPushdown pushdown;
+    pushdown.alignment(get_alignment());
+#if MGB_ENABLE_DEBUG_UTIL
+    pushdown.dbg_key2varnode = dbg_key2varnode;
+#endif
+    for (auto i : m_interval) {
+        auto id = pushdown.add(i->time_begin, i->time_end, i->size, i->key);
+        mgb_assert(id == i->id);
+    }
+    for (auto i : m_interval) {
+        if (!i->is_overwrite_root()) {
+            pushdown.add_overwrite_spec(
+                    i->id, i->overwrite_dest()->id, i->offset_in_overwrite_dest());
+        }
+    }
+    pushdown.solve();
+    std::vector<size_t> addr(m_units.size());
+    for (size_t i = 0; i < m_units.size(); ++i) {
+        addr[i] = pushdown.get_start_addr(m_units[i].root->key);
+    }
+    return addr;
+}
+
+uint64_t StaticMemAllocSearch::hash_intervals() const {
+    std::vector<size_t> buf;
+    buf.reserve(m_interval.size() * 5 + 1);
+    buf.push_back(get_alignment());
+    for (auto i : m_interval) {
+        auto dest = i->overwrite_dest();
+        buf.insert(
+                buf.end(), {i->time_begin, i->time_end, i->size,
+                            dest ? dest->id : INVALID, i->offset_in_overwrite_dest()});
+    }
+    return XXHash{}.update(buf.data(), buf.size() * sizeof(size_t)).digest();
+}
+
+void StaticMemAllocSearch::apply_plan(const std::vector<size_t>& addr) {
+    for (auto i : m_interval) {
+        auto unit_addr = addr[m_interval2unit[i->id]];
+        i->addr_begin = unit_addr + i->offset_in_overwrite_dest_root();
+    }
+    m_peak_usage = align(peak_usage(addr));
+}
+
+void StaticMemAllocSearch::do_solve() {
+    init_units();
+    auto cache_key = hash_intervals();
+    std::vector<size_t> best_addr;
+    m_plan_key = 0;
+    // plans may be loaded from model files, so check the number of units;
+    // conflicts are caught by check_result_and_calc_lower_bound()
+    if (StaticMemPlanCache::get(cache_key, best_addr) &&
+        best_addr.size() == m_units.size()) {
+        apply_plan(best_addr);
+        m_plan_key = cache_key;
+        mgb_log_debug(
+                "static mem alloc search: use cached plan: peak=%zu", m_peak_usage);
+        return;
+    }
+
+    auto pushdown_addr = solve_by_pushdown();
+    if (m_time_budget <= 0) {
+        apply_plan(pushdown_addr);
+        return;
+    }
+
+    RealTimer timer;
+    size_t lower_bound = live_set_lower_bound();
+    best_addr = pushdown_addr;
+    size_t best_peak = peak_usage(best_addr);
+    const char* best_from = "pushdown";
+
+    // greedy orders as seeds of the local search
+    std::vector<size_t> order(m_units.size()), addr, best_order;
+    size_t best_order_peak = std::numeric_limits<size_t>::max();
+    auto try_order = [&](const char* name) {
+        auto peak = place(order, addr);
+        if (peak < best_order_peak) {
+            best_order_peak = peak;
+            best_order = order;
+        }
+        if (peak < best_peak) {
+            best_peak = peak;
+            best_addr = addr;
+            best_from = name;
+        }
+    };
+    auto sort_order = [&](auto&& cmp) {
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+            return cmp(m_units[a], m_units[b]);
+        });
+    };
+    auto length = [](const Unit& u) { return u.time_end - u.time_begin; };
+
+    sort_order([](const Unit& a, const Unit& b) { return a.size > b.size; });
+    try_order("size");
+    sort_order([&](const Unit& a, const Unit& b) {
+        return a.size * length(a) > b.size * length(b);
+    });
+    try_order("area");
+    sort_order([&](const Unit& a, const Unit& b) {
+        return length(a) > length(b) || (length(a) == length(b) && a.size > b.size);
+    });
+    try_order("length");
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return pushdown_addr[a] < pushdown_addr[b];
+    });
+    try_order("pushdown order");
+
+    // local search: move a unit at the peak to an earlier position
+    size_t nr_trial = 0;
+    if (m_units.size() >= 2) {
+        std::mt19937 rng(cache_key);
+        std::vector<size_t> cur_order = best_order, cur_addr, critical;
+        size_t cur_peak = place(cur_order, cur_addr);
+        while (align(best_peak) > lower_bound && timer.get_secs() < m_time_budget) {
+            ++nr_trial;
+            critical.clear();
+            for (size_t i = 0; i < m_units.size(); ++i) {
+                if (cur_addr[i] + m_units[i].size == cur_peak) {
+                    critical.push_back(i);
+                }
+            }
+            auto uid = critical.at(rng() % critical.size());
+            size_t pos = std::find(cur_order.begin(), cur_order.end(), uid) -
+                         cur_order.begin();
+            if (!pos) {
+                pos = 1 + rng() % (cur_order.size() - 1);
+            }
+            size_t new_pos = rng() % pos;
+            order = cur_order;
+            std::rotate(
+                    order.begin() + new_pos, order.begin() + pos,
+                    order.begin() + pos + 1);
+            auto peak = place(order, addr);
+            if (peak <= cur_peak) {
+                cur_peak = peak;
+                cur_order.swap(order);
+                cur_addr.swap(addr);
+                if (cur_peak < best_peak) {
+                    best_peak = cur_peak;
+                    best_addr = cur_addr;
+                    best_from = "local search";
+                }
+            }
+        }
+    }
+
+    apply_plan(best_addr);
+    StaticMemPlanCache::put({cache_key, best_addr});
+    m_plan_key = cache_key;
+    mgb_log_debug(
+            "static mem alloc search: peak=%zu lower_bound=%zu gap=%.2f%% "
+            "from=%s trials=%zu time=%.3fs",
+            m_peak_usage, lower_bound,
+            lower_bound ? (m_peak_usage - lower_bound) * 100.0 / lower_bound : 0.,
+            best_from, nr_trial, timer.get_secs());
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
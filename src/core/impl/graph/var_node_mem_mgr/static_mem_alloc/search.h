@@ -0,0 +1,88 @@
+#pragma once
+
+#include "./impl.h"
+
+namespace mgb {
+namespace cg {
+
+/*!
+ * \brief allocator that searches for a plan with small peak memory within a
+ *      time budget
+ *
+ * The overwrite chains are packed as units. Each unit is placed at the lowest
+ * aligned address that does not conflict with the units placed before it, so
+ * a plan is determined by the order of the units. The search starts from the
+ * plans of PUSHDOWN and several greedy orders, and then improves the order by
+ * moving units ending at the peak to earlier positions, until the live-set
+ * lower bound is reached or the budget runs out.
+ *
+ * Plans are put into StaticMemPlanCache keyed by the hash of the interval
+ * list, so solving the same intervals again (e.g. when a model is reloaded, or
+ * when the plans are loaded from a model file) skips the search. If the time
+ * budget is not positive, only the cache and PUSHDOWN are used.
+ */
+class StaticMemAllocSearch final : public StaticMemAllocImplHelper {
+    //! an interval in an overwrite chain, with address relative to the root
+    struct Block {
+        size_t time_begin, time_end, offset, size;
+    };
+
+    //! an overwrite chain, whose blocks are sorted by time
+    struct Unit {
+        Interval* root;
+        size_t time_begin, time_end, size;
+        std::vector<Block> blocks;
+    };
+
+    double m_time_budget = DEFAULT_TIME_BUDGET;
+    size_t m_peak_usage = 0;
+    uint64_t m_plan_key = 0;
+
+    std::vector<Unit> m_units;
+
+    //! index of the unit of each interval, indexed by interval id
+    std::vector<size_t> m_interval2unit;
+
+    void init_units();
+
+    //! lower bound of peak usage, to stop the search early
+    size_t live_set_lower_bound() const;
+
+    /*!
+     * \brief place the units by given order
+     * \param[out] addr address of each unit
+     * \return peak usage of the plan
+     */
+    size_t place(const std::vector<size_t>& order, std::vector<size_t>& addr) const;
+
+    //! peak usage of a plan given by addresses of units
+    size_t peak_usage(const std::vector<size_t>& addr) const;
+
+    //! the plan of PUSHDOWN on the same intervals, as addresses of units
+    std::vector<size_t> solve_by_pushdown() const;
+
+    //! hash of the intervals and overwrite specs as the key of StaticMemPlanCache
+    uint64_t hash_intervals() const;
+
+    //! assign Interval::addr_begin from the addresses of units
+    void apply_plan(const std::vector<size_t>& addr);
+
+public:
+    static constexpr double DEFAULT_TIME_BUDGET = 0.1;
+
+    void do_solve() override;
+
+    size_t tot_alloc() const override { return m_peak_usage; }
+
+    StaticMemAlloc& time_budget(double seconds) override {
+        m_time_budget = seconds;
+        return *this;
+    }
+
+    uint64_t plan_key() const override { return m_plan_key; }
+};
+
+}  // namespace cg
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,97 @@
+#include "megbrain/graph/static_mem_plan.h"
+
+#include <deque>
+#include <unordered_map>
+
+using namespace mgb;
+using namespace cg;
+
+namespace {
+
+struct CacheStorage {
+    MGB_MUTEX mtx;
+    std::unordered_map<uint64_t, std::vector<size_t>> plans;
+    //! keys in insertion order, for eviction
+    std::deque<uint64_t> keys;
+
+    static CacheStorage& inst() {
+        static CacheStorage storage;
+        return storage;
+    }
+};
+
+//! keys of the plans used by a graph
+class GraphPlanKeys final : public UserDataContainer::UserData {
+    MGB_TYPEINFO_OBJ_DECL;
+
+public:
+    std::vector<uint64_t> keys;
+};
+MGB_TYPEINFO_OBJ_IMPL(GraphPlanKeys);
+
+}  // anonymous namespace
+
+constexpr size_t StaticMemPlanCache::MAX_NR_PLAN;
+
+bool StaticMemPlanCache::get(uint64_t key, std::vector<size_t>& offsets) {
+    auto&& storage = CacheStorage::inst();
+    MGB_LOCK_GUARD(storage.mtx);
+    auto iter = storage.plans.find(key);
+    if (iter == storage.plans.end()) {
+        return false;
+    }
+    offsets = iter->second;
+    return true;
+}
+
+void StaticMemPlanCache::put(const StaticMemPlan& plan) {
+    auto&& storage = CacheStorage::inst();
+    MGB_LOCK_GUARD(storage.mtx);
+    auto ins = storage.plans.emplace(plan.key, plan.offsets);
+    if (!ins.second) {
+        ins.first->second = plan.offsets;
+        return;
+    }
+    storage.keys.push_back(plan.key);
+    if (storage.keys.size() > MAX_NR_PLAN) {
+        storage.plans.erase(storage.keys.front());
+        storage.keys.pop_front();
+    }
+}
+
+bool StaticMemPlanCache::empty() {
+    auto&& storage = CacheStorage::inst();
+    MGB_LOCK_GUARD(storage.mtx);
+    return storage.plans.empty();
+}
+
+void StaticMemPlanCache::clear() {
+    auto&& storage = CacheStorage::inst();
+    MGB_LOCK_GUARD(storage.mtx);
+    storage.plans.clear();
+    storage.keys.clear();
+}
+
+void StaticMemPlanCache::set_graph_plan_keys(
+        ComputingGraph& graph, std::vector<uint64_t> keys) {
+    auto record = graph.options().user_data.get_user_data_or_create<GraphPlanKeys>();
+    record->keys = std::move(keys);
+}
+
+std::vector<StaticMemPlan> StaticMemPlanCache::get_graph_plans(ComputingGraph& graph) {
+    std::vector<StaticMemPlan> ret;
+    auto records = graph.options().user_data.get_user_data<GraphPlanKeys>();
+    if (!records.second) {
+        return ret;
+    }
+    for (auto key : records.first[0]->keys) {
+        StaticMemPlan plan;
+        plan.key = key;
+        if (get(key, plan.offsets)) {
+            ret.emplace_back(std::move(plan));
+        }
+    }
+    return ret;
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
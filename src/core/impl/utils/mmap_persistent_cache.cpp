@@ -0,0 +1,372 @@
+#include "megbrain/utils/mmap_persistent_cache.h"
+#include "megbrain/utils/hash.h"
+
+#include <cstring>
+
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace mgb;
+
+namespace {
+constexpr char MAGIC[8] = "mgbpcch";
+constexpr uint32_t FORMAT_VERSION = 1;
+
+size_t round_up8(size_t size) {
+    return (size + 7) & ~static_cast<size_t>(7);
+}
+}  // anonymous namespace
+
+struct MmapPersistentCache::Header {
+    static constexpr size_t SIGNATURE_SIZE = 208;
+
+    char magic[sizeof(MAGIC)];
+    uint32_t format_version;
+    uint32_t nr_bucket;
+    uint64_t capacity;
+    uint64_t data_begin;
+    //! end of the data region, increased atomically by writers
+    uint64_t data_end;
+    uint64_t nr_entry;
+    char signature[SIGNATURE_SIZE];
+};
+
+struct MmapPersistentCache::Record {
+    uint64_t hash;
+    uint32_t category_size, key_size, value_size, reserved;
+
+    const uint8_t* category() const {
+        return reinterpret_cast<const uint8_t*>(this + 1);
+    }
+    const uint8_t* key() const { return category() + category_size; }
+    const uint8_t* value() const { return key() + key_size; }
+
+    static size_t total_size(size_t category_size, size_t key_size, size_t value_size) {
+        return sizeof(Record) + round_up8(category_size + key_size + value_size);
+    }
+
+    size_t total_size() const {
+        return total_size(category_size, key_size, value_size);
+    }
+
+    bool match(uint64_t hash_, const std::string& category_, const Blob& key_) const {
+        return hash == hash_ && category_size == category_.size() &&
+               key_size == key_.size &&
+               !memcmp(category(), category_.data(), category_size) &&
+               !memcmp(key(), key_.ptr, key_size);
+    }
+};
+
+constexpr size_t MmapPersistentCache::DEFAULT_CAPACITY;
+constexpr size_t MmapPersistentCache::DEFAULT_NR_BUCKET;
+
+uint64_t MmapPersistentCache::hash_key(const std::string& category, const Blob& key) {
+    uint32_t category_size = category.size();
+    return XXHash{}
+            .update(&category_size, sizeof(category_size))
+            .update(category.data(), category.size())
+            .update(key.ptr, key.size)
+            .digest();
+}
+
+#ifndef WIN32
+
+MmapPersistentCache::MmapPersistentCache(
+        const char* path, size_t capacity, size_t nr_bucket) {
+    static_assert(sizeof(Header) % 8 == 0 && sizeof(Record) % 8 == 0, "bad size");
+    // a file with another signature may be created by other processes between
+    // our creation and opening, so retry a few times
+    for (int i = 0; i < 3; ++i) {
+        bool io_error = false;
+        if (open_file(path, &io_error)) {
+            mgb_log_debug(
+                    "use mmap persistent cache: %s entries=%zu", path,
+                    nr_mapped_entry());
+            return;
+        }
+        if (io_error || !create_file(path, capacity, nr_bucket, !access(path, F_OK))) {
+            break;
+        }
+    }
+    mgb_log_warn(
+            "failed to use mmap persistent cache %s; keep the cache in memory", path);
+}
+
+MmapPersistentCache::~MmapPersistentCache() {
+    if (m_ptr) {
+        munmap(m_ptr, m_size);
+    }
+}
+
+bool MmapPersistentCache::open_file(const char* path, bool* io_error) {
+    int fd = open(path, O_RDWR);
+    if (fd < 0) {
+        if (errno != ENOENT) {
+            mgb_log_warn("failed to open %s: %s", path, strerror(errno));
+            *io_error = true;
+        }
+        return false;
+    }
+    struct stat st;
+    if (fstat(fd, &st)) {
+        mgb_log_warn("failed to stat %s: %s", path, strerror(errno));
+        close(fd);
+        *io_error = true;
+        return false;
+    }
+    size_t size = st.st_size;
+    if (!S_ISREG(st.st_mode)) {
+        mgb_log_warn("%s is not a regular file", path);
+        close(fd);
+        *io_error = true;
+        return false;
+    }
+    if (size < sizeof(Header)) {
+        close(fd);
+        return false;
+    }
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    auto err = errno;
+    close(fd);
+    if (ptr == MAP_FAILED) {
+        mgb_log_warn("failed to mmap %s: %s", path, strerror(err));
+        *io_error = true;
+        return false;
+    }
+
+    auto header = static_cast<Header*>(ptr);
+    auto signature = make_host_signature();
+    signature.resize(Header::SIGNATURE_SIZE - 1);
+    bool same_signature = !strncmp(
+            header->signature, signature.c_str(), Header::SIGNATURE_SIZE);
+    auto nr = header->nr_bucket;
+    bool valid = !memcmp(header->magic, MAGIC, sizeof(MAGIC)) &&
+                 header->format_version == FORMAT_VERSION && same_signature &&
+                 header->capacity == size && nr && !(nr & (nr - 1)) &&
+                 header->data_begin == sizeof(Header) + nr * sizeof(uint64_t) &&
+                 header->data_begin <= size;
+    if (!valid) {
+        mgb_log_debug("mmap persistent cache %s is invalid or outdated", path);
+        munmap(ptr, size);
+        return false;
+    }
+    m_ptr = static_cast<uint8_t*>(ptr);
+    m_size = size;
+    m_header = header;
+    m_buckets = reinterpret_cast<uint64_t*>(m_ptr + sizeof(Header));
+    return true;
+}
+
+bool MmapPersistentCache::create_file(
+        const char* path, size_t capacity, size_t nr_bucket, bool replace) {
+    size_t nr = 1;
+    while (nr < nr_bucket) {
+        nr *= 2;
+    }
+    Header header;
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.format_version = FORMAT_VERSION;
+    header.nr_bucket = nr;
+    header.data_begin = header.data_end = sizeof(Header) + nr * sizeof(uint64_t);
+    header.capacity = std::max<size_t>(capacity, header.data_begin);
+    strncpy(header.signature, make_host_signature().c_str(),
+            Header::SIGNATURE_SIZE - 1);
+
+    // the file is initialized aside and then moved in place, so that other
+    // processes never see a partial header
+    auto tmp_path = ssprintf("%s.%d.tmp", path, static_cast<int>(getpid()));
+    int fd = open(tmp_path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) {
+        mgb_log_warn("failed to open %s: %s", tmp_path.c_str(), strerror(errno));
+        return false;
+    }
+    bool succ = !ftruncate(fd, header.capacity) &&
+                pwrite(fd, &header, sizeof(header), 0) ==
+                        static_cast<ssize_t>(sizeof(header));
+    auto err = errno;
+    close(fd);
+    if (!succ) {
+        unlink(tmp_path.c_str());
+        mgb_log_warn("failed to write %s: %s", tmp_path.c_str(), strerror(err));
+        return false;
+    }
+    if (replace) {
+        mgb_log_warn("replace mmap persistent cache %s", path);
+        succ = !rename(tmp_path.c_str(), path);
+    } else {
+        // fail if another process has created the file
+        succ = !link(tmp_path.c_str(), path) || errno == EEXIST;
+    }
+    err = errno;
+    if (!succ) {
+        mgb_log_warn("failed to create %s: %s", path, strerror(err));
+    }
+    if (!replace || !succ) {
+        unlink(tmp_path.c_str());
+    }
+    return succ;
+}
+
+const MmapPersistentCache::Record* MmapPersistentCache::get_record(
+        uint64_t offset) const {
+    if (offset % 8 || offset < m_header->data_begin ||
+        offset + sizeof(Record) > m_size) {
+        return nullptr;
+    }
+    auto record = reinterpret_cast<const Record*>(m_ptr + offset);
+    if (offset + record->total_size() > m_size) {
+        return nullptr;
+    }
+    return record;
+}
+
+const MmapPersistentCache::Record* MmapPersistentCache::get_mapped(
+        const std::string& category, const Blob& key) const {
+    auto hash = hash_key(category, key);
+    size_t mask = m_header->nr_bucket - 1;
+    for (size_t i = 0; i <= mask; ++i) {
+        auto offset = __atomic_load_n(&m_buckets[(hash + i) & mask], __ATOMIC_ACQUIRE);
+        if (!offset) {
+            break;
+        }
+        auto record = get_record(offset);
+        if (record && record->match(hash, category, key)) {
+            return record;
+        }
+    }
+    return nullptr;
+}
+
+bool MmapPersistentCache::put_mapped(
+        const std::string& category, const Blob& key, const Blob& value) {
+    auto hash = hash_key(category, key);
+    auto size = Record::total_size(category.size(), key.size, value.size);
+    auto offset = __atomic_fetch_add(&m_header->data_end, size, __ATOMIC_RELAXED);
+    if (offset + size > m_size) {
+        return false;
+    }
+    auto record = reinterpret_cast<Record*>(m_ptr + offset);
+    record->hash = hash;
+    record->category_size = category.size();
+    record->key_size = key.size;
+    record->value_size = value.size;
+    record->reserved = 0;
+    auto data = m_ptr + offset + sizeof(Record);
+    memcpy(data, category.data(), category.size());
+    memcpy(data + category.size(), key.ptr, key.size);
+    memcpy(data + category.size() + key.size, value.ptr, value.size);
+
+    // publish the record to the first bucket that is empty or holds the same
+    // key; records are never modified after being published
+    size_t mask = m_header->nr_bucket - 1;
+    for (size_t i = 0; i <= mask; ++i) {
+        auto bucket = &m_buckets[(hash + i) & mask];
+        uint64_t cur = __atomic_load_n(bucket, __ATOMIC_ACQUIRE);
+        for (;;) {
+            if (cur) {
+                auto other = get_record(cur);
+                if (!other || !other->match(hash, category, key)) {
+                    break;
+                }
+            }
+            if (__atomic_compare_exchange_n(
+                        bucket, &cur, offset, false, __ATOMIC_ACQ_REL,
+                        __ATOMIC_ACQUIRE)) {
+                if (!cur) {
+                    __atomic_fetch_add(&m_header->nr_entry, 1, __ATOMIC_RELAXED);
+                }
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+size_t MmapPersistentCache::nr_mapped_entry() const {
+    return m_header ? __atomic_load_n(&m_header->nr_entry, __ATOMIC_RELAXED) : 0;
+}
+
+#else  // WIN32
+
+MmapPersistentCache::MmapPersistentCache(const char* path, size_t, size_t) {
+    mgb_log_warn(
+            "mmap persistent cache is not supported on this platform; keep the "
+            "cache of %s in memory",
+            path);
+}
+
+MmapPersistentCache::~MmapPersistentCache() = default;
+
+bool MmapPersistentCache::open_file(const char*, bool*) {
+    return false;
+}
+
+bool MmapPersistentCache::create_file(const char*, size_t, size_t, bool) {
+    return false;
+}
+
+const MmapPersistentCache::Record* MmapPersistentCache::get_record(uint64_t) const {
+    return nullptr;
+}
+
+const MmapPersistentCache::Record* MmapPersistentCache::get_mapped(
+        const std::string&, const Blob&) const {
+    return nullptr;
+}
+
+bool MmapPersistentCache::put_mapped(const std::string&, const Blob&, const Blob&) {
+    return false;
+}
+
+size_t MmapPersistentCache::nr_mapped_entry() const {
+    return 0;
+}
+
+#endif  // WIN32
+
+Maybe<PersistentCache::Blob> MmapPersistentCache::get(
+        const std::string& category, const Blob& key) {
+    if (m_ptr) {
+        if (auto record = get_mapped(category, key)) {
+            return Blob{record->value(), record->value_size};
+        }
+    }
+
+    // entries that are not in the file, or merged from the previous cache
+    MGB_LOCK_GUARD(m_mtx);
+    auto iter0 = m_cache.find(category);
+    if (iter0 == m_cache.end()) {
+        return None;
+    }
+    BlobStorage key_storage;
+    key_storage.Blob::operator=(key);
+    key_storage.init_hash();
+    auto iter1 = iter0->second.find(key_storage);
+    if (iter1 == iter0->second.end()) {
+        return None;
+    }
+    return iter1->second;
+}
+
+void MmapPersistentCache::put(
+        const std::string& category, const Blob& key, const Blob& value) {
+    if (m_ptr && put_mapped(category, key, value)) {
+        return;
+    }
+    BlobStorage key_storage;
+    key_storage.init_data_ref(key).init_hash();
+
+    MGB_LOCK_GUARD(m_mtx);
+    if (m_ptr && !m_full_warned) {
+        m_full_warned = true;
+        mgb_log_warn("mmap persistent cache is full; keep new entries in memory");
+    }
+    m_cache[category][std::move(key_storage)].init_data_ref(value);
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -1,5 +1,7 @@
 #include "megbrain/utils/persistent_cache.h"
 #include "megbrain/comp_node_env.h"
+#include "megbrain/version.h"
+#include "megdnn/version.h"
 
 #include <cstdio>
 #include <cstring>
@@ -12,8 +14,58 @@
 #include <cuda_runtime_api.h>
 #endif
 
+#if defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+#include <sys/auxv.h>
+#endif
+
 using namespace mgb;
 
+namespace {
+//! the key is not empty since InFilePersistentCache can not read empty blobs
+constexpr char HOST_SIGNATURE_CATEGORY[] = "host_signature",
+               HOST_SIGNATURE_KEY[] = "host";
+
+std::string cpu_features() {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    std::string ret;
+    __builtin_cpu_init();
+#define cb(_name)                           \
+    if (__builtin_cpu_supports(_name)) {    \
+        ret.append(ret.empty() ? "" : ","); \
+        ret.append(_name);                  \
+    }
+    cb("sse4.2") cb("avx") cb("avx2") cb("fma") cb("avx512f") cb("avx512bw")
+#undef cb
+    return ret;
+#elif defined(__linux__) && (defined(__aarch64__) || defined(__arm__))
+    return ssprintf(
+            "hwcap=%lx,%lx", getauxval(AT_HWCAP),
+#ifdef AT_HWCAP2
+            getauxval(AT_HWCAP2)
+#else
+            0ul
+#endif
+    );
+#else
+    return "unknown";
+#endif
+}
+
+const char* cpu_arch() {
+#if defined(__x86_64__) || defined(_M_X64)
+    return "x86_64";
+#elif defined(__i386__) || defined(_M_IX86)
+    return "x86";
+#elif defined(__aarch64__)
+    return "aarch64";
+#elif defined(__arm__)
+    return "armv7";
+#else
+    return "unknown";
+#endif
+}
+}  // anonymous namespace
+
 // ================= PersistentCache ======================
 std::shared_ptr<PersistentCache> PersistentCache::sm_impl =
         std::make_shared<InMemoryPersistentCache>();
@@ -77,6 +129,31 @@ bool PersistentCache::BlobStorage::operator==(const BlobStorage& rhs) const {
     return size == rhs.size && !memcmp(ptr, rhs.ptr, size);
 }
 
+std::string PersistentCache::make_host_signature() {
+    auto mgb_ver = get_version();
+    auto dnn_ver = megdnn::get_version();
+    return ssprintf(
+            "mge=%d.%d.%d;megdnn=%d.%d.%d;arch=%s;cpu=%s", mgb_ver.major,
+            mgb_ver.minor, mgb_ver.patch, dnn_ver.major, dnn_ver.minor,
+            dnn_ver.patch, cpu_arch(), cpu_features().c_str());
+}
+
+void PersistentCache::put_host_signature() {
+    auto sig = make_host_signature();
+    put(HOST_SIGNATURE_CATEGORY,
+        {HOST_SIGNATURE_KEY, sizeof(HOST_SIGNATURE_KEY) - 1},
+        {sig.data(), sig.size()});
+}
+
+bool PersistentCache::check_host_signature() {
+    auto sig = get(
+            HOST_SIGNATURE_CATEGORY,
+            {HOST_SIGNATURE_KEY, sizeof(HOST_SIGNATURE_KEY) - 1});
+    return !sig.valid() ||
+           std::string(static_cast<const char*>(sig->ptr), sig->size) ==
+                   make_host_signature();
+}
+
 std::string PersistentCache::make_category_from_comp_node(CompNode comp_node) {
     auto&& env = CompNodeEnv::from_comp_node(comp_node);
     switch (env.property().type) {
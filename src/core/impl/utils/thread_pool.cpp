@@ -1,9 +1,67 @@
 #include "megbrain/utils/thread_pool.h"
+#include "megbrain/utils/thread_local.h"
+#include <algorithm>
+#include <cerrno>
 #include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
 
 using namespace mgb;
 
 #if MGB_HAVE_THREAD
+namespace {
+//! the pool whose task is running on current thread, used to detect nested
+//! add_task()
+MGB_THREAD_LOCAL_PTR(ThreadPool) tl_running_pool = nullptr;
+//! thread id in tl_running_pool of current thread, which is passed to nested
+//! tasks so that they use the per-thread resources of the caller
+MGB_THREAD_LOCAL_PTR(size_t) tl_running_thread_id = nullptr;
+
+ThreadPool* running_pool() {
+    return tl_running_pool;
+}
+
+using Clock = std::chrono::steady_clock;
+
+size_t to_nsecs(Clock::duration duration) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+}
+}  // anonymous namespace
+
+size_t ThreadPool::parse_spin_budget_us(const char* str) {
+    if (str) {
+        char* end;
+        errno = 0;
+        auto spin = strtoull(str, &end, 10);
+        // strtoull accepts and negates a leading minus sign
+        if (end != str && !*end && !errno && !strchr(str, '-')) {
+            mgb_log_debug("thread pool workers would spin %llu us before park", spin);
+            return spin;
+        }
+        mgb_log_warn("ignore invalid MGB_THREAD_POOL_SPIN_US: %s", str);
+    }
+    //! the same 5ms budget as SCQueueSynchronizer::get_default_max_spin
+    return 5000;
+}
+
+size_t ThreadPool::get_default_spin_budget_us() {
+    static size_t spin_budget_us =
+            parse_spin_budget_us(MGB_GETENV("MGB_THREAD_POOL_SPIN_US"));
+    return spin_budget_us;
+}
+
+struct ThreadPool::Job {
+    const TaskElem* task_elem;
+    //! number of sub tasks finished
+    std::atomic_size_t nr_finished{0};
+    //! sequence number in ThreadPoolTrace, 0 if the job is not traced
+    uint64_t trace_job = 0;
+    uint64_t trace_tag = 0;
+    size_t nr_threads = 0;
+};
+
 ThreadPool::ThreadPool(size_t threads_num)
         : m_nr_threads(threads_num),
           m_main_affinity_flag{false},
@@ -12,6 +70,7 @@ ThreadPool::ThreadPool(size_t threads_num)
     if (threads_num < 1) {
         m_nr_threads = 1;
     }
+    set_spin_budget_us(get_default_spin_budget_us());
     if (m_nr_threads > 1) {
         if (m_nr_threads > static_cast<uint32_t>(sys::get_cpu_count())) {
             mgb_log_debug(
@@ -19,85 +78,236 @@ ThreadPool::ThreadPool(size_t threads_num)
                     "physical cpu cores, got: %zu core_number: %zu",
                     static_cast<size_t>(sys::get_cpu_count()), nr_threads());
         }
+        //! workers wait on m_mutex until all of them are constructed
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_workers.reserve(m_nr_threads - 1);
         for (uint32_t i = 0; i < m_nr_threads - 1; i++) {
-            m_workers.push_back(new Worker([this, i]() {
-                while (!m_stop) {
-                    while (m_active) {
-                        if (m_workers[i]->affinity_flag &&
-                            m_core_binding_function != nullptr) {
-                            m_core_binding_function(i);
-                            m_workers[i]->affinity_flag = false;
-                        }
-                        //! if the thread should work
-                        if (m_workers[i]->work_flag.load(std::memory_order_acquire)) {
-                            int index = -1;
-                            //! Get one task and execute
-                            while ((index = m_task_iter.fetch_sub(
-                                            1, std::memory_order_acq_rel)) &&
-                                   index > 0) {
-                                //! index is decrease, use
-                                //! m_all_task_number - index to get the
-                                //! increase id which will pass to task
-                                m_task(static_cast<size_t>(m_nr_parallelism - index),
-                                       i);
-                            }
-                            //! Flag worker is finished
-                            m_workers[i]->work_flag.store(
-                                    false, std::memory_order_release);
-                        }
-                        //! Wait next task coming
-                        std::this_thread::yield();
-                    }
-                    {
-                        std::unique_lock<std::mutex> lock(m_mutex);
-                        if (!m_stop && !m_active) {
-                            m_cv.wait(lock, [this] { return m_stop || m_active; });
-                        }
-                    }
-                }
-            }));
+            m_workers.push_back(new Worker([this, i]() { worker_loop(i); }));
         }
     }
 }
+
+void ThreadPool::worker_loop(size_t id) {
+    tl_running_pool = this;
+    tl_running_thread_id = &id;
+    Worker* worker;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        worker = m_workers[id];
+    }
+    size_t epoch = m_epoch.load();
+    park(worker, epoch);
+    auto idle_start = Clock::now();
+    bool idle = false;
+    while (!m_stop) {
+        if (worker->affinity_flag && m_core_binding_function != nullptr) {
+            m_core_binding_function(id);
+            worker->affinity_flag = false;
+        }
+        //! the epoch must be read before probing the deques, see wake_workers
+        epoch = m_epoch.load();
+        TaskChunk chunk;
+        if (pop_chunk(id, chunk) || steal_chunk(id, nullptr, chunk)) {
+            if (idle) {
+                worker->spin_ns.fetch_add(
+                        to_nsecs(Clock::now() - idle_start),
+                        std::memory_order_relaxed);
+                idle = false;
+            }
+            worker->work_flag.store(true, std::memory_order_relaxed);
+            run_chunk(chunk, id);
+            worker->work_flag.store(false, std::memory_order_release);
+            continue;
+        }
+        auto now = Clock::now();
+        if (!idle) {
+            idle = true;
+            idle_start = now;
+        }
+        auto spin_ns = to_nsecs(now - idle_start);
+        if (!m_active || spin_ns >= m_spin_budget_ns.load(std::memory_order_relaxed)) {
+            //! spin budget exhausted, park until next task coming
+            worker->spin_ns.fetch_add(spin_ns, std::memory_order_relaxed);
+            park(worker, epoch);
+            idle_start = Clock::now();
+        } else {
+            //! Wait next task coming
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ThreadPool::park(Worker* worker, size_t epoch) {
+    auto start = Clock::now();
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_nr_parked.fetch_add(1);
+        m_cv.wait(lock, [this, epoch] {
+            return m_stop || (m_active && m_epoch.load() != epoch);
+        });
+        m_nr_parked.fetch_sub(1);
+    }
+    worker->park_ns.fetch_add(
+            to_nsecs(Clock::now() - start), std::memory_order_relaxed);
+    worker->nr_park.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ThreadPool::wake_workers() {
+    //! pairs with the worker which reads m_epoch before probing deques and
+    //! increases m_nr_parked before parking: either the worker sees the new
+    //! epoch, or the notify is issued after the worker has parked
+    m_epoch.fetch_add(1);
+    if (m_nr_parked.load()) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_cv.notify_all();
+    }
+}
+
+void ThreadPool::split_job(Job* job, SmallVector<TaskChunk>& local_chunks) {
+    size_t parallelism = job->task_elem->nr_parallelism;
+    //! adaptive grain size: at most CHUNKS_PER_THREAD chunks for each
+    //! thread, so that stealing can balance the load while a small task is
+    //! not split into too many pieces
+    size_t nr_chunks = std::min(parallelism, m_nr_threads * CHUNKS_PER_THREAD);
+    size_t grain = (parallelism + nr_chunks - 1) / nr_chunks;
+    size_t slot = m_next_worker.fetch_add(1, std::memory_order_relaxed);
+    for (size_t begin = 0; begin < parallelism; begin += grain, ++slot) {
+        TaskChunk chunk{job, begin, std::min(begin + grain, parallelism)};
+        size_t id = slot % m_nr_threads;
+        if (id == m_nr_threads - 1) {
+            local_chunks.push_back(chunk);
+            continue;
+        }
+        auto worker = m_workers[id];
+        {
+            MGB_LOCK_GUARD(worker->chunks_lock);
+            worker->chunks.push_back(chunk);
+        }
+        worker->nr_chunks.fetch_add(1, std::memory_order_release);
+    }
+    wake_workers();
+}
+
+bool ThreadPool::pop_chunk(size_t id, TaskChunk& chunk) {
+    auto worker = m_workers[id];
+    if (!worker->nr_chunks.load(std::memory_order_acquire)) {
+        return false;
+    }
+    MGB_LOCK_GUARD(worker->chunks_lock);
+    if (worker->chunks.empty()) {
+        return false;
+    }
+    chunk = worker->chunks.back();
+    worker->chunks.pop_back();
+    worker->nr_chunks.fetch_sub(1, std::memory_order_relaxed);
+    return true;
+}
+
+bool ThreadPool::steal_chunk(size_t self, const void* job, TaskChunk& chunk) {
+    for (size_t i = 1; i < m_nr_threads; ++i) {
+        size_t victim = (self + i) % m_nr_threads;
+        //! the submitter thread (with id m_nr_threads - 1) owns no deque
+        if (victim == m_nr_threads - 1) {
+            continue;
+        }
+        auto worker = m_workers[victim];
+        if (!worker->nr_chunks.load(std::memory_order_acquire)) {
+            continue;
+        }
+        MGB_LOCK_GUARD(worker->chunks_lock);
+        auto&& chunks = worker->chunks;
+        for (auto iter = chunks.begin(); iter != chunks.end(); ++iter) {
+            if (!job || iter->job == job) {
+                chunk = *iter;
+                chunks.erase(iter);
+                worker->nr_chunks.fetch_sub(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+void ThreadPool::run_chunk(const TaskChunk& chunk, size_t thread_id) {
+    auto job = static_cast<Job*>(chunk.job);
+    auto&& task = job->task_elem->task;
+    ThreadPoolTrace::Clock::time_point begin;
+    if (job->trace_job) {
+        begin = ThreadPoolTrace::Clock::now();
+    }
+    for (size_t i = chunk.begin; i < chunk.end; ++i) {
+        task(i, thread_id);
+    }
+    if (job->trace_job) {
+        ThreadPoolTrace::append(
+                {job->trace_tag, job->trace_job, job->nr_threads, thread_id,
+                 std::this_thread::get_id(), chunk.end - chunk.begin, begin,
+                 ThreadPoolTrace::Clock::now()});
+    }
+    //! job may be destructed by the submitter once all the sub tasks are
+    //! marked finished, so it must be the last access
+    job->nr_finished.fetch_add(chunk.end - chunk.begin, std::memory_order_acq_rel);
+}
+
 void ThreadPool::add_task(const TaskElem& task_elem) {
     //! Make sure the main thread have bind
     if (m_main_affinity_flag && m_core_binding_function != nullptr) {
         std::lock_guard<std::mutex> lock(m_mutex_task);
-        m_core_binding_function(m_nr_threads - 1);
-        m_main_affinity_flag = false;
+        if (m_main_affinity_flag) {
+            m_core_binding_function(m_nr_threads - 1);
+            m_main_affinity_flag = false;
+        }
     }
     size_t parallelism = task_elem.nr_parallelism;
+    //! If nested in a task of this pool, execute directly with the thread id
+    //! of the caller, which is not used by any other thread in the outer task
+    if (running_pool() == this) {
+        size_t thread_id = *tl_running_thread_id;
+        for (size_t i = 0; i < parallelism; i++) {
+            task_elem.task(i, thread_id);
+        }
+        return;
+    }
     //! If only one thread or one task, execute directly
-    if (task_elem.nr_parallelism == 1 || m_nr_threads == 1) {
+    if (parallelism == 1 || m_nr_threads == 1) {
         for (size_t i = 0; i < parallelism; i++) {
             task_elem.task(i, 0);
         }
         return;
-    } else {
-        std::lock_guard<std::mutex> lock(m_mutex_task);
-        mgb_assert(
-                m_task_iter.load(std::memory_order_acquire) <= 0,
-                "The init value of m_all_sub_task is not zero.");
-        active();
-        //! Set the task number, task iter and task
-        m_nr_parallelism = parallelism;
-        m_task_iter.exchange(parallelism, std::memory_order_relaxed);
-        m_task = [&task_elem](size_t index, size_t thread_id) {
-            task_elem.task(index, thread_id);
-        };
-        //! Set flag to start thread working
-        for (uint32_t i = 0; i < m_nr_threads - 1; i++) {
-            m_workers[i]->work_flag = true;
-        }
-        //! Main thread working
-        int index = -1;
-        while ((index = m_task_iter.fetch_sub(1, std::memory_order_acq_rel)) &&
-               (index > 0)) {
-            m_task(static_cast<size_t>(m_nr_parallelism - index), m_nr_threads - 1);
+    }
+    //! must be ordered before active() reads m_active, see deactive()
+    m_nr_running_jobs.fetch_add(1);
+    active();
+    Job job;
+    job.task_elem = &task_elem;
+    if (auto tag = ThreadPoolTrace::tag()) {
+        job.trace_job = ThreadPoolTrace::next_job();
+        job.trace_tag = tag;
+        job.nr_threads = m_nr_threads;
+    }
+    SmallVector<TaskChunk> local_chunks;
+    split_job(&job, local_chunks);
+
+    //! Main thread working, only on chunks of its own job
+    auto prev_pool = running_pool();
+    size_t* prev_thread_id = tl_running_thread_id;
+    size_t main_id = m_nr_threads - 1;
+    tl_running_pool = this;
+    tl_running_thread_id = &main_id;
+    for (auto&& chunk : local_chunks) {
+        run_chunk(chunk, main_id);
+    }
+    TaskChunk chunk;
+    while (job.nr_finished.load(std::memory_order_acquire) < parallelism) {
+        if (steal_chunk(main_id, &job, chunk)) {
+            run_chunk(chunk, main_id);
+        } else {
+            std::this_thread::yield();
         }
-        //! make sure all threads done
-        sync();
     }
+    tl_running_pool = prev_pool;
+    tl_running_thread_id = prev_thread_id;
+    m_nr_running_jobs.fetch_sub(1, std::memory_order_release);
 }
 
 void ThreadPool::set_affinity(AffinityCallBack affinity_cb) {
@@ -114,25 +324,37 @@ size_t ThreadPool::nr_threads() const {
     return m_nr_threads;
 }
 
+void ThreadPool::set_spin_budget_us(size_t spin_budget_us) {
+    size_t max_us = std::numeric_limits<size_t>::max() / 1000;
+    m_spin_budget_ns.store(
+            std::min(spin_budget_us, max_us) * 1000, std::memory_order_relaxed);
+}
+
+size_t ThreadPool::spin_budget_us() const {
+    return m_spin_budget_ns.load(std::memory_order_relaxed) / 1000;
+}
+
+ThreadPool::WaitStat ThreadPool::get_wait_stat() const {
+    WaitStat stat;
+    for (auto worker : m_workers) {
+        stat.spin_ms += worker->spin_ns.load(std::memory_order_relaxed) / 1e6;
+        stat.park_ms += worker->park_ns.load(std::memory_order_relaxed) / 1e6;
+        stat.nr_park += worker->nr_park.load(std::memory_order_relaxed);
+    }
+    return stat;
+}
+
 void ThreadPool::sync() {
-    bool no_finished = false;
-    do {
-        no_finished = false;
-        for (uint32_t i = 0; i < m_nr_threads - 1; ++i) {
-            if (m_workers[i]->work_flag) {
-                no_finished = true;
-                break;
-            }
-        }
-        if (no_finished) {
-            std::this_thread::yield();
-        }
-    } while (no_finished);
+    while (m_nr_running_jobs.load(std::memory_order_acquire)) {
+        std::this_thread::yield();
+    }
 }
 void ThreadPool::active() {
     if (!m_active) {
         std::unique_lock<std::mutex> lock(m_mutex);
         m_active = true;
+        //! let the parked workers start spinning for the coming tasks
+        m_epoch.fetch_add(1);
         m_cv.notify_all();
     }
 }
@@ -140,8 +362,16 @@ void ThreadPool::deactive() {
     std::lock_guard<std::mutex> lock_task(m_mutex_task);
     std::unique_lock<std::mutex> lock(m_mutex);
     m_active = false;
+    //! another submitter may have seen the pool active and skipped active(),
+    //! keep the workers running for its task
+    if (m_nr_running_jobs.load()) {
+        m_active = true;
+        m_epoch.fetch_add(1);
+        m_cv.notify_all();
+    }
 }
 ThreadPool::~ThreadPool() {
+    sync();
     std::lock_guard<std::mutex> lock_task(m_mutex_task);
     {
         std::unique_lock<std::mutex> lock(m_mutex);
@@ -149,6 +379,11 @@ ThreadPool::~ThreadPool() {
         m_active = false;
         m_cv.notify_all();
     }
+    //! workers may steal from each other, so all of them must exit before
+    //! any deque is destructed
+    for (auto& worker : m_workers) {
+        worker->thread.join();
+    }
     for (auto& worker : m_workers) {
         delete worker;
     }
@@ -164,4 +399,185 @@ void ThreadPool::set_affinity(AffinityCallBack affinity_cb) {
     affinity_cb(0);
 }
 #endif
+
+/* ===================== ThreadPoolTrace ===================== */
+
+namespace {
+/*!
+ * \brief ring buffer of the records of a thread, with the owner thread as the
+ *      only producer and collect() as the only consumer
+ */
+class TraceBuffer {
+    static constexpr size_t CAPACITY = 1024;
+    std::atomic_size_t m_head{0}, m_tail{0};
+    std::unique_ptr<ThreadPoolTrace::Record[]> m_records{
+            new ThreadPoolTrace::Record[CAPACITY]};
+
+public:
+    //! tag of the owner thread, only accessed by itself
+    uint64_t tag = 0;
+
+    bool push(const ThreadPoolTrace::Record& record) {
+        size_t head = m_head.load(std::memory_order_relaxed);
+        if (head - m_tail.load(std::memory_order_acquire) >= CAPACITY) {
+            return false;
+        }
+        m_records[head % CAPACITY] = record;
+        m_head.store(head + 1, std::memory_order_release);
+        return true;
+    }
+
+    template <typename Func>
+    void drain(Func&& on_record) {
+        size_t tail = m_tail.load(std::memory_order_relaxed),
+               head = m_head.load(std::memory_order_acquire);
+        for (; tail < head; ++tail) {
+            on_record(m_records[tail % CAPACITY]);
+        }
+        m_tail.store(head, std::memory_order_release);
+    }
+};
+
+struct TraceRegistry {
+    //! protect buffers and pending
+    std::mutex mtx;
+    //! buffers are kept after their threads exit, so that no record is lost
+    std::vector<std::unique_ptr<TraceBuffer>> buffers;
+    //! drained records not collected yet, grouped by tag
+    std::unordered_map<uint64_t, std::vector<ThreadPoolTrace::Record>> pending;
+    std::atomic_size_t next_job{0}, nr_dropped{0};
+
+    static TraceRegistry& inst() {
+        static TraceRegistry registry;
+        return registry;
+    }
+};
+
+MGB_THREAD_LOCAL_PTR(TraceBuffer) tl_trace_buffer = nullptr;
+
+TraceBuffer& this_thread_trace_buffer() {
+    TraceBuffer* buffer = tl_trace_buffer;
+    if (!buffer) {
+        auto&& registry = TraceRegistry::inst();
+        MGB_LOCK_GUARD(registry.mtx);
+        registry.buffers.emplace_back(std::make_unique<TraceBuffer>());
+        buffer = registry.buffers.back().get();
+        tl_trace_buffer = buffer;
+    }
+    return *buffer;
+}
+
+double to_msecs(ThreadPoolTrace::Clock::duration duration) {
+    return std::chrono::duration<double, std::milli>(duration).count();
+}
+}  // anonymous namespace
+
+void ThreadPoolTrace::set_tag(uint64_t tag) {
+    if (tag || tl_trace_buffer) {
+        this_thread_trace_buffer().tag = tag;
+    }
+}
+
+uint64_t ThreadPoolTrace::tag() {
+    TraceBuffer* buffer = tl_trace_buffer;
+    return buffer ? buffer->tag : 0;
+}
+
+uint64_t ThreadPoolTrace::next_job() {
+    return TraceRegistry::inst().next_job.fetch_add(1, std::memory_order_relaxed) +
+           1;
+}
+
+void ThreadPoolTrace::append(const Record& record) {
+    if (!this_thread_trace_buffer().push(record)) {
+        TraceRegistry::inst().nr_dropped.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::vector<ThreadPoolTrace::Record> ThreadPoolTrace::collect(uint64_t tag) {
+    auto&& registry = TraceRegistry::inst();
+    MGB_LOCK_GUARD(registry.mtx);
+    for (auto&& buffer : registry.buffers) {
+        buffer->drain([&](const Record& record) {
+            registry.pending[record.tag].push_back(record);
+        });
+    }
+    std::vector<Record> ret;
+    auto iter = registry.pending.find(tag);
+    if (iter != registry.pending.end()) {
+        ret = std::move(iter->second);
+        registry.pending.erase(iter);
+    }
+    return ret;
+}
+
+size_t ThreadPoolTrace::nr_dropped() {
+    return TraceRegistry::inst().nr_dropped.load(std::memory_order_relaxed);
+}
+
+ThreadPoolTrace::Stat& ThreadPoolTrace::Stat::operator+=(const Stat& rhs) {
+    nr_jobs += rhs.nr_jobs;
+    nr_chunks += rhs.nr_chunks;
+    nr_tasks += rhs.nr_tasks;
+    max_busy_ms += rhs.max_busy_ms;
+    mean_busy_ms += rhs.mean_busy_ms;
+    straggler_ms += rhs.straggler_ms;
+    if (thread_busy_ms.size() < rhs.thread_busy_ms.size()) {
+        thread_busy_ms.resize(rhs.thread_busy_ms.size());
+        thread_nr_tasks.resize(rhs.thread_nr_tasks.size());
+    }
+    for (size_t i = 0; i < rhs.thread_busy_ms.size(); ++i) {
+        thread_busy_ms[i] += rhs.thread_busy_ms[i];
+        thread_nr_tasks[i] += rhs.thread_nr_tasks[i];
+    }
+    return *this;
+}
+
+ThreadPoolTrace::Stat ThreadPoolTrace::Stat::make(const std::vector<Record>& records) {
+    struct ThreadStat {
+        double busy_ms = 0;
+        Clock::time_point finish;
+    };
+    struct JobStat {
+        size_t nr_threads = 0;
+        std::unordered_map<size_t, ThreadStat> threads;
+    };
+    std::unordered_map<uint64_t, JobStat> jobs;
+    Stat stat;
+    for (auto&& record : records) {
+        auto&& job = jobs[record.job];
+        job.nr_threads = record.nr_threads;
+        auto&& thread = job.threads[record.thread_id];
+        auto busy_ms = to_msecs(record.end - record.begin);
+        thread.busy_ms += busy_ms;
+        thread.finish = std::max(thread.finish, record.end);
+        ++stat.nr_chunks;
+        stat.nr_tasks += record.nr_tasks;
+        if (stat.thread_busy_ms.size() < record.nr_threads) {
+            stat.thread_busy_ms.resize(record.nr_threads);
+            stat.thread_nr_tasks.resize(record.nr_threads);
+        }
+        stat.thread_busy_ms[record.thread_id] += busy_ms;
+        stat.thread_nr_tasks[record.thread_id] += record.nr_tasks;
+    }
+    stat.nr_jobs = jobs.size();
+    for (auto&& job : jobs) {
+        double total_busy = 0, max_busy = 0;
+        auto first_finish = Clock::time_point::max(),
+             last_finish = Clock::time_point::min();
+        for (auto&& i : job.second.threads) {
+            auto&& thread = i.second;
+            total_busy += thread.busy_ms;
+            max_busy = std::max(max_busy, thread.busy_ms);
+            first_finish = std::min(first_finish, thread.finish);
+            last_finish = std::max(last_finish, thread.finish);
+        }
+        stat.max_busy_ms += max_busy;
+        // threads without any chunk are counted as idle
+        stat.mean_busy_ms += total_busy / job.second.nr_threads;
+        stat.straggler_ms += to_msecs(last_finish - first_finish);
+    }
+    return stat;
+}
+
 // vim: syntax=cpp.doxygen
@@ -0,0 +1,65 @@
+#include "megbrain/utils/zero_word_codec.h"
+
+#include <algorithm>
+#include <cstring>
+
+using namespace mgb;
+
+namespace {
+constexpr size_t WORD_SIZE = sizeof(uint32_t);
+}  // anonymous namespace
+
+bool ZeroWordCodec::encode(
+        const void* src_, size_t size, size_t limit, std::vector<uint8_t>& dst) {
+    size_t nr_words = size / WORD_SIZE, tail = size % WORD_SIZE;
+    size_t mask_size = (nr_words + 7) / 8;
+    if (mask_size + tail > limit) {
+        return false;
+    }
+    // each block of 8 words writes at most 8 words, and the limit is checked after
+    // each block
+    dst.resize(limit + 8 * WORD_SIZE);
+    auto src = static_cast<const uint8_t*>(src_);
+    size_t nr_bytes = mask_size;
+    for (size_t i = 0; i < nr_words; i += 8) {
+        uint8_t mask = 0;
+        size_t end = std::min(i + 8, nr_words);
+        for (size_t j = i; j < end; ++j) {
+            uint32_t word;
+            memcpy(&word, src + j * WORD_SIZE, WORD_SIZE);
+            if (word) {
+                mask |= 1 << (j - i);
+                memcpy(dst.data() + nr_bytes, &word, WORD_SIZE);
+                nr_bytes += WORD_SIZE;
+            }
+        }
+        dst[i / 8] = mask;
+        if (nr_bytes + tail > limit) {
+            return false;
+        }
+    }
+    memcpy(dst.data() + nr_bytes, src + nr_words * WORD_SIZE, tail);
+    dst.resize(nr_bytes + tail);
+    dst.shrink_to_fit();
+    return true;
+}
+
+void ZeroWordCodec::decode(const uint8_t* src, size_t size, void* dst_) {
+    size_t nr_words = size / WORD_SIZE, tail = size % WORD_SIZE;
+    auto dst = static_cast<uint8_t*>(dst_);
+    auto mask_ptr = src;
+    src += (nr_words + 7) / 8;
+    memset(dst, 0, nr_words * WORD_SIZE);
+    for (size_t i = 0; i < nr_words; i += 8) {
+        uint8_t mask = mask_ptr[i / 8];
+        for (size_t j = i; mask; ++j, mask >>= 1) {
+            if (mask & 1) {
+                memcpy(dst + j * WORD_SIZE, src, WORD_SIZE);
+                src += WORD_SIZE;
+            }
+        }
+    }
+    memcpy(dst + nr_words * WORD_SIZE, src, tail);
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -20,6 +20,10 @@ namespace cg {
 class ComputingGraph;
 }
 
+namespace mem_alloc {
+struct SizeClassConfig;
+}
+
 class CompNodeSeqRecorder;
 
 /*!
@@ -308,6 +312,19 @@ public:
             size_t alignment, size_t min_req, size_t max_overhead, double growth_factor,
             DeviceType device_type);
 
+    /*!
+     * \brief serve device allocations of this comp node by size class caches
+     *      in front of a best-fit allocator; see mem_alloc::SizeClassConfig
+     *
+     * It must be called before any device memory is allocated on this comp
+     * node, and is only supported by CPU comp nodes. Setting the environment
+     * variable MGB_CPU_SIZE_CLASS_ALLOC enables it with the default config on
+     * all CPU comp nodes.
+     */
+    void enable_size_class_alloc(const mem_alloc::SizeClassConfig& config) const {
+        m_impl->enable_size_class_alloc(config);
+    }
+
     /*!
      * \brief get device property of the specified device
      */
@@ -650,6 +667,12 @@ protected:
             mgb_throw(MegBrainError, "get_uid is not impl yet");
         };
 
+        virtual void enable_size_class_alloc(const mem_alloc::SizeClassConfig&) {
+            mgb_throw(
+                    MegBrainError, "size class alloc is not supported on %s",
+                    locator().to_string().c_str());
+        }
+
     protected:
         ImplBase(free_func_t fd, free_func_t fh) : free_device{fd}, free_host{fh} {}
 
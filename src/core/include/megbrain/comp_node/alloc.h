@@ -56,6 +56,23 @@ public:
  */
 struct FreeMemStat {
     size_t tot, min, max, nr_blk;
+
+    //! bytes of the free blocks held by the size class caches, which are not
+    //! included in tot since they only serve requests of the same size class
+    size_t cached = 0;
+
+    //! number of allocations served by the size class caches and number of
+    //! allocations of a size class that missed the caches
+    size_t nr_cache_hit = 0, nr_cache_miss = 0;
+
+    //! fraction of the free memory that can not be used by the largest request
+    double fragmentation() const { return tot ? 1. - double(max) / tot : 0.; }
+
+    //! fraction of the size class allocations served by the caches
+    double cache_hit_rate() const {
+        size_t nr = nr_cache_hit + nr_cache_miss;
+        return nr ? double(nr_cache_hit) / nr : 0.;
+    }
 };
 
 /*!
@@ -351,6 +368,28 @@ public:
 };
 
 /* ===================== SimpleCachingAlloc  ===================== */
+
+/*!
+ * \brief config of the size class front end of SimpleCachingAlloc
+ *
+ * Requests not larger than max_size are rounded up to size classes (four
+ * classes for each power of 2), and their freed blocks are kept in per-class
+ * free lists instead of being merged into the best-fit free tree. The lists are
+ * sharded by the allocating thread, each shard has its own lock, and a block
+ * always returns to the shard it was allocated from.
+ */
+struct SizeClassConfig {
+    //! max request size served by the size classes
+    size_t max_size = 256 * 1024;
+
+    //! max bytes cached by each size class in each shard; the blocks freed
+    //! beyond it go back to the best-fit free tree
+    size_t max_cached_per_class = 1024 * 1024;
+
+    //! number of shards of the free lists, 0 means the number of cpu cores
+    size_t nr_shards = 0;
+};
+
 /*!
  * \brief An allocator that cache allocations to reduce call to raw allocator.
  * Mainly used for CUDA pinned memory.
@@ -364,6 +403,11 @@ public:
     static std::unique_ptr<SimpleCachingAlloc> make(
             std::unique_ptr<RawAllocator> raw_alloc);
 
+    //! make an allocator whose small and medium requests are served by size
+    //! class caches in front of the best-fit free tree
+    static std::unique_ptr<SimpleCachingAlloc> make(
+            std::unique_ptr<RawAllocator> raw_alloc, const SizeClassConfig& config);
+
     virtual void* alloc(size_t size) = 0;
     virtual void free(void* ptr) = 0;
 
@@ -209,6 +209,8 @@ const char* cnml_get_error_string(cnmlStatus_t err);
 #endif
 #endif
 
+class ThreadPool;
+
 class CPUDispatcher : public MegcoreCPUDispatcher {
 public:
     using AffinityCallBack = thin_function<void(size_t)>;
@@ -219,6 +221,16 @@ public:
     virtual void set_affinity(AffinityCallBack&& /*affinity_cb*/) {
         mgb_assert(0, "The CompNode set_affinity is not implement");
     }
+    //! get the thread pool running the multithreading tasks, or nullptr if
+    //! the tasks are run in a single thread; it can be used to tune the wait
+    //! policy of the worker threads
+    virtual ThreadPool* get_thread_pool() { return nullptr; }
+    //! start (and reset) or stop measuring the latency from dispatching a
+    //! task to starting it on the computing thread
+    virtual void enable_dispatch_stat(bool /*enable*/) {}
+    //! get the dispatch latency measured; it is empty if the tasks are not
+    //! dispatched to a dedicated computing thread
+    virtual AsyncQueueLatencyStat get_dispatch_stat() const { return {}; }
 };
 using AtlasDispatcher = CPUDispatcher;
 
@@ -524,6 +536,8 @@ public:
         void set_affinity(AffinityCallBack&& cb) const {
             dispatcher->set_affinity(std::move(cb));
         }
+
+        ThreadPool* get_thread_pool() const { return dispatcher->get_thread_pool(); }
     };
 
     const CpuEnv& cpu_env() const {
@@ -22,6 +22,18 @@
     ((!MGB_BUILD_SLIM_SERVING) && (!!MGB_HAVE_THREAD) && (MGB_CUDA))
 #endif  //  MGB_ENABLE_MEMORY_SWAP
 
+/*!
+ * swap of large activations on CPU comp nodes to a local spill file or compressed
+ * host memory, which shares the swap planning with MGB_ENABLE_MEMORY_SWAP
+ */
+#ifndef MGB_ENABLE_HOST_MEMORY_SWAP
+#ifdef WIN32
+#define MGB_ENABLE_HOST_MEMORY_SWAP 0
+#else
+#define MGB_ENABLE_HOST_MEMORY_SWAP ((!MGB_BUILD_SLIM_SERVING) && (!!MGB_HAVE_THREAD))
+#endif
+#endif  //  MGB_ENABLE_HOST_MEMORY_SWAP
+
 #ifndef MGB_ENABLE_PARTIAL_EXECUTION
 #define MGB_ENABLE_PARTIAL_EXECUTION (!MGB_BUILD_SLIM_SERVING)
 #endif  //  MGB_ENABLE_PARTIAL_EXECUTION
@@ -330,6 +330,11 @@ public:
             //! whether to enable comp node optimization (e.g. using copy
             //! stream for I/O operators)
             bool enable_seq_comp_node_opt = true;
+
+            //! time budget in seconds for searching a static memory plan
+            //! with lower peak usage than the default algorithm; 0 means no
+            //! search. Plans found are cached within the process
+            double static_mem_search_budget = 0;
         } seq_opt;
 
         //! graph optimization options
@@ -481,6 +486,31 @@ public:
          */
         bool enable_memory_swap = false;
 
+        /*!
+         * Control parameter for memory swap on CPU comp nodes, where vars
+         * are swapped out to a spill file or compressed host memory in
+         * forward and prefetched asynchronously before being consumed
+         */
+        struct HostSwapConfig {
+            enum class Storage {
+                //! mmap'd local file, whose pages could be reclaimed by the
+                //! system under memory pressure
+                SPILL_FILE,
+                //! compressed host memory, and incompressible vars fall back
+                //! to the spill file
+                COMPRESSED,
+            };
+            Storage storage = Storage::SPILL_FILE;
+            //! directory of the spill file; use the system temporary
+            //! directory if empty
+            std::string spill_dir;
+            //! minimum size of vars to be swapped, in bytes
+            size_t min_var_size = 1ULL << 20;
+            //! number of oprs in the seq to start prefetching before the
+            //! consumer of a swapped var
+            int prefetch_distance = 5;
+        } host_swap_config;
+
         /*!
          * whether to use CompNodeSeqRecorder to record the execution
          * sequence and directly replay it for later executions.
@@ -0,0 +1,60 @@
+#pragma once
+
+#include "megbrain/graph/cg.h"
+
+#include <vector>
+
+namespace mgb {
+namespace cg {
+
+/*!
+ * \brief a solved static memory allocation plan on one comp node
+ *
+ * The plan is keyed by the hash of the memory intervals (lifetimes, sizes,
+ * overwrite specs and alignment) passed to the static memory allocator, so it
+ * is reused only if the intervals are exactly the same.
+ */
+struct StaticMemPlan {
+    uint64_t key = 0;
+
+    //! start address of each group of chunks that overwrite each other
+    std::vector<size_t> offsets;
+};
+
+/*!
+ * \brief process-wide cache of static memory plans
+ *
+ * Plans found by the SEARCH static memory allocator are put here, and the
+ * graph loader imports the plans embedded in a model. Static memory
+ * allocation consults the cache before solving if it is not empty.
+ */
+class StaticMemPlanCache {
+public:
+    //! max number of cached plans; the oldest plans are evicted
+    static constexpr size_t MAX_NR_PLAN = 64;
+
+    MGE_WIN_DECLSPEC_FUC static bool get(uint64_t key, std::vector<size_t>& offsets);
+
+    MGE_WIN_DECLSPEC_FUC static void put(const StaticMemPlan& plan);
+
+    MGE_WIN_DECLSPEC_FUC static bool empty();
+
+    MGE_WIN_DECLSPEC_FUC static void clear();
+
+    //! set keys of the plans used by the last static memory allocation of
+    //! a graph
+    MGE_WIN_DECLSPEC_FUC static void set_graph_plan_keys(
+            ComputingGraph& graph, std::vector<uint64_t> keys);
+
+    /*!
+     * \brief get the plans used by the last static memory allocation of a
+     *      graph, which are still in the cache
+     */
+    MGE_WIN_DECLSPEC_FUC static std::vector<StaticMemPlan> get_graph_plans(
+            ComputingGraph& graph);
+};
+
+}  // namespace cg
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,95 @@
+#pragma once
+
+#include "megbrain/utils/persistent_cache.h"
+
+namespace mgb {
+
+/*!
+ * \brief persistent cache backed by a memory-mapped file that can be shared by
+ *      multiple processes
+ *
+ * The file is a hash table of fixed capacity. Readers look up an entry by one
+ * hashed probe in the common case without any lock; writers append the record
+ * to the data region and publish it by compare-and-swap on the bucket, so
+ * several processes can read and fill the same file concurrently, and each
+ * entry is written to the file as soon as it is put.
+ *
+ * The file is tagged with the signature of the host (see
+ * PersistentCache::make_host_signature()); a file with a different signature is
+ * atomically replaced by an empty one. Entries that can not be stored in the
+ * file (e.g. when it is full) are kept in memory, and so are all entries if the
+ * file can not be opened or created (e.g. due to permission or disk space).
+ *
+ * file format (native endian):
+ * <Header><bucket|uint64_t*nr_bucket><Record>*
+ *
+ * Each record is <hash|uint64_t><category_size|uint32_t><key_size|uint32_t>
+ * <value_size|uint32_t><reserved|uint32_t><category><key><value>, padded to 8
+ * bytes, and a bucket holds the offset of a record or 0 if it is empty.
+ */
+class MmapPersistentCache final : public PersistentCache {
+    struct Header;
+    struct Record;
+
+    uint8_t* m_ptr = nullptr;
+    size_t m_size = 0;
+    Header* m_header = nullptr;
+    uint64_t* m_buckets = nullptr;
+
+    //! whether the warning about a full file has been printed
+    bool m_full_warned = false;
+
+    //! map the file if it is valid and has the same signature; \p io_error is
+    //! set if the file exists but can not be used
+    bool open_file(const char* path, bool* io_error);
+
+    //! create an empty file and move it to \p path; return false on error
+    bool create_file(
+            const char* path, size_t capacity, size_t nr_bucket, bool replace);
+
+    //! return the record at given offset, or nullptr if it is corrupted
+    const Record* get_record(uint64_t offset) const;
+
+    static uint64_t hash_key(const std::string& category, const Blob& key);
+
+    //! get from the file; return nullptr if not found
+    const Record* get_mapped(const std::string& category, const Blob& key) const;
+
+    //! put to the file; return false if the file is full
+    bool put_mapped(const std::string& category, const Blob& key, const Blob& value);
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;
+    static constexpr size_t DEFAULT_NR_BUCKET = 64 * 1024;
+
+    /*!
+     * \brief open the cache file at given path, which would be created if it
+     *      does not exist or has a different signature
+     *
+     * \param capacity size in bytes of a new file; pages are allocated on
+     *      demand
+     * \param nr_bucket number of hash buckets of a new file, which would be
+     *      rounded up to a power of 2
+     */
+    MGE_WIN_DECLSPEC_FUC MmapPersistentCache(
+            const char* path, size_t capacity = DEFAULT_CAPACITY,
+            size_t nr_bucket = DEFAULT_NR_BUCKET);
+
+    MGE_WIN_DECLSPEC_FUC ~MmapPersistentCache();
+
+    MGE_WIN_DECLSPEC_FUC Maybe<Blob> get(
+            const std::string& category, const Blob& key) override;
+    MGE_WIN_DECLSPEC_FUC void put(
+            const std::string& category, const Blob& key, const Blob& value) override;
+
+    //! whether the cache file is mapped; false if it is not supported or
+    //! failed to open the file, so all entries are kept in memory
+    bool mapped() const { return m_ptr; }
+
+    //! number of entries in the file, including those from other processes
+    MGE_WIN_DECLSPEC_FUC size_t nr_mapped_entry() const;
+};
+
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
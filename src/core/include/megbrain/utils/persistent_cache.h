@@ -79,6 +79,18 @@ public:
     //! make a cache category that incorporates all tratis of a comp
     //! node (e.g. device name, library versions)
     static std::string make_category_from_comp_node(CompNode comp_node);
+
+    //! signature of MegBrain and MegDNN versions, CPU architecture and
+    //! features of the current host, which affect the CPU profiling results
+    MGE_WIN_DECLSPEC_FUC static std::string make_host_signature();
+
+    //! record the signature of the current host in the cache, so that the
+    //! hosts loading the cache can check that it is tuned for them
+    MGE_WIN_DECLSPEC_FUC void put_host_signature();
+
+    //! whether the host signature recorded in the cache, if any, matches the
+    //! current host
+    MGE_WIN_DECLSPEC_FUC bool check_host_signature();
 };
 
 /*!
@@ -65,6 +65,48 @@ public:
      */
     MGB_WARN_UNUSED_RESULT bool all_task_finished() const { return true; }
 
+protected:
+    virtual void on_sync_all_task_finish() {}
+    virtual void on_async_queue_worker_thread_start() {}
+};
+struct AsyncQueueLatencyStat {
+    size_t nr_task = 0;
+    double tot_us = 0;
+    double max_us = 0;
+};
+
+// tasks would be dispatched inplace
+template <typename Param, class TaskImpl>
+class AsyncRingQueueSC : public NonCopyableObj {
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1;
+
+    AsyncRingQueueSC(size_t capacity = DEFAULT_CAPACITY, ptrdiff_t max_spin = -1) {}
+
+    virtual ~AsyncRingQueueSC() = default;
+
+    void add_task(const Param& param) {
+        static_cast<TaskImpl*>(this)->process_one_task(param);
+    }
+
+    void add_task(Param&& param) {
+        static_cast<TaskImpl*>(this)->process_one_task(param);
+    }
+
+    void wait_all_task_finish() {}
+
+    void check_exception() {}
+
+    MGB_WARN_UNUSED_RESULT bool all_task_finished() const { return true; }
+
+    size_t capacity() const { return DEFAULT_CAPACITY; }
+
+    void enable_latency_stat(bool) {}
+
+    AsyncQueueLatencyStat get_latency_stat() const { return {}; }
+
+    void reset_latency_stat() {}
+
 protected:
     virtual void on_sync_all_task_finish() {}
     virtual void on_async_queue_worker_thread_start() {}
@@ -5,6 +5,7 @@
 #include "megbrain/utils/metahelper.h"
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <limits>
@@ -420,6 +421,387 @@ private:
     }
 };
 
+//! statistics of the latency from adding a task to starting to process it
+struct AsyncQueueLatencyStat {
+    //! number of tasks measured
+    size_t nr_task = 0;
+    //! total latency of all the measured tasks in microseconds
+    double tot_us = 0;
+    //! max latency in microseconds
+    double max_us = 0;
+};
+
+/*!
+ * \brief multi producer, single consumer asynchronous queue on a bounded
+ *      lock-free ring buffer
+ *
+ * Producers reserve a slot by a CAS on the enqueue position and publish the
+ * task by the sequence number of the slot, so add_task() takes no lock unless
+ * the consumer sleeps; only one of a burst of producers pays the wakeup. The
+ * consumer spins for max_spin rounds before sleeping on a condition variable.
+ *
+ * When the ring is full, producers yield until a slot is released. A task
+ * added by the worker itself on a full ring still takes the next position, but
+ * is kept in an unbounded overflow list until the consumer reaches that
+ * position, so tasks are always processed in the order they are added.
+ *
+ * The interface and the callbacks of TaskImpl are the same as AsyncQueueSC,
+ * except that tasks can not be skipped.
+ */
+template <typename Param, class TaskImpl>
+class AsyncRingQueueSC : public NonCopyableObj {
+    struct Cell {
+        std::atomic_size_t seq;
+        //! time of add_task() in nanoseconds, or 0 if not measured
+        int64_t add_time_ns;
+        typename std::aligned_storage<sizeof(Param), alignof(Param)>::type m_storage;
+
+        Param* get() { return aliased_ptr<Param>(&m_storage); }
+    };
+
+    //! task added by the worker on a full ring
+    struct OverflowTask {
+        size_t pos;
+        int64_t add_time_ns;
+        Param param;
+    };
+
+public:
+    static constexpr size_t DEFAULT_CAPACITY = 1024;
+    //! consumer yields once per this many spin rounds, must be a power of 2
+    static constexpr size_t SPIN_YIELD_INTERVAL = 256;
+
+    //! \param capacity number of slots of the ring, rounded up to power of 2
+    //! \param max_spin max spin of the consumer before sleeping, see
+    //!     AsyncQueueSC
+    AsyncRingQueueSC(size_t capacity = DEFAULT_CAPACITY, ptrdiff_t max_spin = -1)
+            : m_max_spin(
+                      max_spin >= 0 ? max_spin
+                                    : SCQueueSynchronizer::get_default_max_spin()) {
+        size_t size = 2;
+        while (size < capacity) {
+            size *= 2;
+        }
+        m_mask = size - 1;
+        m_cells.reset(new Cell[size]);
+        for (size_t i = 0; i < size; ++i) {
+            m_cells[i].seq.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    void add_task(const Param& param) { add_task_impl(param); }
+
+    void add_task(Param&& param) { add_task_impl(std::move(param)); }
+
+    /*!
+     * \brief wait for the worker to process all already issued tasks
+     *
+     * Note: new tasks issued during this call would not be waited
+     */
+    void wait_all_task_finish() {
+        auto tgt = m_enqueue_pos.load(std::memory_order_acquire);
+        if (m_finished_task.load(std::memory_order_acquire) < tgt) {
+            std::unique_lock<std::mutex> lk(m_mtx_finished);
+            for (;;) {
+                if (tgt < m_waiter_target.load(std::memory_order_relaxed)) {
+                    m_waiter_target.store(tgt, std::memory_order_relaxed);
+                }
+                // pair with the fence in consumer_commit()
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (m_finished_task.load(std::memory_order_acquire) >= tgt)
+                    break;
+                m_cv_finished.wait(lk);
+            }
+        }
+        check_exception();
+        on_sync_all_task_finish();
+    }
+
+    /*!
+     * \brief check for exception in worker thread and rethrow it to the
+     *      caller thread
+     */
+    void check_exception() {
+#if MGB_ENABLE_EXCEPTION
+        if (m_worker_exc) {
+            std::exception_ptr exc;
+            std::swap(m_worker_exc, exc);
+            std::rethrow_exception(exc);
+        }
+#endif
+    }
+
+    MGB_WARN_UNUSED_RESULT bool all_task_finished() const {
+        return m_finished_task.load(std::memory_order_acquire) ==
+               m_enqueue_pos.load(std::memory_order_acquire);
+    }
+
+    bool worker_started() const {
+        return m_worker_started.load(std::memory_order_acquire);
+    }
+
+    size_t capacity() const { return m_mask + 1; }
+
+    //! start or stop measuring the latency of the tasks added afterwards
+    void enable_latency_stat(bool enable) {
+        m_latency_stat_enabled.store(enable, std::memory_order_relaxed);
+    }
+
+    AsyncQueueLatencyStat get_latency_stat() const {
+        AsyncQueueLatencyStat ret;
+        ret.nr_task = m_stat_nr_task.load(std::memory_order_relaxed);
+        ret.tot_us = m_stat_tot_ns.load(std::memory_order_relaxed) / 1e3;
+        ret.max_us = m_stat_max_ns.load(std::memory_order_relaxed) / 1e3;
+        return ret;
+    }
+
+    void reset_latency_stat() {
+        m_stat_nr_task.store(0, std::memory_order_relaxed);
+        m_stat_tot_ns.store(0, std::memory_order_relaxed);
+        m_stat_max_ns.store(0, std::memory_order_relaxed);
+    }
+
+protected:
+    ~AsyncRingQueueSC() noexcept {
+        if (m_worker_started.load(std::memory_order_acquire)) {
+#if defined(WIN32) && defined(__i386__)
+            if (SCQueueSynchronizer::is_into_atexit) {
+                // see ~SCQueueSynchronizer()
+                m_worker.detach();
+                return;
+            }
+#endif
+            if (!all_task_finished()) {
+                mgb_log_error("async queue not finished in destructor");
+                mgb_trap();
+            }
+            {
+                MGB_LOCK_GUARD(m_mtx_more_task);
+                m_should_exit.store(true, std::memory_order_relaxed);
+                m_cv_more_task.notify_all();
+            }
+            m_worker.join();
+        }
+    }
+
+    //! see AsyncQueueSC::on_async_queue_worker_thread_start
+    virtual void on_async_queue_worker_thread_start() {}
+
+    //! see AsyncQueueSC::on_sync_all_task_finish
+    virtual void on_sync_all_task_finish() {}
+
+private:
+    size_t m_mask;
+    const size_t m_max_spin;
+    std::unique_ptr<Cell[]> m_cells;
+
+    //! written by producers; padded from the consumer side fields
+    char m_pad0[64];
+    std::atomic_size_t m_enqueue_pos{0};
+    std::atomic_bool m_latency_stat_enabled{false};
+    char m_pad1[64];
+
+    //! only accessed by the worker
+    size_t m_dequeue_pos = 0;
+    std::atomic_size_t m_finished_task{0};
+    std::atomic_bool m_consumer_sleeping{false};
+    std::atomic_size_t m_stat_nr_task{0}, m_stat_tot_ns{0}, m_stat_max_ns{0};
+    char m_pad2[64];
+
+    //! min target of the callers of wait_all_task_finish()
+    std::atomic_size_t m_waiter_target{std::numeric_limits<size_t>::max()};
+    std::atomic_bool m_should_exit{false}, m_worker_started{false};
+    std::atomic<std::thread::id> m_worker_tid{};
+    //! tasks added by the worker on a full ring, ordered by position; only
+    //! accessed by the worker
+    std::deque<OverflowTask> m_overflow;
+    std::mutex m_mtx_more_task, m_mtx_finished, m_mtx_start;
+    std::condition_variable m_cv_more_task, m_cv_finished;
+    std::thread m_worker;
+#if MGB_ENABLE_EXCEPTION
+    std::exception_ptr m_worker_exc;  //!< exception caught in worker
+#endif
+
+    static int64_t now_ns() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                       std::chrono::steady_clock::now().time_since_epoch())
+                .count();
+    }
+
+    template <typename P>
+    void add_task_impl(P&& param) {
+        if (mgb_unlikely(!m_worker_started.load(std::memory_order_acquire))) {
+            start_worker();
+        }
+        size_t pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        Cell* cell;
+        for (;;) {
+            cell = &m_cells[pos & m_mask];
+            auto seq = cell->seq.load(std::memory_order_acquire);
+            auto diff = static_cast<ptrdiff_t>(seq) - static_cast<ptrdiff_t>(pos);
+            if (!diff) {
+                if (m_enqueue_pos.compare_exchange_weak(
+                            pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                // the ring is full
+                if (std::this_thread::get_id() ==
+                    m_worker_tid.load(std::memory_order_relaxed)) {
+                    // no slot would be released while the worker waits; take
+                    // the position and move the task into the ring when the
+                    // consumer reaches it
+                    if (m_enqueue_pos.compare_exchange_weak(
+                                pos, pos + 1, std::memory_order_relaxed)) {
+                        m_overflow.push_back(
+                                {pos,
+                                 m_latency_stat_enabled.load(
+                                         std::memory_order_relaxed)
+                                         ? now_ns()
+                                         : 0,
+                                 Param(std::forward<P>(param))});
+                        return;
+                    }
+                    continue;
+                }
+                std::this_thread::yield();
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            } else {
+                pos = m_enqueue_pos.load(std::memory_order_relaxed);
+            }
+        }
+        new (cell->get()) Param(std::forward<P>(param));
+        cell->add_time_ns =
+                m_latency_stat_enabled.load(std::memory_order_relaxed) ? now_ns() : 0;
+        cell->seq.store(pos + 1, std::memory_order_release);
+
+        // pair with the fence in consumer_wait()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (m_consumer_sleeping.load(std::memory_order_relaxed) &&
+            m_consumer_sleeping.exchange(false, std::memory_order_relaxed)) {
+            MGB_LOCK_GUARD(m_mtx_more_task);
+            m_cv_more_task.notify_one();
+        }
+    }
+
+    MGB_NOINLINE void start_worker() {
+        MGB_LOCK_GUARD(m_mtx_start);
+        if (!m_worker_started.load(std::memory_order_relaxed)) {
+#ifdef WIN32
+            if (!SCQueueSynchronizer::is_into_atexit) {
+                auto cb_atexit = [] { SCQueueSynchronizer::is_into_atexit = true; };
+                auto err = atexit(cb_atexit);
+                mgb_assert(!err, "failed to register windows_call_atexit at exit");
+            }
+#endif
+            m_worker = std::thread{&AsyncRingQueueSC::worker_thread_impl, this};
+            m_worker_started.store(true, std::memory_order_release);
+        }
+    }
+
+    bool cell_ready(size_t pos) const {
+        return m_cells[pos & m_mask].seq.load(std::memory_order_acquire) == pos + 1;
+    }
+
+    //! wait until the task at \p pos is published; return false if the
+    //! worker should exit
+    bool consumer_wait(size_t pos) {
+        for (size_t spin = 0; spin < m_max_spin; ++spin) {
+            if (cell_ready(pos))
+                return true;
+            // let a producer blocked on a full ring run if they share a core
+            if ((spin & (SPIN_YIELD_INTERVAL - 1)) == SPIN_YIELD_INTERVAL - 1)
+                std::this_thread::yield();
+        }
+        std::unique_lock<std::mutex> lk(m_mtx_more_task);
+        for (;;) {
+            m_consumer_sleeping.store(true, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (cell_ready(pos)) {
+                m_consumer_sleeping.store(false, std::memory_order_relaxed);
+                return true;
+            }
+            if (m_should_exit.load(std::memory_order_relaxed))
+                return false;
+            m_cv_more_task.wait(lk);
+        }
+    }
+
+    void consumer_commit(Cell& cell) {
+        auto pos = m_dequeue_pos++;
+        cell.get()->~Param();
+        cell.seq.store(pos + m_mask + 1, std::memory_order_release);
+        m_finished_task.store(pos + 1, std::memory_order_release);
+        // pair with the fence in wait_all_task_finish()
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (pos + 1 >= m_waiter_target.load(std::memory_order_relaxed)) {
+            MGB_LOCK_GUARD(m_mtx_finished);
+            m_waiter_target.store(
+                    std::numeric_limits<size_t>::max(), std::memory_order_relaxed);
+            m_cv_finished.notify_all();
+        }
+    }
+
+    void update_latency_stat(const Cell& cell) {
+        size_t latency = std::max<int64_t>(now_ns() - cell.add_time_ns, 0);
+        m_stat_nr_task.store(
+                m_stat_nr_task.load(std::memory_order_relaxed) + 1,
+                std::memory_order_relaxed);
+        m_stat_tot_ns.store(
+                m_stat_tot_ns.load(std::memory_order_relaxed) + latency,
+                std::memory_order_relaxed);
+        if (latency > m_stat_max_ns.load(std::memory_order_relaxed)) {
+            m_stat_max_ns.store(latency, std::memory_order_relaxed);
+        }
+    }
+
+    void worker_thread_impl() {
+        m_worker_tid.store(std::this_thread::get_id(), std::memory_order_relaxed);
+        on_async_queue_worker_thread_start();
+        for (;;) {
+            Cell* cur = nullptr;
+            MGB_TRY {
+                worker_thread_impl_no_exc(&cur);
+                return;
+            }
+            MGB_CATCH_ALL_EXCEPTION("AsyncRingQueueSC", m_worker_exc);
+            if (cur) {
+                consumer_commit(*cur);
+            }
+        }
+    }
+
+    //! publish the overflow task at \p pos to its slot, which has been
+    //! released since all the previous tasks are finished
+    void publish_overflow(size_t pos) {
+        auto&& task = m_overflow.front();
+        Cell& cell = m_cells[pos & m_mask];
+        new (cell.get()) Param(std::move(task.param));
+        cell.add_time_ns = task.add_time_ns;
+        cell.seq.store(pos + 1, std::memory_order_relaxed);
+        m_overflow.pop_front();
+    }
+
+    void worker_thread_impl_no_exc(Cell** cur) {
+        for (;;) {
+            auto pos = m_dequeue_pos;
+            if (!m_overflow.empty() && m_overflow.front().pos == pos) {
+                publish_overflow(pos);
+            }
+            if (!consumer_wait(pos))
+                return;
+            Cell& cell = m_cells[pos & m_mask];
+            if (cell.add_time_ns) {
+                update_latency_stat(cell);
+            }
+            *cur = &cell;
+            static_cast<TaskImpl*>(this)->process_one_task(*cell.get());
+            *cur = nullptr;
+            consumer_commit(cell);
+        }
+    }
+};
+
 //! a thread would block until all threads reach this barrier
 class Barrier {
     bool m_need_clear = false;
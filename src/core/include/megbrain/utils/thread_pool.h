@@ -2,9 +2,13 @@
 #include "megbrain/common.h"
 #include "megbrain/comp_node.h"
 #include "megbrain/system.h"
+#include "megbrain/utils/small_vector.h"
+#include "megbrain/utils/thread.h"
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
+#include <deque>
 #include <functional>
 #include <mutex>
 #include <queue>
@@ -26,31 +30,78 @@ struct TaskElem {
 };
 
 #if MGB_HAVE_THREAD
+/**
+ * \brief a contiguous range of sub task indices of one TaskElem
+ */
+struct TaskChunk {
+    //! the job this chunk belongs to, see ThreadPool::Job
+    void* job;
+    //! the first sub task index of this chunk
+    size_t begin;
+    //! past-the-end sub task index of this chunk
+    size_t end;
+};
+
 /**
  * \brief Worker and related flag
  */
 struct Worker {
 public:
     Worker(thin_function<void()>&& run) : thread{run} {}
-    ~Worker() { thread.join(); }
+    ~Worker() {
+        if (thread.joinable()) {
+            thread.join();
+        }
+    }
     //! Worker thread
     std::thread thread;
-    //! Indicate whether the Worker thread need run
+    //! Indicate whether the Worker thread is executing a chunk
     std::atomic_bool work_flag{false};
     //! Indicate whether the Worker thread have binding core
     bool affinity_flag{false};
+    //! chunks owned by this worker; the owner pops from the back and
+    //! other threads steal from the front
+    std::deque<TaskChunk> chunks;
+    //! protect chunks
+    Spinlock chunks_lock;
+    //! number of chunks in the deque, used to probe without locking
+    std::atomic_size_t nr_chunks{0};
+    //! total time in nanoseconds spent on spinning for new tasks
+    std::atomic_size_t spin_ns{0};
+    //! total time in nanoseconds spent on parking
+    std::atomic_size_t park_ns{0};
+    //! number of times the worker parked
+    std::atomic_size_t nr_park{0};
 };
 
 /**
  * \brief ThreadPool execute the task in multi-threads(nr_threads>1) mode , it
  * will fallback to single-thread mode if nr_thread is 1.
+ *
+ * Every add_task() splits its sub tasks into chunks whose grain size adapts
+ * to the parallelism and the number of threads, then distributes the chunks
+ * into per-worker deques. Idle workers steal chunks from other workers, so
+ * several threads can call add_task() concurrently and the tasks share the
+ * workers. The submitting thread only executes chunks of its own task (with
+ * thread id nr_threads - 1), which keeps the thread id passed to the task
+ * unique among the threads running that task.
+ *
+ * add_task() called from inside a running task of the same pool (nested
+ * parallelism) executes the nested task inline on the calling thread, with
+ * the thread id of the caller, so that the per-thread workspace indexed by the
+ * thread id is not shared with other threads.
+ *
+ * An idle worker spins (with yield) for at most the spin budget, then parks
+ * on a condition variable until add_task() or active() wakes it up. After
+ * deactive(), the idle workers park immediately, unless add_task() of other
+ * threads is still running.
  */
 class ThreadPool : public NonCopyableObj {
 public:
     //! Create thread-pool nr_threads thread_pool
     ThreadPool(size_t nr_threads);
-    //! The main thread set the task, parallelism and worker flag to
-    //! notify other thread.
+    //! Split the task into chunks and dispatch them to the workers, the
+    //! caller also works on the task and returns after the task finished
     void add_task(const TaskElem& task_elem);
 
     size_t nr_threads() const;
@@ -58,6 +109,7 @@ public:
     //! Set the affinity of all the threads
     void set_affinity(AffinityCallBack affinity_cb);
 
+    //! wait until all the submitted tasks finished
     void sync();
     //! wake up all the threads from cv.wait(), when the thread pool is not
     //! active, all the threads will go to sleep.
@@ -66,22 +118,73 @@ public:
     void deactive();
     ~ThreadPool();
 
+    //! statistics of the waiting of all the workers
+    struct WaitStat {
+        //! total time spent on spinning for new tasks
+        double spin_ms = 0;
+        //! total time spent on parking
+        double park_ms = 0;
+        //! number of times the workers parked
+        size_t nr_park = 0;
+    };
+
+    //! set the max time an idle worker spins before it parks, 0 means park
+    //! immediately and SIZE_MAX means never park while the pool is active
+    void set_spin_budget_us(size_t spin_budget_us);
+    size_t spin_budget_us() const;
+
+    WaitStat get_wait_stat() const;
+
+    //! the default spin budget, which can be set by env
+    //! MGB_THREAD_POOL_SPIN_US
+    static size_t get_default_spin_budget_us();
+
+    //! parse the value of MGB_THREAD_POOL_SPIN_US, the default 5ms budget is
+    //! returned if \p str is null or not a non-negative integer
+    static size_t parse_spin_budget_us(const char* str);
+
+    //! max number of chunks generated for each thread in one task
+    static constexpr size_t CHUNKS_PER_THREAD = 4;
+
 private:
+    struct Job;
+
+    //! main loop of the worker with index \p id
+    void worker_loop(size_t id);
+    //! push chunks of the job into the deques, returns chunks left to the
+    //! submitter
+    void split_job(Job* job, SmallVector<TaskChunk>& local_chunks);
+    //! pop a chunk from the back of deque of worker \p id
+    bool pop_chunk(size_t id, TaskChunk& chunk);
+    //! steal a chunk from the front of other deques; if \p job is not
+    //! null, only chunks of the job are stolen
+    bool steal_chunk(size_t self, const void* job, TaskChunk& chunk);
+    //! run all sub tasks in the chunk and mark them finished
+    static void run_chunk(const TaskChunk& chunk, size_t thread_id);
+    //! park the worker until m_epoch differs from \p epoch
+    void park(Worker* worker, size_t epoch);
+    //! wake up the parked workers after chunks are pushed
+    void wake_workers();
+
     size_t m_nr_threads = 1;
     //! Indicate whether the main thread have binding
     bool m_main_affinity_flag;
     //! The callback binding the threads to cores
     AffinityCallBack m_core_binding_function{nullptr};
-    //! All the sub task number
-    size_t m_nr_parallelism = 0;
     std::atomic_bool m_stop{false};
     std::atomic_bool m_active{false};
-    //! The executable funcition pointer
-    MultiThreadingTask m_task;
 
     std::vector<Worker*> m_workers;
-    //! The task iter, when finished one, the m_all_task_iter sub 1
-    std::atomic_int m_task_iter{0};
+    //! round-robin cursor to spread chunks of concurrent submitters
+    std::atomic_size_t m_next_worker{0};
+    //! number of add_task calls which have not finished
+    std::atomic_size_t m_nr_running_jobs{0};
+    //! increased each time new chunks are pushed, parked workers wait for
+    //! its change
+    std::atomic_size_t m_epoch{0};
+    //! number of parked workers
+    std::atomic_size_t m_nr_parked{0};
+    std::atomic_size_t m_spin_budget_ns{0};
     //! The cv and mutex for threading activity
     std::condition_variable m_cv;
     std::mutex m_mutex;
@@ -101,8 +204,91 @@ public:
     void sync() {}
     ~ThreadPool() {}
     size_t nr_threads() const { return 1_z; }
+
+    struct WaitStat {
+        double spin_ms = 0;
+        double park_ms = 0;
+        size_t nr_park = 0;
+    };
+    void set_spin_budget_us(size_t) {}
+    size_t spin_budget_us() const { return 0; }
+    WaitStat get_wait_stat() const { return {}; }
 };
 
 #endif
+
+/**
+ * \brief opt-in tracing of the chunks run by ThreadPool for multi-thread tasks
+ *
+ * Tasks submitted by a thread are traced while the thread has a non-zero tag,
+ * e.g. the id of the operator whose kernel is being dispatched. Every thread
+ * running a chunk of a traced task appends a Record to its own single-producer
+ * ring buffer without locking, and collect() drains the buffers of all the
+ * threads. Records are dropped while a ring buffer is full.
+ */
+class ThreadPoolTrace {
+public:
+    using Clock = std::chrono::system_clock;
+
+    //! a chunk of sub tasks run by a thread
+    struct Record {
+        //! tag of the submitter when add_task() was called
+        uint64_t tag;
+        //! sequence number of the traced add_task() call
+        uint64_t job;
+        //! number of threads of the pool
+        size_t nr_threads;
+        //! thread id passed to the task, in [0, nr_threads)
+        size_t thread_id;
+        //! system thread running the chunk
+        std::thread::id thread;
+        //! number of sub tasks in the chunk
+        size_t nr_tasks;
+        Clock::time_point begin, end;
+    };
+
+    //! load balance of the traced tasks, accumulated over add_task() calls
+    struct Stat {
+        size_t nr_jobs = 0, nr_chunks = 0, nr_tasks = 0;
+        //! total busy time of the busiest thread of each job
+        double max_busy_ms = 0;
+        //! total average busy time of all the threads of each job
+        double mean_busy_ms = 0;
+        //! total time between the first and the last thread finishing their
+        //! chunks of each job, in which the other threads wait for stragglers
+        double straggler_ms = 0;
+        //! total busy time and number of sub tasks of each thread id
+        std::vector<double> thread_busy_ms;
+        std::vector<size_t> thread_nr_tasks;
+
+        //! max_busy / mean_busy - 1, which is 0 if perfectly balanced
+        double imbalance() const {
+            return mean_busy_ms > 0 ? max_busy_ms / mean_busy_ms - 1 : 0;
+        }
+
+        MGE_WIN_DECLSPEC_FUC Stat& operator+=(const Stat& rhs);
+
+        //! \p records must contain all the chunks of their jobs
+        MGE_WIN_DECLSPEC_FUC static Stat make(const std::vector<Record>& records);
+    };
+
+    //! set the tag of the calling thread, 0 to stop tracing
+    MGE_WIN_DECLSPEC_FUC static void set_tag(uint64_t tag);
+
+    //! tag of the calling thread
+    MGE_WIN_DECLSPEC_FUC static uint64_t tag();
+
+    //! take the records with \p tag appended so far
+    MGE_WIN_DECLSPEC_FUC static std::vector<Record> collect(uint64_t tag);
+
+    //! number of records dropped as the ring buffers are full
+    MGE_WIN_DECLSPEC_FUC static size_t nr_dropped();
+
+private:
+    friend class ThreadPool;
+
+    static uint64_t next_job();
+    static void append(const Record& record);
+};
 }  // namespace mgb
    // vim: syntax=cpp.doxygen
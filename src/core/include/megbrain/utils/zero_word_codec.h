@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace mgb {
+
+/*!
+ * \brief lossless codec which only keeps non-zero 32-bit words
+ *
+ * The content is split into 32-bit words; the encoded data is a bitmap of
+ * non-zero words, followed by the non-zero words themselves and the trailing
+ * bytes which do not fill a word. It is cheap enough to be run on the critical
+ * path and works well on activations after relu, dropout or masking.
+ */
+class ZeroWordCodec {
+public:
+    /*!
+     * \brief encode \p size bytes at \p src into \p dst
+     *
+     * \param limit max encoded size in bytes; encoding is aborted as soon as it
+     *      is exceeded
+     * \return whether the content is encoded within \p limit; \p dst is
+     *      undefined otherwise
+     */
+    static bool encode(
+            const void* src, size_t size, size_t limit, std::vector<uint8_t>& dst);
+
+    /*!
+     * \brief decode \p size bytes of original content from \p src to \p dst
+     */
+    static void decode(const uint8_t* src, size_t size, void* dst);
+};
+
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -500,6 +500,80 @@ TEST(TestSimpleCachingAlloc, Basic) {
     EXPECT_EQ(0u, raw_alloc->nr_free());
 };
 
+TEST(TestSimpleCachingAlloc, SizeClass) {
+    constexpr size_t TOT = 1 << 20;
+    auto raw_alloc = new DummyAllocator(TOT);
+    SizeClassConfig config;
+    config.max_size = 1024;
+    config.max_cached_per_class = 1280;
+    config.nr_shards = 2;
+    auto alloc = SimpleCachingAlloc::make(
+            std::unique_ptr<RawAllocator>(raw_alloc), config);
+
+    // 600 is rounded up to the size class of 640
+    auto ptr0 = alloc->alloc(600);
+    EXPECT_EQ(640u, alloc->get_used_memory());
+    alloc->free(ptr0);
+    EXPECT_EQ(0u, alloc->get_used_memory());
+    auto stat = alloc->get_free_memory();
+    EXPECT_EQ(640u, stat.cached);
+    EXPECT_EQ(0u, stat.tot);
+    EXPECT_EQ(0u, stat.nr_cache_hit);
+    EXPECT_EQ(1u, stat.nr_cache_miss);
+
+    auto ptr1 = alloc->alloc(520);
+    EXPECT_EQ(ptr0, ptr1);
+    EXPECT_EQ(1u, raw_alloc->nr_alloc());
+    EXPECT_EQ(640u, alloc->get_used_memory());
+    stat = alloc->get_free_memory();
+    EXPECT_EQ(0u, stat.cached);
+    EXPECT_EQ(1u, stat.nr_cache_hit);
+    EXPECT_DOUBLE_EQ(0.5, stat.cache_hit_rate());
+
+    // blocks freed beyond the cap of the size class go to the free tree
+    auto ptr2 = alloc->alloc(640), ptr3 = alloc->alloc(640);
+    alloc->free(ptr1);
+    alloc->free(ptr2);
+    alloc->free(ptr3);
+    stat = alloc->get_free_memory();
+    EXPECT_EQ(1280u, stat.cached);
+    EXPECT_EQ(640u, stat.tot);
+    EXPECT_EQ(0u, alloc->get_used_memory());
+
+    // large requests bypass the size classes
+    auto ptr4 = alloc->alloc(2000);
+    EXPECT_EQ(2000u, alloc->get_used_memory());
+    alloc->free(ptr4);
+    stat = alloc->get_free_memory();
+    EXPECT_EQ(2640u, stat.tot);
+    EXPECT_EQ(2000u, stat.max);
+    EXPECT_DOUBLE_EQ(1 - 2000. / 2640, stat.fragmentation());
+
+    // a block freed by another thread returns to the shard of the allocating
+    // thread
+    auto ptr5 = alloc->alloc(100);
+    std::thread{[&]() { alloc->free(ptr5); }}.join();
+    EXPECT_EQ(ptr5, alloc->alloc(100));
+    alloc->free(ptr5);
+}
+
+#if !MGB_BUILD_SLIM_SERVING
+TEST(TestSimpleCachingAlloc, CpuCompNode) {
+    auto cn = CompNode::load("cpu23");
+    cn.enable_size_class_alloc({});
+    void* ptr;
+    {
+        DeviceTensorND dv{cn, {100}, dtype::Float32()};
+        ptr = dv.raw_ptr();
+        EXPECT_GE(cn.get_used_memory(), 400u);
+    }
+    cn.sync();
+    EXPECT_EQ(0u, cn.get_used_memory());
+    DeviceTensorND dv{cn, {110}, dtype::Float32()};
+    EXPECT_EQ(ptr, dv.raw_ptr());
+}
+#endif
+
 namespace {
 class DevicePolicy {
 public:
@@ -5,6 +5,8 @@
 #include "megbrain/opr/dnn/convolution.h"
 #include "megbrain/opr/io.h"
 
+#include "../impl/graph/swap/swap_opr.h"
+
 using namespace mgb;
 
 using Elemwise = opr::Elemwise;
@@ -91,4 +93,83 @@ TEST(TestMemorySwap, FullConvParallel) {
 
 #endif  // MGB_ENABLE_MEMORY_SWAP
 
+#if MGB_ENABLE_HOST_MEMORY_SWAP
+namespace {
+using HostSwapStorage = cg::ComputingGraph::Options::HostSwapConfig::Storage;
+
+void run_host_swap(HostSwapStorage storage) {
+    HostTensorGenerator<> gen_;
+    auto gen = [&](const TensorShape& shp) { return gen_(shp, "cpu0"); };
+    constexpr size_t batch_size = 2, C = 8, H = 32, W = 32;
+    constexpr size_t limit = 60;
+    auto host_data = gen({batch_size, C, H, W});
+    auto graph = ComputingGraph::make();
+
+    SymbolVarArray kernels;
+    SymbolVarArray conv_res;
+    conv_res.push_back(opr::Host2DeviceCopy::make(*graph, host_data).rename("data"));
+    for (size_t i = 0; i < limit; ++i) {
+        gen_.std(sqrt(2.0 / (C * 3 * 3)));
+        auto host_kern = gen({C, C, 3, 3});
+        kernels.emplace_back(opr::SharedDeviceTensor::make(*graph, *host_kern)
+                                     .rename(ssprintf("param%zu", i)));
+        opr::Convolution::Param param;
+        param.pad_h = param.pad_w = 1;
+        conv_res.push_back(
+                opr::relu(opr::Convolution::make(conv_res.back(), kernels[i], param)));
+    }
+
+    auto loss = opr::Dot::make(conv_res[limit].flatten(), conv_res[limit].flatten())
+                        .rename("loss");
+    std::vector<HostTensorND> grad_kernels_get(kernels.size());
+    ComputingGraph::OutputSpec out_spec;
+    for (size_t i = 0; i < kernels.size(); ++i) {
+        out_spec.emplace_back(
+                make_callback_copy(cg::grad(loss, kernels[i]), grad_kernels_get[i]));
+    }
+    std::vector<HostTensorND> grad_kernels_expect(grad_kernels_get.size());
+    auto&& config = graph->options().host_swap_config;
+    config.storage = storage;
+    // each activation is 64KB
+    config.min_var_size = 16 * 1024;
+    config.prefetch_distance = 3;
+    for (bool swap : {false, true}) {
+        graph->options().enable_memory_swap = swap;
+        auto func = graph->compile(out_spec);
+        size_t nr_swap_out = 0, nr_swap_in = 0;
+        func->iter_opr_seq([&](cg::OperatorNodeBase* opr) {
+            nr_swap_out += opr->same_type<swap::opr::HostSwapOut>();
+            nr_swap_in += opr->same_type<swap::opr::HostSwapIn>();
+            return true;
+        });
+        if (swap) {
+            ASSERT_GT(nr_swap_out, 0u);
+            ASSERT_GE(nr_swap_in, nr_swap_out);
+        } else {
+            ASSERT_EQ(0u, nr_swap_out);
+        }
+        // the second execution reuses the slots of the first one
+        for (int i = 0; i < 2; ++i) {
+            func->execute();
+        }
+        if (!swap) {
+            for (size_t i = 0; i < grad_kernels_get.size(); ++i)
+                grad_kernels_expect[i].copy_from(grad_kernels_get[i]);
+        }
+    }
+
+    for (size_t i = 0; i < grad_kernels_get.size(); ++i)
+        MGB_ASSERT_TENSOR_EQ(grad_kernels_get[i], grad_kernels_expect[i]);
+}
+}  // anonymous namespace
+
+TEST(TestMemorySwap, HostSpillFile) {
+    run_host_swap(HostSwapStorage::SPILL_FILE);
+}
+
+TEST(TestMemorySwap, HostCompressed) {
+    run_host_swap(HostSwapStorage::COMPRESSED);
+}
+#endif  // MGB_ENABLE_HOST_MEMORY_SWAP
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -13,7 +13,7 @@ using namespace cg;
         "static_mem_alloc disabled because it causes the program to crash at startup"
 #else
 
-#define ITER_ALGO(cb) cb(INTERVAL_MOVE) cb(BEST_FIT) cb(PUSHDOWN)
+#define ITER_ALGO(cb) cb(INTERVAL_MOVE) cb(BEST_FIT) cb(PUSHDOWN) cb(SEARCH)
 
 namespace {
 
@@ -139,7 +139,8 @@ TEST_P(RandomOpr, Main) {
     auto&& param = this->GetParam();
     std::mt19937_64 rng(param.rng_seed);
 
-    if (param.algo == TestParam::Algo::INTERVAL_MOVE &&
+    if ((param.algo == TestParam::Algo::INTERVAL_MOVE ||
+         param.algo == TestParam::Algo::SEARCH) &&
         param.nr_rand_opr > INTERVAL_MOVE_MAX_SIZE)
         return;
 
@@ -234,6 +235,52 @@ TEST(TestStaticMemAllocAlgo, PushdownConsistence) {
         ASSERT_EQ(NR + NR - 1, allocator->tot_alloc());
     }
 }
+TEST(TestStaticMemAllocAlgo, SearchNotWorseThanPushdown) {
+    std::mt19937_64 rng(next_rand_seed());
+    for (size_t run_nr = 0; run_nr < 20; ++run_nr) {
+        auto search = StaticMemAlloc::make(StaticMemAlloc::AllocatorAlgo::SEARCH),
+             pushdown = StaticMemAlloc::make(StaticMemAlloc::AllocatorAlgo::PUSHDOWN);
+        search->time_budget(0.01);
+        constexpr size_t NR = 100;
+        for (auto allocator : {search.get(), pushdown.get()}) {
+            allocator->alignment(4);
+        }
+        for (size_t i = 0; i < NR; ++i) {
+            size_t begin = rng() % NR, end = begin + 1 + rng() % 10,
+                   size = 1 + rng() % 64;
+            search->add(begin, end, size, makeuk(i));
+            pushdown->add(begin, end, size, makeuk(i));
+        }
+        search->solve();
+        pushdown->solve();
+        ASSERT_LE(search->tot_alloc(), pushdown->tot_alloc());
+        ASSERT_EQ(pushdown->tot_alloc_lower_bound(), search->tot_alloc_lower_bound());
+    }
+}
+
+TEST(TestStaticMemAllocAlgo, SearchCachedPlan) {
+    auto run = [](double time_budget) {
+        auto allocator = StaticMemAlloc::make(StaticMemAlloc::AllocatorAlgo::SEARCH);
+        allocator->time_budget(time_budget);
+        constexpr size_t NR = 50;
+        for (size_t i = 0; i < NR; ++i) {
+            allocator->add(i, i + 1 + i % 7, 1 + (i * 37) % 29, makeuk(i));
+        }
+        auto id0 = allocator->add(NR, NR + 3, 20, makeuk(NR)),
+             id1 = allocator->add(NR + 2, NR + 5, 8, makeuk(NR + 1));
+        allocator->add_overwrite_spec(id1, id0, 4);
+        allocator->solve();
+        std::vector<size_t> addr;
+        for (size_t i = 0; i < NR + 2; ++i) {
+            addr.push_back(allocator->get_start_addr(makeuk(i)));
+        }
+        EXPECT_EQ(addr[NR] + 4, addr[NR + 1]);
+        return std::make_pair(allocator->tot_alloc(), addr);
+    };
+    // the second run uses the plan found by the first one
+    auto plan0 = run(0.05), plan1 = run(0);
+    ASSERT_EQ(plan0, plan1);
+}
 #endif  // WIN32
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
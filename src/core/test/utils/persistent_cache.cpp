@@ -0,0 +1,163 @@
+#include "megbrain/utils/mmap_persistent_cache.h"
+#include "megbrain/test/helper.h"
+
+#include <cstdio>
+#include <thread>
+
+#ifndef WIN32
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+using namespace mgb;
+
+namespace {
+using Blob = PersistentCache::Blob;
+
+Blob make_blob(const std::string& str) {
+    return {str.data(), str.size()};
+}
+
+std::string get_str(
+        PersistentCache& cache, const std::string& category, const std::string& key) {
+    auto ret = cache.get(category, make_blob(key));
+    if (!ret.valid()) {
+        return "<none>";
+    }
+    return {static_cast<const char*>(ret->ptr), ret->size};
+}
+
+std::string make_path(const char* name) {
+    auto path = output_file(ssprintf("MmapPersistentCache.%s", name));
+    remove(path.c_str());
+    return path;
+}
+}  // anonymous namespace
+
+TEST(TestPersistentCache, HostSignature) {
+    InMemoryPersistentCache impl;
+    PersistentCache& cache = impl;
+    ASSERT_TRUE(cache.check_host_signature());
+    cache.put_host_signature();
+    ASSERT_TRUE(cache.check_host_signature());
+    cache.put("host_signature", make_blob("host"), make_blob("mge=0.0.0"));
+    ASSERT_FALSE(cache.check_host_signature());
+}
+
+#ifndef WIN32
+
+TEST(TestMmapPersistentCache, Basic) {
+    auto path = make_path("Basic");
+    {
+        MmapPersistentCache cache{path.c_str()};
+        ASSERT_TRUE(cache.mapped());
+        ASSERT_EQ(0u, cache.nr_mapped_entry());
+        cache.put("c0", make_blob("k0"), make_blob("v0"));
+        cache.put("c0", make_blob("k1"), make_blob("v1"));
+        cache.put("c1", make_blob("k0"), make_blob(""));
+        ASSERT_EQ("v0", get_str(cache, "c0", "k0"));
+        ASSERT_EQ("v1", get_str(cache, "c0", "k1"));
+        ASSERT_EQ("", get_str(cache, "c1", "k0"));
+        ASSERT_EQ("<none>", get_str(cache, "c1", "k1"));
+        ASSERT_EQ("<none>", get_str(cache, "c2", "k0"));
+
+        // a new value replaces the old one
+        cache.put("c0", make_blob("k0"), make_blob("new_v0"));
+        ASSERT_EQ("new_v0", get_str(cache, "c0", "k0"));
+        ASSERT_EQ(3u, cache.nr_mapped_entry());
+    }
+
+    // entries are persisted without dumping
+    MmapPersistentCache cache{path.c_str()};
+    ASSERT_EQ(3u, cache.nr_mapped_entry());
+    ASSERT_EQ("new_v0", get_str(cache, "c0", "k0"));
+    ASSERT_EQ("v1", get_str(cache, "c0", "k1"));
+    ASSERT_EQ("", get_str(cache, "c1", "k0"));
+}
+
+TEST(TestMmapPersistentCache, Shared) {
+    auto path = make_path("Shared");
+    MmapPersistentCache cache0{path.c_str()}, cache1{path.c_str()};
+    cache0.put("c", make_blob("k0"), make_blob("v0"));
+    ASSERT_EQ("v0", get_str(cache1, "c", "k0"));
+    cache1.put("c", make_blob("k0"), make_blob("v1"));
+    ASSERT_EQ("v1", get_str(cache0, "c", "k0"));
+}
+
+TEST(TestMmapPersistentCache, ConcurrentPut) {
+    auto path = make_path("ConcurrentPut");
+    constexpr size_t NR_THREAD = 4, NR_ENTRY = 1000;
+    // few buckets to make collisions frequent
+    MmapPersistentCache reader{path.c_str(), 4 * 1024 * 1024, 8192};
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < NR_THREAD; ++i) {
+        workers.emplace_back([&path, i]() {
+            MmapPersistentCache cache{path.c_str()};
+            for (size_t j = 0; j < NR_ENTRY; ++j) {
+                auto key = ssprintf("k%zu_%zu", i, j), val = ssprintf("v%zu", j);
+                cache.put("c", make_blob(key), make_blob(val));
+            }
+        });
+    }
+    for (auto&& i : workers) {
+        i.join();
+    }
+    ASSERT_EQ(NR_THREAD * NR_ENTRY, reader.nr_mapped_entry());
+    for (size_t i = 0; i < NR_THREAD; ++i) {
+        for (size_t j = 0; j < NR_ENTRY; ++j) {
+            auto key = ssprintf("k%zu_%zu", i, j);
+            ASSERT_EQ(ssprintf("v%zu", j), get_str(reader, "c", key));
+        }
+    }
+}
+
+TEST(TestMmapPersistentCache, Full) {
+    auto path = make_path("Full");
+    MmapPersistentCache cache{path.c_str(), 0, 4};
+    ASSERT_TRUE(cache.mapped());
+    for (int i = 0; i < 10; ++i) {
+        cache.put("c", make_blob(std::to_string(i)), make_blob(ssprintf("v%d", i)));
+    }
+    ASSERT_EQ(0u, cache.nr_mapped_entry());
+    for (int i = 0; i < 10; ++i) {
+        ASSERT_EQ(ssprintf("v%d", i), get_str(cache, "c", std::to_string(i)));
+    }
+}
+
+TEST(TestMmapPersistentCache, UnusablePath) {
+    // a directory can not be opened for write, and files can not be created
+    // under a missing directory
+    auto dir = make_path("UnusablePath");
+    ASSERT_EQ(0, mkdir(dir.c_str(), 0755));
+    for (auto&& path : {dir, dir + "/missing/cache"}) {
+        MmapPersistentCache cache{path.c_str()};
+        ASSERT_FALSE(cache.mapped());
+        cache.put("c", make_blob("k"), make_blob("v"));
+        ASSERT_EQ("v", get_str(cache, "c", "k"));
+    }
+    rmdir(dir.c_str());
+}
+
+TEST(TestMmapPersistentCache, OutdatedFile) {
+    auto path = make_path("OutdatedFile");
+    {
+        MmapPersistentCache cache{path.c_str()};
+        cache.put("c", make_blob("k"), make_blob("v"));
+    }
+    // overwrite the signature, which follows the fixed-size fields
+    {
+        auto fp = fopen(path.c_str(), "r+b");
+        ASSERT_TRUE(fp);
+        fseek(fp, 48, SEEK_SET);
+        fputs("mge=0.0.0", fp);
+        fclose(fp);
+    }
+    MmapPersistentCache cache{path.c_str()};
+    ASSERT_TRUE(cache.mapped());
+    ASSERT_EQ(0u, cache.nr_mapped_entry());
+    ASSERT_EQ("<none>", get_str(cache, "c", "k"));
+}
+
+#endif  // WIN32
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
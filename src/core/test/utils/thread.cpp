@@ -400,6 +400,204 @@ TEST(TestAsyncQueue, Benchmark) {
     ASSERT_EQ(N * 5, nr_call);
 }
 
+namespace {
+class RingAdder final : public AsyncRingQueueSC<int, RingAdder> {
+    int m_sum = 0;
+    std::mt19937 m_rng;
+
+public:
+    using AsyncRingQueueSC::AsyncRingQueueSC;
+
+    std::atomic_bool add_task_in_worker{false};
+    std::atomic_size_t nr_task_added_in_worker{0};
+
+    void process_one_task(int val) {
+        if (add_task_in_worker && (m_rng() & 2)) {
+            ++nr_task_added_in_worker;
+            add_task(val);
+        } else {
+            m_sum += val;
+        }
+    }
+
+    int sum() const { return m_sum; }
+};
+
+//! negative tasks add -val tasks from the worker
+class RingRecorder final : public AsyncRingQueueSC<int, RingRecorder> {
+    bool m_in_task = false;
+
+public:
+    using AsyncRingQueueSC::AsyncRingQueueSC;
+
+    std::vector<int> processed;
+    bool nested = false;
+
+    void process_one_task(int val) {
+        nested |= m_in_task;
+        m_in_task = true;
+        processed.push_back(val);
+        for (int i = 0; i < -val; ++i) {
+            add_task(i);
+        }
+        m_in_task = false;
+    }
+};
+
+#if MGB_ENABLE_EXCEPTION
+class RingExcMaker final : public AsyncRingQueueSC<int, RingExcMaker> {
+public:
+    void process_one_task(int) { throw std::runtime_error("test"); }
+};
+#endif
+}  // namespace
+
+TEST(TestAsyncRingQueue, MultiProducer) {
+    // a small ring to make the producers wait for free slots
+    for (ptrdiff_t max_spin : {0, 1000}) {
+        RingAdder adder{8, max_spin};
+        ASSERT_EQ(8u, adder.capacity());
+        constexpr int N = 10000, M = 4;
+        std::atomic_int nr_started{0};
+        auto producer = [&](int id) {
+            ++nr_started;
+            while (nr_started != M)
+                ;
+            for (int i = 0; i < N; ++i) {
+                adder.add_task(id % 2 ? i : -i);
+                if (i % 1000 == 0) {
+                    adder.wait_all_task_finish();
+                }
+            }
+            adder.add_task(id);
+        };
+        std::vector<std::thread> threads;
+        for (int i = 0; i < M; ++i) {
+            threads.emplace_back(producer, i);
+        }
+        for (auto&& i : threads) {
+            i.join();
+        }
+        adder.wait_all_task_finish();
+        ASSERT_TRUE(adder.all_task_finished());
+        ASSERT_EQ(M * (M - 1) / 2, adder.sum());
+    }
+}
+
+TEST(TestAsyncRingQueue, AddInWorker) {
+    RingAdder adder{4};
+    adder.add_task_in_worker = true;
+    for (int i = 0; i < 10000; ++i) {
+        adder.add_task(i % 2 ? i : -i - 1);
+    }
+    while (adder.nr_task_added_in_worker < 100)
+        ;
+    adder.add_task_in_worker = false;
+    adder.add_task(1);
+    adder.wait_all_task_finish();
+    ASSERT_EQ(1, adder.sum());
+}
+
+TEST(TestAsyncRingQueue, AddInWorkerOrder) {
+    // the worker fills the ring by itself
+    RingRecorder recorder{4};
+    constexpr int N = 100;
+    recorder.add_task(-N);
+    recorder.add_task(N);
+    recorder.wait_all_task_finish();
+    recorder.add_task(N + 1);
+    recorder.wait_all_task_finish();
+    ASSERT_TRUE(recorder.all_task_finished());
+    ASSERT_FALSE(recorder.nested);
+
+    auto&& processed = recorder.processed;
+    ASSERT_EQ(N + 3u, processed.size());
+    ASSERT_EQ(-N, processed[0]);
+    ASSERT_EQ(N + 1, processed.back());
+    // the task added by the main thread may be interleaved, but the tasks
+    // added by the worker must keep their order
+    std::vector<int> from_worker;
+    for (size_t i = 1; i < processed.size() - 1; ++i) {
+        if (processed[i] != N) {
+            from_worker.push_back(processed[i]);
+        }
+    }
+    ASSERT_EQ(size_t(N), from_worker.size());
+    for (int i = 0; i < N; ++i) {
+        ASSERT_EQ(i, from_worker[i]);
+    }
+}
+
+TEST(TestAsyncRingQueue, LatencyStat) {
+    RingAdder adder;
+    adder.add_task(1);
+    adder.wait_all_task_finish();
+    ASSERT_EQ(0u, adder.get_latency_stat().nr_task);
+
+    adder.enable_latency_stat(true);
+    for (int i = 0; i < 100; ++i) {
+        adder.add_task(1);
+    }
+    adder.wait_all_task_finish();
+    auto stat = adder.get_latency_stat();
+    ASSERT_EQ(100u, stat.nr_task);
+    ASSERT_GE(stat.tot_us, stat.max_us);
+    ASSERT_EQ(101, adder.sum());
+
+    adder.reset_latency_stat();
+    ASSERT_EQ(0u, adder.get_latency_stat().nr_task);
+}
+
+#if MGB_ENABLE_EXCEPTION
+TEST(TestAsyncRingQueue, Exception) {
+    RingExcMaker exc_maker;
+    exc_maker.wait_all_task_finish();
+    exc_maker.add_task(0);
+    ASSERT_THROW(exc_maker.wait_all_task_finish(), std::runtime_error);
+    exc_maker.wait_all_task_finish();
+}
+#endif
+
+TEST(TestAsyncRingQueue, Benchmark) {
+    class Executor final : public AsyncRingQueueSC<thin_function<void()>, Executor> {
+    public:
+        void process_one_task(const thin_function<void()>& task) { task(); }
+    };
+    std::atomic_int nr_call{0};
+    auto run = [&](auto& queue, int nr_producer) {
+        constexpr int N = 100000;
+        auto producer = [&]() {
+            for (int i = 0; i < N; ++i) {
+                queue.add_task([&nr_call]() {
+                    nr_call.store(
+                            nr_call.load(std::memory_order_relaxed) + 1,
+                            std::memory_order_relaxed);
+                });
+            }
+        };
+        RealTimer timer;
+        std::vector<std::thread> threads;
+        for (int i = 0; i < nr_producer; ++i) {
+            threads.emplace_back(producer);
+        }
+        for (auto&& i : threads) {
+            i.join();
+        }
+        queue.wait_all_task_finish();
+        return timer.get_secs() * 1e9 / (N * nr_producer);
+    };
+    for (int nr_producer : {1, 4}) {
+        FuncExecutor sc_queue;
+        Executor ring_queue;
+        auto t_sc = run(sc_queue, nr_producer);
+        auto t_ring = run(ring_queue, nr_producer);
+        printf("time_per_task with %d producers: AsyncQueueSC=%.3f "
+               "AsyncRingQueueSC=%.3f [ns]\n",
+               nr_producer, t_sc, t_ring);
+    }
+    ASSERT_EQ(100000 * 10, nr_call.load());
+}
+
 TEST(TestThread, Spinlock) {
     Spinlock lock;
     int cnt = 0;
@@ -1,6 +1,7 @@
 #include "megbrain/utils/thread_pool.h"
 #include <atomic>
 #include <random>
+#include <set>
 #include "megbrain/comp_node.h"
 #include "megbrain/opr/io.h"
 #include "megbrain/opr/utility.h"
@@ -52,6 +53,192 @@ TEST(TestThreadPool, BASIC) {
     }
 }
 
+TEST(TestThreadPool, ConcurrentSubmitters) {
+    constexpr size_t NR_THREADS = 4, NR_SUBMITTER = 3, NR_RUN = 20;
+    ThreadPool thread_pool{NR_THREADS};
+    auto submit = [&]() {
+        for (size_t run = 0; run < NR_RUN; ++run) {
+            for (size_t total_task : {2, 7, 50, 333}) {
+                std::vector<std::atomic_size_t> hit(total_task);
+                for (auto&& i : hit) {
+                    i = 0;
+                }
+                std::atomic_bool thread_id_ok{true};
+                auto func = [&](size_t index, size_t thread_id) {
+                    if (thread_id >= NR_THREADS) {
+                        thread_id_ok = false;
+                    }
+                    hit[index]++;
+                };
+                thread_pool.add_task({func, total_task});
+                ASSERT_TRUE(thread_id_ok);
+                for (auto&& i : hit) {
+                    ASSERT_EQ(i, 1u);
+                }
+            }
+        }
+    };
+    std::vector<std::thread> submitters;
+    for (size_t i = 0; i < NR_SUBMITTER; ++i) {
+        submitters.emplace_back(submit);
+    }
+    for (auto&& i : submitters) {
+        i.join();
+    }
+    thread_pool.deactive();
+}
+
+TEST(TestThreadPool, Nested) {
+    ThreadPool thread_pool{4u};
+    size_t outer_task = 10, inner_task = 20;
+    std::atomic_size_t count{0};
+    auto inner = [&](size_t, size_t) { count++; };
+    auto outer = [&](size_t, size_t) { thread_pool.add_task({inner, inner_task}); };
+    thread_pool.active();
+    thread_pool.add_task({outer, outer_task});
+    thread_pool.deactive();
+    ASSERT_EQ(count, outer_task * inner_task);
+}
+
+TEST(TestThreadPool, NestedWorkspace) {
+    constexpr size_t NR_THREADS = 4, OUTER_TASK = 16, INNER_TASK = 8;
+    ThreadPool thread_pool{NR_THREADS};
+    //! per-thread workspace indexed by the thread id, as megdnn kernels do
+    std::vector<size_t> workspace(NR_THREADS);
+    std::vector<std::atomic_bool> busy(NR_THREADS);
+    for (auto&& i : busy) {
+        i = false;
+    }
+    std::atomic_bool ok{true};
+    std::atomic_size_t count{0};
+    auto outer = [&](size_t, size_t outer_id) {
+        auto inner = [&, outer_id](size_t index, size_t thread_id) {
+            if (thread_id != outer_id || busy[thread_id].exchange(true)) {
+                ok = false;
+                return;
+            }
+            workspace[thread_id] = index;
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            if (workspace[thread_id] != index) {
+                ok = false;
+            }
+            busy[thread_id] = false;
+            count++;
+        };
+        thread_pool.add_task({inner, INNER_TASK});
+    };
+    thread_pool.active();
+    thread_pool.add_task({outer, OUTER_TASK});
+    thread_pool.deactive();
+    ASSERT_TRUE(ok);
+    ASSERT_EQ(OUTER_TASK * INNER_TASK, count);
+}
+
+TEST(TestThreadPool, Trace) {
+    constexpr size_t NR_THREADS = 4, NR_SUBMITTER = 2, NR_RUN = 10, NR_TASK = 50;
+    ThreadPool thread_pool{NR_THREADS};
+    auto submit = [&](uint64_t tag) {
+        ThreadPoolTrace::set_tag(tag);
+        // the task with index 0 is a straggler
+        auto func = [](size_t index, size_t) {
+            std::this_thread::sleep_for(std::chrono::microseconds(index ? 10 : 2000));
+        };
+        for (size_t run = 0; run < NR_RUN; ++run) {
+            thread_pool.add_task({func, NR_TASK});
+        }
+        ThreadPoolTrace::set_tag(0);
+        // untagged tasks are not traced
+        thread_pool.add_task({func, NR_TASK});
+    };
+    std::vector<std::thread> submitters;
+    for (size_t i = 0; i < NR_SUBMITTER; ++i) {
+        submitters.emplace_back(submit, i + 1);
+    }
+    for (auto&& i : submitters) {
+        i.join();
+    }
+    thread_pool.deactive();
+
+    for (uint64_t tag = 1; tag <= NR_SUBMITTER; ++tag) {
+        auto records = ThreadPoolTrace::collect(tag);
+        std::set<uint64_t> jobs;
+        for (auto&& i : records) {
+            ASSERT_EQ(tag, i.tag);
+            ASSERT_EQ(NR_THREADS, i.nr_threads);
+            ASSERT_LT(i.thread_id, NR_THREADS);
+            ASSERT_LE(i.begin, i.end);
+            jobs.insert(i.job);
+        }
+        ASSERT_EQ(NR_RUN, jobs.size());
+        auto stat = ThreadPoolTrace::Stat::make(records);
+        ASSERT_EQ(NR_RUN, stat.nr_jobs);
+        ASSERT_EQ(NR_RUN * NR_TASK, stat.nr_tasks);
+        ASSERT_GT(stat.imbalance(), 0);
+        ASSERT_GT(stat.straggler_ms, 0);
+        ASSERT_EQ(NR_THREADS, stat.thread_nr_tasks.size());
+        size_t nr_tasks = 0;
+        for (auto i : stat.thread_nr_tasks) {
+            nr_tasks += i;
+        }
+        ASSERT_EQ(stat.nr_tasks, nr_tasks);
+        auto sum = stat;
+        sum += stat;
+        ASSERT_EQ(stat.nr_jobs * 2, sum.nr_jobs);
+        ASSERT_DOUBLE_EQ(stat.imbalance(), sum.imbalance());
+        ASSERT_TRUE(ThreadPoolTrace::collect(tag).empty());
+    }
+    ASSERT_TRUE(ThreadPoolTrace::collect(0).empty());
+}
+
+TEST(TestThreadPool, SpinAndPark) {
+    ThreadPool thread_pool{4u};
+    ASSERT_EQ(ThreadPool::get_default_spin_budget_us(), thread_pool.spin_budget_us());
+    //! idle workers park almost immediately
+    thread_pool.set_spin_budget_us(1);
+    ASSERT_EQ(1u, thread_pool.spin_budget_us());
+
+    constexpr size_t NR_WORKERS = 3, TOTAL_TASK = 64;
+    std::atomic_size_t count{0};
+    auto func = [&](size_t, size_t) {
+        std::this_thread::sleep_for(std::chrono::microseconds(100));
+        count++;
+    };
+    auto wait_stat = [&](size_t min_nr_park) {
+        auto stat = thread_pool.get_wait_stat();
+        for (int i = 0; i < 10000 && stat.nr_park < min_nr_park; ++i) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+            stat = thread_pool.get_wait_stat();
+        }
+        return stat;
+    };
+
+    thread_pool.active();
+    thread_pool.add_task({func, TOTAL_TASK});
+    ASSERT_EQ(TOTAL_TASK, count);
+
+    //! out of work, all the workers park before the next task
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    auto stat0 = thread_pool.get_wait_stat();
+    thread_pool.add_task({func, TOTAL_TASK});
+    ASSERT_EQ(TOTAL_TASK * 2, count);
+    auto stat1 = wait_stat(stat0.nr_park + NR_WORKERS);
+    ASSERT_GE(stat1.nr_park, stat0.nr_park + NR_WORKERS);
+    ASSERT_GT(stat1.park_ms, stat0.park_ms);
+    ASSERT_GE(stat1.spin_ms, stat0.spin_ms);
+    thread_pool.deactive();
+}
+
+TEST(TestThreadPool, SpinBudgetEnv) {
+    ASSERT_EQ(100u, ThreadPool::parse_spin_budget_us("100"));
+    ASSERT_EQ(0u, ThreadPool::parse_spin_budget_us("0"));
+    //! malformed values fall back to the default, as if the env is not set
+    size_t default_us = ThreadPool::parse_spin_budget_us(nullptr);
+    ASSERT_EQ(5000u, default_us);
+    for (auto str : {"", "abc", "12us", "1 ", "-1", "99999999999999999999999"}) {
+        ASSERT_EQ(default_us, ThreadPool::parse_spin_budget_us(str)) << str;
+    }
+}
+
 TEST(TestGraph, ParallelRunMultithreadMode) {
     // check race conditions when graphs are executed on multple threads
     std::atomic_size_t sync_counter{0};
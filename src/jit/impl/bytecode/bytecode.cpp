@@ -0,0 +1,230 @@
+#include "./bytecode.h"
+
+#if MGB_JIT
+
+#include <algorithm>
+#include <cmath>
+
+using namespace mgb;
+using namespace jit;
+using namespace bytecode;
+
+namespace {
+
+/*!
+ * \brief the scalar semantics of the opcodes, which are consistent with the
+ *      float kernels of megdnn elemwise
+ */
+template <Opcode opcode>
+struct Kern;
+
+#define DEF_KERN(_mode, _sig, _imp)                        \
+    template <>                                            \
+    struct Kern<Opcode::_mode> {                           \
+        static inline float apply(_sig) { return (_imp); } \
+    };
+
+#define SIG1 float x
+#define SIG2 float x, float y
+#define SIG3 float x, float y, float z
+#define SIG4 float x, float y, float z, float w
+
+inline float h_swish(float x) {
+    return x * std::min(std::max(x + 3.f, 0.f), 6.f) * (1.f / 6.f);
+}
+
+inline float sigmoid(float x) {
+    return 1.f / (std::exp(-x) + 1.f);
+}
+
+// unary
+DEF_KERN(RELU, SIG1, x <= 0.f ? 0.f : x)
+DEF_KERN(ABS, SIG1, std::fabs(x))
+DEF_KERN(NEGATE, SIG1, -x)
+DEF_KERN(ACOS, SIG1, std::acos(x))
+DEF_KERN(ASIN, SIG1, std::asin(x))
+DEF_KERN(CEIL, SIG1, std::ceil(x))
+DEF_KERN(COS, SIG1, std::cos(x))
+DEF_KERN(EXP, SIG1, std::exp(x))
+DEF_KERN(EXPM1, SIG1, std::expm1(x))
+DEF_KERN(FLOOR, SIG1, std::floor(x))
+DEF_KERN(LOG, SIG1, std::log(x))
+DEF_KERN(LOG1P, SIG1, std::log1p(x))
+DEF_KERN(SIGMOID, SIG1, sigmoid(x))
+DEF_KERN(SIN, SIG1, std::sin(x))
+DEF_KERN(TANH, SIG1, std::tanh(x))
+DEF_KERN(ERF, SIG1, std::erf(x))
+DEF_KERN(ERFC, SIG1, std::erfc(x))
+DEF_KERN(H_SWISH, SIG1, h_swish(x))
+
+// binary
+DEF_KERN(ABS_GRAD, SIG2, x > 0.f ? y : -y)
+DEF_KERN(ADD, SIG2, x + y)
+DEF_KERN(FLOOR_DIV, SIG2, std::floor(x / y))
+DEF_KERN(MAX, SIG2, x > y ? x : y)
+DEF_KERN(MIN, SIG2, x < y ? x : y)
+DEF_KERN(MOD, SIG2, std::fmod(x, y))
+DEF_KERN(MUL, SIG2, x* y)
+DEF_KERN(POW, SIG2, std::pow(x, y))
+DEF_KERN(SIGMOID_GRAD, SIG2, x*(1.f - x) * y)
+DEF_KERN(SUB, SIG2, x - y)
+DEF_KERN(SWITCH_GT0, SIG2, x > 0.f ? y : 0.f)
+DEF_KERN(TANH_GRAD, SIG2, (1.f - x * x) * y)
+DEF_KERN(TRUE_DIV, SIG2, x / y)
+DEF_KERN(
+        LOG_SUM_EXP, SIG2,
+        (x < y ? y : x) + std::log1p(std::exp((x < y ? x : y) - (x < y ? y : x))))
+DEF_KERN(LT, SIG2, x < y ? 1.f : 0.f)
+DEF_KERN(LEQ, SIG2, x <= y ? 1.f : 0.f)
+DEF_KERN(EQ, SIG2, x == y ? 1.f : 0.f)
+DEF_KERN(ATAN2, SIG2, std::atan2(x, y))
+DEF_KERN(
+        H_SWISH_GRAD, SIG2,
+        x < -3.f ? 0.f : (x > 3.f ? y : (2.f * x + 3.f) / 6.f * y))
+DEF_KERN(FUSE_ADD_RELU, SIG2, (x + y) <= 0.f ? 0.f : (x + y))
+DEF_KERN(FUSE_ADD_SIGMOID, SIG2, sigmoid(x + y))
+DEF_KERN(FUSE_ADD_TANH, SIG2, std::tanh(x + y))
+DEF_KERN(FUSE_ADD_H_SWISH, SIG2, h_swish(x + y))
+
+// ternary
+DEF_KERN(COND_LEQ_MOV, SIG3, x <= y ? z : 0.f)
+DEF_KERN(COND_LT_MOV, SIG3, x < y ? z : 0.f)
+DEF_KERN(FUSE_MUL_ADD3, SIG3, x* y + z)
+
+// quaternary
+DEF_KERN(FUSE_MUL_ADD4, SIG4, x* y + z * w)
+
+#undef SIG4
+#undef SIG3
+#undef SIG2
+#undef SIG1
+#undef DEF_KERN
+
+/*
+ * The loops below are plain loops over a tile, which are vectorized by the
+ * compiler. dst may be the same as a src register, so no restrict is used.
+ */
+
+template <Opcode opcode>
+void run_unary(float* dst, const float* x, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = Kern<opcode>::apply(x[i]);
+    }
+}
+
+template <Opcode opcode>
+void run_binary(float* dst, const float* x, const float* y, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = Kern<opcode>::apply(x[i], y[i]);
+    }
+}
+
+template <Opcode opcode>
+void run_ternary(
+        float* dst, const float* x, const float* y, const float* z, size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = Kern<opcode>::apply(x[i], y[i], z[i]);
+    }
+}
+
+template <Opcode opcode>
+void run_quaternary(
+        float* dst, const float* x, const float* y, const float* z, const float* w,
+        size_t size) {
+    for (size_t i = 0; i < size; ++i) {
+        dst[i] = Kern<opcode>::apply(x[i], y[i], z[i], w[i]);
+    }
+}
+
+}  // anonymous namespace
+
+void Program::run(float* const* regs, size_t size) const {
+    for (auto&& inst : insts) {
+        float* dst = regs[inst.dst];
+        auto src = [&](size_t i) -> const float* { return regs[inst.src[i]]; };
+        switch (inst.opcode) {
+#define cb(_mode)                                    \
+    case Opcode::_mode:                              \
+        run_unary<Opcode::_mode>(dst, src(0), size); \
+        break;
+            MGB_JIT_BYTECODE_FOREACH_UNARY(cb)
+#undef cb
+#define cb(_mode)                                             \
+    case Opcode::_mode:                                       \
+        run_binary<Opcode::_mode>(dst, src(0), src(1), size); \
+        break;
+            MGB_JIT_BYTECODE_FOREACH_BINARY(cb)
+#undef cb
+#define cb(_mode)                                                      \
+    case Opcode::_mode:                                                \
+        run_ternary<Opcode::_mode>(dst, src(0), src(1), src(2), size); \
+        break;
+            MGB_JIT_BYTECODE_FOREACH_TERNARY(cb)
+#undef cb
+#define cb(_mode)                                                                 \
+    case Opcode::_mode:                                                           \
+        run_quaternary<Opcode::_mode>(dst, src(0), src(1), src(2), src(3), size); \
+        break;
+            MGB_JIT_BYTECODE_FOREACH_QUATERNARY(cb)
+#undef cb
+            default:
+                mgb_throw(
+                        InternalError, "invalid bytecode opcode %d",
+                        static_cast<int>(inst.opcode));
+        }
+    }
+}
+
+bool Program::is_supported(opr::Elemwise::Mode mode) {
+    switch (mode) {
+#define cb(_mode) case opr::Elemwise::Mode::_mode:
+        MGB_JIT_BYTECODE_FOREACH_UNARY(cb)
+        MGB_JIT_BYTECODE_FOREACH_BINARY(cb)
+        MGB_JIT_BYTECODE_FOREACH_TERNARY(cb)
+        MGB_JIT_BYTECODE_FOREACH_QUATERNARY(cb)
+#undef cb
+        return true;
+        default:
+            return false;
+    }
+}
+
+Opcode Program::to_opcode(opr::Elemwise::Mode mode) {
+    switch (mode) {
+#define cb(_mode)                    \
+    case opr::Elemwise::Mode::_mode: \
+        return Opcode::_mode;
+        MGB_JIT_BYTECODE_FOREACH_UNARY(cb)
+        MGB_JIT_BYTECODE_FOREACH_BINARY(cb)
+        MGB_JIT_BYTECODE_FOREACH_TERNARY(cb)
+        MGB_JIT_BYTECODE_FOREACH_QUATERNARY(cb)
+#undef cb
+        default:
+            mgb_throw(
+                    InternalError, "elemwise mode %d is not supported by bytecode jit",
+                    static_cast<int>(mode));
+    }
+}
+
+size_t Program::nr_src(Opcode opcode) {
+    switch (opcode) {
+#define cb(_mode) case Opcode::_mode:
+        MGB_JIT_BYTECODE_FOREACH_UNARY(cb)
+        return 1;
+        MGB_JIT_BYTECODE_FOREACH_BINARY(cb)
+        return 2;
+        MGB_JIT_BYTECODE_FOREACH_TERNARY(cb)
+        return 3;
+        MGB_JIT_BYTECODE_FOREACH_QUATERNARY(cb)
+        return 4;
+#undef cb
+        default:
+            mgb_throw(
+                    InternalError, "invalid bytecode opcode %d",
+                    static_cast<int>(opcode));
+    }
+}
+
+#endif  // MGB_JIT
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,99 @@
+#pragma once
+
+#include "megbrain_build_config.h"
+#if MGB_JIT
+
+#include "megbrain/opr/basic_arith.h"
+
+#include <vector>
+
+namespace mgb {
+namespace jit {
+namespace bytecode {
+
+// clang-format off
+#define MGB_JIT_BYTECODE_FOREACH_UNARY(cb)                                    \
+    cb(RELU) cb(ABS) cb(NEGATE) cb(ACOS) cb(ASIN) cb(CEIL) cb(COS) cb(EXP)    \
+    cb(EXPM1) cb(FLOOR) cb(LOG) cb(LOG1P) cb(SIGMOID) cb(SIN) cb(TANH)        \
+    cb(ERF) cb(ERFC) cb(H_SWISH)
+
+#define MGB_JIT_BYTECODE_FOREACH_BINARY(cb)                                   \
+    cb(ABS_GRAD) cb(ADD) cb(FLOOR_DIV) cb(MAX) cb(MIN) cb(MOD) cb(MUL)        \
+    cb(POW) cb(SIGMOID_GRAD) cb(SUB) cb(SWITCH_GT0) cb(TANH_GRAD)             \
+    cb(TRUE_DIV) cb(LOG_SUM_EXP) cb(LT) cb(LEQ) cb(EQ) cb(ATAN2)              \
+    cb(H_SWISH_GRAD) cb(FUSE_ADD_RELU) cb(FUSE_ADD_SIGMOID) cb(FUSE_ADD_TANH) \
+    cb(FUSE_ADD_H_SWISH)
+
+#define MGB_JIT_BYTECODE_FOREACH_TERNARY(cb) \
+    cb(COND_LEQ_MOV) cb(COND_LT_MOV) cb(FUSE_MUL_ADD3)
+
+#define MGB_JIT_BYTECODE_FOREACH_QUATERNARY(cb) cb(FUSE_MUL_ADD4)
+// clang-format on
+
+//! opcodes are named after the elemwise modes they implement
+enum class Opcode : uint8_t {
+#define cb(_mode) _mode,
+    MGB_JIT_BYTECODE_FOREACH_UNARY(cb) MGB_JIT_BYTECODE_FOREACH_BINARY(cb)
+            MGB_JIT_BYTECODE_FOREACH_TERNARY(cb)
+                    MGB_JIT_BYTECODE_FOREACH_QUATERNARY(cb)
+#undef cb
+};
+
+/*!
+ * \brief one instruction, computing a whole tile of register dst from the
+ *      tiles of the source registers
+ */
+struct Inst {
+    static constexpr size_t MAX_NR_SRC = 4;
+
+    Opcode opcode;
+    uint16_t dst;
+    uint16_t src[MAX_NR_SRC];
+};
+
+/*!
+ * \brief a register-based program of a fused elemwise subgraph on float32
+ *
+ * Every register holds a tile of at most TILE_SIZE elements. The registers are
+ * numbered as the inputs (by the input id of the placeholders), the constants,
+ * the temporaries and finally the output, and the temporaries are reused once
+ * their values are dead, so the working set of a tile stays in the cache.
+ */
+struct Program {
+    //! number of elements processed by one pass of the program
+    static constexpr size_t TILE_SIZE = 1024;
+
+    size_t nr_inputs = 0;
+    //! value of the constant registers, following the input registers
+    std::vector<float> consts;
+    size_t nr_temps = 0;
+    std::vector<Inst> insts;
+
+    size_t nr_regs() const { return nr_inputs + consts.size() + nr_temps + 1; }
+
+    size_t output_reg() const { return nr_regs() - 1; }
+
+    /*!
+     * \brief run the program on one tile
+     * \param regs pointers to the tiles of all the registers
+     * \param size number of elements in the tile
+     */
+    void run(float* const* regs, size_t size) const;
+
+    //! whether an elemwise mode can be lowered to an opcode
+    static bool is_supported(opr::Elemwise::Mode mode);
+
+    //! get the opcode of a supported elemwise mode
+    static Opcode to_opcode(opr::Elemwise::Mode mode);
+
+    //! number of source registers used by an opcode
+    static size_t nr_src(Opcode opcode);
+};
+
+}  // namespace bytecode
+}  // namespace jit
+}  // namespace mgb
+
+#endif  // MGB_JIT
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
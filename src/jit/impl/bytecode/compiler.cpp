@@ -0,0 +1,267 @@
+#include "megbrain_build_config.h"
+#if MGB_JIT
+
+#include "./compiler.h"
+
+#include "megbrain/comp_node_env.h"
+#include "megbrain/graph/helper.h"
+#include "megbrain/jit/placeholder_opr.h"
+
+using namespace mgb;
+using namespace jit;
+using namespace bytecode;
+
+namespace {
+
+//! how an input tile is obtained from the collapsed input layout
+enum class InputKind {
+    CONTIG,   //!< read in place
+    SCALAR,   //!< all strides are zero, filled once for each task
+    STRIDED,  //!< gathered for each tile
+};
+
+struct InputDesc {
+    InputKind kind;
+    const float* ptr;
+    TensorLayout layout;
+};
+
+using InputDescArray = SmallVector<InputDesc>;
+
+/*!
+ * \brief gather elements [offset, offset + size) of a broadcasted or
+ *      monotone input, whose layout has the same shape as the output
+ */
+void gather(
+        const float* ptr, const TensorLayout& layout, size_t offset, size_t size,
+        float* dst) {
+    size_t ndim = layout.ndim;
+    size_t idx[TensorLayout::MAX_NDIM];
+    ptrdiff_t pos = 0;
+    for (size_t i = ndim, rem = offset; i--;) {
+        idx[i] = rem % layout.shape[i];
+        rem /= layout.shape[i];
+        pos += idx[i] * layout.stride[i];
+    }
+    size_t last = ndim - 1;
+    ptrdiff_t last_stride = layout.stride[last];
+    while (size) {
+        size_t nr = std::min(size, layout.shape[last] - idx[last]);
+        const float* src = ptr + pos;
+        if (last_stride == 0) {
+            std::fill(dst, dst + nr, *src);
+        } else if (last_stride == 1) {
+            std::copy(src, src + nr, dst);
+        } else {
+            for (size_t i = 0; i < nr; ++i) {
+                dst[i] = src[i * last_stride];
+            }
+        }
+        dst += nr;
+        size -= nr;
+        idx[last] += nr;
+        pos += nr * last_stride;
+        for (size_t i = last; i && idx[i] == layout.shape[i]; --i) {
+            pos -= layout.shape[i] * layout.stride[i];
+            idx[i] = 0;
+            ++idx[i - 1];
+            pos += layout.stride[i - 1];
+        }
+    }
+}
+
+//! run the program on the tiles of output elements [begin, end)
+void run_tiles(
+        const Program& program, const InputDescArray& inputs, float* out,
+        size_t begin, size_t end) {
+    constexpr size_t TILE = Program::TILE_SIZE;
+    size_t nr_regs = program.nr_regs();
+    //! one tile for each register, reused by the tasks on the same thread
+    thread_local std::vector<float> scratch;
+    if (scratch.size() < nr_regs * TILE) {
+        scratch.resize(nr_regs * TILE);
+    }
+    auto tile = [](size_t reg) { return scratch.data() + reg * TILE; };
+
+    SmallVector<float*, 16> regs(nr_regs);
+    for (size_t i = 0; i < nr_regs; ++i) {
+        regs[i] = tile(i);
+    }
+    for (size_t i = 0; i < program.consts.size(); ++i) {
+        auto reg = program.nr_inputs + i;
+        std::fill(regs[reg], regs[reg] + TILE, program.consts[i]);
+    }
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        if (inputs[i].kind == InputKind::SCALAR) {
+            std::fill(regs[i], regs[i] + TILE, *inputs[i].ptr);
+        }
+    }
+
+    auto out_reg = program.output_reg();
+    for (size_t offset = begin; offset < end; offset += TILE) {
+        size_t size = std::min(TILE, end - offset);
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            auto&& inp = inputs[i];
+            if (inp.kind == InputKind::CONTIG) {
+                regs[i] = const_cast<float*>(inp.ptr) + offset;
+            } else if (inp.kind == InputKind::STRIDED) {
+                gather(inp.ptr, inp.layout, offset, size, tile(i));
+            }
+        }
+        regs[out_reg] = out + offset;
+        program.run(regs.data(), size);
+    }
+}
+
+}  // anonymous namespace
+
+/* ==================== BytecodeCompiler ===================== */
+
+std::unique_ptr<Executable> BytecodeCompiler::do_compile(
+        const InternalGraph& graph, const JITExecutor::Args& args) {
+    MGB_MARK_USED_VAR(args);
+    return std::make_unique<BytecodeExecutable>(lower(graph));
+}
+
+size_t BytecodeCompiler::get_nr_workspace_outputs(JITExecutor* opr) const {
+    MGB_MARK_USED_VAR(opr);
+    return 0;
+}
+
+void BytecodeCompiler::init_workspace_size_infer(JITExecutor* opr) {
+    MGB_MARK_USED_VAR(opr);
+}
+
+Program BytecodeCompiler::lower(const InternalGraph& graph) {
+    Program program;
+    program.nr_inputs = graph.placeholders().size();
+
+    std::vector<cg::OperatorNodeBase*> oprs;
+    ThinHashMap<VarNode*, size_t> nr_reader;
+    cg::DepOprIter{[&](cg::OperatorNodeBase* opr) {
+        oprs.push_back(opr);
+        for (auto i : opr->input()) {
+            ++nr_reader[i];
+        }
+    }}.add(graph.output());
+
+    // the inputs and constants take the leading registers
+    ThinHashMap<VarNode*, size_t> var2reg;
+    std::vector<opr::Elemwise*> elemwise_oprs;
+    for (auto opr : oprs) {
+        auto var = opr->output(0);
+        if (auto ph = opr->try_cast_final<JITPlaceholder>()) {
+            mgb_assert(
+                    !ph->is_host_value_shape_input() &&
+                            ph->input_id() < program.nr_inputs,
+                    "invalid placeholder in bytecode jit");
+            var2reg[var] = ph->input_id();
+        } else if (SymbolVar{var}.as_immutable_scalar().valid()) {
+            auto imm = SymbolVar{var}.as_immutable_scalar().val();
+            var2reg[var] = program.nr_inputs + program.consts.size();
+            program.consts.push_back(imm.get_cast<float>());
+        } else if (auto elem = opr->try_cast_final<opr::Elemwise>()) {
+            mgb_assert(
+                    Program::is_supported(elem->param().mode) &&
+                            var->dtype() == dtype::Float32(),
+                    "unsupported elemwise in bytecode jit: mode=%d dtype=%s",
+                    static_cast<int>(elem->param().mode), var->dtype().name());
+            elemwise_oprs.push_back(elem);
+        } else {
+            mgb_throw(
+                    InternalError, "unsupported opr in bytecode jit: %s{%s}",
+                    opr->cname(), opr->dyn_typeinfo()->name);
+        }
+    }
+    mgb_assert(
+            !elemwise_oprs.empty() && elemwise_oprs.back()->output(0) == graph.output(),
+            "the output of bytecode jit should be computed by an elemwise opr");
+
+    // the temporaries are allocated by linear scan and released after their
+    // last use, the output register is patched after all temporaries are known
+    constexpr uint16_t OUTPUT_REG = std::numeric_limits<uint16_t>::max();
+    size_t temp_begin = program.nr_inputs + program.consts.size();
+    std::vector<uint16_t> free_temps;
+    for (auto elem : elemwise_oprs) {
+        Inst inst;
+        inst.opcode = Program::to_opcode(elem->param().mode);
+        mgb_assert(elem->input().size() == Program::nr_src(inst.opcode));
+        for (size_t i = 0; i < elem->input().size(); ++i) {
+            inst.src[i] = var2reg.at(elem->input(i));
+        }
+        for (auto i : elem->input()) {
+            auto reg = var2reg.at(i);
+            if (!--nr_reader.at(i) && reg >= temp_begin) {
+                free_temps.push_back(reg);
+            }
+        }
+        auto var = elem->output(0);
+        if (var == graph.output()) {
+            inst.dst = OUTPUT_REG;
+        } else if (!free_temps.empty()) {
+            inst.dst = free_temps.back();
+            free_temps.pop_back();
+        } else {
+            inst.dst = temp_begin + program.nr_temps++;
+        }
+        var2reg[var] = inst.dst;
+        program.insts.push_back(inst);
+    }
+    mgb_assert(
+            program.nr_regs() < OUTPUT_REG, "too many registers in bytecode jit: %zu",
+            program.nr_regs());
+    program.insts.back().dst = program.output_reg();
+    return program;
+}
+
+/* =================== BytecodeExecutable ==================== */
+
+void BytecodeExecutable::execute(JITExecutor* fusion_opr) {
+    auto&& args = fusion_opr->args();
+    auto&& out = args.outputs[0];
+    mgb_assert(
+            out.layout.dtype == dtype::Float32() && out.layout.is_contiguous(),
+            "bytecode jit needs contiguous float32 output, got %s",
+            out.layout.to_string().c_str());
+    size_t size = out.layout.total_nr_elems();
+    if (!size) {
+        return;
+    }
+
+    // the task runs asynchronously, so the layouts and pointers are captured by
+    // value
+    InputDescArray inputs(args.inputs.size());
+    for (auto&& i : args.inputs) {
+        auto&& desc = inputs.at(i.idx);
+        desc.ptr = i.from->dev_tensor().ptr<float>();
+        desc.layout = i.layout;
+        if (i.layout.is_contiguous()) {
+            desc.kind = InputKind::CONTIG;
+        } else if (std::all_of(
+                           i.layout.stride, i.layout.stride + i.layout.ndim,
+                           [](ptrdiff_t s) { return !s; })) {
+            desc.kind = InputKind::SCALAR;
+        } else {
+            desc.kind = InputKind::STRIDED;
+        }
+    }
+    float* out_ptr = out.from->dev_tensor().ptr<float>();
+
+    auto&& env = CompNodeEnv::from_comp_node(fusion_opr->comp_node()).cpu_env();
+    auto div_ceil = [](size_t a, size_t b) { return (a + b - 1) / b; };
+    size_t nr_tiles = div_ceil(size, Program::TILE_SIZE);
+    size_t nr_tasks = std::min(env.dispatcher->nr_threads(), nr_tiles);
+    size_t task_size = div_ceil(nr_tiles, nr_tasks) * Program::TILE_SIZE;
+    nr_tasks = div_ceil(size, task_size);
+    auto program = &m_program;
+    auto kern = [program, inputs, out_ptr, size, task_size](size_t task_id, size_t) {
+        size_t begin = task_id * task_size;
+        run_tiles(
+                *program, inputs, out_ptr, begin, std::min(begin + task_size, size));
+    };
+    env.dispatch(std::move(kern), nr_tasks);
+}
+
+#endif  // MGB_JIT
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
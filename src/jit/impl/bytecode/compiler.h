@@ -0,0 +1,59 @@
+#pragma once
+
+#include "megbrain_build_config.h"
+#if MGB_JIT
+
+#include "./bytecode.h"
+
+#include "megbrain/jit/compiler.h"
+
+namespace mgb {
+namespace jit {
+
+/*!
+ * \brief Executable that interprets a bytecode program over cache-sized tiles
+ *
+ * The program does not depend on the shapes, so one executable is shared by
+ * all the JITExecutor oprs with the same internal graph.
+ */
+class BytecodeExecutable final : public Executable {
+public:
+    explicit BytecodeExecutable(bytecode::Program program)
+            : m_program{std::move(program)} {}
+
+    void execute(JITExecutor* fusion_opr) override;
+
+    const bytecode::Program& program() const { return m_program; }
+
+private:
+    const bytecode::Program m_program;
+};
+
+/*!
+ * \brief codegen-free compiler for float32 elemwise subgraphs on CPU, which
+ *      lowers the internal graph to a register-based bytecode program
+ */
+class BytecodeCompiler final : public Compiler {
+    std::unique_ptr<Executable> do_compile(
+            const InternalGraph& graph, const JITExecutor::Args& args) override;
+
+public:
+    Property property() const override {
+        using F = Property::Flag;
+        return Property{F::NEED_INPUT_COLLAPSE, JITFeatureBits::NONE, 64};
+    }
+
+    size_t get_nr_workspace_outputs(JITExecutor* opr) const override;
+
+    void init_workspace_size_infer(JITExecutor* opr) override;
+
+    //! lower an internal graph to a bytecode program
+    static bytecode::Program lower(const InternalGraph& graph);
+};
+
+}  // namespace jit
+}  // namespace mgb
+
+#endif  // MGB_JIT
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -1,4 +1,5 @@
 #include "./mlir/compiler.h"
+#include "./bytecode/compiler.h"
 #include "./halide/compiler_cuda.h"
 #include "./nvrtc/compiler_cuda.h"
 
@@ -108,6 +109,10 @@ Compiler* Compiler::get(ComputingGraph& graph, CompNode comp_node) {
                     break;
                 }
 #endif
+                if (!strcmp(backend.c_str(), "BYTECODE")) {
+                    compiler = std::make_unique<BytecodeCompiler>();
+                    break;
+                }
                 mgb_throw(
                         InternalError,
                         "No compiler support for cpu, may caused by build not enable "
@@ -1,4 +1,5 @@
 #include "megbrain/jit/fusion_pass.h"
+#include "./bytecode/bytecode.h"
 #include "megbrain/common.h"
 #include "megbrain/comp_node_env.h"
 #include "megbrain/gopt/gtrans.h"
@@ -116,11 +117,12 @@ void JITFusionPass::Impl::config_jit_backends(CompNode comp_node) const {
                     "MLIR/HALIDE module or error config jit backend env");
             break;
 #endif
-        // CPU jit only support MLIR now
+        // CPU jit default property: MLIR > BYTECODE
         case CompNode::DeviceType::CPU:
 #if MGB_JIT_MLIR
             ENV_CB("MLIR");
 #endif
+            ENV_CB("BYTECODE");
             mgb_throw(
                     InternalError,
                     "No compiler support for cpu, may caused by build not enable "
@@ -431,6 +433,11 @@ bool JITFusionPass::Impl::can_be_fused(cg::OperatorNodeBase* opr) const {
 #undef FOREACH_ELEMWISE_SKIP_MODE
         }
 #endif  // MGB_JIT_MLIR
+        //! the bytecode programs only compute on float32
+        if (!strcmp(backend.c_str(), "BYTECODE")) {
+            ret = bytecode::Program::is_supported(elem->param().mode) &&
+                  elem->output(0)->dtype() == dtype::Float32();
+        }
 
         return ret &&
                ast_c::check_elem_mode(
@@ -438,8 +445,9 @@ bool JITFusionPass::Impl::can_be_fused(cg::OperatorNodeBase* opr) const {
                elem->output(0)->dtype().category() == DTypeCategory::FLOAT;
     }
 
-    //! TINYOPENCL and MLIR only support elemwise now
-    if (strcmp(backend.c_str(), "MLIR") && strcmp(backend.c_str(), "TINYOPENCL")) {
+    //! TINYOPENCL, MLIR and BYTECODE only support elemwise now
+    if (strcmp(backend.c_str(), "MLIR") && strcmp(backend.c_str(), "TINYOPENCL") &&
+        strcmp(backend.c_str(), "BYTECODE")) {
         if (opr->same_type<opr::PowC>()) {
             return true;
         }
@@ -556,6 +556,123 @@ TEST(TestJITMlirDimshuffle, BasicGPU) {
 
 #endif  // MGB_JIT_MLIR
 
+/* ===================== TestJITBytecodeCodeGen ===================== */
+
+namespace {
+template <typename Func>
+void check_bytecode(
+        CompNode cn, const TensorShapeArray& shapes, Func&& make_y,
+        float low = -2.f, float high = 2.f, float maxerr = 1e-5) {
+    set_backend(Backend::BYTECODE);
+    auto graph = ComputingGraph::make();
+    HostTensorGenerator<dtype::Float32, RandomDistribution::UNIFORM> gen(low, high);
+
+    SymbolVarArray inputs;
+    for (auto&& shape : shapes) {
+        inputs.push_back(opr::Host2DeviceCopy::make(*graph, gen(shape, cn)));
+    }
+    SymbolVar y = make_y(inputs);
+
+    auto ig_gen = std::make_unique<InternalGraphGenerator>(y.node()->owner_opr());
+    for (auto i : get_rev_topo_order(y)) {
+        if (!i->same_type<opr::Host2DeviceCopy>()) {
+            ig_gen->add_opr(i);
+        }
+    }
+    auto igraph = ig_gen->generate();
+    auto y_jit = JITExecutor::make(igraph, ig_gen->orig_inps());
+
+    HostTensorND host_y, host_y_jit;
+    auto func = graph->compile(
+            {make_callback_copy(y, host_y), make_callback_copy(y_jit, host_y_jit)});
+    func->execute();
+
+    MGB_ASSERT_TENSOR_NEAR(host_y, host_y_jit, maxerr);
+}
+
+void run_bytecode_broadcast(CompNode cn) {
+    // 6000 elements cover several tiles; the inputs are read in place, gathered
+    // and filled as a scalar
+    check_bytecode(
+            cn, {{10, 20, 5, 6}, {1, 20, 1, 1}, {10, 1, 5, 1}, {1}},
+            [](const SymbolVarArray& inp) {
+                using Mode = opr::Elemwise::Mode;
+                auto x = opr::Elemwise::make(
+                        {inp[0], inp[1], inp[2]}, Mode::FUSE_MUL_ADD3);
+                auto y = opr::Elemwise::make({x, inp[3]}, Mode::FUSE_ADD_RELU);
+                return opr::sigmoid(y) * x - opr::abs(inp[0]) + 0.3f;
+            });
+}
+
+void run_bytecode_different_shape(CompNode cn) {
+    for (auto&& shape :
+         TensorShapeArray{{23, 42}, {16, 31}, {32, 56}, {10}, {1}, {1025}}) {
+        check_bytecode(cn, {shape, shape}, [](const SymbolVarArray& inp) {
+            return opr::tanh(inp[0] * 2.f + inp[1]) * inp[0];
+        });
+    }
+}
+
+void run_bytecode_mode(CompNode cn, opr::Elemwise::Mode mode) {
+    using Mode = opr::Elemwise::Mode;
+    float low = -2.f, high = 2.f;
+    switch (mode) {
+        case Mode::LOG:
+        case Mode::LOG1P:
+        case Mode::POW:
+        case Mode::TRUE_DIV:
+        case Mode::FLOOR_DIV:
+        case Mode::MOD:
+        case Mode::ACOS:
+        case Mode::ASIN:
+            low = 0.1f;
+            high = 1.f;
+            break;
+        default:
+            break;
+    }
+    size_t arity = megdnn::Elemwise::ModeTrait::from_mode(mode).arity;
+    TensorShapeArray shapes(arity, TensorShape{123, 45});
+    check_bytecode(
+            cn, shapes,
+            [mode](const SymbolVarArray& inp) {
+                // an extra opr makes the subgraph worth fusing
+                return opr::Elemwise::make(inp, mode) + 1.f;
+            },
+            low, high);
+}
+}  // anonymous namespace
+
+TEST(TestJITBytecodeCodeGen, Basic) {
+    auto cn = CompNode::load("cpu0");
+    run_bytecode_broadcast(cn);
+    run_bytecode_different_shape(cn);
+}
+
+TEST(TestJITBytecodeCodeGen, MultiThread) {
+    auto cn = CompNode::load("multithread4:0");
+    run_bytecode_broadcast(cn);
+    run_bytecode_different_shape(cn);
+}
+
+TEST(TestJITBytecodeCodeGen, Modes) {
+    using Mode = opr::Elemwise::Mode;
+    auto cn = CompNode::load("cpu0");
+    for (auto mode :
+         {Mode::RELU, Mode::ABS, Mode::NEGATE, Mode::ACOS, Mode::ASIN, Mode::CEIL,
+          Mode::COS, Mode::EXP, Mode::EXPM1, Mode::FLOOR, Mode::LOG, Mode::LOG1P,
+          Mode::SIGMOID, Mode::SIN, Mode::TANH, Mode::ERF, Mode::ERFC, Mode::H_SWISH,
+          Mode::ABS_GRAD, Mode::ADD, Mode::FLOOR_DIV, Mode::MAX, Mode::MIN, Mode::MOD,
+          Mode::MUL, Mode::POW, Mode::SIGMOID_GRAD, Mode::SUB, Mode::SWITCH_GT0,
+          Mode::TANH_GRAD, Mode::TRUE_DIV, Mode::LOG_SUM_EXP, Mode::LT, Mode::LEQ,
+          Mode::EQ, Mode::ATAN2, Mode::H_SWISH_GRAD, Mode::FUSE_ADD_RELU,
+          Mode::FUSE_ADD_SIGMOID, Mode::FUSE_ADD_TANH, Mode::FUSE_ADD_H_SWISH,
+          Mode::COND_LEQ_MOV, Mode::COND_LT_MOV, Mode::FUSE_MUL_ADD3,
+          Mode::FUSE_MUL_ADD4}) {
+        run_bytecode_mode(cn, mode);
+    }
+}
+
 TEST(TestJITExecutor, TestJITExecutorShallowCopy) {
     REQUIRE_GPU(1);
     set_backend(Backend::NVRTC);
@@ -1677,6 +1677,36 @@ TEST(TestJITExecutor, TestJITMlirFusionGpu) {
 
 #endif  // MGB_JIT_MLIR
 
+TEST(TestJITExecutor, TestJITBytecodeFusion) {
+    set_backend(Backend::BYTECODE);
+    auto cn = CompNode::load("cpu0");
+
+    HostTensorGenerator<> gen;
+    auto host_x0 = gen({23, 42}, cn), host_x1 = gen({23, 1}, cn),
+         host_x2 = gen({1, 42}, cn), host_x3 = gen({23, 42}, cn),
+         host_x4 = gen({1, 42}, cn);
+
+    auto make_dst = [&](ComputingGraph& graph) {
+        auto a = opr::Host2DeviceCopy::make(graph, host_x0),
+             b = opr::Host2DeviceCopy::make(graph, host_x1),
+             c = opr::Host2DeviceCopy::make(graph, host_x2),
+             d = opr::Host2DeviceCopy::make(graph, host_x3),
+             e = opr::Host2DeviceCopy::make(graph, host_x4);
+        return opr::tanh(a + opr::max(b, c)) * 0.5f + opr::relu(opr::max(d, e));
+    };
+    HostTensorND host_y1, host_y2;
+    auto funcs = make_func_pair(host_y1, host_y2, make_dst, 2);
+
+    funcs.first->execute();
+    funcs.second->execute();
+    MGB_ASSERT_TENSOR_NEAR(host_y1, host_y2, 1e-6);
+
+    JITExecutor* jit;
+    unpack_vector(find_oprs<JITExecutor>(*funcs.second), jit);
+    ASSERT_EQ(0u, find_oprs<opr::Elemwise>(*funcs.second).size());
+    ASSERT_EQ(5u, jit->input().size());
+}
+
 #endif  // MGB_JIT
 
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -4,7 +4,7 @@
 
 namespace mgb {
 namespace jit {
-enum class Backend { NONE, HALIDE, NVRTC, MLIR, TINYOPENCL };
+enum class Backend { NONE, HALIDE, NVRTC, MLIR, TINYOPENCL, BYTECODE };
 
 void set_backend(Backend backend);
 
@@ -36,6 +36,21 @@ const char* get_param_name(CollectiveComm::Param param) {
     }
 }
 
+#if MGB_ENABLE_MEGRAY
+MegRay::ReduceOp get_megray_reduce_op(ShmCommunicator::ReduceOp op) {
+    switch (op) {
+        case ShmCommunicator::ReduceOp::SUM:
+            return MegRay::ReduceOp::MEGRAY_SUM;
+        case ShmCommunicator::ReduceOp::MAX:
+            return MegRay::ReduceOp::MEGRAY_MAX;
+        case ShmCommunicator::ReduceOp::MIN:
+            return MegRay::ReduceOp::MEGRAY_MIN;
+        default:
+            mgb_throw(MegBrainError, "bad CollectiveComm reduce op");
+    }
+}
+#endif
+
 }  // anonymous namespace
 
 /* ================= ModeTrait ================= */
@@ -144,10 +159,18 @@ class CollectiveComm::ModeTrait::ALL_GATHER : public ModeTrait {
         auto ivar = opr->input(0), ovar = opr->output(0);
         auto &&iv = ivar->dev_tensor(), &&ov = ovar->dev_tensor();
         mgb_assert(ivar->comp_node().mem_node() == ovar->comp_node().mem_node());
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->all_gather(
+                    iv.raw_ptr(), ov.raw_ptr(), iv.shape().total_nr_elems(),
+                    iv.dtype());
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->all_gather(
                 (void*)iv.raw_ptr(), (void*)ov.raw_ptr(), iv.shape().total_nr_elems(),
                 get_megray_dtype(iv.dtype()), opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay all_gather failed");
+#endif
     }
 
     Mode grad_mode() override { return Mode::REDUCE_SCATTER_SUM; }
@@ -187,11 +210,19 @@ class CollectiveComm::ModeTrait::REDUCE_SCATTER_SUM : public ModeTrait {
         mgb_assert(ivar->comp_node().mem_node() == ovar->comp_node().mem_node());
 
         size_t buff_len = ov.shape().total_nr_elems();  // * opr->m_nr_devices;
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->reduce_scatter(
+                    iv.raw_ptr(), ov.raw_ptr(), buff_len, ov.dtype(),
+                    ShmCommunicator::ReduceOp::SUM);
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->reduce_scatter(
                 (void*)iv.raw_ptr(), (void*)ov.raw_ptr(), buff_len,
                 get_megray_dtype(ov.dtype()), MegRay::ReduceOp::MEGRAY_SUM,
                 opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay reduce_scatter failed");
+#endif
     }
 
     Mode grad_mode() override { return Mode::ALL_GATHER; }
@@ -217,7 +248,7 @@ class CollectiveComm::ModeTrait::ReducedBasedTrait {
 protected:
     ~ReducedBasedTrait() = default;
 
-    virtual MegRay::ReduceOp op() const = 0;
+    virtual ShmCommunicator::ReduceOp op() const = 0;
 };
 
 class CollectiveComm::ModeTrait::AllReduceBase : public ReducedBasedTrait,
@@ -233,10 +264,19 @@ class CollectiveComm::ModeTrait::AllReduceBase : public ReducedBasedTrait,
         auto ivar = opr->input(0), ovar = opr->output(0);
         auto &&iv = ivar->dev_tensor(), &&ov = ovar->dev_tensor();
         mgb_assert(ivar->comp_node().mem_node() == ovar->comp_node().mem_node());
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->all_reduce(
+                    iv.raw_ptr(), ov.raw_ptr(), iv.shape().total_nr_elems(),
+                    iv.dtype(), op());
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->all_reduce(
                 (void*)iv.raw_ptr(), (void*)ov.raw_ptr(), iv.shape().total_nr_elems(),
-                get_megray_dtype(iv.dtype()), op(), opr->megray_ctx());
+                get_megray_dtype(iv.dtype()), get_megray_reduce_op(op()),
+                opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay all_reduce failed");
+#endif
     }
 
     Mode grad_mode() override { return Mode::ALL_REDUCE_SUM; }
@@ -248,11 +288,15 @@ public:
 };
 
 class CollectiveComm::ModeTrait::ALL_REDUCE_SUM final : public AllReduceBase {
-    MegRay::ReduceOp op() const override { return MegRay::ReduceOp::MEGRAY_SUM; }
+    ShmCommunicator::ReduceOp op() const override {
+        return ShmCommunicator::ReduceOp::SUM;
+    }
 };
 
 class CollectiveComm::ModeTrait::ALL_REDUCE_MAX final : public AllReduceBase {
-    MegRay::ReduceOp op() const override { return MegRay::ReduceOp::MEGRAY_MAX; }
+    ShmCommunicator::ReduceOp op() const override {
+        return ShmCommunicator::ReduceOp::MAX;
+    }
 
     VarNode* grad(VarNode* out_grad, const CollectiveComm* opr) const override {
         VarNode* grad;
@@ -271,7 +315,9 @@ class CollectiveComm::ModeTrait::ALL_REDUCE_MAX final : public AllReduceBase {
 };
 
 class CollectiveComm::ModeTrait::ALL_REDUCE_MIN final : public AllReduceBase {
-    MegRay::ReduceOp op() const override { return MegRay::ReduceOp::MEGRAY_MIN; }
+    ShmCommunicator::ReduceOp op() const override {
+        return ShmCommunicator::ReduceOp::MIN;
+    }
 
     VarNode* grad(VarNode* out_grad, const CollectiveComm* opr) const override {
         VarNode* grad;
@@ -310,15 +356,26 @@ class CollectiveComm::ModeTrait::ReduceBase : public ReducedBasedTrait,
         if (opr->is_root()) {
             recvbuf = ovar->dev_tensor().raw_ptr();
         }
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->reduce(
+                    iv.raw_ptr(), recvbuf, iv.shape().total_nr_elems(), iv.dtype(),
+                    op(), opr->m_root);
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->reduce(
                 (void*)iv.raw_ptr(), recvbuf, iv.shape().total_nr_elems(),
-                get_megray_dtype(iv.dtype()), op(), opr->m_root, opr->megray_ctx());
+                get_megray_dtype(iv.dtype()), get_megray_reduce_op(op()),
+                opr->m_root, opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay reduce failed");
+#endif
     }
 };
 
 class CollectiveComm::ModeTrait::REDUCE_SUM final : public ReduceBase {
-    MegRay::ReduceOp op() const override { return MegRay::ReduceOp::MEGRAY_SUM; }
+    ShmCommunicator::ReduceOp op() const override {
+        return ShmCommunicator::ReduceOp::SUM;
+    }
 
     VarNode* grad(VarNode* out_grad, const CollectiveComm* opr) const override {
         VarNode* input = opr->is_root() ? out_grad : nullptr;
@@ -355,10 +412,16 @@ class CollectiveComm::ModeTrait::BROADCAST : public ModeTrait {
             datatype = ov.dtype();
             length = ov.shape().total_nr_elems();
         }
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->broadcast(buff, ov.raw_ptr(), length, datatype, opr->m_root);
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->broadcast(
                 buff, (void*)ov.raw_ptr(), length, get_megray_dtype(datatype),
                 opr->m_root, opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay broadcast failed");
+#endif
     }
 
     Mode grad_mode() override { return Mode::REDUCE_SUM; }
@@ -384,10 +447,18 @@ class CollectiveComm::ModeTrait::GATHER : public ModeTrait {
         if (opr->is_root()) {
             recvbuf = opr->output(0)->dev_tensor().raw_ptr();
         }
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->gather(
+                    iv.raw_ptr(), recvbuf, iv.shape().total_nr_elems(), iv.dtype(),
+                    opr->m_root);
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->gather(
                 (void*)iv.raw_ptr(), recvbuf, iv.shape().total_nr_elems(),
                 get_megray_dtype(iv.dtype()), opr->m_root, opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay gather failed");
+#endif
     }
 
     VarNode* grad(VarNode* out_grad, const CollectiveComm* opr) const override {
@@ -412,10 +483,18 @@ class CollectiveComm::ModeTrait::SCATTER : public ModeTrait {
         if (opr->is_root()) {
             sendbuf = opr->input(0)->dev_tensor().raw_ptr();
         }
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->scatter(
+                    sendbuf, recvbuf, ov.shape().total_nr_elems(), ov.dtype(),
+                    opr->m_root);
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->scatter(
                 sendbuf, recvbuf, ov.shape().total_nr_elems(),
                 get_megray_dtype(ov.dtype()), opr->m_root, opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay scatter failed");
+#endif
     }
 
     Mode grad_mode() override { return Mode::GATHER; }
@@ -432,11 +511,19 @@ class CollectiveComm::ModeTrait::ALL_TO_ALL : public ModeTrait {
     void exec(CollectiveComm* opr) override {
         auto&& iv = opr->input(0)->dev_tensor();
         auto&& ov = opr->output(0)->dev_tensor();
+        if (auto shm = opr->m_shm_comm.get()) {
+            shm->all_to_all(
+                    iv.raw_ptr(), ov.raw_ptr(),
+                    iv.shape().total_nr_elems() / opr->nr_devices(), iv.dtype());
+            return;
+        }
+#if MGB_ENABLE_MEGRAY
         auto status = opr->m_megray_comm->all_to_all(
                 (void*)iv.raw_ptr(), (void*)ov.raw_ptr(),
                 iv.shape().total_nr_elems() / opr->nr_devices(),
                 get_megray_dtype(iv.dtype()), opr->megray_ctx());
         mgb_assert(status == MegRay::MEGRAY_OK, "MegRay all_to_all failed");
+#endif
     }
 
     Mode grad_mode() override { return Mode::ALL_TO_ALL; }
@@ -579,11 +666,30 @@ void CollectiveComm::opr_register() {
     m_rank = reg_info.rank;
     m_root = reg_info.root_rank;
 
+    if (m_backend == "shm") {
+        mgb_assert(
+                comp_node.device_type() == CompNode::DeviceType::CPU,
+                "shm backend of CollectiveComm requires cpu comp node, got %s",
+                comp_node.to_string().c_str());
+        m_shm_comm = ShmCommunicator::get(
+                reg_info.hash, m_nr_devices, m_rank, m_group_client);
+        m_init = true;
+        return;
+    }
+
+#if MGB_ENABLE_MEGRAY
     m_megray_comm = MegRayCommBuilder::get_megray_comm(
             reg_info.hash, m_key, m_nr_devices, m_rank, get_megray_backend(m_backend),
             m_group_client);
 
     m_megray_ctx = get_megray_context(output(0)->comp_node());
+#else
+    mgb_throw(
+            MegBrainError,
+            "%s backend of CollectiveComm requires MegRay, which is only built "
+            "with CUDA or ROCm",
+            m_backend.c_str());
+#endif
 
     m_init = true;
 }
@@ -206,9 +206,11 @@ uint32_t GroupManager::group_barrier(uint32_t size, uint32_t rank) {
     m_barrier_set.insert(rank);
     if (m_barrier_set.size() == m_barrier_size) {
         m_barrier_set.clear();
+        ++m_barrier_generation;
         m_barrier_cv.notify_all();
     } else {
-        m_barrier_cv.wait(lk, [&] { return m_barrier_set.empty(); });
+        auto generation = m_barrier_generation;
+        m_barrier_cv.wait(lk, [&] { return m_barrier_generation != generation; });
     }
     return m_barrier_size;
 }
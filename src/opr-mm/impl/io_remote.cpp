@@ -38,6 +38,7 @@ SymbolVar RemoteSend::make(
 }
 
 void RemoteSend::scn_do_execute() {
+#if MGB_ENABLE_MEGRAY
     if (!m_init) {
         auto&& comp_node = output(0)->comp_node();
         bool use_cache = output(0)->owner_graph()->options().imperative_proxy_graph;
@@ -83,6 +84,11 @@ void RemoteSend::scn_do_execute() {
         }
         dest.copy_from_fixlayout(m_output_val);
     }
+#else
+    mgb_throw(
+            MegBrainError,
+            "RemoteSend requires MegRay, which is only built with CUDA or ROCm");
+#endif
 }
 
 void RemoteSend::init_output_static_infer_desc() {
@@ -176,6 +182,7 @@ SymbolVar RemoteRecv::make(
 }
 
 void RemoteRecv::scn_do_execute() {
+#if MGB_ENABLE_MEGRAY
     if (!m_init) {
         auto&& comp_node = output(0)->comp_node();
         bool use_cache = output(0)->owner_graph()->options().imperative_proxy_graph;
@@ -212,6 +219,11 @@ void RemoteRecv::scn_do_execute() {
             tensor.raw_ptr(), data_size, get_megray_dtype(tensor.dtype()), 0,
             m_megray_ctx);
     mgb_assert(status == MegRay::MEGRAY_OK, "MegRay recv failed");
+#else
+    mgb_throw(
+            MegBrainError,
+            "RemoteRecv requires MegRay, which is only built with CUDA or ROCm");
+#endif
 }
 
 void RemoteRecv::init_output_static_infer_desc() {
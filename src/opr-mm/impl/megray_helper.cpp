@@ -1,4 +1,6 @@
 #include "megbrain/opr/megray_helper.h"
+
+#if MGB_ENABLE_MEGRAY
 #include "megbrain/comp_node_env.h"
 #include "megray/common.h"
 
@@ -111,3 +113,5 @@ std::shared_ptr<MegRay::Communicator> MegRayCommBuilder::get_megray_comm(
 MegRayCommBuilder* MegRayCommBuilder::sm_instance = nullptr;
 
 std::mutex MegRayCommBuilder::sm_instance_mtx;
+
+#endif  // MGB_ENABLE_MEGRAY
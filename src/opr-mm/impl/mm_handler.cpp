@@ -233,6 +233,7 @@ uint32_t GroupClientProxy::group_barrier(uint32_t size, uint32_t rank) {
     return rsp.size();
 }
 
+#if MGB_ENABLE_MEGRAY
 std::shared_ptr<MegRay::Communicator> BatchSendRecvHelper::get(std::string&& key) {
     auto ptr = megray_comm_cache.find(key);
     if (ptr != megray_comm_cache.end()) {
@@ -266,6 +267,7 @@ bool BatchSendRecvHelper::init(
     return megray_comm_cache.insert({std::string("init_all_cards"), megray_comm})
             .second;
 }
+#endif
 
 #undef INFO_INIT
 #undef SOLVE_REQUEST
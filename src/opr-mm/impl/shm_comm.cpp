@@ -0,0 +1,405 @@
+#include "megbrain/opr/shm_comm.h"
+#include "megbrain/utils/hash.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstring>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace mgb;
+using namespace opr;
+
+/* ================= ShmCommunicator::Header ================= */
+
+struct ShmCommunicator::Header {
+    static constexpr uint64_t MAGIC = 0x6d67625f73686d31ull;
+    uint64_t magic;
+    uint32_t size;
+    //! number of ranks that have reached the current barrier
+    alignas(64) std::atomic<uint32_t> nr_arrived;
+    //! incremented by the last rank arriving at a barrier
+    alignas(64) std::atomic<uint32_t> generation;
+
+    //! size of the header padded to the alignment of chunk buffers
+    static constexpr size_t padded_size() { return (sizeof(Header) + 4095) & ~4095; }
+};
+
+namespace {
+
+static_assert(
+        ATOMIC_INT_LOCK_FREE == 2, "atomics in shared memory must be lock free");
+
+template <typename T>
+struct SumOp {
+    static T apply(T a, T b) { return static_cast<T>(a + b); }
+};
+
+template <typename T>
+struct MaxOp {
+    static T apply(T a, T b) { return std::max(a, b); }
+};
+
+template <typename T>
+struct MinOp {
+    static T apply(T a, T b) { return std::min(a, b); }
+};
+
+/*!
+ * \brief dst[0:n] = reduction of srcs[i][0:n] for i in [0, nr)
+ *
+ * The loops over restrict pointers are vectorized by the compiler.
+ */
+template <typename T, class Op>
+void reduce_bufs(T* __restrict dst, const T* const* srcs, size_t nr, size_t n) {
+    const T* __restrict src0 = srcs[0];
+    const T* __restrict src1 = srcs[1];
+    for (size_t i = 0; i < n; ++i) {
+        dst[i] = Op::apply(src0[i], src1[i]);
+    }
+    for (size_t r = 2; r < nr; ++r) {
+        const T* __restrict src = srcs[r];
+        for (size_t i = 0; i < n; ++i) {
+            dst[i] = Op::apply(dst[i], src[i]);
+        }
+    }
+}
+
+template <typename T>
+void reduce_bufs(
+        ShmCommunicator::ReduceOp op, void* dst, const void* const* srcs, size_t nr,
+        size_t n) {
+    auto d = static_cast<T*>(dst);
+    auto s = reinterpret_cast<const T* const*>(srcs);
+    if (nr == 1) {
+        memcpy(d, s[0], n * sizeof(T));
+        return;
+    }
+    switch (op) {
+        case ShmCommunicator::ReduceOp::SUM:
+            return reduce_bufs<T, SumOp<T>>(d, s, nr, n);
+        case ShmCommunicator::ReduceOp::MAX:
+            return reduce_bufs<T, MaxOp<T>>(d, s, nr, n);
+        case ShmCommunicator::ReduceOp::MIN:
+            return reduce_bufs<T, MinOp<T>>(d, s, nr, n);
+    }
+}
+
+void reduce_bufs(
+        ShmCommunicator::ReduceOp op, DType dtype, void* dst, const void* const* srcs,
+        size_t nr, size_t n) {
+    switch (dtype.enumv()) {
+#define cb(_dt)                  \
+    case DTypeTrait<_dt>::enumv: \
+        return reduce_bufs<DTypeTrait<_dt>::ctype>(op, dst, srcs, nr, n);
+        cb(dtype::Int8);
+        cb(dtype::Uint8);
+        cb(dtype::Int32);
+        cb(dtype::Float32);
+#if !MEGDNN_DISABLE_FLOAT16
+        cb(dtype::Float16);
+#endif
+#undef cb
+        default:
+            mgb_throw(
+                    MegBrainError, "bad dtype for shm CollectiveComm: %s",
+                    dtype.name());
+    }
+}
+
+//! part of [0, n) owned by rank among size ranks
+void split(size_t n, uint32_t size, uint32_t rank, size_t& begin, size_t& end) {
+    begin = n * rank / size;
+    end = n * (rank + 1) / size;
+}
+
+}  // anonymous namespace
+
+/* ================= ShmCommunicator ================= */
+
+ShmCommunicator::ShmCommunicator(
+        const std::string& name, uint32_t size, uint32_t rank, const Barrier& barrier)
+        : m_size{size}, m_rank{rank} {
+    mgb_assert(size > 0 && rank < size, "bad rank %u of %u ranks", rank, size);
+    // two buffers for each slot and two for the reduced chunks
+    m_segment_size = Header::padded_size() + (size + 1) * 2 * CHUNK_SIZE;
+    int fd;
+    if (rank == 0) {
+        // remove the segment left by a crashed job with the same name
+        shm_unlink(name.c_str());
+        fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        mgb_throw_if(
+                fd < 0, SystemError, "failed to create shared memory %s: %s",
+                name.c_str(), strerror(errno));
+        if (ftruncate(fd, m_segment_size) != 0) {
+            auto err = errno;
+            close(fd);
+            mgb_throw(
+                    SystemError, "failed to resize shared memory %s: %s",
+                    name.c_str(), strerror(err));
+        }
+    }
+    barrier();
+    if (rank != 0) {
+        fd = shm_open(name.c_str(), O_RDWR, 0600);
+        mgb_throw_if(
+                fd < 0, SystemError, "failed to open shared memory %s: %s",
+                name.c_str(), strerror(errno));
+    }
+    m_segment =
+            mmap(nullptr, m_segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    mgb_throw_if(
+            m_segment == MAP_FAILED, SystemError, "failed to map shared memory %s: %s",
+            name.c_str(), strerror(errno));
+    m_header = static_cast<Header*>(m_segment);
+    if (rank == 0) {
+        m_header->magic = Header::MAGIC;
+        m_header->size = size;
+        m_header->nr_arrived.store(0);
+        m_header->generation.store(0);
+    }
+    barrier();
+    mgb_assert(
+            m_header->magic == Header::MAGIC && m_header->size == size,
+            "bad shared memory segment %s", name.c_str());
+    if (rank == 0) {
+        // the segment stays alive until all the ranks unmap it
+        shm_unlink(name.c_str());
+    }
+}
+
+ShmCommunicator::~ShmCommunicator() {
+    if (m_segment) {
+        munmap(m_segment, m_segment_size);
+    }
+}
+
+std::shared_ptr<ShmCommunicator> ShmCommunicator::get(
+        uint64_t hash, uint32_t size, uint32_t rank,
+        std::shared_ptr<GroupClient> group_client) {
+    static std::mutex mtx;
+    //! ranks of a group may live in one process, so they are cached separately
+    static std::map<std::pair<uint64_t, uint32_t>, std::shared_ptr<ShmCommunicator>>
+            comms;
+    auto key = std::make_pair(hash, rank);
+    {
+        MGB_LOCK_GUARD(mtx);
+        auto iter = comms.find(key);
+        if (iter != comms.end()) {
+            return iter->second;
+        }
+    }
+
+    // the constructor waits for the other ranks, so it must not hold the lock
+    auto&& addr = group_client->get_addr();
+    // the server address distinguishes jobs on the same host
+    auto job_hash = XXHash{}.update(addr.data(), addr.size()).digest();
+    auto name = ssprintf(
+            "/mgb_comm_%016llx_%016llx", static_cast<unsigned long long>(job_hash),
+            static_cast<unsigned long long>(hash));
+    auto barrier = [size, rank, group_client]() {
+        group_client->group_barrier(size, rank);
+    };
+    auto comm = std::make_shared<ShmCommunicator>(name, size, rank, barrier);
+
+    MGB_LOCK_GUARD(mtx);
+    return comms.emplace(key, std::move(comm)).first->second;
+}
+
+uint8_t* ShmCommunicator::slot(uint32_t rank, size_t buf) const {
+    return static_cast<uint8_t*>(m_segment) + Header::padded_size() +
+           (rank * 2 + buf) * CHUNK_SIZE;
+}
+
+uint8_t* ShmCommunicator::result(size_t buf) const {
+    return slot(m_size, buf);
+}
+
+void ShmCommunicator::barrier() {
+    auto gen = m_header->generation.load(std::memory_order_acquire);
+    if (m_header->nr_arrived.fetch_add(1, std::memory_order_acq_rel) + 1 == m_size) {
+        m_header->nr_arrived.store(0, std::memory_order_relaxed);
+        m_header->generation.fetch_add(1, std::memory_order_release);
+        return;
+    }
+    for (size_t spin = 0;
+         m_header->generation.load(std::memory_order_acquire) == gen; ++spin) {
+        if (spin >= 1024) {
+            std::this_thread::yield();
+        }
+    }
+}
+
+void ShmCommunicator::all_reduce(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype, ReduceOp op) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem;
+    std::vector<const void*> srcs(m_size);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf(), begin, end;
+        memcpy(slot(m_rank, buf), send + off * elem, n * elem);
+        barrier();
+        // reduce-scatter: reduce the owned part of the chunk
+        split(n, m_size, m_rank, begin, end);
+        for (uint32_t r = 0; r < m_size; ++r) {
+            srcs[r] = slot(r, buf) + begin * elem;
+        }
+        reduce_bufs(
+                op, dtype, result(buf) + begin * elem, srcs.data(), m_size,
+                end - begin);
+        barrier();
+        // all-gather: collect the reduced parts of all the ranks
+        memcpy(recv + off * elem, result(buf), n * elem);
+    }
+}
+
+void ShmCommunicator::reduce(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype, ReduceOp op,
+        uint32_t root) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem;
+    std::vector<const void*> srcs(m_size);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf();
+        memcpy(slot(m_rank, buf), send + off * elem, n * elem);
+        barrier();
+        if (m_rank == root) {
+            for (uint32_t r = 0; r < m_size; ++r) {
+                srcs[r] = slot(r, buf);
+            }
+            reduce_bufs(op, dtype, recv + off * elem, srcs.data(), m_size, n);
+        }
+    }
+    barrier();
+}
+
+void ShmCommunicator::reduce_scatter(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype, ReduceOp op) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem / m_size;
+    mgb_assert(chunk, "too many ranks for shm CollectiveComm: %u", m_size);
+    std::vector<const void*> srcs(m_size);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf();
+        // the slot holds the chunks of all the parts
+        for (uint32_t r = 0; r < m_size; ++r) {
+            memcpy(slot(m_rank, buf) + r * n * elem, send + (r * len + off) * elem,
+                   n * elem);
+        }
+        barrier();
+        for (uint32_t r = 0; r < m_size; ++r) {
+            srcs[r] = slot(r, buf) + m_rank * n * elem;
+        }
+        reduce_bufs(op, dtype, recv + off * elem, srcs.data(), m_size, n);
+    }
+    barrier();
+}
+
+void ShmCommunicator::all_gather(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem;
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf();
+        memcpy(slot(m_rank, buf), send + off * elem, n * elem);
+        barrier();
+        for (uint32_t r = 0; r < m_size; ++r) {
+            memcpy(recv + (r * len + off) * elem, slot(r, buf), n * elem);
+        }
+    }
+    barrier();
+}
+
+void ShmCommunicator::gather(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype, uint32_t root) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem;
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf();
+        memcpy(slot(m_rank, buf), send + off * elem, n * elem);
+        barrier();
+        if (m_rank == root) {
+            for (uint32_t r = 0; r < m_size; ++r) {
+                memcpy(recv + (r * len + off) * elem, slot(r, buf), n * elem);
+            }
+        }
+    }
+    barrier();
+}
+
+void ShmCommunicator::broadcast(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype, uint32_t root) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem;
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf();
+        if (m_rank == root) {
+            memcpy(slot(root, buf), send + off * elem, n * elem);
+        }
+        barrier();
+        if (m_rank != root) {
+            memcpy(recv + off * elem, slot(root, buf), n * elem);
+        }
+    }
+    if (m_rank == root && recv != send) {
+        memcpy(recv, send, len * elem);
+    }
+    barrier();
+}
+
+void ShmCommunicator::scatter(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype, uint32_t root) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem / m_size;
+    mgb_assert(chunk, "too many ranks for shm CollectiveComm: %u", m_size);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf();
+        if (m_rank == root) {
+            for (uint32_t r = 0; r < m_size; ++r) {
+                memcpy(slot(root, buf) + r * n * elem, send + (r * len + off) * elem,
+                       n * elem);
+            }
+        }
+        barrier();
+        memcpy(recv + off * elem, slot(root, buf) + m_rank * n * elem, n * elem);
+    }
+    barrier();
+}
+
+void ShmCommunicator::all_to_all(
+        const void* sendbuff, void* recvbuff, size_t len, DType dtype) {
+    auto send = static_cast<const uint8_t*>(sendbuff);
+    auto recv = static_cast<uint8_t*>(recvbuff);
+    size_t elem = dtype.size(), chunk = CHUNK_SIZE / elem / m_size;
+    mgb_assert(chunk, "too many ranks for shm CollectiveComm: %u", m_size);
+    for (size_t off = 0; off < len; off += chunk) {
+        size_t n = std::min(chunk, len - off), buf = next_buf();
+        for (uint32_t r = 0; r < m_size; ++r) {
+            memcpy(slot(m_rank, buf) + r * n * elem, send + (r * len + off) * elem,
+                   n * elem);
+        }
+        barrier();
+        for (uint32_t r = 0; r < m_size; ++r) {
+            memcpy(recv + (r * len + off) * elem, slot(r, buf) + m_rank * n * elem,
+                   n * elem);
+        }
+    }
+    barrier();
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -3,7 +3,11 @@
 #include "megbrain/graph.h"
 #include "megbrain/opr/group_manager.h"
 #include "megbrain/opr/param_defs.h"
+#include "megbrain/opr/shm_comm.h"
+
+#if MGB_ENABLE_MEGRAY
 #include "megray.h"
+#endif
 
 namespace mgb {
 namespace opr {
@@ -72,7 +76,9 @@ public:
 
     uint64_t pack_hash() const { return m_pack_hash; }
 
+#if MGB_ENABLE_MEGRAY
     std::shared_ptr<MegRay::Context> megray_ctx() const { return m_megray_ctx; }
+#endif
 
     VarNode* grad(VarNode* out_grad) const;
 
@@ -118,8 +124,12 @@ private:
     //! set in PackAllReduceScanPass and used in PackAllReduceReplacePass
     uint64_t m_pack_hash = 0;
 
+#if MGB_ENABLE_MEGRAY
     std::shared_ptr<MegRay::Context> m_megray_ctx;
     std::shared_ptr<MegRay::Communicator> m_megray_comm;
+#endif
+    //! communicator of the "shm" backend, used instead of m_megray_comm
+    std::shared_ptr<ShmCommunicator> m_shm_comm;
     bool m_init = false;
     bool m_debug_mode = false;
 
@@ -115,6 +115,9 @@ private:
     //! barrier
     uint32_t m_barrier_size;
     std::set<uint32_t> m_barrier_set;
+    //! incremented when all ranks reach the barrier, so that a rank entering
+    //! the next barrier early does not block the waiters of the previous one
+    uint64_t m_barrier_generation = 0;
     std::mutex m_barrier_mtx;
     std::condition_variable m_barrier_cv;
 };
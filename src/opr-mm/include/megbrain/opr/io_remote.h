@@ -4,7 +4,9 @@
 #include "megbrain/opr/group_manager.h"
 #include "megbrain/opr/internal/mixin_base.h"
 
+#if MGB_ENABLE_MEGRAY
 #include "megray.h"
+#endif
 
 namespace mgb {
 namespace opr {
@@ -21,8 +23,10 @@ public:
 protected:
     std::string m_key;
     std::shared_ptr<GroupClient> m_group_client;
+#if MGB_ENABLE_MEGRAY
     std::shared_ptr<MegRay::Communicator> m_megray_comm;
     std::shared_ptr<MegRay::Context> m_megray_ctx;
+#endif
     bool m_init = false;
     using Super::Super;
 };
@@ -1,5 +1,9 @@
 #pragma once
 
+#include "megbrain_build_config.h"
+
+#if MGB_ENABLE_MEGRAY
+
 #include <memory>
 #include <mutex>
 
@@ -41,4 +45,6 @@ public:
 }  // namespace opr
 }  // namespace mgb
 
+#endif  // MGB_ENABLE_MEGRAY
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
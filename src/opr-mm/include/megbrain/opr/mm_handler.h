@@ -75,6 +75,7 @@ public:
     void operator=(ProcessGlobal const&) = delete;
 };
 
+#if MGB_ENABLE_MEGRAY
 class BatchSendRecvHelper : public ProcessGlobal<BatchSendRecvHelper> {
     static std::unordered_map<std::string, std::shared_ptr<MegRay::Communicator>>
             megray_comm_cache;
@@ -83,6 +84,7 @@ public:
     std::shared_ptr<MegRay::Communicator> get(std::string&&);
     bool init(int nranks, int rank, std::string ip, int port, int root);
 };
+#endif
 
 /* ======================== ZmqRpcServerMgr ========================== */
 
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "megbrain/dtype.h"
+#include "megbrain/opr/group_manager.h"
+#include "megbrain/utils/thin/function.h"
+
+namespace mgb {
+namespace opr {
+
+/*!
+ * \brief collective communication between processes on the same host through a
+ *      POSIX shared memory segment
+ *
+ * Every rank owns a slot of two chunk buffers in the segment. Data are
+ * processed chunk by chunk: each rank copies its chunk into its slot, and after
+ * a barrier reads the slots of its peers; a reduction is split into a
+ * reduce-scatter, where each rank reduces its own part of the chunk over all
+ * the slots, followed by an all-gather of the reduced parts. The two buffers of
+ * a slot are used alternately, so that the next chunk can be copied in while
+ * the peers are still reading the previous one, and one barrier per chunk
+ * suffices except for all_reduce.
+ *
+ * The buffers must be in host memory.
+ *
+ * Unlike the other backends it does not need MegRay, so it is also available
+ * in distributed builds without CUDA or ROCm.
+ */
+class ShmCommunicator {
+public:
+    enum class ReduceOp { SUM, MAX, MIN };
+    //! blocks until all the ranks reach it
+    using Barrier = thin_function<void()>;
+
+    //! size in bytes of each chunk buffer
+    static constexpr size_t CHUNK_SIZE = 256 * 1024;
+
+    /*!
+     * \brief create the segment on rank 0 and attach to it on other ranks
+     *
+     * \param name name of the segment, which is unlinked once all the ranks
+     *      have attached to it
+     * \param barrier barrier between all the ranks out of the segment
+     */
+    ShmCommunicator(
+            const std::string& name, uint32_t size, uint32_t rank,
+            const Barrier& barrier);
+    ~ShmCommunicator();
+
+    ShmCommunicator(const ShmCommunicator&) = delete;
+    ShmCommunicator& operator=(const ShmCommunicator&) = delete;
+
+    /*!
+     * \brief get the communicator of given rank of a group, which is created at
+     *      the first call with group_client used for synchronization
+     *
+     * Several ranks of a group may be created concurrently in one process.
+     */
+    static std::shared_ptr<ShmCommunicator> get(
+            uint64_t hash, uint32_t size, uint32_t rank,
+            std::shared_ptr<GroupClient> group_client);
+
+    uint32_t size() const { return m_size; }
+    uint32_t rank() const { return m_rank; }
+
+    //! block until all the ranks reach it
+    void barrier();
+
+    //! recvbuff of \p len elements is the reduction of all the sendbuffs
+    void all_reduce(
+            const void* sendbuff, void* recvbuff, size_t len, DType dtype,
+            ReduceOp op);
+
+    //! like all_reduce(), but only \p root receives the result
+    void reduce(
+            const void* sendbuff, void* recvbuff, size_t len, DType dtype,
+            ReduceOp op, uint32_t root);
+
+    //! recvbuff of \p len elements is the rank-th part of the reduction
+    void reduce_scatter(
+            const void* sendbuff, void* recvbuff, size_t len, DType dtype,
+            ReduceOp op);
+
+    //! recvbuff is the concatenation of sendbuffs of \p len elements
+    void all_gather(const void* sendbuff, void* recvbuff, size_t len, DType dtype);
+
+    //! like all_gather(), but only \p root receives the result
+    void gather(
+            const void* sendbuff, void* recvbuff, size_t len, DType dtype,
+            uint32_t root);
+
+    //! recvbuff of \p len elements is copied from sendbuff of \p root
+    void broadcast(
+            const void* sendbuff, void* recvbuff, size_t len, DType dtype,
+            uint32_t root);
+
+    //! recvbuff of \p len elements is the rank-th part of sendbuff of \p root
+    void scatter(
+            const void* sendbuff, void* recvbuff, size_t len, DType dtype,
+            uint32_t root);
+
+    //! the i-th part of recvbuff is the rank-th part of sendbuff of rank i,
+    //! where each part has \p len elements
+    void all_to_all(const void* sendbuff, void* recvbuff, size_t len, DType dtype);
+
+private:
+    struct Header;
+
+    uint32_t m_size, m_rank;
+    size_t m_segment_size;
+    void* m_segment = nullptr;
+    Header* m_header = nullptr;
+    //! buffer index of the next chunk
+    size_t m_buf = 0;
+
+    //! buffer \p buf of the slot of \p rank
+    uint8_t* slot(uint32_t rank, size_t buf) const;
+    //! buffer holding reduced chunks of all_reduce()
+    uint8_t* result(size_t buf) const;
+    //! switch to the other buffer and return the current one
+    size_t next_buf() { return (m_buf ^= 1) ^ 1; }
+};
+
+}  // namespace opr
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -0,0 +1,201 @@
+#include "megbrain/opr/shm_comm.h"
+#include "megbrain/opr/basic_arith.h"
+#include "megbrain/opr/collective_comm.h"
+#include "megbrain/opr/io.h"
+#include "megbrain/test/helper.h"
+#include "mock_client.h"
+
+#include <sys/mman.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <atomic>
+#include <thread>
+
+using namespace mgb;
+
+namespace {
+
+using ReduceOp = opr::ShmCommunicator::ReduceOp;
+
+//! barrier between forked processes in an anonymous shared mapping
+struct ProcessBarrier {
+    std::atomic<uint32_t> nr_arrived{0}, generation{0};
+
+    void wait(uint32_t size) {
+        auto gen = generation.load();
+        if (nr_arrived.fetch_add(1) + 1 == size) {
+            nr_arrived.store(0);
+            generation.fetch_add(1);
+            return;
+        }
+        while (generation.load() == gen) {
+            std::this_thread::yield();
+        }
+    }
+};
+
+float value_of(uint32_t rank, size_t i) {
+    return static_cast<float>((rank * 7 + i) % 13);
+}
+
+//! run the collectives on given rank and return the number of wrong results
+size_t run_rank(opr::ShmCommunicator& comm, size_t len) {
+    uint32_t size = comm.size(), rank = comm.rank();
+    size_t nr_error = 0;
+    std::vector<float> send(len * size), recv(len * size);
+    for (size_t i = 0; i < len * size; ++i) {
+        send[i] = value_of(rank, i);
+    }
+
+    comm.all_reduce(send.data(), recv.data(), len, dtype::Float32(), ReduceOp::SUM);
+    for (size_t i = 0; i < len; ++i) {
+        float expect = 0;
+        for (uint32_t r = 0; r < size; ++r) {
+            expect += value_of(r, i);
+        }
+        nr_error += recv[i] != expect;
+    }
+
+    comm.reduce_scatter(
+            send.data(), recv.data(), len, dtype::Float32(), ReduceOp::MAX);
+    for (size_t i = 0; i < len; ++i) {
+        float expect = 0;
+        for (uint32_t r = 0; r < size; ++r) {
+            expect = std::max(expect, value_of(r, rank * len + i));
+        }
+        nr_error += recv[i] != expect;
+    }
+
+    comm.all_gather(send.data(), recv.data(), len, dtype::Float32());
+    for (size_t i = 0; i < len * size; ++i) {
+        nr_error += recv[i] != value_of(i / len, i % len);
+    }
+
+    comm.all_to_all(send.data(), recv.data(), len, dtype::Float32());
+    for (size_t i = 0; i < len * size; ++i) {
+        nr_error += recv[i] != value_of(i / len, rank * len + i % len);
+    }
+
+    uint32_t root = size - 1;
+    comm.broadcast(send.data(), recv.data(), len, dtype::Float32(), root);
+    for (size_t i = 0; i < len; ++i) {
+        nr_error += recv[i] != value_of(root, i);
+    }
+
+    // in-place reduction of another dtype
+    std::vector<int32_t> data(len, rank + 1);
+    comm.all_reduce(data.data(), data.data(), len, dtype::Int32(), ReduceOp::MIN);
+    for (size_t i = 0; i < len; ++i) {
+        nr_error += data[i] != 1;
+    }
+    return nr_error;
+}
+
+}  // anonymous namespace
+
+TEST(TestShmComm, MultiProcess) {
+    constexpr uint32_t SIZE = 4;
+    // not a multiple of the chunk size
+    constexpr size_t LEN = 200003;
+    auto barrier_mem = mmap(
+            nullptr, sizeof(ProcessBarrier), PROT_READ | PROT_WRITE,
+            MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    ASSERT_NE(MAP_FAILED, barrier_mem);
+    auto process_barrier = new (barrier_mem) ProcessBarrier;
+    auto name = ssprintf("/mgb_test_shm_comm_%d", static_cast<int>(getpid()));
+
+    std::vector<pid_t> pids;
+    for (uint32_t rank = 0; rank < SIZE; ++rank) {
+        auto pid = fork();
+        ASSERT_GE(pid, 0);
+        if (pid == 0) {
+            size_t nr_error = 1;
+            MGB_TRY {
+                opr::ShmCommunicator comm{
+                        name, SIZE, rank, [=]() { process_barrier->wait(SIZE); }};
+                nr_error = run_rank(comm, LEN);
+            }
+            MGB_CATCH(std::exception & exc, {
+                fprintf(stderr, "rank %u: %s\n", rank, exc.what());
+            });
+            _exit(nr_error != 0);
+        }
+        pids.push_back(pid);
+    }
+    for (auto pid : pids) {
+        int status;
+        ASSERT_EQ(pid, waitpid(pid, &status, 0));
+        ASSERT_TRUE(WIFEXITED(status));
+        ASSERT_EQ(0, WEXITSTATUS(status));
+    }
+    munmap(barrier_mem, sizeof(ProcessBarrier));
+}
+
+TEST(TestShmComm, GetInProcess) {
+    constexpr uint32_t SIZE = 3;
+    constexpr size_t LEN = 1000;
+    auto client = std::make_shared<test::MockGroupClient>();
+    std::shared_ptr<opr::ShmCommunicator> comms[SIZE];
+    size_t nr_error[SIZE];
+    // the ranks of a group are created concurrently in one process
+    auto run = [&](uint32_t rank) {
+        auto comm = opr::ShmCommunicator::get(1, SIZE, rank, client);
+        comms[rank] = comm;
+        nr_error[rank] = comm != opr::ShmCommunicator::get(1, SIZE, rank, client);
+        nr_error[rank] += run_rank(*comm, LEN);
+    };
+    std::vector<std::thread> threads;
+    for (uint32_t rank = 0; rank < SIZE; ++rank) {
+        threads.emplace_back(run, rank);
+    }
+    for (auto&& i : threads) {
+        i.join();
+    }
+    for (uint32_t rank = 0; rank < SIZE; ++rank) {
+        ASSERT_EQ(rank, comms[rank]->rank());
+        ASSERT_EQ(0u, nr_error[rank]);
+    }
+}
+
+TEST(TestOprCollectiveComm, ShmAllReduce) {
+    using Mode = opr::CollectiveComm::Param::Mode;
+    HostTensorGenerator<> gen;
+    auto host_x0 = gen({28, 28}), host_x1 = gen({28, 28});
+    auto client = std::make_shared<test::MockGroupClient>();
+
+    auto run_mode = [&](Mode mode, const char* key) {
+        HostTensorND host_y0, host_y1, host_y_expect;
+        auto run = [&](int rank, std::shared_ptr<HostTensorND> host_x,
+                       HostTensorND& host_y) {
+            auto cn = CompNode::load(ssprintf("cpu%d", rank));
+            auto graph = ComputingGraph::make();
+            auto x = opr::Host2DeviceCopy::make(*graph, host_x, cn);
+            auto y = opr::CollectiveComm::make(
+                    {x}, graph.get(), key, 2, false, rank, false, client, {mode},
+                    dtype::Float32(), "shm")[0];
+            auto func = graph->compile({make_callback_copy(y, host_y)});
+            func->execute().wait();
+        };
+        std::thread t0{[&]() { run(0, host_x0, host_y0); }};
+        std::thread t1{[&]() { run(1, host_x1, host_y1); }};
+        t0.join();
+        t1.join();
+
+        auto graph = ComputingGraph::make();
+        auto x0 = opr::Host2DeviceCopy::make(*graph, host_x0),
+             x1 = opr::Host2DeviceCopy::make(*graph, host_x1);
+        auto elemwise_mode = mode == Mode::ALL_REDUCE_SUM
+                                   ? opr::Elemwise::Mode::ADD
+                                   : opr::Elemwise::Mode::MAX;
+        auto y_expect = opr::Elemwise::make({x0, x1}, elemwise_mode);
+        graph->compile({make_callback_copy(y_expect, host_y_expect)})->execute();
+
+        MGB_ASSERT_TENSOR_EQ(host_y_expect, host_y0);
+        MGB_ASSERT_TENSOR_EQ(host_y_expect, host_y1);
+    };
+
+    run_mode(Mode::ALL_REDUCE_SUM, "shm_all_reduce_sum");
+    run_mode(Mode::ALL_REDUCE_MAX, "shm_all_reduce_max");
+}
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
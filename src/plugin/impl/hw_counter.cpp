@@ -0,0 +1,227 @@
+#include "megbrain/plugin/hw_counter.h"
+
+#include <algorithm>
+#include <cstdlib>
+
+#if MGB_HAVE_PERF_EVENT
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+using namespace mgb;
+
+namespace {
+#if MGB_HAVE_PERF_EVENT
+struct CounterDesc {
+    uint64_t config;
+    uint64_t HwCounter::Values::*field;
+};
+
+constexpr CounterDesc COUNTERS[] = {
+        {PERF_COUNT_HW_CPU_CYCLES, &HwCounter::Values::cycles},
+        {PERF_COUNT_HW_INSTRUCTIONS, &HwCounter::Values::instructions},
+        {PERF_COUNT_HW_CACHE_MISSES, &HwCounter::Values::llc_misses},
+        {PERF_COUNT_HW_BRANCH_MISSES, &HwCounter::Values::branch_misses},
+};
+constexpr size_t NR_COUNTERS = sizeof(COUNTERS) / sizeof(COUNTERS[0]);
+
+/*!
+ * \brief counters of a thread opened as a group, whose leader is the first one
+ *      successfully opened
+ */
+class CounterGroup final : public NonCopyableObj {
+    int m_fd[NR_COUNTERS];
+    //! counters in the order they appear in the group
+    const CounterDesc* m_opened[NR_COUNTERS];
+    size_t m_nr_opened = 0;
+
+    struct ReadFormat {
+        uint64_t nr, time_enabled, time_running;
+        uint64_t values[NR_COUNTERS];
+    };
+
+    int leader() const { return m_nr_opened ? m_fd[0] : -1; }
+
+    static int open(uint64_t config, int group_fd) {
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HARDWARE;
+        attr.size = sizeof(attr);
+        attr.config = config;
+        attr.disabled = group_fd < 0;
+        // counting user space only is allowed under perf_event_paranoid=2
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED |
+                           PERF_FORMAT_TOTAL_TIME_RUNNING;
+        return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+    }
+
+public:
+    CounterGroup() {
+        for (auto&& desc : COUNTERS) {
+            int fd = open(desc.config, leader());
+            if (fd >= 0) {
+                m_fd[m_nr_opened] = fd;
+                m_opened[m_nr_opened++] = &desc;
+            }
+        }
+        if (m_nr_opened) {
+            ioctl(leader(), PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+
+    ~CounterGroup() {
+        for (size_t i = m_nr_opened; i; --i) {
+            close(m_fd[i - 1]);
+        }
+    }
+
+    bool available() const { return m_nr_opened; }
+
+    HwCounter::Values read() const {
+        HwCounter::Values ret;
+        ReadFormat buf;
+        if (!m_nr_opened || ::read(leader(), &buf, sizeof(buf)) <= 0 ||
+            buf.nr != m_nr_opened) {
+            return ret;
+        }
+        double scale = 1;
+        if (buf.time_running && buf.time_running < buf.time_enabled) {
+            scale = static_cast<double>(buf.time_enabled) / buf.time_running;
+        }
+        for (size_t i = 0; i < m_nr_opened; ++i) {
+            ret.*(m_opened[i]->field) = static_cast<uint64_t>(buf.values[i] * scale);
+        }
+        return ret;
+    }
+
+    static CounterGroup& inst() {
+        thread_local CounterGroup group;
+        return group;
+    }
+};
+#endif  // MGB_HAVE_PERF_EVENT
+
+double getenv_double(const char* name) {
+    auto val = MGB_GETENV(name);
+    return val ? atof(val) : 0;
+}
+}  // anonymous namespace
+
+/* ===================== HwCounter ===================== */
+
+HwCounter::Values& HwCounter::Values::operator+=(const Values& rhs) {
+    cycles += rhs.cycles;
+    instructions += rhs.instructions;
+    llc_misses += rhs.llc_misses;
+    branch_misses += rhs.branch_misses;
+    return *this;
+}
+
+HwCounter::Values HwCounter::Values::operator-(const Values& rhs) const {
+    // scaled values of multiplexed counters are not strictly monotonic
+    auto sub = [](uint64_t a, uint64_t b) -> uint64_t { return a > b ? a - b : 0; };
+    Values ret;
+    ret.cycles = sub(cycles, rhs.cycles);
+    ret.instructions = sub(instructions, rhs.instructions);
+    ret.llc_misses = sub(llc_misses, rhs.llc_misses);
+    ret.branch_misses = sub(branch_misses, rhs.branch_misses);
+    return ret;
+}
+
+bool HwCounter::available() {
+#if MGB_HAVE_PERF_EVENT
+    return CounterGroup::inst().available();
+#else
+    return false;
+#endif
+}
+
+HwCounter::Values HwCounter::read_this_thread() {
+#if MGB_HAVE_PERF_EVENT
+    return CounterGroup::inst().read();
+#else
+    return {};
+#endif
+}
+
+/* ===================== RooflinePeak ===================== */
+
+RooflinePeak RooflinePeak::from_env() {
+    RooflinePeak ret;
+    ret.gflops = getenv_double("MGB_PROFILE_PEAK_GFLOPS");
+    ret.gbps = getenv_double("MGB_PROFILE_PEAK_GBPS");
+    return ret;
+}
+
+/* ===================== HwCounterStat ===================== */
+
+void HwCounterStat::add(const HwCounter::Values& delta, double time) {
+    counters += delta;
+    this->time += time;
+    ++nr_run;
+}
+
+std::vector<std::pair<const char*, double>> HwCounterStat::metrics(
+        const OprFootprint::Result& footprint, const RooflinePeak& peak) const {
+    std::vector<std::pair<const char*, double>> ret{
+            {"nr_run", nr_run}, {"time", time}, {"nr_threads", nr_threads}};
+    // the counters of the dispatcher thread only cover a part of the kernels
+    // of a multi-thread comp node, while time and footprint cover all of them
+    bool per_thread = nr_threads <= 1;
+    if (per_thread) {
+        ret.emplace_back("cycles", counters.cycles);
+        ret.emplace_back("instructions", counters.instructions);
+        ret.emplace_back("llc_misses", counters.llc_misses);
+        ret.emplace_back("branch_misses", counters.branch_misses);
+    }
+    if (!nr_run) {
+        return ret;
+    }
+    double flops = static_cast<double>(footprint.computation) * nr_run,
+           bytes = static_cast<double>(footprint.memory) * nr_run;
+    if (per_thread && counters.cycles) {
+        ret.emplace_back("ipc", counters.instructions / double(counters.cycles));
+    }
+    double gflops = 0;
+    if (flops && time > 0) {
+        gflops = flops / time * 1e-9;
+        ret.emplace_back("gflops", gflops);
+    }
+    if (per_thread && bytes && counters.cycles) {
+        ret.emplace_back("bytes_per_cycle", bytes / counters.cycles);
+    }
+    if (flops && bytes) {
+        double intensity = flops / bytes;
+        ret.emplace_back("arith_intensity", intensity);
+        if (peak.valid()) {
+            // the ridge point of the roofline is at peak.gflops / peak.gbps
+            double mem_roof = intensity * peak.gbps,
+                   attainable = std::min(mem_roof, peak.gflops);
+            ret.emplace_back("attainable_gflops", attainable);
+            if (gflops) {
+                ret.emplace_back("roofline_efficiency", gflops / attainable);
+            }
+            ret.emplace_back("memory_bound", mem_roof < peak.gflops);
+        }
+    }
+    return ret;
+}
+
+#if MGB_ENABLE_JSON
+std::shared_ptr<json::Value> HwCounterStat::to_json(
+        const OprFootprint::Result& footprint, const RooflinePeak& peak) const {
+    auto ret = json::Object::make();
+    auto&& obj = *ret;
+    for (auto&& i : metrics(footprint, peak)) {
+        obj[i.first] = json::Number::make(i.second);
+    }
+    return ret;
+}
+#endif
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
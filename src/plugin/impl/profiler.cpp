@@ -2,6 +2,7 @@
 #include "megbrain/plugin/opr_footprint.h"
 
 #if MGB_ENABLE_JSON
+#include "megbrain/comp_node_env.h"
 #include "megbrain/graph/event.h"
 #include "megbrain/opr/io.h"
 #include "megbrain/system.h"
@@ -68,6 +69,8 @@ GraphProfiler::GraphProfiler(cg::ComputingGraph* graph) : PluginBase(graph) {
         }
 
         record_event(*evptr, event.comp_node);
+        record_hw_counter(event.opr, event.comp_node, true);
+        trace_thread_pool(event.opr, event.comp_node, true);
     };
     auto on_after_kern = [this](AfterKernel const& event) {
         if (!opr_filter(event.opr))
@@ -78,6 +81,9 @@ GraphProfiler::GraphProfiler(cg::ComputingGraph* graph) : PluginBase(graph) {
             MGB_LOCK_GUARD(m_mtx);
             evptr = &m_kern_event[{event.opr, event.comp_node}].end;
         }
+        // stop tracing before the end event, which is waited in to_json()
+        record_hw_counter(event.opr, event.comp_node, false);
+        trace_thread_pool(event.opr, event.comp_node, false);
         record_event(*evptr, event.comp_node);
     };
     auto on_graph_compile = [this](const CompSeqOrderDetermined&) {
@@ -85,6 +91,8 @@ GraphProfiler::GraphProfiler(cg::ComputingGraph* graph) : PluginBase(graph) {
         m_host_time.clear();
         m_kern_event.clear();
         m_opr_fp_rst.clear();
+        m_hw_counter.clear();
+        m_thread_pool_stat.clear();
         m_start_of_time = None;
     };
     auto&& ev = graph->event();
@@ -94,6 +102,13 @@ GraphProfiler::GraphProfiler(cg::ComputingGraph* graph) : PluginBase(graph) {
     add_event_handler(ev.register_receiver<BeforeKernel>(on_before_kern));
     add_event_handler(ev.register_receiver<AfterKernel>(on_after_kern));
     add_event_handler(ev.register_receiver<CompSeqOrderDetermined>(on_graph_compile));
+
+    if (MGB_GETENV("MGB_PROFILE_HW_COUNTER")) {
+        enable_hw_counter(RooflinePeak::from_env());
+    }
+    if (MGB_GETENV("MGB_PROFILE_THREAD_POOL")) {
+        enable_thread_pool_trace();
+    }
 }
 
 GraphProfiler::~GraphProfiler() noexcept {
@@ -130,6 +145,73 @@ void GraphProfiler::record_event(CompNodeEventPtr& dest, CompNode comp_node) {
     dest->record();
 }
 
+void GraphProfiler::enable_hw_counter(const RooflinePeak& peak) {
+    if (!HwCounter::available()) {
+        mgb_log_warn("hardware counters are unavailable on this host");
+    }
+    m_hw_counter_enabled = true;
+    m_roofline_peak = peak;
+}
+
+void GraphProfiler::record_hw_counter(
+        cg::OperatorNodeBase* opr, CompNode comp_node, bool start) {
+    if (!m_hw_counter_enabled)
+        return;
+    auto&& env = CompNodeEnv::from_comp_node(comp_node);
+    if (env.property().type != CompNode::DeviceType::CPU)
+        return;
+
+    OprHwCounter* rec;
+    {
+        MGB_LOCK_GUARD(m_mtx);
+        rec = &m_hw_counter[{opr, comp_node}];
+    }
+    // kernels of a comp node run sequentially on its dispatcher thread, and the
+    // counters are read there as close to the kernel as possible; they do not
+    // include the other threads of its pool, see HwCounterStat::nr_threads
+    if (start) {
+        size_t nr_threads = env.cpu_env().dispatcher->nr_threads();
+        env.cpu_env().dispatch([this, rec, nr_threads]() {
+            rec->stat.nr_threads = nr_threads;
+            rec->start_time = m_timer.get_secs();
+            rec->start = HwCounter::read_this_thread();
+        });
+    } else {
+        env.cpu_env().dispatch([this, rec]() {
+            auto delta = HwCounter::read_this_thread() - rec->start;
+            rec->stat.add(delta, m_timer.get_secs() - rec->start_time);
+        });
+    }
+}
+
+void GraphProfiler::enable_thread_pool_trace() {
+    m_thread_pool_trace_enabled = true;
+}
+
+void GraphProfiler::trace_thread_pool(
+        cg::OperatorNodeBase* opr, CompNode comp_node, bool start) {
+    if (!m_thread_pool_trace_enabled)
+        return;
+    auto&& env = CompNodeEnv::from_comp_node(comp_node);
+    if (env.property().type != CompNode::DeviceType::CPU)
+        return;
+
+    // the kernel is submitted to the thread pool by the dispatcher thread
+    auto tag = reinterpret_cast<uintptr_t>(opr);
+    if (start) {
+        env.cpu_env().dispatch([tag]() { ThreadPoolTrace::set_tag(tag); });
+    } else {
+        env.cpu_env().dispatch([this, opr, comp_node, tag]() {
+            ThreadPoolTrace::set_tag(0);
+            auto stat = ThreadPoolTrace::Stat::make(ThreadPoolTrace::collect(tag));
+            if (!stat.nr_jobs)
+                return;
+            MGB_LOCK_GUARD(m_mtx);
+            m_thread_pool_stat[{opr, comp_node}] += stat;
+        });
+    }
+}
+
 bool GraphProfiler::opr_filter(cg::OperatorNodeBase* opr) {
     static bool only_wait = MGB_GETENV("MGB_PROFILE_ONLY_WAIT");
     if (!only_wait)
@@ -186,6 +268,35 @@ std::shared_ptr<json::Object> GraphProfiler::to_json() const {
         opr_fp_item[tpair.first->id_str()] = tpair.second.to_json();
     }
 
+    auto hw_counter = Object::make();
+    for (auto&& tpair : m_hw_counter) {
+        auto&& opr_prof = visit_json_obj(*hw_counter, tpair.first.first->id_str());
+        auto&& fp = m_opr_fp_rst.at(tpair.first.first);
+        opr_prof[tpair.first.second.to_string()] =
+                tpair.second.stat.to_json(fp, m_roofline_peak);
+    }
+
+    auto thread_pool = Object::make();
+    for (auto&& tpair : m_thread_pool_stat) {
+        auto&& opr_prof = visit_json_obj(*thread_pool, tpair.first.first->id_str());
+        auto&& stat = tpair.second;
+        auto threads = Array::make();
+        for (size_t i = 0; i < stat.thread_busy_ms.size(); ++i) {
+            threads->add(Object::make(
+                    {{"busy_ms", Number::make(stat.thread_busy_ms[i])},
+                     {"nr_tasks", NumberInt::make(stat.thread_nr_tasks[i])}}));
+        }
+        opr_prof[tpair.first.second.to_string()] = Object::make(
+                {{"nr_jobs", NumberInt::make(stat.nr_jobs)},
+                 {"nr_chunks", NumberInt::make(stat.nr_chunks)},
+                 {"nr_tasks", NumberInt::make(stat.nr_tasks)},
+                 {"max_busy_ms", Number::make(stat.max_busy_ms)},
+                 {"mean_busy_ms", Number::make(stat.mean_busy_ms)},
+                 {"straggler_ms", Number::make(stat.straggler_ms)},
+                 {"imbalance", Number::make(stat.imbalance())},
+                 {"threads", threads}});
+    }
+
     auto pf_holder_pair =
             m_owner_graph->options()
                     .user_data.get_user_data<opr_profile::OprProfileHolder>();
@@ -201,7 +312,9 @@ std::shared_ptr<json::Object> GraphProfiler::to_json() const {
             {{"device", dev_prof},
              {"host", host_prof},
              {"opr_footprint", opr_fp},
-             {"opr_internal_pf", opr_internal_pf}});
+             {"opr_internal_pf", opr_internal_pf},
+             {"hw_counter", hw_counter},
+             {"thread_pool", thread_pool}});
 }
 
 #endif  // MGB_ENABLE_JSON
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "megbrain/plugin/opr_footprint.h"
+
+#include <utility>
+#include <vector>
+
+//! whether hardware counters can be read by perf_event_open(2)
+#ifndef MGB_HAVE_PERF_EVENT
+#if defined(__linux__) && !MGB_BUILD_SLIM_SERVING
+#define MGB_HAVE_PERF_EVENT 1
+#else
+#define MGB_HAVE_PERF_EVENT 0
+#endif
+#endif
+
+namespace mgb {
+
+/*!
+ * \brief hardware counters of the calling thread
+ *
+ * Counters are opened by perf_event_open(2) as a group on the first read in
+ * each thread, so that they are scheduled together; if the kernel multiplexes
+ * them, values are scaled by the ratio of enabled time to running time. Counters
+ * unsupported by the host (e.g. in virtual machines, or if forbidden by
+ * perf_event_paranoid) read as zero.
+ */
+class HwCounter {
+public:
+    struct Values {
+        uint64_t cycles = 0, instructions = 0, llc_misses = 0, branch_misses = 0;
+
+        Values& operator+=(const Values& rhs);
+        Values operator-(const Values& rhs) const;
+    };
+
+    //! whether any counter could be opened in the calling thread
+    MGE_WIN_DECLSPEC_FUC static bool available();
+
+    //! read counters of the calling thread since it opened them
+    MGE_WIN_DECLSPEC_FUC static Values read_this_thread();
+};
+
+/*!
+ * \brief peak performance of the machine to place oprs on the roofline
+ *
+ * The roofline position is not reported if either value is zero.
+ */
+struct RooflinePeak {
+    double gflops = 0,  //!< peak arithmetic performance in GFLOPS
+            gbps = 0;   //!< peak memory bandwidth in GB/s
+
+    bool valid() const { return gflops > 0 && gbps > 0; }
+
+    //! read from MGB_PROFILE_PEAK_GFLOPS and MGB_PROFILE_PEAK_GBPS
+    MGE_WIN_DECLSPEC_FUC static RooflinePeak from_env();
+};
+
+/*!
+ * \brief hardware counters accumulated over kernel executions of an opr
+ */
+struct HwCounterStat {
+    HwCounter::Values counters;
+    double time = 0;    //!< total wall time of the kernels in seconds
+    size_t nr_run = 0;  //!< number of kernel executions
+
+    /*!
+     * number of threads of the comp node running the kernels; counters are
+     * only read on its dispatcher thread and miss the chunks run by the other
+     * threads of its pool, so counter based metrics are dropped if it is more
+     * than one
+     */
+    size_t nr_threads = 1;
+
+    void add(const HwCounter::Values& delta, double time);
+
+    /*!
+     * \brief raw counters and metrics derived with the footprint of a single
+     *      execution
+     *
+     * keys:
+     *
+     * nr_run, time, nr_threads
+     * cycles, instructions, llc_misses, branch_misses // if nr_threads is 1
+     * ipc // if nr_threads is 1
+     * gflops // only available if computation is known
+     * bytes_per_cycle // only available if memory is known and nr_threads is 1
+     * arith_intensity // flops per byte
+     * attainable_gflops, roofline_efficiency, memory_bound // if peak is valid
+     */
+    MGE_WIN_DECLSPEC_FUC std::vector<std::pair<const char*, double>> metrics(
+            const OprFootprint::Result& footprint, const RooflinePeak& peak) const;
+
+#if MGB_ENABLE_JSON
+    //! metrics in json format
+    MGE_WIN_DECLSPEC_FUC std::shared_ptr<json::Value> to_json(
+            const OprFootprint::Result& footprint, const RooflinePeak& peak) const;
+#endif
+};
+
+}  // namespace mgb
+
+// vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
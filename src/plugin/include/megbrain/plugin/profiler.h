@@ -2,8 +2,10 @@
 
 #include "megbrain/graph.h"
 #include "megbrain/plugin/base.h"
+#include "megbrain/plugin/hw_counter.h"
 #include "megbrain/plugin/opr_footprint.h"
 #include "megbrain/utils/small_vector.h"
+#include "megbrain/utils/thread_pool.h"
 #include "megbrain/utils/timer.h"
 
 #if MGB_ENABLE_JSON
@@ -54,6 +56,26 @@ class GraphProfiler final : public PluginBase {
             std::pair<cg::OperatorNodeBase*, CompNode>, OprKernEvent, pairhash>
             m_kern_event;
 
+    struct OprHwCounter {
+        HwCounter::Values start;  //!< counters when the kernel starts
+        double start_time = 0;
+        HwCounterStat stat;
+    };
+
+    //! (opr, comp node) => hardware counters of kernels on CPU
+    std::unordered_map<
+            std::pair<cg::OperatorNodeBase*, CompNode>, OprHwCounter, pairhash>
+            m_hw_counter;
+    bool m_hw_counter_enabled = false;
+    RooflinePeak m_roofline_peak;
+
+    //! (opr, comp node) => load balance of multi-thread kernels on CPU
+    std::unordered_map<
+            std::pair<cg::OperatorNodeBase*, CompNode>, ThreadPoolTrace::Stat,
+            pairhash>
+            m_thread_pool_stat;
+    bool m_thread_pool_trace_enabled = false;
+
     //! (opr) => computation and memory usage
     using OprFootprintRst = OprFootprint::Result;
     std::unordered_map<cg::OperatorNodeBase*, OprFootprintRst> m_opr_fp_rst;
@@ -71,10 +93,37 @@ class GraphProfiler final : public PluginBase {
     void ensure_start_time();
     void record_event(CompNodeEventPtr& dest, CompNode comp_node);
 
+    //! start or stop hardware counters of a kernel if it runs on CPU
+    void record_hw_counter(cg::OperatorNodeBase* opr, CompNode comp_node, bool start);
+
+    //! start or stop ThreadPoolTrace of a kernel if it runs on CPU
+    void trace_thread_pool(cg::OperatorNodeBase* opr, CompNode comp_node, bool start);
+
 public:
     MGE_WIN_DECLSPEC_FUC GraphProfiler(cg::ComputingGraph* graph);
     MGE_WIN_DECLSPEC_FUC ~GraphProfiler() noexcept;
 
+    /*!
+     * \brief read hardware counters around kernels on CPU comp nodes
+     *
+     * The counters are read on the dispatcher thread of a comp node, so the
+     * work of the multi-thread kernel workers is not counted. Computation and
+     * memory from OprFootprint are merged with the counters into achieved
+     * performance, and the roofline position if \p peak is valid.
+     *
+     * This is also enabled by setting MGB_PROFILE_HW_COUNTER, with peak from
+     * RooflinePeak::from_env().
+     */
+    MGE_WIN_DECLSPEC_FUC void enable_hw_counter(const RooflinePeak& peak);
+
+    /*!
+     * \brief trace the chunks run by the thread pool of multi-thread CPU comp
+     *      nodes, to report the load balance among the threads for each opr
+     *
+     * This is also enabled by setting MGB_PROFILE_THREAD_POOL.
+     */
+    MGE_WIN_DECLSPEC_FUC void enable_thread_pool_trace();
+
     /*!
      * \brief convert only profiling result to json
      */
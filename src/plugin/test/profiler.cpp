@@ -1,6 +1,8 @@
 #include "megbrain/plugin/profiler.h"
 #include <sstream>
 #include "megbrain/opr/basic_arith.h"
+#include "megbrain/opr/blas.h"
+#include "megbrain/opr/dnn/convolution.h"
 #include "megbrain/opr/io.h"
 #include "megbrain/test/helper.h"
 
@@ -35,4 +37,114 @@ TEST(TestGraphProfiler, APlusBCPU) {
     run_test(CompNode::load("cpu0"), "test_profiler_cpu.json");
 }
 
+namespace {
+//! hw counter result of a matmul run 3 times on \p cn
+std::shared_ptr<json::Value> run_hw_counter(CompNode cn, const char* fpath) {
+    HostTensorGenerator<> gen;
+    auto host_x = gen({64, 1024}, cn), host_y = gen({1024, 256}, cn);
+    auto graph = ComputingGraph::make();
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x).rename("x"),
+         y = opr::Host2DeviceCopy::make(*graph, host_y).rename("y"),
+         z = opr::MatrixMul::make(x, y);
+
+    HostTensorND host_z;
+    auto func = graph->compile({make_callback_copy(z, host_z)});
+    auto profiler = std::make_shared<GraphProfiler>(graph.get());
+    profiler->enable_hw_counter({1000, 10});
+    for (int i = 0; i < 3; ++i) {
+        func->execute().wait();
+    }
+
+    auto root = profiler->to_json();
+    root->writeto_fpath(output_file(fpath));
+    auto get = [](json::Value& obj, const std::string& key) -> json::Value& {
+        auto&& val = static_cast<json::Object&>(obj)[key];
+        mgb_assert(val, "key %s not found", key.c_str());
+        return *val;
+    };
+    auto&& hw_counter = static_cast<json::Object&>(get(*root, "hw_counter"));
+    auto&& opr = static_cast<json::Object&>(
+            get(hw_counter, z.node()->owner_opr()->id_str()));
+    return opr[cn.to_string()];
+}
+
+double get_number(json::Value& obj, const char* key) {
+    auto&& val = static_cast<json::Object&>(obj)[key];
+    mgb_assert(val, "key %s not found", key);
+    return static_cast<json::Number&>(*val).get_impl();
+}
+}  // namespace
+
+TEST(TestGraphProfiler, HwCounterCPU) {
+    auto cn = CompNode::load("cpu0");
+    auto rst = run_hw_counter(cn, "test_profiler_hw_counter.json");
+    ASSERT_TRUE(rst);
+    auto number = [&](const char* key) { return get_number(*rst, key); };
+    ASSERT_EQ(3, number("nr_run"));
+    ASSERT_EQ(1, number("nr_threads"));
+    ASSERT_GT(number("time"), 0);
+    ASSERT_GT(number("gflops"), 0);
+    // the intensity is below the ridge point at 100 flops per byte
+    ASSERT_FLOAT_EQ(10, number("attainable_gflops") / number("arith_intensity"));
+    ASSERT_EQ(1, number("memory_bound"));
+    if (HwCounter::available()) {
+        ASSERT_GT(number("cycles"), 0);
+        ASSERT_GT(number("bytes_per_cycle"), 0);
+    }
+}
+
+TEST(TestGraphProfiler, HwCounterMultiThread) {
+    auto cn = CompNode::load("multithread4:0");
+    auto rst = run_hw_counter(cn, "test_profiler_hw_counter_multithread.json");
+    ASSERT_TRUE(rst);
+    auto number = [&](const char* key) { return get_number(*rst, key); };
+    ASSERT_EQ(3, number("nr_run"));
+    ASSERT_EQ(4, number("nr_threads"));
+    ASSERT_GT(number("gflops"), 0);
+    // counters of the dispatcher thread miss the work of the other threads
+    auto&& obj = static_cast<json::Object&>(*rst);
+    for (auto key : {"cycles", "instructions", "ipc", "bytes_per_cycle"}) {
+        ASSERT_FALSE(obj[key]) << key;
+    }
+}
+
+TEST(TestGraphProfiler, ThreadPoolTrace) {
+    auto cn = CompNode::load("multithread4:0");
+    HostTensorGenerator<> gen;
+    auto host_x = gen({8, 8, 32, 32}, cn), host_w = gen({16, 8, 3, 3}, cn);
+    auto graph = ComputingGraph::make();
+    opr::Convolution::Param param;
+    param.pad_h = param.pad_w = 1;
+    // kernels of convolution are dispatched as multi-thread tasks
+    auto x = opr::Host2DeviceCopy::make(*graph, host_x),
+         w = opr::Host2DeviceCopy::make(*graph, host_w),
+         z = opr::Convolution::make(x, w, param);
+
+    HostTensorND host_z;
+    auto func = graph->compile({make_callback_copy(z, host_z)});
+    auto profiler = std::make_shared<GraphProfiler>(graph.get());
+    profiler->enable_thread_pool_trace();
+    for (int i = 0; i < 3; ++i) {
+        func->execute().wait();
+    }
+
+    auto root = profiler->to_json();
+    root->writeto_fpath(output_file("test_profiler_thread_pool.json"));
+    auto&& thread_pool = static_cast<json::Object&>(*(*root)["thread_pool"]);
+    size_t nr_traced_opr = 0;
+    for (auto&& opr_prof : thread_pool.get_impl()) {
+        auto&& obj = static_cast<json::Object&>(*opr_prof.second);
+        auto&& rst = static_cast<json::Object&>(*obj[cn.to_string()]);
+        auto number = [&](const char* key) {
+            return static_cast<json::NumberInt&>(*rst[key]).get_impl();
+        };
+        ASSERT_EQ(0, number("nr_jobs") % 3);
+        ASSERT_GE(number("nr_tasks"), number("nr_chunks"));
+        auto&& threads = static_cast<json::Array&>(*rst["threads"]);
+        ASSERT_EQ(4u, threads.get_impl().size());
+        ++nr_traced_opr;
+    }
+    ASSERT_GT(nr_traced_opr, 0u);
+}
+
 // vim: syntax=cpp.doxygen foldmethod=marker foldmarker=f{{{,f}}}
@@ -1,5 +1,12 @@
 #include "megbrain/serialization/file.h"
 
+#ifndef WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
 namespace mgb {
 namespace serialization {
 
@@ -233,6 +240,27 @@ std::unique_ptr<InputFile> InputFile::make_mem_proxy(
     return std::make_unique<SharedMemProxyImpl>(std::move(ptr), size, writable);
 }
 
+std::unique_ptr<InputFile> InputFile::make_mmap(const char* path) {
+#ifndef WIN32
+    int fd = open(path, O_RDONLY);
+    mgb_assert(fd >= 0, "failed to open %s: %s", path, strerror(errno));
+    struct stat st;
+    auto err = fstat(fd, &st);
+    mgb_assert(!err, "failed to stat %s: %s", path, strerror(errno));
+    size_t size = st.st_size;
+    mgb_assert(size, "empty file: %s", path);
+    // pages are copy-on-write, so the rare in-place modification of a shared
+    // tensor would not touch the file; the mapping outlives the descriptor
+    void* ptr = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+    close(fd);
+    mgb_assert(ptr != MAP_FAILED, "failed to mmap %s: %s", path, strerror(errno));
+    std::shared_ptr<void> buf{ptr, [size](void* p) { munmap(p, size); }};
+    return std::make_unique<SharedMemProxyImpl>(std::move(buf), size, false);
+#else
+    return make_fs(path);
+#endif
+}
+
 class OutputFile::VectorProxyImpl final : public OutputFile {
     std::vector<uint8_t>* const m_buf;
     size_t m_offset;
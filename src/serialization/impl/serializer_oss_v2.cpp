@@ -2,6 +2,7 @@
 
 #include <map>
 #include "megbrain/comp_node_env.h"
+#include "megbrain/graph/static_mem_plan.h"
 #include "megbrain/opr/io.h"
 #include "megbrain/serialization/helper.h"
 #include "megbrain/serialization/internal/flatbuffers_helper.h"
@@ -371,6 +372,21 @@ GraphDumper::DumpResult GraphDumperOSSV2::dump(
     if (m_config.keep_var_name >= 1)
         fb_mid_tensor = m_builder.CreateVector(m_model_middle_tensors);
 
+    // Dump static memory plans
+    flatbuffers::Offset<
+            flatbuffers::Vector<flatbuffers::Offset<fbs::v2::StaticMemPlan>>>
+            fb_mem_plans;
+    if (m_config.keep_static_mem_plan) {
+        std::vector<flatbuffers::Offset<fbs::v2::StaticMemPlan>> mem_plans;
+        for (auto&& plan : cg::StaticMemPlanCache::get_graph_plans(
+                     *output_vars[0].node()->owner_graph())) {
+            std::vector<uint64_t> offsets(plan.offsets.begin(), plan.offsets.end());
+            mem_plans.push_back(fbs::v2::CreateStaticMemPlan(
+                    m_builder, plan.key, m_builder.CreateVector(offsets)));
+        }
+        fb_mem_plans = m_builder.CreateVector(mem_plans);
+    }
+
     fbs::v2::ModelBuilder model(m_builder);
     model.add_mge_version(MGB_VERSION);
     model.add_model_version(m_version);
@@ -382,6 +398,9 @@ GraphDumper::DumpResult GraphDumperOSSV2::dump(
     model.add_output_alias(fbs_output_alias);
     model.add_nr_shared_tensor(m_nr_shared_tensor);
     model.add_metadata(fbmeta);
+    if (m_config.keep_static_mem_plan) {
+        model.add_static_mem_plans(fb_mem_plans);
+    }
     m_builder.FinishSizePrefixed(model.Finish(), fbs::v2::ModelIdentifier());
 
     // Write serialized fbs::Graph
@@ -448,6 +467,10 @@ void GraphDumperOSSV2::dump_tensor(
                     reinterpret_cast<uint8_t*>(out_vec.data()), out_vec.size());
             m_cur_rst.tensor_value_bytes += out_vec.size();
         } else {
+            if (auto align = m_config.tensor_value_alignment) {
+                m_builder.ForceVectorAlignment(
+                        layout.span().high_byte, sizeof(uint8_t), align);
+            }
             data = m_builder.CreateVector(
                     reinterpret_cast<uint8_t*>(tensor.raw_ptr()),
                     layout.span().high_byte);
@@ -884,6 +907,19 @@ GraphLoader::LoadResult GraphLoaderOSSV2::load(const LoadConfig& config, bool re
     OprLoadContextImpl ctx{this, &tensor_alignment, m_model->mge_version()};
     ctx.load_middle_tensor();
     auto metadata = ctx.load_metadata();
+    if (auto fb_mem_plans = m_model->static_mem_plans()) {
+        // imported into the cache to be used by graph_compile_ahead() below and
+        // later compiles of the graph
+        for (auto fb_plan : *fb_mem_plans) {
+            cg::StaticMemPlan plan;
+            plan.key = fb_plan->key();
+            if (fb_plan->offsets()) {
+                plan.offsets.assign(
+                        fb_plan->offsets()->begin(), fb_plan->offsets()->end());
+            }
+            cg::StaticMemPlanCache::put(plan);
+        }
+    }
     auto result = ctx.load_oprs();
     result.metadata = metadata;
     if (m_model->output_alias() && m_model->output_alias()->size() > 0) {
@@ -18,6 +18,9 @@ public:
     const void* data() const { return m_buf.get(); }
 
     size_t size() const { return m_size; }
+
+    //! the pointer that holds the buffer, used to share sub-regions of it
+    const std::shared_ptr<const void>& holder() const { return m_buf; }
 };
 
 //! abstract input file interface
@@ -87,6 +90,17 @@ public:
      */
     MGE_WIN_DECLSPEC_FUC static std::unique_ptr<InputFile> make_mem_proxy(
             std::shared_ptr<void> ptr, size_t size, bool writable = true);
+
+    /*!
+     * \brief create a read-only InputFile that maps a file on local file
+     *      system into memory
+     *
+     * Tensor values whose address in the mapping is suitably aligned would be
+     * shared without copy, and the mapping is kept alive until all of them
+     * are released. It falls back to make_fs() on platforms without mmap.
+     */
+    MGE_WIN_DECLSPEC_FUC static std::unique_ptr<InputFile> make_mmap(
+            const char* path);
 };
 
 //! abstract output file interface
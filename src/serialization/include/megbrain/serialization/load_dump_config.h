@@ -66,6 +66,19 @@ struct GraphDumpConfig {
     //! whether dump to compat older megbrain version
     std::string compat_older_version;
 
+    //! alignment in bytes of the raw tensor values relative to the start of
+    //! the model (only supported by FLATBUFFERS_V2), so that they can be
+    //! shared without copy when loaded by InputFile::make_mmap(); padding
+    //! changes the dumped bytes, so it is disabled (0) by default
+    size_t tensor_value_alignment = 0;
+
+    //! whether to dump the static memory plans used by the last compile of
+    //! the graph (only supported by FLATBUFFERS_V2); they are reused when the
+    //! loaded graph is compiled with the same memory intervals, which is
+    //! usually the case if the dumped graph has been optimized for inference
+    //! and compiled with seq_opt.static_mem_search_budget > 0
+    bool keep_static_mem_plan = false;
+
     GraphDumpConfig(
             int keep_var_name_ = 1, bool keep_param_name_ = false,
             bool keep_opr_priority_ = false, bool keep_op_name_ = true,
@@ -152,7 +152,8 @@ public:
 
     //! shared or copy the loaded flatbuffer memory to the CPU tensor, this can reduce
     //! the memory used when load model, but should consider the memory
-    //! alignment
+    //! alignment: read-only buffers (such as a mmaped file) could not be
+    //! reordered later, so only the values aligned at dump time are shared
     void fill_tensor_memory(
             HostTensorND& tensor, const uint8_t* data, size_t size, bool shared,
             GraphLoadConfig::TensorValueLoader loader) {
@@ -168,10 +169,14 @@ public:
             mgb_assert(
                     size == tensor_size,
                     "the size is not match when shared the flatbuffer memory\n");
-            if (shared) {
+            auto align = tensor.comp_node().get_mem_addr_alignment();
+            bool aligned = !(reinterpret_cast<uintptr_t>(ptr) & (align - 1));
+            if (shared && (aligned || m_loader->m_file->writable())) {
                 HostTensorStorage storage;
+                //! hold the model buffer, which may be unmapped on release
                 auto raw_storage = std::shared_ptr<mgb::dt_byte>(
-                        static_cast<mgb::dt_byte*>(ptr), [](void*) {});
+                        std::const_pointer_cast<void>(m_loader->m_model_buf.holder()),
+                        static_cast<mgb::dt_byte*>(ptr));
                 storage.reset(tensor.comp_node(), size, raw_storage);
                 tensor.reset(storage, tensor.layout());
             } else {
@@ -1,6 +1,7 @@
 #include "megbrain/opr/nn_int.h"
 #if MGB_ENABLE_FBS_SERIALIZATION
 
+#include "megbrain/graph/static_mem_plan.h"
 #include "megbrain/opr/basic_arith_wrapper.h"
 #include "megbrain/opr/dnn/convolution.h"
 #include "megbrain/opr/dnn/softmax.h"
@@ -10,6 +11,11 @@
 #include "megbrain/serialization/serializer.h"
 #include "megbrain/test/helper.h"
 
+#include <fstream>
+#ifdef __linux__
+#include <sys/stat.h>
+#endif
+
 using namespace mgb;
 using namespace serialization;
 
@@ -1048,6 +1054,122 @@ TEST(TestSerializer2, ShareMemv2) {
     test_serializer_memshare(GraphDumpFormat::FLATBUFFERS_V2);
 }
 
+namespace {
+#ifdef __linux__
+//! whether \p ptr lies in a mapping of the file \p fname, by /proc/self/maps
+bool in_file_mapping(const void* ptr, const std::string& fname) {
+    struct stat st;
+    mgb_assert(!stat(fname.c_str(), &st));
+    auto addr = reinterpret_cast<uintptr_t>(ptr);
+    std::ifstream maps{"/proc/self/maps"};
+    std::string line;
+    while (std::getline(maps, line)) {
+        // address range, perms, offset, dev, inode and path
+        unsigned long long begin, end, inode;
+        if (sscanf(line.c_str(), "%llx-%llx %*s %*s %*s %llu", &begin, &end,
+                   &inode) == 3 &&
+            inode == st.st_ino && addr >= begin && addr < end) {
+            return true;
+        }
+    }
+    return false;
+}
+#endif
+}  // namespace
+
+TEST(TestSerializer2, MmapV2) {
+    auto fname = GET_OUTPUT_FILE(GraphDumpFormat::FLATBUFFERS_V2);
+    HostTensorGenerator<> gen;
+    auto xval = gen({127}, "cpu0"), yval = gen({3, 5}, "cpu0");
+    {
+        auto graph = ComputingGraph::make();
+        auto x = opr::SharedDeviceTensor::make(*graph, *xval).rename("x");
+        auto y = opr::ImmutableTensor::make(*graph, *yval).rename("y");
+        auto dumper = GraphDumper::make(
+                OutputFile::make_fs(fname.c_str()), GraphDumpFormat::FLATBUFFERS_V2);
+        GraphDumpConfig config;
+        config.tensor_value_alignment = 64;
+        dumper->dump({x, y}, config);
+    }
+
+    // the loader is released right after load, and the params shared from the
+    // mapping should keep it alive
+    auto rst = GraphLoader::make(
+                       InputFile::make_mmap(fname.c_str()),
+                       GraphDumpFormat::FLATBUFFERS_V2)
+                       ->load();
+    auto&& x = rst.output_var_map.at("x")
+                       .node()
+                       ->owner_opr()
+                       ->cast_final_safe<opr::SharedDeviceTensor>();
+    auto&& y = rst.output_var_map.at("y")
+                       .node()
+                       ->owner_opr()
+                       ->cast_final_safe<opr::ImmutableTensor>();
+    for (auto&& dv : {*x.dev_data(), y.value()}) {
+        auto align = dv.comp_node().get_mem_addr_alignment();
+        ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(dv.raw_ptr()) & (align - 1));
+#ifdef __linux__
+        // shared from the mapping rather than copied
+        ASSERT_TRUE(in_file_mapping(dv.raw_ptr(), fname));
+#endif
+    }
+    MGB_ASSERT_TENSOR_EQ(*xval, HostTensorND{}.copy_from(*x.dev_data()).sync());
+    MGB_ASSERT_TENSOR_EQ(*yval, HostTensorND{}.copy_from(y.value()).sync());
+}
+
+TEST(TestSerializer2, StaticMemPlanV2) {
+    auto fname = GET_OUTPUT_FILE(GraphDumpFormat::FLATBUFFERS_V2);
+    HostTensorGenerator<> gen;
+    auto host_x = gen({23, 45}, "cpu0");
+    auto make_y = [](SymbolVar x) {
+        auto y = x;
+        for (int i = 0; i < 5; ++i) {
+            y = opr::exp(y * 0.1f) + opr::abs(x) * (y + i);
+        }
+        return y;
+    };
+
+    std::vector<cg::StaticMemPlan> dumped_plans;
+    HostTensorND y_expect;
+    {
+        auto graph = ComputingGraph::make();
+        graph->options().seq_opt.static_mem_search_budget = 0.05;
+        auto x = opr::Host2DeviceCopy::make(*graph, host_x).rename("x");
+        auto y = make_y(x).rename("y");
+        auto func = graph->compile({make_callback_copy(y, y_expect)});
+        func->execute();
+        dumped_plans = cg::StaticMemPlanCache::get_graph_plans(*graph);
+        ASSERT_FALSE(dumped_plans.empty());
+
+        GraphDumpConfig config;
+        config.keep_static_mem_plan = true;
+        GraphDumper::make(
+                OutputFile::make_fs(fname.c_str()), GraphDumpFormat::FLATBUFFERS_V2)
+                ->dump({y}, config);
+    }
+
+    // the loaded graph uses the plans in the model without searching
+    cg::StaticMemPlanCache::clear();
+    auto rst = GraphLoader::make(
+                       InputFile::make_fs(fname.c_str()),
+                       GraphDumpFormat::FLATBUFFERS_V2)
+                       ->load();
+    ASSERT_FALSE(cg::StaticMemPlanCache::empty());
+    HostTensorND y_get;
+    rst.tensor_map.at("x")->copy_from(*host_x);
+    auto func = rst.graph_compile({make_callback_copy(rst.output_var_list[0], y_get)});
+    func->execute();
+    auto loaded_plans = cg::StaticMemPlanCache::get_graph_plans(*rst.graph);
+    ASSERT_EQ(dumped_plans.size(), loaded_plans.size());
+    for (size_t i = 0; i < dumped_plans.size(); ++i) {
+        ASSERT_EQ(dumped_plans[i].key, loaded_plans[i].key);
+        ASSERT_EQ(dumped_plans[i].offsets, loaded_plans[i].offsets);
+    }
+    MGB_ASSERT_TENSOR_NEAR(y_expect, y_get, 1e-5);
+    cg::StaticMemPlanCache::clear();
+}
+
 TEST(TestSerializer2, TestSoftMaxLoadDump) {
     auto fname = GET_OUTPUT_FILE(GraphDumpFormat::FLATBUFFERS_V2);
     TensorShape shape{2, 3};